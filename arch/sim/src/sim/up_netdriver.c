@@ -58,6 +58,10 @@
 #  include <nuttx/net/pkt.h>
 #endif
 
+#ifdef CONFIG_NETDEV_IOB_RX
+#  include <nuttx/mm/iob.h>
+#endif
+
 #include "up_internal.h"
 
 /****************************************************************************
@@ -120,6 +124,9 @@ static void netdriver_recv_work(FAR void *arg)
 {
   FAR struct net_driver_s *dev = arg;
   FAR struct eth_hdr_s *eth;
+#ifdef CONFIG_NETDEV_IOB_RX
+  FAR struct iob_s *iob;
+#endif
 
   net_lock();
 
@@ -127,8 +134,33 @@ static void netdriver_recv_work(FAR void *arg)
    * on a data received event
    */
 
-  dev->d_len = netdev_read((FAR unsigned char *)dev->d_buf,
-                           dev->d_pktsize);
+#ifdef CONFIG_NETDEV_IOB_RX
+  /* Receive into an I/O buffer so that the network can keep received data
+   * without copying it.
+   */
+
+  iob = iob_tryalloc(true, IOBUSER_NET_NETDEV);
+  if (iob != NULL)
+    {
+      iob->io_len    = netdev_read(IOB_DATA(iob), dev->d_pktsize);
+      iob->io_pktlen = iob->io_len;
+      if (iob->io_len > 0)
+        {
+          netdev_iob_prepare(dev, iob);
+        }
+      else
+        {
+          iob_free(iob, IOBUSER_NET_NETDEV);
+          dev->d_len = 0;
+        }
+    }
+  else
+#endif
+    {
+      dev->d_len = netdev_read((FAR unsigned char *)dev->d_buf,
+                               dev->d_pktsize);
+    }
+
   if (dev->d_len > 0)
     {
       NETDEV_RXPACKETS(dev);
@@ -218,6 +250,12 @@ static void netdriver_recv_work(FAR void *arg)
         }
     }
 
+#ifdef CONFIG_NETDEV_IOB_RX
+  /* Free the I/O buffer (if any) now that any reply has been sent */
+
+  netdev_iob_release(dev);
+#endif
+
   net_unlock();
 }
 
@@ -166,6 +166,60 @@ int simuart_getc(int fd)
   return ret < 0 ? ret : ch;
 }
 
+/****************************************************************************
+ * Name: simuart_read
+ ****************************************************************************/
+
+int simuart_read(int fd, char *buf, size_t len)
+{
+  int ret;
+
+  ret = read(fd, buf, len);
+  return ret < 0 ? -errno : ret;
+}
+
+/****************************************************************************
+ * Name: simuart_write
+ *
+ * Description:
+ *   Write the whole buffer.  The host fd may be non-blocking, so wait for
+ *   it to drain whenever it is full instead of returning a short count.
+ *
+ ****************************************************************************/
+
+int simuart_write(int fd, const char *buf, size_t len)
+{
+  struct pollfd pfd;
+  size_t nwritten = 0;
+  ssize_t ret;
+
+  while (nwritten < len)
+    {
+      ret = write(fd, &buf[nwritten], len - nwritten);
+      if (ret > 0)
+        {
+          nwritten += ret;
+        }
+      else if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+          pfd.fd     = fd;
+          pfd.events = POLLOUT;
+          poll(&pfd, 1, -1);
+        }
+      else if (ret == 0 || errno != EINTR)
+        {
+          if (nwritten == 0 && ret < 0)
+            {
+              return -errno;
+            }
+
+          break;
+        }
+    }
+
+  return nwritten;
+}
+
 /****************************************************************************
  * Name: simuart_getcflag
  ****************************************************************************/
@@ -42,6 +42,7 @@
 #include <nuttx/fs/ioctl.h>
 #include <sys/types.h>
 #include <fcntl.h>
+#include <string.h>
 #include <errno.h>
 
 #include "up_internal.h"
@@ -81,6 +82,12 @@ static int  tty_ioctl(FAR struct file *filep, int cmd,
 static int  tty_receive(FAR struct uart_dev_s *dev, uint32_t *status);
 static void tty_rxint(FAR struct uart_dev_s *dev, bool enable);
 static bool tty_rxavailable(FAR struct uart_dev_s *dev);
+#ifdef CONFIG_SERIAL_BLOCKIO
+static size_t tty_recvbuf(FAR struct uart_dev_s *dev, FAR char *buffer,
+                          size_t buflen);
+static size_t tty_sendbuf(FAR struct uart_dev_s *dev,
+                          FAR const char *buffer, size_t buflen);
+#endif
 static void tty_send(FAR struct uart_dev_s *dev, int ch);
 static void tty_txint(FAR struct uart_dev_s *dev, bool enable);
 static bool tty_txready(FAR struct uart_dev_s *dev);
@@ -104,6 +111,10 @@ static const struct uart_ops_s g_tty_ops =
   .txint          = tty_txint,
   .txready        = tty_txready,
   .txempty        = tty_txempty,
+#ifdef CONFIG_SERIAL_BLOCKIO
+  .recvbuf        = tty_recvbuf,
+  .sendbuf        = tty_sendbuf,
+#endif
 };
 #endif
 
@@ -415,6 +426,96 @@ static bool tty_rxavailable(struct uart_dev_s *dev)
   return simuart_checkc(dev->isconsole ? 0 : priv->fd);
 }
 
+/****************************************************************************
+ * Name: tty_recvbuf
+ *
+ * Description:
+ *   Read whatever the host has buffered with a single read() call
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SERIAL_BLOCKIO
+static size_t tty_recvbuf(FAR struct uart_dev_s *dev, FAR char *buffer,
+                          size_t buflen)
+{
+  FAR struct tty_priv_s *priv = dev->priv;
+  int fd = dev->isconsole ? 0 : priv->fd;
+  int ret;
+
+  /* The console is not opened non-blocking, so check first */
+
+  if (!simuart_checkc(fd))
+    {
+      return 0;
+    }
+
+  ret = simuart_read(fd, buffer, buflen);
+  return ret > 0 ? ret : 0;
+}
+
+/****************************************************************************
+ * Name: tty_sendbuf
+ *
+ * Description:
+ *   Write a buffer with a single write() call, or with one call per line
+ *   on the console where '\n' has to become "\r\n".  simuart_write()
+ *   waits for the host fd to drain, so the whole buffer is sent unless the
+ *   host reports an error.
+ *
+ ****************************************************************************/
+
+static size_t tty_sendbuf(FAR struct uart_dev_s *dev,
+                          FAR const char *buffer, size_t buflen)
+{
+  FAR struct tty_priv_s *priv = dev->priv;
+  FAR const char *newline = NULL;
+  int fd = dev->isconsole ? 1 : priv->fd;
+  size_t nsent = 0;
+  size_t len;
+  int ret;
+
+  while (nsent < buflen)
+    {
+      len = buflen - nsent;
+      if (dev->isconsole)
+        {
+          newline = memchr(&buffer[nsent], '\n', len);
+          if (newline != NULL)
+            {
+              len = newline - &buffer[nsent];
+            }
+        }
+
+      if (len > 0)
+        {
+          ret = simuart_write(fd, &buffer[nsent], len);
+          if (ret <= 0)
+            {
+              break;
+            }
+
+          nsent += ret;
+          if ((size_t)ret < len)
+            {
+              break;
+            }
+        }
+
+      if (newline != NULL)
+        {
+          if (simuart_write(fd, "\r\n", 2) != 2)
+            {
+              break;
+            }
+
+          nsent++;
+        }
+    }
+
+  return nsent;
+}
+#endif
+
 /****************************************************************************
  * Name: tty_send
  *
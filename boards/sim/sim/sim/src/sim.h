@@ -145,4 +145,71 @@ int sim_gpio_initialize(void);
 int sim_tsc_setup(int minor);
 #endif
 
+/****************************************************************************
+ * Name: sim_bench_start
+ *
+ * Description:
+ *   Start the thread that runs the enabled board benchmarks.
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is returned on
+ *   failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SIM_BENCH
+int sim_bench_start(void);
+#endif
+
+/****************************************************************************
+ * Name: sim_heapbench
+ *
+ * Description:
+ *   Run the heap manager benchmark and report the results to the SYSLOG.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SIM_HEAPBENCH
+void sim_heapbench(void);
+#endif
+
+/****************************************************************************
+ * Name: sim_stringbench
+ *
+ * Description:
+ *   Run the string function checks and benchmark and report the results to
+ *   the SYSLOG.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SIM_STRINGBENCH
+void sim_stringbench(void);
+#endif
+
+/****************************************************************************
+ * Name: sim_serialbench
+ *
+ * Description:
+ *   Run the serial upper half throughput benchmark and report the results
+ *   to the SYSLOG.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SIM_SERIALBENCH
+void sim_serialbench(void);
+#endif
+
+/****************************************************************************
+ * Name: sim_sembench
+ *
+ * Description:
+ *   Run the uncontended semaphore and mutex benchmark and report the
+ *   results to the SYSLOG.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SIM_SEMBENCH
+void sim_sembench(void);
+#endif
+
 #endif /* __BOARDS_SIM_SIM_SIM_SRC_SIM_H */
@@ -0,0 +1,89 @@
+/****************************************************************************
+ * boards/sim/sim/sim/src/sim_bench.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdlib.h>
+
+#include <nuttx/kthread.h>
+
+#include "sim.h"
+
+#ifdef CONFIG_SIM_BENCH
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sim_bench_main
+ *
+ * Description:
+ *   Run the enabled benchmarks one after the other.
+ *
+ ****************************************************************************/
+
+static int sim_bench_main(int argc, FAR char *argv[])
+{
+#ifdef CONFIG_SIM_HEAPBENCH
+  sim_heapbench();
+#endif
+
+#ifdef CONFIG_SIM_STRINGBENCH
+  sim_stringbench();
+#endif
+
+#ifdef CONFIG_SIM_SERIALBENCH
+  sim_serialbench();
+#endif
+
+#ifdef CONFIG_SIM_SEMBENCH
+  sim_sembench();
+#endif
+
+  return EXIT_SUCCESS;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sim_bench_start
+ *
+ * Description:
+ *   Start the thread that runs the enabled board benchmarks.
+ *
+ ****************************************************************************/
+
+int sim_bench_start(void)
+{
+  int pid;
+
+  pid = kthread_create("sim_bench", CONFIG_SIM_BENCH_PRIORITY,
+                       CONFIG_SIM_BENCH_STACKSIZE, sim_bench_main, NULL);
+  return pid < 0 ? pid : OK;
+}
+
+#endif /* CONFIG_SIM_BENCH */
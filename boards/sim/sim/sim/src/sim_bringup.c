@@ -31,6 +31,7 @@
 
 #include <nuttx/board.h>
 #include <nuttx/clock.h>
+#include <nuttx/crypto/crypto.h>
 #include <nuttx/kmalloc.h>
 #include <nuttx/mtd/mtd.h>
 #include <nuttx/fs/nxffs.h>
@@ -311,5 +312,26 @@ int sim_bringup(void)
     }
 #endif
 
+#if defined(CONFIG_CRYPTO_ALGTEST) && defined(CONFIG_CRYPTO_CRYPTODEV) && \
+    (defined(CONFIG_CRYPTO_AES) || defined(CONFIG_CRYPTO_SW_AES))
+  /* Test /dev/crypto now that it is registered and the work queues run */
+
+  ret = cryptodev_test();
+  if (ret < 0)
+    {
+      syslog(LOG_ERR, "ERROR: cryptodev_test() failed: %d\n", ret);
+    }
+#endif
+
+#ifdef CONFIG_SIM_BENCH
+  /* Run the board benchmarks in the background */
+
+  ret = sim_bench_start();
+  if (ret < 0)
+    {
+      syslog(LOG_ERR, "ERROR: sim_bench_start() failed: %d\n", ret);
+    }
+#endif
+
   return ret;
 }
@@ -0,0 +1,195 @@
+/****************************************************************************
+ * boards/sim/sim/sim/src/sim_heapbench.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <malloc.h>
+#include <syslog.h>
+
+#include <nuttx/mm/mm.h>
+
+#include "up_internal.h"
+#include "sim.h"
+
+#ifdef CONFIG_SIM_HEAPBENCH
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define HEAPBENCH_NSLOTS  CONFIG_SIM_HEAPBENCH_NSLOTS
+
+#ifdef CONFIG_MM_TLSF_MANAGER
+#  define HEAPBENCH_NAME  "TLSF"
+#else
+#  define HEAPBENCH_NAME  "default"
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct heapbench_stat_s
+{
+  uint64_t total;   /* Total time of all operations (ns) */
+  uint64_t worst;   /* Time of the slowest operation (ns) */
+  uint32_t count;   /* Number of operations */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The benchmark uses a private heap so that the results do not depend on
+ * the state of the system heaps.
+ */
+
+static struct mm_heap_s g_benchheap;
+static uint64_t g_benchmem[CONFIG_SIM_HEAPBENCH_HEAPSIZE / sizeof(uint64_t)];
+static FAR void *g_benchslot[HEAPBENCH_NSLOTS];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint32_t heapbench_random(FAR uint32_t *seed)
+{
+  *seed = *seed * 1103515245 + 12345;
+  return *seed >> 8;
+}
+
+static void heapbench_account(FAR struct heapbench_stat_s *stat,
+                              uint64_t elapsed)
+{
+  stat->total += elapsed;
+  stat->count++;
+  if (elapsed > stat->worst)
+    {
+      stat->worst = elapsed;
+    }
+}
+
+static void heapbench_report(FAR const char *name,
+                             FAR struct heapbench_stat_s *stat)
+{
+  syslog(LOG_INFO, "heapbench: %-7s count=%lu avg=%lu ns worst=%lu ns\n",
+         name, (unsigned long)stat->count,
+         (unsigned long)(stat->count ? stat->total / stat->count : 0),
+         (unsigned long)stat->worst);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sim_heapbench
+ *
+ * Description:
+ *   Run a randomized allocate/free workload against a private heap and
+ *   report the average and worst case times of mm_malloc() and mm_free()
+ *   and the fragmentation of the heap.  Run it with MM_DEFAULT_MANAGER
+ *   and with MM_TLSF_MANAGER to compare the two heap managers.
+ *
+ ****************************************************************************/
+
+void sim_heapbench(void)
+{
+  struct heapbench_stat_s mstat =
+  {
+    0
+  };
+
+  struct heapbench_stat_s fstat =
+  {
+    0
+  };
+
+  struct mallinfo info;
+  uint32_t seed = 1;
+  uint32_t failed = 0;
+  uint64_t start;
+  size_t size;
+  int slot;
+  int i;
+
+  mm_initialize(&g_benchheap, g_benchmem, sizeof(g_benchmem));
+
+  for (i = 0; i < CONFIG_SIM_HEAPBENCH_ITERATIONS; i++)
+    {
+      slot = heapbench_random(&seed) % HEAPBENCH_NSLOTS;
+      if (g_benchslot[slot] != NULL)
+        {
+          start = host_gettime(false);
+          mm_free(&g_benchheap, g_benchslot[slot]);
+          heapbench_account(&fstat, host_gettime(false) - start);
+
+          g_benchslot[slot] = NULL;
+        }
+      else
+        {
+          /* Mostly small allocations with some larger ones mixed in to
+           * fragment the heap.
+           */
+
+          if ((heapbench_random(&seed) & 7) != 0)
+            {
+              size = 8 + heapbench_random(&seed) % 256;
+            }
+          else
+            {
+              size = 256 + heapbench_random(&seed) % 8192;
+            }
+
+          start = host_gettime(false);
+          g_benchslot[slot] = mm_malloc(&g_benchheap, size);
+          heapbench_account(&mstat, host_gettime(false) - start);
+
+          if (g_benchslot[slot] == NULL)
+            {
+              failed++;
+            }
+        }
+    }
+
+  mm_mallinfo(&g_benchheap, &info);
+
+  syslog(LOG_INFO, "heapbench: %s heap manager, %d iterations\n",
+         HEAPBENCH_NAME, CONFIG_SIM_HEAPBENCH_ITERATIONS);
+  heapbench_report("malloc", &mstat);
+  heapbench_report("free", &fstat);
+  syslog(LOG_INFO, "heapbench: failed=%lu free=%d chunks=%d largest=%d\n",
+         (unsigned long)failed, info.fordblks, info.ordblks, info.mxordblk);
+
+  /* Release the remaining allocations */
+
+  for (slot = 0; slot < HEAPBENCH_NSLOTS; slot++)
+    {
+      mm_free(&g_benchheap, g_benchslot[slot]);
+      g_benchslot[slot] = NULL;
+    }
+}
+
+#endif /* CONFIG_SIM_HEAPBENCH */
@@ -0,0 +1,130 @@
+/****************************************************************************
+ * boards/sim/sim/sim/src/sim_sembench.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <syslog.h>
+
+#include <nuttx/semaphore.h>
+
+#include "up_internal.h"
+#include "sim.h"
+
+#ifdef CONFIG_SIM_SEMBENCH
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void sembench_report(FAR const char *name, uint64_t elapsed,
+                            int errors)
+{
+  syslog(LOG_INFO, "sembench: %-5s %lu ns, %lu ns/cycle, %d errors\n",
+         name, (unsigned long)elapsed,
+         (unsigned long)(elapsed / CONFIG_SIM_SEMBENCH_ITERATIONS),
+         errors);
+}
+
+/* Take and give a semaphore that is always available */
+
+static void sembench_sem(void)
+{
+  uint64_t start;
+  sem_t sem;
+  int errors = 0;
+  int i;
+
+  sem_init(&sem, 0, 1);
+  sem_setprotocol(&sem, SEM_PRIO_NONE);
+
+  start = host_gettime(false);
+  for (i = 0; i < CONFIG_SIM_SEMBENCH_ITERATIONS; i++)
+    {
+      if (sem_wait(&sem) < 0 || sem_post(&sem) < 0)
+        {
+          errors++;
+        }
+    }
+
+  sembench_report("sem", host_gettime(false) - start, errors);
+  sem_destroy(&sem);
+}
+
+#ifndef CONFIG_DISABLE_PTHREAD
+/* Lock and unlock a mutex that no other thread ever asks for */
+
+static void sembench_mutex(void)
+{
+  pthread_mutexattr_t attr;
+  pthread_mutex_t mutex;
+  uint64_t start;
+  int errors = 0;
+  int i;
+
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_NONE);
+  pthread_mutex_init(&mutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+
+  start = host_gettime(false);
+  for (i = 0; i < CONFIG_SIM_SEMBENCH_ITERATIONS; i++)
+    {
+      if (pthread_mutex_lock(&mutex) != 0 ||
+          pthread_mutex_unlock(&mutex) != 0)
+        {
+          errors++;
+        }
+    }
+
+  sembench_report("mutex", host_gettime(false) - start, errors);
+  pthread_mutex_destroy(&mutex);
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sim_sembench
+ *
+ * Description:
+ *   Time uncontended semaphore wait/post and mutex lock/unlock cycles and
+ *   report the average cost of a cycle.  With CONFIG_SEM_FASTPATH these
+ *   should never enter the OS.
+ *
+ ****************************************************************************/
+
+void sim_sembench(void)
+{
+  sembench_sem();
+#ifndef CONFIG_DISABLE_PTHREAD
+  sembench_mutex();
+#endif
+}
+
+#endif /* CONFIG_SIM_SEMBENCH */
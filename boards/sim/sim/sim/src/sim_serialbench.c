@@ -0,0 +1,366 @@
+/****************************************************************************
+ * boards/sim/sim/sim/src/sim_serialbench.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <syslog.h>
+
+#include <nuttx/serial/serial.h>
+
+#include "up_internal.h"
+#include "sim.h"
+
+#ifdef CONFIG_SIM_SERIALBENCH
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define SERIALBENCH_FIFOSIZE  16     /* FIFO depth of a 16550 */
+#define SERIALBENCH_BUFSIZE   256    /* Same buffers as the sim UARTs */
+#define SERIALBENCH_TXBURST   64     /* Bytes queued per write() */
+#define SERIALBENCH_NCHECKS   64     /* Iterations of the check pass */
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int  serialbench_receive(FAR struct uart_dev_s *dev,
+                                FAR unsigned int *status);
+static bool serialbench_rxavailable(FAR struct uart_dev_s *dev);
+static void serialbench_send(FAR struct uart_dev_s *dev, int ch);
+static void serialbench_txint(FAR struct uart_dev_s *dev, bool enable);
+static bool serialbench_txready(FAR struct uart_dev_s *dev);
+static bool serialbench_txempty(FAR struct uart_dev_s *dev);
+#ifdef CONFIG_SERIAL_BLOCKIO
+static size_t serialbench_recvbuf(FAR struct uart_dev_s *dev,
+                                  FAR char *buffer, size_t buflen);
+static size_t serialbench_sendbuf(FAR struct uart_dev_s *dev,
+                                  FAR const char *buffer, size_t buflen);
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* A loopback lower half that models the FIFOs of a 16550: every RX
+ * interrupt finds a full RX FIFO and every TX interrupt an empty TX FIFO.
+ */
+
+static const struct uart_ops_s g_serialbench_charops =
+{
+  .receive        = serialbench_receive,
+  .rxavailable    = serialbench_rxavailable,
+  .send           = serialbench_send,
+  .txint          = serialbench_txint,
+  .txready        = serialbench_txready,
+  .txempty        = serialbench_txempty,
+};
+
+#ifdef CONFIG_SERIAL_BLOCKIO
+static const struct uart_ops_s g_serialbench_blockops =
+{
+  .receive        = serialbench_receive,
+  .rxavailable    = serialbench_rxavailable,
+  .recvbuf        = serialbench_recvbuf,
+  .sendbuf        = serialbench_sendbuf,
+  .send           = serialbench_send,
+  .txint          = serialbench_txint,
+  .txready        = serialbench_txready,
+  .txempty        = serialbench_txempty,
+};
+#endif
+
+static char g_serialbench_rxbuf[SERIALBENCH_BUFSIZE];
+static char g_serialbench_txbuf[SERIALBENCH_BUFSIZE];
+
+static struct uart_dev_s g_serialbench_dev =
+{
+  .xmit =
+  {
+    .size         = SERIALBENCH_BUFSIZE,
+    .buffer       = g_serialbench_txbuf,
+  },
+  .recv =
+  {
+    .size         = SERIALBENCH_BUFSIZE,
+    .buffer       = g_serialbench_rxbuf,
+  },
+};
+
+static char     g_rxfifo[SERIALBENCH_FIFOSIZE];
+static size_t   g_rxfifolen;      /* Bytes in the RX FIFO */
+static size_t   g_rxfifopos;      /* Next byte to read from the RX FIFO */
+static size_t   g_txfifolen;      /* Bytes in the TX FIFO */
+static uint8_t  g_rxseq;          /* Next byte arriving on the wire */
+static uint8_t  g_txseq;          /* Next byte expected on the wire */
+static bool     g_checking;       /* Verify the transmitted data */
+static uint32_t g_ncalls;         /* Calls into the lower half */
+static int      g_errors;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static int serialbench_receive(FAR struct uart_dev_s *dev,
+                               FAR unsigned int *status)
+{
+  g_ncalls++;
+  *status = 0;
+  return (uint8_t)g_rxfifo[g_rxfifopos++];
+}
+
+static bool serialbench_rxavailable(FAR struct uart_dev_s *dev)
+{
+  g_ncalls++;
+  return g_rxfifopos < g_rxfifolen;
+}
+
+static void serialbench_send(FAR struct uart_dev_s *dev, int ch)
+{
+  g_ncalls++;
+  if (g_checking && (uint8_t)ch != g_txseq)
+    {
+      g_errors++;
+    }
+
+  g_txseq++;
+  g_txfifolen++;
+}
+
+static void serialbench_txint(FAR struct uart_dev_s *dev, bool enable)
+{
+}
+
+static bool serialbench_txready(FAR struct uart_dev_s *dev)
+{
+  g_ncalls++;
+  return g_txfifolen < SERIALBENCH_FIFOSIZE;
+}
+
+static bool serialbench_txempty(FAR struct uart_dev_s *dev)
+{
+  return g_txfifolen == 0;
+}
+
+#ifdef CONFIG_SERIAL_BLOCKIO
+static size_t serialbench_recvbuf(FAR struct uart_dev_s *dev,
+                                  FAR char *buffer, size_t buflen)
+{
+  size_t nbytes = g_rxfifolen - g_rxfifopos;
+
+  g_ncalls++;
+  if (nbytes > buflen)
+    {
+      nbytes = buflen;
+    }
+
+  memcpy(buffer, &g_rxfifo[g_rxfifopos], nbytes);
+  g_rxfifopos += nbytes;
+  return nbytes;
+}
+
+static size_t serialbench_sendbuf(FAR struct uart_dev_s *dev,
+                                  FAR const char *buffer, size_t buflen)
+{
+  size_t nbytes;
+
+  /* Like u16550_sendbuf(), only fill an empty FIFO */
+
+  g_ncalls++;
+  if (g_txfifolen != 0)
+    {
+      return 0;
+    }
+
+  nbytes = buflen < SERIALBENCH_FIFOSIZE ? buflen : SERIALBENCH_FIFOSIZE;
+  if (g_checking)
+    {
+      size_t i;
+
+      for (i = 0; i < nbytes; i++)
+        {
+          if ((uint8_t)buffer[i] != (uint8_t)(g_txseq + i))
+            {
+              g_errors++;
+              break;
+            }
+        }
+    }
+
+  g_txseq += nbytes;
+  g_txfifolen = nbytes;
+  return nbytes;
+}
+#endif
+
+/* Let one RX FIFO worth of data arrive and take it with one interrupt, then
+ * let the reader take it out of the RX buffer.
+ */
+
+static void serialbench_rx(FAR struct uart_dev_s *dev, int iterations)
+{
+  FAR struct uart_buffer_s *rxbuf = &dev->recv;
+  uint8_t rxcheck = g_rxseq;
+  int i;
+  int j;
+
+  for (i = 0; i < iterations; i++)
+    {
+      for (j = 0; j < SERIALBENCH_FIFOSIZE; j++)
+        {
+          g_rxfifo[j] = g_rxseq++;
+        }
+
+      g_rxfifolen = SERIALBENCH_FIFOSIZE;
+      g_rxfifopos = 0;
+      uart_recvchars(dev);
+
+      if (g_checking)
+        {
+          while (rxbuf->tail != rxbuf->head)
+            {
+              if ((uint8_t)rxbuf->buffer[rxbuf->tail] != rxcheck++)
+                {
+                  g_errors++;
+                }
+
+              if (++rxbuf->tail >= rxbuf->size)
+                {
+                  rxbuf->tail = 0;
+                }
+            }
+
+          if (rxcheck != g_rxseq)
+            {
+              g_errors++;
+              rxcheck = g_rxseq;
+            }
+        }
+      else
+        {
+          rxbuf->tail = rxbuf->head;
+        }
+    }
+}
+
+/* Let the writer queue a burst in the TX buffer, then take TX interrupts
+ * until it has been sent.
+ */
+
+static void serialbench_tx(FAR struct uart_dev_s *dev, int iterations)
+{
+  FAR struct uart_buffer_s *txbuf = &dev->xmit;
+  uint8_t txdata = g_txseq;
+  int i;
+  int j;
+
+  for (i = 0; i < iterations; i++)
+    {
+      if (g_checking)
+        {
+          for (j = 0; j < SERIALBENCH_TXBURST; j++)
+            {
+              txbuf->buffer[(txbuf->head + j) % txbuf->size] = txdata++;
+            }
+        }
+
+      txbuf->head = (txbuf->head + SERIALBENCH_TXBURST) % txbuf->size;
+      while (txbuf->head != txbuf->tail)
+        {
+          g_txfifolen = 0;
+          uart_xmitchars(dev);
+        }
+    }
+}
+
+static void serialbench_report(FAR const char *name, FAR const char *dir,
+                               uint64_t elapsed, uint32_t bytes)
+{
+  syslog(LOG_INFO, "serialbench: %-5s %s %lu ns, %lu MB/s, "
+         "%lu calls/KiB\n", name, dir, (unsigned long)elapsed,
+         (unsigned long)(elapsed ? (uint64_t)bytes * 1000 / elapsed : 0),
+         (unsigned long)((uint64_t)g_ncalls * 1024 / bytes));
+}
+
+static void serialbench_run(FAR const char *name,
+                            FAR const struct uart_ops_s *ops)
+{
+  FAR struct uart_dev_s *dev = &g_serialbench_dev;
+  int iterations = CONFIG_SIM_SERIALBENCH_ITERATIONS;
+  uint64_t start;
+
+  dev->ops = ops;
+
+  /* Check that the data arrives intact and in order */
+
+  g_checking = true;
+  g_errors = 0;
+  serialbench_rx(dev, SERIALBENCH_NCHECKS);
+  serialbench_tx(dev, SERIALBENCH_NCHECKS);
+  g_checking = false;
+
+  syslog(LOG_INFO, "serialbench: %s transfers, %d errors\n",
+         name, g_errors);
+
+  g_ncalls = 0;
+  start = host_gettime(false);
+  serialbench_rx(dev, iterations);
+  serialbench_report(name, "RX", host_gettime(false) - start,
+                     SERIALBENCH_FIFOSIZE * iterations);
+
+  g_ncalls = 0;
+  start = host_gettime(false);
+  serialbench_tx(dev, iterations);
+  serialbench_report(name, "TX", host_gettime(false) - start,
+                     SERIALBENCH_TXBURST * iterations);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sim_serialbench
+ *
+ * Description:
+ *   Move data through the serial upper half with a loopback lower half that
+ *   models the FIFOs of a 16550, once with the per-character methods and,
+ *   with CONFIG_SERIAL_BLOCKIO, once with the block methods.  Report the
+ *   throughput and the number of lower half calls for each.
+ *
+ ****************************************************************************/
+
+void sim_serialbench(void)
+{
+  serialbench_run("char", &g_serialbench_charops);
+#ifdef CONFIG_SERIAL_BLOCKIO
+  serialbench_run("block", &g_serialbench_blockops);
+#endif
+}
+
+#endif /* CONFIG_SIM_SERIALBENCH */
@@ -0,0 +1,271 @@
+/****************************************************************************
+ * boards/sim/sim/sim/src/sim_stringbench.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <syslog.h>
+
+#include "up_internal.h"
+#include "sim.h"
+
+#ifdef CONFIG_SIM_STRINGBENCH
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define STRINGBENCH_MAXLEN   256    /* Longest buffer of the checks */
+#define STRINGBENCH_BUFSIZE  4096   /* Buffer size of the throughput tests */
+#define STRINGBENCH_MARK     '\x01' /* Character searched by strchr() */
+
+#ifdef CONFIG_LIBC_STRING_OPTSPEED
+#  define STRINGBENCH_NAME   "word-wise"
+#else
+#  define STRINGBENCH_NAME   "byte-wise"
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static uint64_t g_benchsrc[(STRINGBENCH_BUFSIZE + 16) / sizeof(uint64_t)];
+static uint64_t g_benchdst[(STRINGBENCH_BUFSIZE + 16) / sizeof(uint64_t)];
+static volatile uintptr_t g_benchsink;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint32_t stringbench_random(FAR uint32_t *seed)
+{
+  *seed = *seed * 1103515245 + 12345;
+  return *seed >> 8;
+}
+
+/* Fill a buffer with random non-zero bytes */
+
+static void stringbench_fill(FAR char *buf, size_t len, FAR uint32_t *seed)
+{
+  size_t i;
+
+  for (i = 0; i < len; i++)
+    {
+      buf[i] = (char)(1 + stringbench_random(seed) % 255);
+    }
+}
+
+/* Check the functions against simple byte-wise definitions for all
+ * alignments of the source and destination and for all short lengths.
+ */
+
+static int stringbench_check(void)
+{
+  FAR char *src = (FAR char *)g_benchsrc;
+  FAR char *dst = (FAR char *)g_benchdst;
+  uint32_t seed = 1;
+  int errors = 0;
+  size_t soff;
+  size_t doff;
+  size_t len;
+  size_t i;
+  int ret;
+
+  for (soff = 0; soff < 8; soff++)
+    {
+      for (doff = 0; doff < 8; doff++)
+        {
+          for (len = 0; len < STRINGBENCH_MAXLEN; len++)
+            {
+              stringbench_fill(src, STRINGBENCH_MAXLEN + 16, &seed);
+
+              /* memset() must only write the requested bytes */
+
+              memset(dst, 0x5a, STRINGBENCH_MAXLEN + 16);
+              memset(dst + doff, 0xa5, len);
+              for (i = 0; i < STRINGBENCH_MAXLEN + 16; i++)
+                {
+                  if (dst[i] != (i >= doff && i < doff + len ?
+                                 (char)0xa5 : (char)0x5a))
+                    {
+                      errors++;
+                      break;
+                    }
+                }
+
+              /* memcpy() and memcmp() */
+
+              memcpy(dst + doff, src + soff, len);
+              for (i = 0; i < len; i++)
+                {
+                  if (dst[doff + i] != src[soff + i])
+                    {
+                      errors++;
+                      break;
+                    }
+                }
+
+              if (dst[doff + len] != (char)0x5a ||
+                  memcmp(dst + doff, src + soff, len) != 0)
+                {
+                  errors++;
+                }
+
+              if (len > 0)
+                {
+                  i = stringbench_random(&seed) % len;
+                  dst[doff + i]++;
+
+                  ret = memcmp(dst + doff, src + soff, len);
+                  if ((unsigned char)dst[doff + i] >
+                      (unsigned char)src[soff + i] ? ret <= 0 : ret >= 0)
+                    {
+                      errors++;
+                    }
+                }
+
+              /* strlen() and strchr() */
+
+              src[soff + len] = '\0';
+              if (strlen(src + soff) != len ||
+                  strchr(src + soff, '\0') != src + soff + len)
+                {
+                  errors++;
+                }
+
+              if (len > 0)
+                {
+                  i = stringbench_random(&seed) % len;
+                  if (memchr(src + soff, src[soff + i], len) !=
+                      strchr(src + soff, src[soff + i]))
+                    {
+                      errors++;
+                    }
+                }
+            }
+        }
+    }
+
+  return errors;
+}
+
+static void stringbench_report(FAR const char *name, uint64_t elapsed,
+                               uint64_t bytes)
+{
+  syslog(LOG_INFO, "stringbench: %-7s %lu ns, %lu MB/s\n", name,
+         (unsigned long)elapsed,
+         (unsigned long)(elapsed ? bytes * 1000 / elapsed : 0));
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sim_stringbench
+ *
+ * Description:
+ *   Check memcpy(), memset(), memcmp(), strlen() and strchr() for all
+ *   alignments and short lengths, then report the throughput of each on a
+ *   large buffer.  Build with and without CONFIG_LIBC_STRING_OPTSPEED to
+ *   compare the word-wise and the byte-wise versions.
+ *
+ ****************************************************************************/
+
+void sim_stringbench(void)
+{
+  FAR char *src = (FAR char *)g_benchsrc;
+  FAR char *dst = (FAR char *)g_benchdst;
+  uint64_t bytes = (uint64_t)STRINGBENCH_BUFSIZE *
+                   CONFIG_SIM_STRINGBENCH_ITERATIONS;
+  uint32_t seed = 1;
+  uint64_t start;
+  int errors;
+  int i;
+
+  errors = stringbench_check();
+  syslog(LOG_INFO, "stringbench: %s string functions, %d errors\n",
+         STRINGBENCH_NAME, errors);
+
+  /* Use an unaligned source so that the head/tail handling is included.
+   * The string ends with the only occurrence of STRINGBENCH_MARK, which
+   * strchr() has to find.
+   */
+
+  stringbench_fill(src, STRINGBENCH_BUFSIZE + 16, &seed);
+  for (i = 1; i < STRINGBENCH_BUFSIZE; i++)
+    {
+      if (src[i] == STRINGBENCH_MARK)
+        {
+          src[i]++;
+        }
+    }
+
+  src[STRINGBENCH_BUFSIZE]     = STRINGBENCH_MARK;
+  src[STRINGBENCH_BUFSIZE + 1] = '\0';
+
+  start = host_gettime(false);
+  for (i = 0; i < CONFIG_SIM_STRINGBENCH_ITERATIONS; i++)
+    {
+      memcpy(dst, src + 1, STRINGBENCH_BUFSIZE);
+    }
+
+  stringbench_report("memcpy", host_gettime(false) - start, bytes);
+
+  start = host_gettime(false);
+  for (i = 0; i < CONFIG_SIM_STRINGBENCH_ITERATIONS; i++)
+    {
+      memset(dst + 1, i, STRINGBENCH_BUFSIZE);
+    }
+
+  stringbench_report("memset", host_gettime(false) - start, bytes);
+
+  memcpy(dst, src, STRINGBENCH_BUFSIZE + 16);
+  start = host_gettime(false);
+  for (i = 0; i < CONFIG_SIM_STRINGBENCH_ITERATIONS; i++)
+    {
+      g_benchsink += memcmp(dst + 1, src + 1, STRINGBENCH_BUFSIZE);
+    }
+
+  stringbench_report("memcmp", host_gettime(false) - start, bytes);
+
+  start = host_gettime(false);
+  for (i = 0; i < CONFIG_SIM_STRINGBENCH_ITERATIONS; i++)
+    {
+      g_benchsink += strlen(src + 1);
+    }
+
+  stringbench_report("strlen", host_gettime(false) - start, bytes);
+
+  start = host_gettime(false);
+  for (i = 0; i < CONFIG_SIM_STRINGBENCH_ITERATIONS; i++)
+    {
+      g_benchsink += (uintptr_t)strchr(src + 1, STRINGBENCH_MARK);
+    }
+
+  stringbench_report("strchr", host_gettime(false) - start, bytes);
+}
+
+#endif /* CONFIG_SIM_STRINGBENCH */
@@ -40,15 +40,127 @@
 
 #include <nuttx/config.h>
 
+#include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 #include <errno.h>
 
 #include <nuttx/crypto/aes.h>
+#include <nuttx/crypto/crypto.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The bitsliced implementation encrypts two blocks in one pass, so the
+ * modes hand it two blocks at a time whenever they can.
+ */
+
+#ifdef CONFIG_CRYPTO_SW_AES_BITSLICE
+#  define AES_NPARALLEL 2
+#else
+#  define AES_NPARALLEL 1
+#endif
+
+#define AES_ROR(x, n)  (((x) >> (n)) | ((x) << (32 - (n))))
+
+#define AES_GETBE32(p) \
+  (((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) | \
+   ((uint32_t)(p)[2] << 8) | (uint32_t)(p)[3])
+
+#define AES_PUTBE32(p, v) \
+  do \
+    { \
+      (p)[0] = (uint8_t)((v) >> 24); \
+      (p)[1] = (uint8_t)((v) >> 16); \
+      (p)[2] = (uint8_t)((v) >> 8); \
+      (p)[3] = (uint8_t)(v); \
+    } \
+  while (0)
+
+#define AES_GETLE32(p) \
+  (((uint32_t)(p)[3] << 24) | ((uint32_t)(p)[2] << 16) | \
+   ((uint32_t)(p)[1] << 8) | (uint32_t)(p)[0])
+
+#define AES_PUTLE32(p, v) \
+  do \
+    { \
+      (p)[3] = (uint8_t)((v) >> 24); \
+      (p)[2] = (uint8_t)((v) >> 16); \
+      (p)[1] = (uint8_t)((v) >> 8); \
+      (p)[0] = (uint8_t)(v); \
+    } \
+  while (0)
+
+#ifndef CONFIG_CRYPTO_SW_AES_BITSLICE
+
+/* One column of a round: SubBytes, ShiftRows and MixColumns are a lookup
+ * in g_te0 (g_td0 for decryption) and its rotations.
+ */
+
+#  define AES_TE(a, b, c, d) \
+  (g_te0[(a) >> 24] ^ AES_ROR(g_te0[((b) >> 16) & 0xff], 8) ^ \
+   AES_ROR(g_te0[((c) >> 8) & 0xff], 16) ^ AES_ROR(g_te0[(d) & 0xff], 24))
+
+#  define AES_TD(a, b, c, d) \
+  (g_td0[(a) >> 24] ^ AES_ROR(g_td0[((b) >> 16) & 0xff], 8) ^ \
+   AES_ROR(g_td0[((c) >> 8) & 0xff], 16) ^ AES_ROR(g_td0[(d) & 0xff], 24))
+
+/* One column of the last round, which has no MixColumns */
+
+#  define AES_SE(a, b, c, d) \
+  (((uint32_t)g_sbox[(a) >> 24] << 24) | \
+   ((uint32_t)g_sbox[((b) >> 16) & 0xff] << 16) | \
+   ((uint32_t)g_sbox[((c) >> 8) & 0xff] << 8) | \
+   (uint32_t)g_sbox[(d) & 0xff])
+
+#  define AES_SD(a, b, c, d) \
+  (((uint32_t)g_rsbox[(a) >> 24] << 24) | \
+   ((uint32_t)g_rsbox[((b) >> 16) & 0xff] << 16) | \
+   ((uint32_t)g_rsbox[((c) >> 8) & 0xff] << 8) | \
+   (uint32_t)g_rsbox[(d) & 0xff])
+
+#else
+
+/* Exchange the bits selected by 'cl' in x with those selected by 'ch' in
+ * y, 's' bits apart.
+ */
+
+#  define AES_BSSWAP(cl, ch, s, x, y) \
+  do \
+    { \
+      uint32_t a_ = (x); \
+      uint32_t b_ = (y); \
+      (x) = (a_ & (cl)) | ((b_ & (cl)) << (s)); \
+      (y) = ((a_ & (ch)) >> (s)) | (b_ & (ch)); \
+    } \
+  while (0)
+
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* GHASH state of one GCM operation */
+
+struct aes_ghash_s
+{
+#ifdef CONFIG_CRYPTO_SW_AES_BITSLICE
+  uint32_t h[4];               /* The hash key H */
+#else
+  uint64_t hl[16];             /* Multiples of H by all 4-bit values */
+  uint64_t hh[16];
+#endif
+  uint8_t y[AES_BLOCK_SIZE];   /* The running hash */
+};
 
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
+#ifndef CONFIG_CRYPTO_SW_AES_BITSLICE
+
 /* Forward sbox */
 
 static const uint8_t g_sbox[256] =
@@ -129,6 +241,116 @@ static const uint8_t g_rsbox[256] =
                           0x14, 0x63, 0x55, 0x21, 0x0c, 0x7d
 };
 
+/* Encryption table: the columns of MixColumns applied to the sbox */
+
+static const uint32_t g_te0[256] =
+{
+  0xc66363a5, 0xf87c7c84, 0xee777799, 0xf67b7b8d, 0xfff2f20d, 0xd66b6bbd,
+  0xde6f6fb1, 0x91c5c554, 0x60303050, 0x02010103, 0xce6767a9, 0x562b2b7d,
+  0xe7fefe19, 0xb5d7d762, 0x4dababe6, 0xec76769a, 0x8fcaca45, 0x1f82829d,
+  0x89c9c940, 0xfa7d7d87, 0xeffafa15, 0xb25959eb, 0x8e4747c9, 0xfbf0f00b,
+  0x41adadec, 0xb3d4d467, 0x5fa2a2fd, 0x45afafea, 0x239c9cbf, 0x53a4a4f7,
+  0xe4727296, 0x9bc0c05b, 0x75b7b7c2, 0xe1fdfd1c, 0x3d9393ae, 0x4c26266a,
+  0x6c36365a, 0x7e3f3f41, 0xf5f7f702, 0x83cccc4f, 0x6834345c, 0x51a5a5f4,
+  0xd1e5e534, 0xf9f1f108, 0xe2717193, 0xabd8d873, 0x62313153, 0x2a15153f,
+  0x0804040c, 0x95c7c752, 0x46232365, 0x9dc3c35e, 0x30181828, 0x379696a1,
+  0x0a05050f, 0x2f9a9ab5, 0x0e070709, 0x24121236, 0x1b80809b, 0xdfe2e23d,
+  0xcdebeb26, 0x4e272769, 0x7fb2b2cd, 0xea75759f, 0x1209091b, 0x1d83839e,
+  0x582c2c74, 0x341a1a2e, 0x361b1b2d, 0xdc6e6eb2, 0xb45a5aee, 0x5ba0a0fb,
+  0xa45252f6, 0x763b3b4d, 0xb7d6d661, 0x7db3b3ce, 0x5229297b, 0xdde3e33e,
+  0x5e2f2f71, 0x13848497, 0xa65353f5, 0xb9d1d168, 0x00000000, 0xc1eded2c,
+  0x40202060, 0xe3fcfc1f, 0x79b1b1c8, 0xb65b5bed, 0xd46a6abe, 0x8dcbcb46,
+  0x67bebed9, 0x7239394b, 0x944a4ade, 0x984c4cd4, 0xb05858e8, 0x85cfcf4a,
+  0xbbd0d06b, 0xc5efef2a, 0x4faaaae5, 0xedfbfb16, 0x864343c5, 0x9a4d4dd7,
+  0x66333355, 0x11858594, 0x8a4545cf, 0xe9f9f910, 0x04020206, 0xfe7f7f81,
+  0xa05050f0, 0x783c3c44, 0x259f9fba, 0x4ba8a8e3, 0xa25151f3, 0x5da3a3fe,
+  0x804040c0, 0x058f8f8a, 0x3f9292ad, 0x219d9dbc, 0x70383848, 0xf1f5f504,
+  0x63bcbcdf, 0x77b6b6c1, 0xafdada75, 0x42212163, 0x20101030, 0xe5ffff1a,
+  0xfdf3f30e, 0xbfd2d26d, 0x81cdcd4c, 0x180c0c14, 0x26131335, 0xc3ecec2f,
+  0xbe5f5fe1, 0x359797a2, 0x884444cc, 0x2e171739, 0x93c4c457, 0x55a7a7f2,
+  0xfc7e7e82, 0x7a3d3d47, 0xc86464ac, 0xba5d5de7, 0x3219192b, 0xe6737395,
+  0xc06060a0, 0x19818198, 0x9e4f4fd1, 0xa3dcdc7f, 0x44222266, 0x542a2a7e,
+  0x3b9090ab, 0x0b888883, 0x8c4646ca, 0xc7eeee29, 0x6bb8b8d3, 0x2814143c,
+  0xa7dede79, 0xbc5e5ee2, 0x160b0b1d, 0xaddbdb76, 0xdbe0e03b, 0x64323256,
+  0x743a3a4e, 0x140a0a1e, 0x924949db, 0x0c06060a, 0x4824246c, 0xb85c5ce4,
+  0x9fc2c25d, 0xbdd3d36e, 0x43acacef, 0xc46262a6, 0x399191a8, 0x319595a4,
+  0xd3e4e437, 0xf279798b, 0xd5e7e732, 0x8bc8c843, 0x6e373759, 0xda6d6db7,
+  0x018d8d8c, 0xb1d5d564, 0x9c4e4ed2, 0x49a9a9e0, 0xd86c6cb4, 0xac5656fa,
+  0xf3f4f407, 0xcfeaea25, 0xca6565af, 0xf47a7a8e, 0x47aeaee9, 0x10080818,
+  0x6fbabad5, 0xf0787888, 0x4a25256f, 0x5c2e2e72, 0x381c1c24, 0x57a6a6f1,
+  0x73b4b4c7, 0x97c6c651, 0xcbe8e823, 0xa1dddd7c, 0xe874749c, 0x3e1f1f21,
+  0x964b4bdd, 0x61bdbddc, 0x0d8b8b86, 0x0f8a8a85, 0xe0707090, 0x7c3e3e42,
+  0x71b5b5c4, 0xcc6666aa, 0x904848d8, 0x06030305, 0xf7f6f601, 0x1c0e0e12,
+  0xc26161a3, 0x6a35355f, 0xae5757f9, 0x69b9b9d0, 0x17868691, 0x99c1c158,
+  0x3a1d1d27, 0x279e9eb9, 0xd9e1e138, 0xebf8f813, 0x2b9898b3, 0x22111133,
+  0xd26969bb, 0xa9d9d970, 0x078e8e89, 0x339494a7, 0x2d9b9bb6, 0x3c1e1e22,
+  0x15878792, 0xc9e9e920, 0x87cece49, 0xaa5555ff, 0x50282878, 0xa5dfdf7a,
+  0x038c8c8f, 0x59a1a1f8, 0x09898980, 0x1a0d0d17, 0x65bfbfda, 0xd7e6e631,
+  0x844242c6, 0xd06868b8, 0x824141c3, 0x299999b0, 0x5a2d2d77, 0x1e0f0f11,
+  0x7bb0b0cb, 0xa85454fc, 0x6dbbbbd6, 0x2c16163a
+};
+
+/* Decryption table: the columns of InvMixColumns applied to the inverse
+ * sbox
+ */
+
+static const uint32_t g_td0[256] =
+{
+  0x51f4a750, 0x7e416553, 0x1a17a4c3, 0x3a275e96, 0x3bab6bcb, 0x1f9d45f1,
+  0xacfa58ab, 0x4be30393, 0x2030fa55, 0xad766df6, 0x88cc7691, 0xf5024c25,
+  0x4fe5d7fc, 0xc52acbd7, 0x26354480, 0xb562a38f, 0xdeb15a49, 0x25ba1b67,
+  0x45ea0e98, 0x5dfec0e1, 0xc32f7502, 0x814cf012, 0x8d4697a3, 0x6bd3f9c6,
+  0x038f5fe7, 0x15929c95, 0xbf6d7aeb, 0x955259da, 0xd4be832d, 0x587421d3,
+  0x49e06929, 0x8ec9c844, 0x75c2896a, 0xf48e7978, 0x99583e6b, 0x27b971dd,
+  0xbee14fb6, 0xf088ad17, 0xc920ac66, 0x7dce3ab4, 0x63df4a18, 0xe51a3182,
+  0x97513360, 0x62537f45, 0xb16477e0, 0xbb6bae84, 0xfe81a01c, 0xf9082b94,
+  0x70486858, 0x8f45fd19, 0x94de6c87, 0x527bf8b7, 0xab73d323, 0x724b02e2,
+  0xe31f8f57, 0x6655ab2a, 0xb2eb2807, 0x2fb5c203, 0x86c57b9a, 0xd33708a5,
+  0x302887f2, 0x23bfa5b2, 0x02036aba, 0xed16825c, 0x8acf1c2b, 0xa779b492,
+  0xf307f2f0, 0x4e69e2a1, 0x65daf4cd, 0x0605bed5, 0xd134621f, 0xc4a6fe8a,
+  0x342e539d, 0xa2f355a0, 0x058ae132, 0xa4f6eb75, 0x0b83ec39, 0x4060efaa,
+  0x5e719f06, 0xbd6e1051, 0x3e218af9, 0x96dd063d, 0xdd3e05ae, 0x4de6bd46,
+  0x91548db5, 0x71c45d05, 0x0406d46f, 0x605015ff, 0x1998fb24, 0xd6bde997,
+  0x894043cc, 0x67d99e77, 0xb0e842bd, 0x07898b88, 0xe7195b38, 0x79c8eedb,
+  0xa17c0a47, 0x7c420fe9, 0xf8841ec9, 0x00000000, 0x09808683, 0x322bed48,
+  0x1e1170ac, 0x6c5a724e, 0xfd0efffb, 0x0f853856, 0x3daed51e, 0x362d3927,
+  0x0a0fd964, 0x685ca621, 0x9b5b54d1, 0x24362e3a, 0x0c0a67b1, 0x9357e70f,
+  0xb4ee96d2, 0x1b9b919e, 0x80c0c54f, 0x61dc20a2, 0x5a774b69, 0x1c121a16,
+  0xe293ba0a, 0xc0a02ae5, 0x3c22e043, 0x121b171d, 0x0e090d0b, 0xf28bc7ad,
+  0x2db6a8b9, 0x141ea9c8, 0x57f11985, 0xaf75074c, 0xee99ddbb, 0xa37f60fd,
+  0xf701269f, 0x5c72f5bc, 0x44663bc5, 0x5bfb7e34, 0x8b432976, 0xcb23c6dc,
+  0xb6edfc68, 0xb8e4f163, 0xd731dcca, 0x42638510, 0x13972240, 0x84c61120,
+  0x854a247d, 0xd2bb3df8, 0xaef93211, 0xc729a16d, 0x1d9e2f4b, 0xdcb230f3,
+  0x0d8652ec, 0x77c1e3d0, 0x2bb3166c, 0xa970b999, 0x119448fa, 0x47e96422,
+  0xa8fc8cc4, 0xa0f03f1a, 0x567d2cd8, 0x223390ef, 0x87494ec7, 0xd938d1c1,
+  0x8ccaa2fe, 0x98d40b36, 0xa6f581cf, 0xa57ade28, 0xdab78e26, 0x3fadbfa4,
+  0x2c3a9de4, 0x5078920d, 0x6a5fcc9b, 0x547e4662, 0xf68d13c2, 0x90d8b8e8,
+  0x2e39f75e, 0x82c3aff5, 0x9f5d80be, 0x69d0937c, 0x6fd52da9, 0xcf2512b3,
+  0xc8ac993b, 0x10187da7, 0xe89c636e, 0xdb3bbb7b, 0xcd267809, 0x6e5918f4,
+  0xec9ab701, 0x834f9aa8, 0xe6956e65, 0xaaffe67e, 0x21bccf08, 0xef15e8e6,
+  0xbae79bd9, 0x4a6f36ce, 0xea9f09d4, 0x29b07cd6, 0x31a4b2af, 0x2a3f2331,
+  0xc6a59430, 0x35a266c0, 0x744ebc37, 0xfc82caa6, 0xe090d0b0, 0x33a7d815,
+  0xf104984a, 0x41ecdaf7, 0x7fcd500e, 0x1791f62f, 0x764dd68d, 0x43efb04d,
+  0xccaa4d54, 0xe49604df, 0x9ed1b5e3, 0x4c6a881b, 0xc12c1fb8, 0x4665517f,
+  0x9d5eea04, 0x018c355d, 0xfa877473, 0xfb0b412e, 0xb3671d5a, 0x92dbd252,
+  0xe9105633, 0x6dd64713, 0x9ad7618c, 0x37a10c7a, 0x59f8148e, 0xeb133c89,
+  0xcea927ee, 0xb761c935, 0xe11ce5ed, 0x7a47b13c, 0x9cd2df59, 0x55f2733f,
+  0x1814ce79, 0x73c737bf, 0x53f7cdea, 0x5ffdaa5b, 0xdf3d6f14, 0x7844db86,
+  0xcaaff381, 0xb968c43e, 0x3824342c, 0xc2a3405f, 0x161dc372, 0xbce2250c,
+  0x283c498b, 0xff0d9541, 0x39a80171, 0x080cb3de, 0xd8b4e49c, 0x6456c190,
+  0x7bcb8461, 0xd532b670, 0x486c5c74, 0xd0b85742
+};
+
+/* Reduction of the 4 bits shifted out of a GHASH product */
+
+static const uint16_t g_last4[16] =
+{
+  0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+  0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+};
+
+#endif
+
 /* Round constant */
 
 static const uint8_t g_rcon[11] =
@@ -142,565 +364,1119 @@ static struct aes_state_s g_aes_state;
  * Private Functions
  ****************************************************************************/
 
+#ifndef CONFIG_CRYPTO_SW_AES_BITSLICE
+
 /****************************************************************************
- * Name: expand_key
+ * Name: aes_setupkey_rounds
  *
  * Description:
- *   Expend a 16 bytes key for AES128 implementation
- *
- * Input Parameters:
- *  key          AES128 key - 16 bytes
- *  expanded_key expanded AES128 key
- *
- * Returned Value:
- *  None
+ *   Expand the key into the encryption round keys and derive the round
+ *   keys of the equivalent inverse cipher, which lets decryption use the
+ *   same round structure as encryption.
  *
  ****************************************************************************/
 
-static void expand_key(FAR uint8_t *expanded_key, FAR const uint8_t *key)
+static void aes_setupkey_rounds(FAR struct aes_state_s *state,
+                                FAR const uint8_t *key, int nk)
 {
-  uint16_t buf1;
-  uint16_t ii;
+  FAR uint32_t *ek = state->ekey;
+  FAR uint32_t *dk = state->dkey;
+  int nwords = (state->nrounds + 1) * 4;
+  uint32_t w;
+  int i;
+  int j;
 
-  for (ii = 0; ii < 16; ii++)
+  for (i = 0; i < nk; i++)
     {
-      expanded_key[ii] = key[ii];
+      ek[i] = AES_GETBE32(key + 4 * i);
     }
 
-  for (ii = 1; ii < 11; ii++)
+  for (; i < nwords; i++)
     {
-      buf1 = expanded_key[ii * 16 - 4];
-      expanded_key[ii * 16 + 0] = g_sbox[expanded_key[ii *16 - 3]] ^
-                            expanded_key[(ii - 1) * 16 + 0] ^ g_rcon[ii];
-
-      expanded_key[ii * 16 + 1] = g_sbox[expanded_key[ii *16 - 2]] ^
-                            expanded_key[(ii - 1) * 16 + 1];
-
-      expanded_key[ii * 16 + 2] = g_sbox[expanded_key[ii *16 - 1]] ^
-                            expanded_key[(ii - 1) * 16 + 2];
-
-      expanded_key[ii * 16 + 3] = g_sbox[buf1] ^
-                            expanded_key[(ii - 1) * 16 + 3];
-
-      expanded_key[ii * 16 + 4] = expanded_key[(ii - 1) * 16 + 4] ^
-                            expanded_key[ii * 16 + 0];
-
-      expanded_key[ii * 16 + 5] = expanded_key[(ii - 1) * 16 + 5] ^
-                            expanded_key[ii * 16 + 1];
-
-      expanded_key[ii * 16 + 6] = expanded_key[(ii - 1) * 16 + 6] ^
-                            expanded_key[ii * 16 + 2];
-
-      expanded_key[ii * 16 + 7] = expanded_key[(ii - 1) * 16 + 7] ^
-                            expanded_key[ii * 16 + 3];
-
-      expanded_key[ii * 16 + 8] = expanded_key[(ii - 1) * 16 + 8] ^
-                            expanded_key[ii * 16 + 4];
-
-      expanded_key[ii * 16 + 9] = expanded_key[(ii - 1) * 16 + 9] ^
-                            expanded_key[ii * 16 + 5];
-
-      expanded_key[ii * 16 +10] = expanded_key[(ii - 1) * 16 +10] ^
-                            expanded_key[ii * 16 + 6];
-
-      expanded_key[ii * 16 +11] = expanded_key[(ii - 1) * 16 +11] ^
-                            expanded_key[ii * 16 + 7];
-
-      expanded_key[ii * 16 +12] = expanded_key[(ii - 1) * 16 +12] ^
-                            expanded_key[ii * 16 + 8];
-
-      expanded_key[ii * 16 +13] = expanded_key[(ii - 1) * 16 +13] ^
-                            expanded_key[ii * 16 + 9];
+      w = ek[i - 1];
+      if (i % nk == 0)
+        {
+          w = (w << 8) | (w >> 24);
+          w = AES_SE(w, w, w, w) ^ ((uint32_t)g_rcon[i / nk] << 24);
+        }
+      else if (nk > 6 && i % nk == 4)
+        {
+          w = AES_SE(w, w, w, w);
+        }
+
+      ek[i] = ek[i - nk] ^ w;
+    }
 
-      expanded_key[ii * 16 +14] = expanded_key[(ii - 1) * 16 +14] ^
-                            expanded_key[ii * 16 +10];
+  /* The decryption round keys are the encryption round keys in reverse
+   * order, passed through InvMixColumns except for the first and the last.
+   */
 
-      expanded_key[ii * 16 +15] = expanded_key[(ii - 1) * 16 +15] ^
-                            expanded_key[ii * 16 +11];
+  for (i = 0; i < nwords; i += 4)
+    {
+      for (j = 0; j < 4; j++)
+        {
+          w = ek[nwords - 4 - i + j];
+          if (i > 0 && i < nwords - 4)
+            {
+              w = AES_SE(w, w, w, w);
+              w = AES_TD(w, w, w, w);
+            }
+
+          dk[i + j] = w;
+        }
     }
 }
 
 /****************************************************************************
- * Name: galois_mul2
+ * Name: aes_encr
  *
  * Description:
- *    Multiply by 2 in the galois field
- *
- * Input Parameters:
- *  value    argument to multiply
- *
- * Returned Value:
- *  Multiplied argument
+ *   Encrypt 'nblk' 16-byte blocks with 32-bit table lookups.  'out' may be
+ *   the same as 'in'.
  *
  ****************************************************************************/
 
-static uint8_t galois_mul2(uint8_t value)
+static void aes_encr(FAR const struct aes_state_s *state, FAR uint8_t *out,
+                     FAR const uint8_t *in, int nblk)
 {
-  if (value >> 7)
+  FAR const uint32_t *rk;
+  uint32_t s0;
+  uint32_t s1;
+  uint32_t s2;
+  uint32_t s3;
+  uint32_t t0;
+  uint32_t t1;
+  uint32_t t2;
+  uint32_t t3;
+  int round;
+
+  for (; nblk > 0; nblk--, in += AES_BLOCK_SIZE, out += AES_BLOCK_SIZE)
     {
-      value = value << 1;
-      return (value ^ 0x1b);
-    }
-  else
-    {
-      return value << 1;
+      rk = state->ekey;
+      s0 = AES_GETBE32(in) ^ rk[0];
+      s1 = AES_GETBE32(in + 4) ^ rk[1];
+      s2 = AES_GETBE32(in + 8) ^ rk[2];
+      s3 = AES_GETBE32(in + 12) ^ rk[3];
+
+      for (round = 1; round < state->nrounds; round++)
+        {
+          rk += 4;
+          t0 = AES_TE(s0, s1, s2, s3) ^ rk[0];
+          t1 = AES_TE(s1, s2, s3, s0) ^ rk[1];
+          t2 = AES_TE(s2, s3, s0, s1) ^ rk[2];
+          t3 = AES_TE(s3, s0, s1, s2) ^ rk[3];
+          s0 = t0;
+          s1 = t1;
+          s2 = t2;
+          s3 = t3;
+        }
+
+      rk += 4;
+      t0 = AES_SE(s0, s1, s2, s3) ^ rk[0];
+      t1 = AES_SE(s1, s2, s3, s0) ^ rk[1];
+      t2 = AES_SE(s2, s3, s0, s1) ^ rk[2];
+      t3 = AES_SE(s3, s0, s1, s2) ^ rk[3];
+
+      AES_PUTBE32(out, t0);
+      AES_PUTBE32(out + 4, t1);
+      AES_PUTBE32(out + 8, t2);
+      AES_PUTBE32(out + 12, t3);
     }
 }
 
 /****************************************************************************
- * Name: aes_encr
+ * Name: aes_decr
  *
  * Description:
- *  Internal implementation of AES128 encryption.
- *  Straight forward aes encryption implementation. First the group of
- *  operations:
- *
- *    - addRoundKey
- *    - subbytes
- *    - shiftrows
- *    - mixcolums
- *
- *  is executed 9 times, after this addroundkey to finish the 9th round,
- *  after that the 10th round without mixcolums no further subfunctions
- *  to save cycles for function calls no structuring with "for (....)"
- *  to save cycles.
- *
- * Input Parameters:
- *  expanded_key expanded AES128 key
- *  state        16 bytes of plain text and cipher text
- *
- * Returned Value:
- *  None
+ *   Decrypt 'nblk' 16-byte blocks with 32-bit table lookups.  'out' may be
+ *   the same as 'in'.
  *
  ****************************************************************************/
 
-static void aes_encr(FAR uint8_t *state, FAR const uint8_t *expanded_key)
+static void aes_decr(FAR const struct aes_state_s *state, FAR uint8_t *out,
+                     FAR const uint8_t *in, int nblk)
 {
-  uint8_t buf1;
-  uint8_t buf2;
-  uint8_t buf3;
-  uint8_t round;
-
-  for (round = 0; round < 9; round ++)
+  FAR const uint32_t *rk;
+  uint32_t s0;
+  uint32_t s1;
+  uint32_t s2;
+  uint32_t s3;
+  uint32_t t0;
+  uint32_t t1;
+  uint32_t t2;
+  uint32_t t3;
+  int round;
+
+  for (; nblk > 0; nblk--, in += AES_BLOCK_SIZE, out += AES_BLOCK_SIZE)
     {
-      /* addroundkey, sbox and shiftrows */
-
-      /* Row 0 */
-
-      state[0]   = g_sbox[(state[0]  ^ expanded_key[(round * 16)])];
-      state[4]   = g_sbox[(state[4]  ^ expanded_key[(round * 16) +  4])];
-      state[8]   = g_sbox[(state[8]  ^ expanded_key[(round * 16) +  8])];
-      state[12]  = g_sbox[(state[12] ^ expanded_key[(round * 16) + 12])];
-
-      /* Row 1 */
-
-      buf1       = state[1] ^ expanded_key[(round * 16) + 1];
-      state[1]   = g_sbox[(state[5]  ^ expanded_key[(round * 16) +  5])];
-      state[5]   = g_sbox[(state[9]  ^ expanded_key[(round * 16) +  9])];
-      state[9]   = g_sbox[(state[13] ^ expanded_key[(round * 16) + 13])];
-      state[13]  = g_sbox[buf1];
-
-      /* Row 2 */
-
-      buf1       = state[2] ^ expanded_key[(round * 16) + 2];
-      buf2       = state[6] ^ expanded_key[(round * 16) + 6];
-      state[2]   = g_sbox[(state[10] ^ expanded_key[(round * 16) + 10])];
-      state[6]   = g_sbox[(state[14] ^ expanded_key[(round * 16) + 14])];
-      state[10]  = g_sbox[buf1];
-      state[14]  = g_sbox[buf2];
-
-      /* Row 3 */
-
-      buf1       = state[15] ^ expanded_key[(round * 16) + 15];
-      state[15]  = g_sbox[(state[11] ^ expanded_key[(round * 16) + 11])];
-      state[11]  = g_sbox[(state[7]  ^ expanded_key[(round * 16) +  7])];
-      state[7]   = g_sbox[(state[3]  ^ expanded_key[(round * 16) +  3])];
-      state[3]   = g_sbox[buf1];
-
-      /* mixcolums */
+      rk = state->dkey;
+      s0 = AES_GETBE32(in) ^ rk[0];
+      s1 = AES_GETBE32(in + 4) ^ rk[1];
+      s2 = AES_GETBE32(in + 8) ^ rk[2];
+      s3 = AES_GETBE32(in + 12) ^ rk[3];
+
+      for (round = 1; round < state->nrounds; round++)
+        {
+          rk += 4;
+          t0 = AES_TD(s0, s3, s2, s1) ^ rk[0];
+          t1 = AES_TD(s1, s0, s3, s2) ^ rk[1];
+          t2 = AES_TD(s2, s1, s0, s3) ^ rk[2];
+          t3 = AES_TD(s3, s2, s1, s0) ^ rk[3];
+          s0 = t0;
+          s1 = t1;
+          s2 = t2;
+          s3 = t3;
+        }
+
+      rk += 4;
+      t0 = AES_SD(s0, s3, s2, s1) ^ rk[0];
+      t1 = AES_SD(s1, s0, s3, s2) ^ rk[1];
+      t2 = AES_SD(s2, s1, s0, s3) ^ rk[2];
+      t3 = AES_SD(s3, s2, s1, s0) ^ rk[3];
+
+      AES_PUTBE32(out, t0);
+      AES_PUTBE32(out + 4, t1);
+      AES_PUTBE32(out + 8, t2);
+      AES_PUTBE32(out + 12, t3);
+    }
+}
 
-      /* Col1 */
+/****************************************************************************
+ * Name: aes_ghash_init
+ *
+ * Description:
+ *   Prepare the multiples of the hash key H by all 4-bit values for the
+ *   4-bit table GHASH multiplication.
+ *
+ ****************************************************************************/
 
-      buf1 = state[0] ^ state[1] ^ state[2] ^ state[3];
-      buf2 = state[0];
+static void aes_ghash_init(FAR struct aes_ghash_s *ghash,
+                           FAR const uint8_t *h)
+{
+  uint64_t vh;
+  uint64_t vl;
+  uint32_t t;
+  int i;
+  int j;
 
-      buf3 = state[0] ^ state[1];
-      buf3 = galois_mul2(buf3);
-      state[0] = state[0] ^ buf3 ^ buf1;
+  vh = ((uint64_t)AES_GETBE32(h) << 32) | AES_GETBE32(h + 4);
+  vl = ((uint64_t)AES_GETBE32(h + 8) << 32) | AES_GETBE32(h + 12);
 
-      buf3 = state[1] ^ state[2];
-      buf3 = galois_mul2(buf3);
-      state[1] = state[1] ^ buf3 ^ buf1;
+  ghash->hl[8] = vl;
+  ghash->hh[8] = vh;
+  ghash->hl[0] = 0;
+  ghash->hh[0] = 0;
 
-      buf3 = state[2] ^ state[3];
-      buf3 = galois_mul2(buf3);
-      state[2] = state[2] ^ buf3 ^ buf1;
+  for (i = 4; i > 0; i >>= 1)
+    {
+      t  = (uint32_t)(vl & 1) * 0xe1000000;
+      vl = (vh << 63) | (vl >> 1);
+      vh = (vh >> 1) ^ ((uint64_t)t << 32);
 
-      buf3 = state[3] ^ buf2;
-      buf3 = galois_mul2(buf3);
-      state[3] = state[3] ^ buf3 ^ buf1;
+      ghash->hl[i] = vl;
+      ghash->hh[i] = vh;
+    }
 
-      /* Col2 */
+  for (i = 2; i <= 8; i *= 2)
+    {
+      for (j = 1; j < i; j++)
+        {
+          ghash->hh[i + j] = ghash->hh[i] ^ ghash->hh[j];
+          ghash->hl[i + j] = ghash->hl[i] ^ ghash->hl[j];
+        }
+    }
 
-      buf1 = state[4] ^ state[5] ^ state[6] ^ state[7];
-      buf2 = state[4];
+  memset(ghash->y, 0, AES_BLOCK_SIZE);
+}
 
-      buf3 = state[4] ^ state[5];
-      buf3 = galois_mul2(buf3);
-      state[4] = state[4] ^ buf3 ^ buf1;
+/****************************************************************************
+ * Name: aes_ghash_mult
+ *
+ * Description:
+ *   Multiply the running hash by H, 4 bits at a time.
+ *
+ ****************************************************************************/
 
-      buf3 = state[5] ^ state[6];
-      buf3 = galois_mul2(buf3);
-      state[5] = state[5] ^ buf3 ^ buf1;
+static void aes_ghash_mult(FAR struct aes_ghash_s *ghash)
+{
+  FAR uint8_t *y = ghash->y;
+  uint64_t zh;
+  uint64_t zl;
+  uint8_t nib;
+  uint8_t rem;
+  int i;
 
-      buf3 = state[6] ^ state[7];
-      buf3 = galois_mul2(buf3);
-      state[6] = state[6] ^ buf3 ^ buf1;
+  nib = y[15] & 0x0f;
+  zh  = ghash->hh[nib];
+  zl  = ghash->hl[nib];
 
-      buf3 = state[7] ^ buf2;
-      buf3 = galois_mul2(buf3);
-      state[7] = state[7] ^ buf3 ^ buf1;
+  for (i = 15; i >= 0; i--)
+    {
+      if (i != 15)
+        {
+          nib = y[i] & 0x0f;
+          rem = (uint8_t)zl & 0x0f;
+          zl  = (zh << 60) | (zl >> 4);
+          zh  = (zh >> 4) ^ ((uint64_t)g_last4[rem] << 48);
+          zh ^= ghash->hh[nib];
+          zl ^= ghash->hl[nib];
+        }
+
+      nib = y[i] >> 4;
+      rem = (uint8_t)zl & 0x0f;
+      zl  = (zh << 60) | (zl >> 4);
+      zh  = (zh >> 4) ^ ((uint64_t)g_last4[rem] << 48);
+      zh ^= ghash->hh[nib];
+      zl ^= ghash->hl[nib];
+    }
 
-      /* Col3 */
+  AES_PUTBE32(y, (uint32_t)(zh >> 32));
+  AES_PUTBE32(y + 4, (uint32_t)zh);
+  AES_PUTBE32(y + 8, (uint32_t)(zl >> 32));
+  AES_PUTBE32(y + 12, (uint32_t)zl);
+}
 
-      buf1 = state[8] ^ state[9] ^ state[10] ^ state[11];
-      buf2 = state[8];
+#else /* CONFIG_CRYPTO_SW_AES_BITSLICE */
 
-      buf3 = state[8] ^ state[9];
-      buf3 = galois_mul2(buf3);
-      state[8] = state[8] ^ buf3 ^ buf1;
+/****************************************************************************
+ * Name: aes_bs_ortho
+ *
+ * Description:
+ *   Convert between the normal and the bitsliced representation of two
+ *   blocks.  In the bitsliced representation q[i] holds bit i of every
+ *   byte.  The conversion is its own inverse.
+ *
+ ****************************************************************************/
 
-      buf3 = state[9] ^ state[10];
-      buf3 = galois_mul2(buf3);
-      state[9] = state[9] ^ buf3 ^ buf1;
+static void aes_bs_ortho(FAR uint32_t *q)
+{
+  AES_BSSWAP(0x55555555, 0xaaaaaaaa, 1, q[0], q[1]);
+  AES_BSSWAP(0x55555555, 0xaaaaaaaa, 1, q[2], q[3]);
+  AES_BSSWAP(0x55555555, 0xaaaaaaaa, 1, q[4], q[5]);
+  AES_BSSWAP(0x55555555, 0xaaaaaaaa, 1, q[6], q[7]);
+
+  AES_BSSWAP(0x33333333, 0xcccccccc, 2, q[0], q[2]);
+  AES_BSSWAP(0x33333333, 0xcccccccc, 2, q[1], q[3]);
+  AES_BSSWAP(0x33333333, 0xcccccccc, 2, q[4], q[6]);
+  AES_BSSWAP(0x33333333, 0xcccccccc, 2, q[5], q[7]);
+
+  AES_BSSWAP(0x0f0f0f0f, 0xf0f0f0f0, 4, q[0], q[4]);
+  AES_BSSWAP(0x0f0f0f0f, 0xf0f0f0f0, 4, q[1], q[5]);
+  AES_BSSWAP(0x0f0f0f0f, 0xf0f0f0f0, 4, q[2], q[6]);
+  AES_BSSWAP(0x0f0f0f0f, 0xf0f0f0f0, 4, q[3], q[7]);
+}
 
-      buf3 = state[10] ^ state[11];
-      buf3 = galois_mul2(buf3);
-      state[10] = state[10] ^ buf3 ^ buf1;
+/****************************************************************************
+ * Name: aes_bs_sbox
+ *
+ * Description:
+ *   Apply the sbox to all 32 bytes of the bitsliced state with the 113
+ *   gate circuit of Boyar and Peralta: a linear transformation, the
+ *   inversion in GF(2^8) and another linear transformation.  There are no
+ *   lookups, so the time taken does not depend on the data.
+ *
+ ****************************************************************************/
 
-      buf3 = state[11] ^ buf2;
-      buf3 = galois_mul2(buf3);
-      state[11] = state[11] ^ buf3 ^ buf1;
+static void aes_bs_sbox(FAR uint32_t *q)
+{
+  uint32_t x0;
+  uint32_t x1;
+  uint32_t x2;
+  uint32_t x3;
+  uint32_t x4;
+  uint32_t x5;
+  uint32_t x6;
+  uint32_t x7;
+  uint32_t y1;
+  uint32_t y2;
+  uint32_t y3;
+  uint32_t y4;
+  uint32_t y5;
+  uint32_t y6;
+  uint32_t y7;
+  uint32_t y8;
+  uint32_t y9;
+  uint32_t y10;
+  uint32_t y11;
+  uint32_t y12;
+  uint32_t y13;
+  uint32_t y14;
+  uint32_t y15;
+  uint32_t y16;
+  uint32_t y17;
+  uint32_t y18;
+  uint32_t y19;
+  uint32_t y20;
+  uint32_t y21;
+  uint32_t z0;
+  uint32_t z1;
+  uint32_t z2;
+  uint32_t z3;
+  uint32_t z4;
+  uint32_t z5;
+  uint32_t z6;
+  uint32_t z7;
+  uint32_t z8;
+  uint32_t z9;
+  uint32_t z10;
+  uint32_t z11;
+  uint32_t z12;
+  uint32_t z13;
+  uint32_t z14;
+  uint32_t z15;
+  uint32_t z16;
+  uint32_t z17;
+  uint32_t t[68];
+  uint32_t s0;
+  uint32_t s1;
+  uint32_t s2;
+  uint32_t s3;
+  uint32_t s4;
+  uint32_t s5;
+  uint32_t s6;
+  uint32_t s7;
+
+  x0 = q[7];
+  x1 = q[6];
+  x2 = q[5];
+  x3 = q[4];
+  x4 = q[3];
+  x5 = q[2];
+  x6 = q[1];
+  x7 = q[0];
+
+  /* Top linear transformation */
+
+  y14   = x3 ^ x5;
+  y13   = x0 ^ x6;
+  y9    = x0 ^ x3;
+  y8    = x0 ^ x5;
+  t[0]  = x1 ^ x2;
+  y1    = t[0] ^ x7;
+  y4    = y1 ^ x3;
+  y12   = y13 ^ y14;
+  y2    = y1 ^ x0;
+  y5    = y1 ^ x6;
+  y3    = y5 ^ y8;
+  t[1]  = x4 ^ y12;
+  y15   = t[1] ^ x5;
+  y20   = t[1] ^ x1;
+  y6    = y15 ^ x7;
+  y10   = y15 ^ t[0];
+  y11   = y20 ^ y9;
+  y7    = x7 ^ y11;
+  y17   = y10 ^ y11;
+  y19   = y10 ^ y8;
+  y16   = t[0] ^ y11;
+  y21   = y13 ^ y16;
+  y18   = x0 ^ y16;
+
+  /* Non-linear section */
+
+  t[2]  = y12 & y15;
+  t[3]  = y3 & y6;
+  t[4]  = t[3] ^ t[2];
+  t[5]  = y4 & x7;
+  t[6]  = t[5] ^ t[2];
+  t[7]  = y13 & y16;
+  t[8]  = y5 & y1;
+  t[9]  = t[8] ^ t[7];
+  t[10] = y2 & y7;
+  t[11] = t[10] ^ t[7];
+  t[12] = y9 & y11;
+  t[13] = y14 & y17;
+  t[14] = t[13] ^ t[12];
+  t[15] = y8 & y10;
+  t[16] = t[15] ^ t[12];
+  t[17] = t[4] ^ t[14];
+  t[18] = t[6] ^ t[16];
+  t[19] = t[9] ^ t[14];
+  t[20] = t[11] ^ t[16];
+  t[21] = t[17] ^ y20;
+  t[22] = t[18] ^ y19;
+  t[23] = t[19] ^ y21;
+  t[24] = t[20] ^ y18;
+
+  t[25] = t[21] ^ t[22];
+  t[26] = t[21] & t[23];
+  t[27] = t[24] ^ t[26];
+  t[28] = t[25] & t[27];
+  t[29] = t[28] ^ t[22];
+  t[30] = t[23] ^ t[24];
+  t[31] = t[22] ^ t[26];
+  t[32] = t[31] & t[30];
+  t[33] = t[32] ^ t[24];
+  t[34] = t[23] ^ t[33];
+  t[35] = t[27] ^ t[33];
+  t[36] = t[24] & t[35];
+  t[37] = t[36] ^ t[34];
+  t[38] = t[27] ^ t[36];
+  t[39] = t[29] & t[38];
+  t[40] = t[25] ^ t[39];
+
+  t[41] = t[40] ^ t[37];
+  t[42] = t[29] ^ t[33];
+  t[43] = t[29] ^ t[40];
+  t[44] = t[33] ^ t[37];
+  t[45] = t[42] ^ t[41];
+  z0    = t[44] & y15;
+  z1    = t[37] & y6;
+  z2    = t[33] & x7;
+  z3    = t[43] & y16;
+  z4    = t[40] & y1;
+  z5    = t[29] & y7;
+  z6    = t[42] & y11;
+  z7    = t[45] & y17;
+  z8    = t[41] & y10;
+  z9    = t[44] & y12;
+  z10   = t[37] & y3;
+  z11   = t[33] & y4;
+  z12   = t[43] & y13;
+  z13   = t[40] & y5;
+  z14   = t[29] & y2;
+  z15   = t[42] & y9;
+  z16   = t[45] & y14;
+  z17   = t[41] & y8;
+
+  /* Bottom linear transformation */
+
+  t[46] = z15 ^ z16;
+  t[47] = z10 ^ z11;
+  t[48] = z5 ^ z13;
+  t[49] = z9 ^ z10;
+  t[50] = z2 ^ z12;
+  t[51] = z2 ^ z5;
+  t[52] = z7 ^ z8;
+  t[53] = z0 ^ z3;
+  t[54] = z6 ^ z7;
+  t[55] = z16 ^ z17;
+  t[56] = z12 ^ t[48];
+  t[57] = t[50] ^ t[53];
+  t[58] = z4 ^ t[46];
+  t[59] = z3 ^ t[54];
+  t[60] = t[46] ^ t[57];
+  t[61] = z14 ^ t[57];
+  t[62] = t[52] ^ t[58];
+  t[63] = t[49] ^ t[58];
+  t[64] = z4 ^ t[59];
+  t[65] = t[61] ^ t[62];
+  t[66] = z1 ^ t[63];
+  s0    = t[59] ^ t[63];
+  s6    = t[56] ^ ~t[62];
+  s7    = t[48] ^ ~t[60];
+  t[67] = t[64] ^ t[65];
+  s3    = t[53] ^ t[66];
+  s4    = t[51] ^ t[66];
+  s5    = t[47] ^ t[65];
+  s1    = t[64] ^ ~s3;
+  s2    = t[55] ^ ~t[67];
+
+  q[7] = s0;
+  q[6] = s1;
+  q[5] = s2;
+  q[4] = s3;
+  q[3] = s4;
+  q[2] = s5;
+  q[1] = s6;
+  q[0] = s7;
+}
 
-      /* Col4 */
+/****************************************************************************
+ * Name: aes_bs_invaffine
+ *
+ * Description:
+ *   Apply the inverse of the affine transformation of the sbox.
+ *
+ ****************************************************************************/
 
-      buf1 = state[12] ^ state[13] ^ state[14] ^ state[15];
-      buf2 = state[12];
+static void aes_bs_invaffine(FAR uint32_t *q)
+{
+  uint32_t q0 = ~q[0];
+  uint32_t q1 = ~q[1];
+  uint32_t q2 = q[2];
+  uint32_t q3 = q[3];
+  uint32_t q4 = q[4];
+  uint32_t q5 = ~q[5];
+  uint32_t q6 = ~q[6];
+  uint32_t q7 = q[7];
+
+  q[7] = q1 ^ q4 ^ q6;
+  q[6] = q0 ^ q3 ^ q5;
+  q[5] = q7 ^ q2 ^ q4;
+  q[4] = q6 ^ q1 ^ q3;
+  q[3] = q5 ^ q0 ^ q2;
+  q[2] = q4 ^ q7 ^ q1;
+  q[1] = q3 ^ q6 ^ q0;
+  q[0] = q2 ^ q5 ^ q7;
+}
 
-      buf3 = state[12] ^ state[13];
-      buf3 = galois_mul2(buf3);
-      state[12] = state[12] ^ buf3 ^ buf1;
+/****************************************************************************
+ * Name: aes_bs_invsbox
+ *
+ * Description:
+ *   Apply the inverse sbox.  The inversion in GF(2^8) is its own inverse,
+ *   so wrapping the sbox in the inverse affine transformation leaves only
+ *   the inversion and the inverse affine transformation.
+ *
+ ****************************************************************************/
 
-      buf3 = state[13] ^ state[14];
-      buf3 = galois_mul2(buf3);
-      state[13] = state[13] ^ buf3 ^ buf1;
+static void aes_bs_invsbox(FAR uint32_t *q)
+{
+  aes_bs_invaffine(q);
+  aes_bs_sbox(q);
+  aes_bs_invaffine(q);
+}
 
-      buf3 = state[14] ^ state[15];
-      buf3 = galois_mul2(buf3);
-      state[14] = state[14] ^ buf3 ^ buf1;
+static void aes_bs_shiftrows(FAR uint32_t *q)
+{
+  uint32_t x;
+  int i;
 
-      buf3 = state[15] ^ buf2;
-      buf3 = galois_mul2(buf3);
-      state[15] = state[15] ^ buf3 ^ buf1;
+  for (i = 0; i < 8; i++)
+    {
+      x = q[i];
+      q[i] = (x & 0x000000ff) |
+             ((x & 0x0000fc00) >> 2) | ((x & 0x00000300) << 6) |
+             ((x & 0x00f00000) >> 4) | ((x & 0x000f0000) << 4) |
+             ((x & 0xc0000000) >> 6) | ((x & 0x3f000000) << 2);
     }
+}
 
-  /* 10th round without mixcols */
-
-  state[0]   = g_sbox[(state[0]  ^ expanded_key[(round * 16)])];
-  state[4]   = g_sbox[(state[4]  ^ expanded_key[(round * 16) +  4])];
-  state[8]   = g_sbox[(state[8]  ^ expanded_key[(round * 16) +  8])];
-  state[12]  = g_sbox[(state[12] ^ expanded_key[(round * 16) + 12])];
-
-  /* Row 1 */
-
-  buf1       = state[1] ^ expanded_key[(round * 16) + 1];
-  state[1]   = g_sbox[(state[5]  ^ expanded_key[(round * 16) +  5])];
-  state[5]   = g_sbox[(state[9]  ^ expanded_key[(round * 16) +  9])];
-  state[9]   = g_sbox[(state[13] ^ expanded_key[(round * 16) + 13])];
-  state[13]  = g_sbox[buf1];
-
-  /* Row 2 */
+static void aes_bs_invshiftrows(FAR uint32_t *q)
+{
+  uint32_t x;
+  int i;
 
-  buf1       = state[2] ^ expanded_key[(round * 16) + 2];
-  buf2       = state[6] ^ expanded_key[(round * 16) + 6];
-  state[2]   = g_sbox[(state[10] ^ expanded_key[(round * 16) + 10])];
-  state[6]   = g_sbox[(state[14] ^ expanded_key[(round * 16) + 14])];
-  state[10]  = g_sbox[buf1];
-  state[14]  = g_sbox[buf2];
+  for (i = 0; i < 8; i++)
+    {
+      x = q[i];
+      q[i] = (x & 0x000000ff) |
+             ((x & 0x00003f00) << 2) | ((x & 0x0000c000) >> 6) |
+             ((x & 0x000f0000) << 4) | ((x & 0x00f00000) >> 4) |
+             ((x & 0x03000000) << 6) | ((x & 0xfc000000) >> 2);
+    }
+}
 
-  /* Row 3 */
+static void aes_bs_mixcolumns(FAR uint32_t *q)
+{
+  uint32_t q0 = q[0];
+  uint32_t q1 = q[1];
+  uint32_t q2 = q[2];
+  uint32_t q3 = q[3];
+  uint32_t q4 = q[4];
+  uint32_t q5 = q[5];
+  uint32_t q6 = q[6];
+  uint32_t q7 = q[7];
+  uint32_t r0 = AES_ROR(q0, 8);
+  uint32_t r1 = AES_ROR(q1, 8);
+  uint32_t r2 = AES_ROR(q2, 8);
+  uint32_t r3 = AES_ROR(q3, 8);
+  uint32_t r4 = AES_ROR(q4, 8);
+  uint32_t r5 = AES_ROR(q5, 8);
+  uint32_t r6 = AES_ROR(q6, 8);
+  uint32_t r7 = AES_ROR(q7, 8);
+
+  q[0] = q7 ^ r7 ^ r0 ^ AES_ROR(q0 ^ r0, 16);
+  q[1] = q0 ^ r0 ^ q7 ^ r7 ^ r1 ^ AES_ROR(q1 ^ r1, 16);
+  q[2] = q1 ^ r1 ^ r2 ^ AES_ROR(q2 ^ r2, 16);
+  q[3] = q2 ^ r2 ^ q7 ^ r7 ^ r3 ^ AES_ROR(q3 ^ r3, 16);
+  q[4] = q3 ^ r3 ^ q7 ^ r7 ^ r4 ^ AES_ROR(q4 ^ r4, 16);
+  q[5] = q4 ^ r4 ^ r5 ^ AES_ROR(q5 ^ r5, 16);
+  q[6] = q5 ^ r5 ^ r6 ^ AES_ROR(q6 ^ r6, 16);
+  q[7] = q6 ^ r6 ^ r7 ^ AES_ROR(q7 ^ r7, 16);
+}
 
-  buf1       = state[15] ^ expanded_key[(round * 16) + 15];
-  state[15]  = g_sbox[(state[11] ^ expanded_key[(round * 16) + 11])];
-  state[11]  = g_sbox[(state[7]  ^ expanded_key[(round * 16) +  7])];
-  state[7]   = g_sbox[(state[3]  ^ expanded_key[(round * 16) +  3])];
-  state[3]   = g_sbox[buf1];
+static void aes_bs_invmixcolumns(FAR uint32_t *q)
+{
+  uint32_t q0 = q[0];
+  uint32_t q1 = q[1];
+  uint32_t q2 = q[2];
+  uint32_t q3 = q[3];
+  uint32_t q4 = q[4];
+  uint32_t q5 = q[5];
+  uint32_t q6 = q[6];
+  uint32_t q7 = q[7];
+  uint32_t r0 = AES_ROR(q0, 8);
+  uint32_t r1 = AES_ROR(q1, 8);
+  uint32_t r2 = AES_ROR(q2, 8);
+  uint32_t r3 = AES_ROR(q3, 8);
+  uint32_t r4 = AES_ROR(q4, 8);
+  uint32_t r5 = AES_ROR(q5, 8);
+  uint32_t r6 = AES_ROR(q6, 8);
+  uint32_t r7 = AES_ROR(q7, 8);
+
+  q[0] = q5 ^ q6 ^ q7 ^ r0 ^ r5 ^ r7 ^
+         AES_ROR(q0 ^ q5 ^ q6 ^ r0 ^ r5, 16);
+  q[1] = q0 ^ q5 ^ r0 ^ r1 ^ r5 ^ r6 ^ r7 ^
+         AES_ROR(q1 ^ q5 ^ q7 ^ r1 ^ r5 ^ r6, 16);
+  q[2] = q0 ^ q1 ^ q6 ^ r1 ^ r2 ^ r6 ^ r7 ^
+         AES_ROR(q0 ^ q2 ^ q6 ^ r2 ^ r6 ^ r7, 16);
+  q[3] = q0 ^ q1 ^ q2 ^ q5 ^ q6 ^ r0 ^ r2 ^ r3 ^ r5 ^
+         AES_ROR(q0 ^ q1 ^ q3 ^ q5 ^ q6 ^ q7 ^ r0 ^ r3 ^ r5 ^ r7, 16);
+  q[4] = q1 ^ q2 ^ q3 ^ q5 ^ r1 ^ r3 ^ r4 ^ r5 ^ r6 ^ r7 ^
+         AES_ROR(q1 ^ q2 ^ q4 ^ q5 ^ q7 ^ r1 ^ r4 ^ r5 ^ r6, 16);
+  q[5] = q2 ^ q3 ^ q4 ^ q6 ^ r2 ^ r4 ^ r5 ^ r6 ^ r7 ^
+         AES_ROR(q2 ^ q3 ^ q5 ^ q6 ^ r2 ^ r5 ^ r6 ^ r7, 16);
+  q[6] = q3 ^ q4 ^ q5 ^ q7 ^ r3 ^ r5 ^ r6 ^ r7 ^
+         AES_ROR(q3 ^ q4 ^ q6 ^ q7 ^ r3 ^ r6 ^ r7, 16);
+  q[7] = q4 ^ q5 ^ q6 ^ r4 ^ r6 ^ r7 ^
+         AES_ROR(q4 ^ q5 ^ q7 ^ r4 ^ r7, 16);
+}
 
-  /* Last addroundkey */
+static void aes_bs_addroundkey(FAR uint32_t *q, FAR const uint32_t *sk)
+{
+  int i;
 
-  state[0]  ^= expanded_key[160];
-  state[1]  ^= expanded_key[161];
-  state[2]  ^= expanded_key[162];
-  state[3]  ^= expanded_key[163];
-  state[4]  ^= expanded_key[164];
-  state[5]  ^= expanded_key[165];
-  state[6]  ^= expanded_key[166];
-  state[7]  ^= expanded_key[167];
-  state[8]  ^= expanded_key[168];
-  state[9]  ^= expanded_key[169];
-  state[10] ^= expanded_key[170];
-  state[11] ^= expanded_key[171];
-  state[12] ^= expanded_key[172];
-  state[13] ^= expanded_key[173];
-  state[14] ^= expanded_key[174];
-  state[15] ^= expanded_key[175];
+  for (i = 0; i < 8; i++)
+    {
+      q[i] ^= sk[i];
+    }
 }
 
 /****************************************************************************
- * Name: aes_decr
+ * Name: aes_bs_subword
  *
  * Description:
- *  Internal implementation of AES128 decryption.
- *  Straight forward aes decryption implementation.  The order of substeps is
- *  the exact reverse of decryption inverse functions:
- *
- *     - addRoundKey is its own inverse
- *     - rsbox is inverse of sbox
- *     - rightshift instead of leftshift
- *     - invMixColumns = barreto + mixColumns
- *
- *  No further subfunctions to save cycles for function calls no structuring
- *  with "for (....)" to save cycles
- *
- * Input Parameters:
- *  expanded_key expanded AES128 key
- *  state        16 bytes of cipher text and plain text
- *
- * Returned Value:
- *  None
+ *   Apply the sbox to the 4 bytes of a key schedule word.
  *
  ****************************************************************************/
 
-static void aes_decr(FAR uint8_t *state, FAR const uint8_t *expanded_key)
+static uint32_t aes_bs_subword(uint32_t w)
 {
-  uint8_t buf1;
-  uint8_t buf2;
-  uint8_t buf3;
-  int8_t round;
-
-  round = 9;
+  uint32_t q[8];
+
+  memset(q, 0, sizeof(q));
+  q[0] = w;
+  aes_bs_ortho(q);
+  aes_bs_sbox(q);
+  aes_bs_ortho(q);
+  return q[0];
+}
 
-  /* Initial addroundkey */
+/****************************************************************************
+ * Name: aes_setupkey_rounds
+ *
+ * Description:
+ *   Expand the key and store the round keys in the bitsliced
+ *   representation, duplicated for the two blocks of a pass.
+ *
+ ****************************************************************************/
 
-  state[0]  ^= expanded_key[160];
-  state[1]  ^= expanded_key[161];
-  state[2]  ^= expanded_key[162];
-  state[3]  ^= expanded_key[163];
-  state[4]  ^= expanded_key[164];
-  state[5]  ^= expanded_key[165];
-  state[6]  ^= expanded_key[166];
-  state[7]  ^= expanded_key[167];
-  state[8]  ^= expanded_key[168];
-  state[9]  ^= expanded_key[169];
-  state[10] ^= expanded_key[170];
-  state[11] ^= expanded_key[171];
-  state[12] ^= expanded_key[172];
-  state[13] ^= expanded_key[173];
-  state[14] ^= expanded_key[174];
-  state[15] ^= expanded_key[175];
+static void aes_setupkey_rounds(FAR struct aes_state_s *state,
+                                FAR const uint8_t *key, int nk)
+{
+  FAR uint32_t *sk = state->skey;
+  int nwords = (state->nrounds + 1) * 4;
+  uint32_t w = 0;
+  uint32_t x;
+  uint32_t y;
+  int i;
 
-  /* 10th round without mixcols */
+  /* Expand the key with little endian words.  Each word is stored twice,
+   * once for each block.
+   */
 
-  state[0]   = g_rsbox[state[0]]  ^ expanded_key[(round * 16)];
-  state[4]   = g_rsbox[state[4]]  ^ expanded_key[(round * 16) +  4];
-  state[8]   = g_rsbox[state[8]]  ^ expanded_key[(round * 16) +  8];
-  state[12]  = g_rsbox[state[12]] ^ expanded_key[(round * 16) + 12];
+  for (i = 0; i < nk; i++)
+    {
+      w = AES_GETLE32(key + 4 * i);
+      sk[2 * i] = w;
+      sk[2 * i + 1] = w;
+    }
 
-  /* Row 1 */
+  for (; i < nwords; i++)
+    {
+      if (i % nk == 0)
+        {
+          w = (w << 24) | (w >> 8);
+          w = aes_bs_subword(w) ^ g_rcon[i / nk];
+        }
+      else if (nk > 6 && i % nk == 4)
+        {
+          w = aes_bs_subword(w);
+        }
+
+      w ^= sk[2 * (i - nk)];
+      sk[2 * i] = w;
+      sk[2 * i + 1] = w;
+    }
 
-  buf1       = g_rsbox[state[13]] ^ expanded_key[(round * 16) +  1];
-  state[13]  = g_rsbox[state[9]]  ^ expanded_key[(round * 16) + 13];
-  state[9]   = g_rsbox[state[5]]  ^ expanded_key[(round * 16) +  9];
-  state[5]   = g_rsbox[state[1]]  ^ expanded_key[(round * 16) +  5];
-  state[1]   = buf1;
+  /* Then convert each round key to the bitsliced representation.  As both
+   * blocks use the same round key, the bits of the first block's words are
+   * also the bits of the second block's.
+   */
 
-  /* Row 2 */
+  for (i = 0; i < nwords * 2; i += 8)
+    {
+      aes_bs_ortho(sk + i);
+    }
 
-  buf1       = g_rsbox[state[2]]  ^ expanded_key[(round * 16) + 10];
-  buf2       = g_rsbox[state[6]]  ^ expanded_key[(round * 16) + 14];
-  state[2]   = g_rsbox[state[10]] ^ expanded_key[(round * 16) +  2];
-  state[6]   = g_rsbox[state[14]] ^ expanded_key[(round * 16) +  6];
-  state[10]  = buf1;
-  state[14]  = buf2;
+  for (i = 0; i < nwords * 2; i += 2)
+    {
+      x = sk[i] & 0x55555555;
+      y = sk[i + 1] & 0xaaaaaaaa;
+      sk[i] = x | (x << 1);
+      sk[i + 1] = y | (y >> 1);
+    }
+}
 
-  /* Row 3 */
+/****************************************************************************
+ * Name: aes_bs_load
+ *
+ * Description:
+ *   Load one or two blocks into the bitsliced state.
+ *
+ ****************************************************************************/
 
-  buf1       = g_rsbox[state[3]]  ^ expanded_key[(round * 16) + 15];
-  state[3]   = g_rsbox[state[7]]  ^ expanded_key[(round * 16) +  3];
-  state[7]   = g_rsbox[state[11]] ^ expanded_key[(round * 16) +  7];
-  state[11]  = g_rsbox[state[15]] ^ expanded_key[(round * 16) + 11];
-  state[15]  = buf1;
+static void aes_bs_load(FAR uint32_t *q, FAR const uint8_t *in, int nblk)
+{
+  int i;
 
-  for (round = 8; round >= 0; round--)
+  for (i = 0; i < 4; i++)
     {
-      /* barreto */
+      q[2 * i] = AES_GETLE32(in + 4 * i);
+      q[2 * i + 1] = nblk > 1 ? AES_GETLE32(in + AES_BLOCK_SIZE + 4 * i) : 0;
+    }
 
-      /* Col1 */
+  aes_bs_ortho(q);
+}
 
-      buf1       = galois_mul2(galois_mul2(state[0] ^ state[2]));
-      buf2       = galois_mul2(galois_mul2(state[1] ^ state[3]));
-      state[0]  ^= buf1;
-      state[1]  ^= buf2;
-      state[2]  ^= buf1;
-      state[3]  ^= buf2;
+static void aes_bs_store(FAR uint8_t *out, FAR uint32_t *q, int nblk)
+{
+  int i;
 
-      /* Col2 */
+  aes_bs_ortho(q);
 
-      buf1       = galois_mul2(galois_mul2(state[4] ^ state[6]));
-      buf2       = galois_mul2(galois_mul2(state[5] ^ state[7]));
-      state[4]  ^= buf1;
-      state[5]  ^= buf2;
-      state[6]  ^= buf1;
-      state[7]  ^= buf2;
+  for (i = 0; i < 4; i++)
+    {
+      AES_PUTLE32(out + 4 * i, q[2 * i]);
+      if (nblk > 1)
+        {
+          AES_PUTLE32(out + AES_BLOCK_SIZE + 4 * i, q[2 * i + 1]);
+        }
+    }
+}
 
-      /* Col3 */
+/****************************************************************************
+ * Name: aes_encr
+ *
+ * Description:
+ *   Encrypt 'nblk' 16-byte blocks, two at a time, in constant time.  'out'
+ *   may be the same as 'in'.
+ *
+ ****************************************************************************/
 
-      buf1       = galois_mul2(galois_mul2(state[8] ^ state[10]));
-      buf2       = galois_mul2(galois_mul2(state[9] ^ state[11]));
-      state[8]  ^= buf1;
-      state[9]  ^= buf2;
-      state[10] ^= buf1;
-      state[11] ^= buf2;
+static void aes_encr(FAR const struct aes_state_s *state, FAR uint8_t *out,
+                     FAR const uint8_t *in, int nblk)
+{
+  FAR const uint32_t *sk;
+  uint32_t q[8];
+  int round;
+  int n;
 
-      /* Col4 */
+  for (; nblk > 0; nblk -= n)
+    {
+      n = nblk > 1 ? 2 : 1;
+      sk = state->skey;
+
+      aes_bs_load(q, in, n);
+      aes_bs_addroundkey(q, sk);
+
+      for (round = 1; round < state->nrounds; round++)
+        {
+          sk += 8;
+          aes_bs_sbox(q);
+          aes_bs_shiftrows(q);
+          aes_bs_mixcolumns(q);
+          aes_bs_addroundkey(q, sk);
+        }
+
+      aes_bs_sbox(q);
+      aes_bs_shiftrows(q);
+      aes_bs_addroundkey(q, sk + 8);
+      aes_bs_store(out, q, n);
+
+      in  += n * AES_BLOCK_SIZE;
+      out += n * AES_BLOCK_SIZE;
+    }
+}
 
-      buf1       = galois_mul2(galois_mul2(state[12] ^ state[14]));
-      buf2       = galois_mul2(galois_mul2(state[13] ^ state[15]));
-      state[12] ^= buf1;
-      state[13] ^= buf2;
-      state[14] ^= buf1;
-      state[15] ^= buf2;
+/****************************************************************************
+ * Name: aes_decr
+ *
+ * Description:
+ *   Decrypt 'nblk' 16-byte blocks, two at a time, in constant time.  'out'
+ *   may be the same as 'in'.
+ *
+ ****************************************************************************/
 
-      /* mixcolums */
+static void aes_decr(FAR const struct aes_state_s *state, FAR uint8_t *out,
+                     FAR const uint8_t *in, int nblk)
+{
+  FAR const uint32_t *sk;
+  uint32_t q[8];
+  int round;
+  int n;
 
-      /* Col1 */
+  for (; nblk > 0; nblk -= n)
+    {
+      n = nblk > 1 ? 2 : 1;
+      sk = state->skey + state->nrounds * 8;
+
+      aes_bs_load(q, in, n);
+      aes_bs_addroundkey(q, sk);
+
+      for (round = 1; round < state->nrounds; round++)
+        {
+          sk -= 8;
+          aes_bs_invshiftrows(q);
+          aes_bs_invsbox(q);
+          aes_bs_addroundkey(q, sk);
+          aes_bs_invmixcolumns(q);
+        }
+
+      aes_bs_invshiftrows(q);
+      aes_bs_invsbox(q);
+      aes_bs_addroundkey(q, state->skey);
+      aes_bs_store(out, q, n);
+
+      in  += n * AES_BLOCK_SIZE;
+      out += n * AES_BLOCK_SIZE;
+    }
+}
 
-      buf1 = state[0]  ^ state[1] ^ state[2] ^ state[3];
-      buf2 = state[0];
+/****************************************************************************
+ * Name: aes_ghash_init
+ *
+ * Description:
+ *   Prepare the GHASH state for the hash key H.
+ *
+ ****************************************************************************/
 
-      buf3 = state[0]  ^ state[1];
-      buf3 = galois_mul2(buf3);
-      state[0] = state[0] ^ buf3 ^ buf1;
+static void aes_ghash_init(FAR struct aes_ghash_s *ghash,
+                           FAR const uint8_t *h)
+{
+  int i;
 
-      buf3 = state[1]  ^ state[2];
-      buf3 = galois_mul2(buf3);
-      state[1] = state[1] ^ buf3 ^ buf1;
+  for (i = 0; i < 4; i++)
+    {
+      ghash->h[i] = AES_GETBE32(h + 4 * i);
+    }
 
-      buf3 = state[2]  ^ state[3];
-      buf3 = galois_mul2(buf3);
-      state[2] = state[2] ^ buf3 ^ buf1;
+  memset(ghash->y, 0, AES_BLOCK_SIZE);
+}
 
-      buf3 = state[3]  ^ buf2;
-      buf3 = galois_mul2(buf3);
-      state[3] = state[3] ^ buf3 ^ buf1;
+/****************************************************************************
+ * Name: aes_ghash_mult
+ *
+ * Description:
+ *   Multiply the running hash by H one bit at a time.  Every bit takes the
+ *   same operations, selected with masks rather than branches, so the time
+ *   taken does not depend on the data or the key.
+ *
+ ****************************************************************************/
 
-      /* Col2 */
+static void aes_ghash_mult(FAR struct aes_ghash_s *ghash)
+{
+  uint32_t z[4];
+  uint32_t v[4];
+  uint32_t mask;
+  int i;
+  int j;
 
-      buf1 = state[4]  ^ state[5] ^ state[6] ^ state[7];
-      buf2 = state[4];
+  memset(z, 0, sizeof(z));
+  memcpy(v, ghash->h, sizeof(v));
 
-      buf3 = state[4]  ^ state[5];
-      buf3 = galois_mul2(buf3);
-      state[4] = state[4] ^ buf3 ^ buf1;
+  for (i = 0; i < 128; i++)
+    {
+      mask = -(uint32_t)((ghash->y[i >> 3] >> (7 - (i & 7))) & 1);
+      for (j = 0; j < 4; j++)
+        {
+          z[j] ^= v[j] & mask;
+        }
+
+      mask = -(v[3] & 1);
+      v[3] = (v[3] >> 1) | (v[2] << 31);
+      v[2] = (v[2] >> 1) | (v[1] << 31);
+      v[1] = (v[1] >> 1) | (v[0] << 31);
+      v[0] = (v[0] >> 1) ^ (0xe1000000 & mask);
+    }
 
-      buf3 = state[5]  ^ state[6];
-      buf3 = galois_mul2(buf3);
-      state[5] = state[5] ^ buf3 ^ buf1;
+  for (j = 0; j < 4; j++)
+    {
+      AES_PUTBE32(ghash->y + 4 * j, z[j]);
+    }
+}
 
-      buf3 = state[6]  ^ state[7];
-      buf3 = galois_mul2(buf3);
-      state[6] = state[6] ^ buf3 ^ buf1;
+#endif /* CONFIG_CRYPTO_SW_AES_BITSLICE */
 
-      buf3 = state[7]  ^ buf2;
-      buf3 = galois_mul2(buf3);
-      state[7] = state[7] ^ buf3 ^ buf1;
+/****************************************************************************
+ * Name: aes_ghash_update
+ *
+ * Description:
+ *   Hash 'len' bytes.  A partial last block is padded with zeroes.
+ *
+ ****************************************************************************/
 
-      /* Col3 */
+static void aes_ghash_update(FAR struct aes_ghash_s *ghash,
+                             FAR const uint8_t *data, size_t len)
+{
+  size_t n;
+  size_t i;
 
-      buf1 = state[8]  ^ state[9] ^ state[10] ^ state[11];
-      buf2 = state[8];
+  while (len > 0)
+    {
+      n = len < AES_BLOCK_SIZE ? len : AES_BLOCK_SIZE;
+      for (i = 0; i < n; i++)
+        {
+          ghash->y[i] ^= data[i];
+        }
+
+      aes_ghash_mult(ghash);
+      data += n;
+      len  -= n;
+    }
+}
 
-      buf3 = state[8]  ^ state[9];
-      buf3 = galois_mul2(buf3);
-      state[8] = state[8] ^ buf3 ^ buf1;
+/****************************************************************************
+ * Name: aes_ctr_xor
+ *
+ * Description:
+ *   XOR 'len' bytes with the key stream of the counter block 'ctr'.  The
+ *   last 'ctrlen' bytes of the counter block are incremented as a big
+ *   endian integer for each block, including a partial last block.
+ *
+ ****************************************************************************/
 
-      buf3 = state[9]  ^ state[10];
-      buf3 = galois_mul2(buf3);
-      state[9] = state[9] ^ buf3 ^ buf1;
+static void aes_ctr_xor(FAR const struct aes_state_s *state,
+                        FAR uint8_t *ctr, FAR uint8_t *out,
+                        FAR const uint8_t *in, size_t len, int ctrlen)
+{
+  uint8_t ks[AES_NPARALLEL * AES_BLOCK_SIZE];
+  size_t n;
+  size_t i;
+  int nblk;
+  int j;
 
-      buf3 = state[10] ^ state[11];
-      buf3 = galois_mul2(buf3);
-      state[10] = state[10] ^ buf3 ^ buf1;
+  while (len > 0)
+    {
+      for (nblk = 0; nblk < AES_NPARALLEL &&
+                     nblk * AES_BLOCK_SIZE < len; nblk++)
+        {
+          memcpy(ks + nblk * AES_BLOCK_SIZE, ctr, AES_BLOCK_SIZE);
+          for (j = AES_BLOCK_SIZE - 1;
+               j >= AES_BLOCK_SIZE - ctrlen && ++ctr[j] == 0; j--)
+            {
+            }
+        }
+
+      aes_encr(state, ks, ks, nblk);
+
+      n = nblk * AES_BLOCK_SIZE;
+      if (n > len)
+        {
+          n = len;
+        }
+
+      for (i = 0; i < n; i++)
+        {
+          out[i] = in[i] ^ ks[i];
+        }
+
+      in  += n;
+      out += n;
+      len -= n;
+    }
 
-      buf3 = state[11] ^ buf2;
-      buf3 = galois_mul2(buf3);
-      state[11] = state[11] ^ buf3 ^ buf1;
+  explicit_bzero(ks, sizeof(ks));
+}
 
-      /* Col4 */
+/****************************************************************************
+ * Name: aes_gcm_crypt
+ *
+ * Description:
+ *   Encrypt or decrypt with GCM and compute the authentication tag.
+ *
+ ****************************************************************************/
 
-      buf1 = state[12] ^ state[13] ^ state[14] ^ state[15];
-      buf2 = state[12];
+static void aes_gcm_crypt(FAR const struct aes_state_s *state,
+                          FAR const uint8_t *iv, size_t ivlen,
+                          FAR const uint8_t *aad, size_t aadlen,
+                          FAR uint8_t *out, FAR const uint8_t *in,
+                          size_t len, FAR uint8_t *tag, bool encrypt)
+{
+  struct aes_ghash_s ghash;
+  uint8_t j0[AES_BLOCK_SIZE];
+  uint8_t ctr[AES_BLOCK_SIZE];
+  uint8_t lens[AES_BLOCK_SIZE];
+  int i;
 
-      buf3 = state[12] ^ state[13];
-      buf3 = galois_mul2(buf3);
-      state[12] = state[12] ^ buf3 ^ buf1;
+  /* The hash key is the encryption of the zero block */
 
-      buf3 = state[13] ^ state[14];
-      buf3 = galois_mul2(buf3);
-      state[13] = state[13] ^ buf3 ^ buf1;
+  memset(ctr, 0, AES_BLOCK_SIZE);
+  aes_encr(state, ctr, ctr, 1);
+  aes_ghash_init(&ghash, ctr);
 
-      buf3 = state[14] ^ state[15];
-      buf3 = galois_mul2(buf3);
-      state[14] = state[14] ^ buf3 ^ buf1;
+  /* The pre-counter block is the IV with a 32-bit counter of 1 appended if
+   * the IV has 96 bits, or the hash of the IV otherwise.
+   */
 
-      buf3 = state[15] ^ buf2;
-      buf3 = galois_mul2(buf3);
-      state[15] = state[15] ^ buf3 ^ buf1;
+  memset(lens, 0, AES_BLOCK_SIZE);
+  if (ivlen == AES_GCM_IV_SIZE)
+    {
+      memcpy(j0, iv, AES_GCM_IV_SIZE);
+      memset(j0 + AES_GCM_IV_SIZE, 0, AES_BLOCK_SIZE - AES_GCM_IV_SIZE);
+      j0[AES_BLOCK_SIZE - 1] = 1;
+    }
+  else
+    {
+      aes_ghash_update(&ghash, iv, ivlen);
+      AES_PUTBE32(lens + 8, (uint32_t)(ivlen >> 29));
+      AES_PUTBE32(lens + 12, (uint32_t)(ivlen << 3));
+      aes_ghash_update(&ghash, lens, AES_BLOCK_SIZE);
 
-      /* addroundkey, rsbox and shiftrows */
+      memcpy(j0, ghash.y, AES_BLOCK_SIZE);
+      memset(ghash.y, 0, AES_BLOCK_SIZE);
+    }
 
-      /* Row 0 */
+  /* Hash the additional data, then the cipher text */
 
-      state[0]   = g_rsbox[state[0]]  ^ expanded_key[(round * 16)];
-      state[4]   = g_rsbox[state[4]]  ^ expanded_key[(round * 16) +  4];
-      state[8]   = g_rsbox[state[8]]  ^ expanded_key[(round * 16) +  8];
-      state[12]  = g_rsbox[state[12]] ^ expanded_key[(round * 16) + 12];
+  aes_ghash_update(&ghash, aad, aadlen);
 
-      /* Row 1 */
+  memcpy(ctr, j0, AES_BLOCK_SIZE);
+  for (i = AES_BLOCK_SIZE - 1; i >= AES_BLOCK_SIZE - 4 && ++ctr[i] == 0;
+       i--)
+    {
+    }
 
-      buf1       = g_rsbox[state[13]] ^ expanded_key[(round * 16) +  1];
-      state[13]  = g_rsbox[state[9]]  ^ expanded_key[(round * 16) + 13];
-      state[9]   = g_rsbox[state[5]]  ^ expanded_key[(round * 16) +  9];
-      state[5]   = g_rsbox[state[1]]  ^ expanded_key[(round * 16) +  5];
-      state[1]   = buf1;
+  if (encrypt)
+    {
+      aes_ctr_xor(state, ctr, out, in, len, 4);
+      aes_ghash_update(&ghash, out, len);
+    }
+  else
+    {
+      aes_ghash_update(&ghash, in, len);
+      aes_ctr_xor(state, ctr, out, in, len, 4);
+    }
 
-      /* Row 2 */
+  /* Then the bit lengths of both */
 
-      buf1       = g_rsbox[state[2]]  ^ expanded_key[(round * 16) + 10];
-      buf2       = g_rsbox[state[6]]  ^ expanded_key[(round * 16) + 14];
-      state[2]   = g_rsbox[state[10]] ^ expanded_key[(round * 16) +  2];
-      state[6]   = g_rsbox[state[14]] ^ expanded_key[(round * 16) +  6];
-      state[10]  = buf1;
-      state[14]  = buf2;
+  AES_PUTBE32(lens, (uint32_t)(aadlen >> 29));
+  AES_PUTBE32(lens + 4, (uint32_t)(aadlen << 3));
+  AES_PUTBE32(lens + 8, (uint32_t)(len >> 29));
+  AES_PUTBE32(lens + 12, (uint32_t)(len << 3));
+  aes_ghash_update(&ghash, lens, AES_BLOCK_SIZE);
 
-      /* Row 3 */
+  /* The tag is the hash encrypted with the pre-counter block */
 
-      buf1       = g_rsbox[state[3]]  ^ expanded_key[(round * 16) + 15];
-      state[3]   = g_rsbox[state[7]]  ^ expanded_key[(round * 16) +  3];
-      state[7]   = g_rsbox[state[11]] ^ expanded_key[(round * 16) +  7];
-      state[11]  = g_rsbox[state[15]] ^ expanded_key[(round * 16) + 11];
-      state[15]  = buf1;
+  aes_encr(state, j0, j0, 1);
+  for (i = 0; i < AES_GCM_TAG_SIZE; i++)
+    {
+      tag[i] = j0[i] ^ ghash.y[i];
     }
+
+  explicit_bzero(&ghash, sizeof(ghash));
+  explicit_bzero(j0, sizeof(j0));
 }
 
 /****************************************************************************
@@ -715,14 +1491,12 @@ static void aes_decr(FAR uint8_t *state, FAR const uint8_t *expanded_key)
  *
  * Input Parameters:
  *  state  an AES context that can be used for AES operations
- *  key    a pointer to a 16-byte buffer holding the AES-128 key
- *  len    length of the key, must be 16
- *
- * TODO: Support other key lengths of 24 (AES-192) and 32 (AES-256)
+ *  key    a pointer to a buffer holding the AES key
+ *  len    length of the key, must be 16, 24 or 32
  *
  * Returned Value:
  *   0 if OK
- *   -EINVAL if len is not 16
+ *   -EINVAL if len is not 16, 24 or 32
  *
  ****************************************************************************/
 
@@ -730,12 +1504,14 @@ int aes_setupkey(FAR struct aes_state_s *state,
                  FAR const uint8_t *key,
                  int len)
 {
-  if (len != 16)
+  if (len != AES128_KEY_SIZE && len != AES192_KEY_SIZE &&
+      len != AES256_KEY_SIZE)
     {
       return -EINVAL;
     }
 
-  expand_key(state->expanded_key, key);
+  state->nrounds = len / 4 + 6;
+  aes_setupkey_rounds(state, key, len / 4);
   return 0;
 }
 
@@ -755,14 +1531,7 @@ int aes_setupkey(FAR struct aes_state_s *state,
 void aes_encipher(FAR struct aes_state_s *state, FAR uint8_t *blocks,
                   int nblk)
 {
-  int i;
-  uint32_t off = 0;
-
-  for (i = 0; i < nblk; i++)
-    {
-      aes_encr(blocks + off, state->expanded_key);
-      off += 16;
-    }
+  aes_encr(state, blocks, blocks, nblk);
 }
 
 /****************************************************************************
@@ -780,17 +1549,182 @@ void aes_encipher(FAR struct aes_state_s *state, FAR uint8_t *blocks,
 
 void aes_decipher(FAR struct aes_state_s *state, FAR uint8_t *blocks,
                   int nblk)
+{
+  aes_decr(state, blocks, blocks, nblk);
+}
+
+/****************************************************************************
+ * Name: aes_cbc_encipher
+ *
+ * Description:
+ *   Encipher some 16-byte blocks in CBC mode.  'iv' is updated to the last
+ *   cipher text block so that the next call continues the chain.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void aes_cbc_encipher(FAR struct aes_state_s *state, FAR uint8_t *iv,
+                      FAR uint8_t *blocks, int nblk)
 {
   int i;
-  uint32_t off = 0;
 
-  for (i = 0; i < nblk; i++)
+  for (; nblk > 0; nblk--, blocks += AES_BLOCK_SIZE)
     {
-      aes_decr(blocks + off, state->expanded_key);
-      off += 16;
+      for (i = 0; i < AES_BLOCK_SIZE; i++)
+        {
+          blocks[i] ^= iv[i];
+        }
+
+      aes_encr(state, blocks, blocks, 1);
+      memcpy(iv, blocks, AES_BLOCK_SIZE);
     }
 }
 
+/****************************************************************************
+ * Name: aes_cbc_decipher
+ *
+ * Description:
+ *   Decipher some 16-byte blocks in CBC mode.  'iv' is updated to the last
+ *   cipher text block so that the next call continues the chain.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void aes_cbc_decipher(FAR struct aes_state_s *state, FAR uint8_t *iv,
+                      FAR uint8_t *blocks, int nblk)
+{
+  uint8_t tmp[AES_NPARALLEL * AES_BLOCK_SIZE];
+  FAR const uint8_t *prev;
+  int n;
+  int i;
+  int j;
+
+  /* Unlike encryption, the blocks can be decrypted independently */
+
+  for (; nblk > 0; nblk -= n, blocks += n * AES_BLOCK_SIZE)
+    {
+      n = nblk < AES_NPARALLEL ? nblk : AES_NPARALLEL;
+      aes_decr(state, tmp, blocks, n);
+
+      for (j = 0; j < n; j++)
+        {
+          prev = j == 0 ? iv : blocks + (j - 1) * AES_BLOCK_SIZE;
+          for (i = 0; i < AES_BLOCK_SIZE; i++)
+            {
+              tmp[j * AES_BLOCK_SIZE + i] ^= prev[i];
+            }
+        }
+
+      memcpy(iv, blocks + (n - 1) * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+      memcpy(blocks, tmp, n * AES_BLOCK_SIZE);
+    }
+
+  explicit_bzero(tmp, sizeof(tmp));
+}
+
+/****************************************************************************
+ * Name: aes_ctr_crypt
+ *
+ * Description:
+ *   Encrypt or decrypt 'len' bytes in CTR mode.  The 16-byte counter block
+ *   'ctr' is incremented as a 128-bit big endian integer for each block,
+ *   including a partial last block, so that the next call continues the
+ *   key stream at the next block.  'out' may be the same as 'in'.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void aes_ctr_crypt(FAR struct aes_state_s *state, FAR uint8_t *ctr,
+                   FAR uint8_t *out, FAR const uint8_t *in, size_t len)
+{
+  aes_ctr_xor(state, ctr, out, in, len, AES_BLOCK_SIZE);
+}
+
+/****************************************************************************
+ * Name: aes_gcm_encrypt
+ *
+ * Description:
+ *   Encrypt 'len' bytes in GCM mode and compute the AES_GCM_TAG_SIZE byte
+ *   authentication tag over the additional data 'aad' and the cipher text.
+ *   'out' may be the same as 'in'.
+ *
+ * Returned Value:
+ *   0 if OK
+ *   -EINVAL if the IV is empty
+ *
+ ****************************************************************************/
+
+int aes_gcm_encrypt(FAR struct aes_state_s *state,
+                    FAR const uint8_t *iv, size_t ivlen,
+                    FAR const uint8_t *aad, size_t aadlen,
+                    FAR uint8_t *out, FAR const uint8_t *in, size_t len,
+                    FAR uint8_t *tag)
+{
+  if (ivlen == 0)
+    {
+      return -EINVAL;
+    }
+
+  aes_gcm_crypt(state, iv, ivlen, aad, aadlen, out, in, len, tag, true);
+  return 0;
+}
+
+/****************************************************************************
+ * Name: aes_gcm_decrypt
+ *
+ * Description:
+ *   Decrypt 'len' bytes in GCM mode and check the AES_GCM_TAG_SIZE byte
+ *   authentication tag.  'out' may be the same as 'in'.  If the tag does
+ *   not match, the output is cleared.
+ *
+ * Returned Value:
+ *   0 if OK
+ *   -EINVAL if the IV is empty
+ *   -EBADMSG if the tag does not match
+ *
+ ****************************************************************************/
+
+int aes_gcm_decrypt(FAR struct aes_state_s *state,
+                    FAR const uint8_t *iv, size_t ivlen,
+                    FAR const uint8_t *aad, size_t aadlen,
+                    FAR uint8_t *out, FAR const uint8_t *in, size_t len,
+                    FAR const uint8_t *tag)
+{
+  uint8_t check[AES_GCM_TAG_SIZE];
+  uint8_t diff = 0;
+  int i;
+
+  if (ivlen == 0)
+    {
+      return -EINVAL;
+    }
+
+  aes_gcm_crypt(state, iv, ivlen, aad, aadlen, out, in, len, check, false);
+
+  /* Compare all of the tag so that the time taken does not tell how much
+   * of it was right.
+   */
+
+  for (i = 0; i < AES_GCM_TAG_SIZE; i++)
+    {
+      diff |= check[i] ^ tag[i];
+    }
+
+  if (diff != 0)
+    {
+      explicit_bzero(out, len);
+      return -EBADMSG;
+    }
+
+  return 0;
+}
+
 /****************************************************************************
  * Name: aes_encrypt
  *
@@ -810,10 +1744,10 @@ void aes_decipher(FAR struct aes_state_s *state, FAR uint8_t *blocks,
 
 void aes_encrypt(FAR uint8_t *state, FAR const uint8_t *key)
 {
-  /* Expand the key into 176 bytes */
+  /* Expand the key */
 
-  aes_setupkey(&g_aes_state, key, 16);
-  aes_encr(state, g_aes_state.expanded_key);
+  aes_setupkey(&g_aes_state, key, AES128_KEY_SIZE);
+  aes_encr(&g_aes_state, state, state, 1);
 }
 
 /****************************************************************************
@@ -835,8 +1769,91 @@ void aes_encrypt(FAR uint8_t *state, FAR const uint8_t *key)
 
 void aes_decrypt(FAR uint8_t *state, FAR const uint8_t *key)
 {
-  /* Expand the key into 176 bytes */
+  /* Expand the key */
+
+  aes_setupkey(&g_aes_state, key, AES128_KEY_SIZE);
+  aes_decr(&g_aes_state, state, state, 1);
+}
+
+#ifdef CONFIG_CRYPTO_SW_AES_CYPHER
+
+/****************************************************************************
+ * Name: aes_cypher
+ *
+ * Description:
+ *   Implement the aes_cypher() interface of include/nuttx/crypto/crypto.h
+ *   with the software AES library, for targets without an AES peripheral.
+ *   'iv' is not updated.
+ *
+ * Returned Value:
+ *   0 if OK
+ *   -EINVAL if the key size or the mode is invalid, or if the size is not
+ *   a multiple of 16 in ECB or CBC mode
+ *
+ ****************************************************************************/
+
+int aes_cypher(FAR void *out, FAR const void *in, uint32_t size,
+               FAR const void *iv, FAR const void *key, uint32_t keysize,
+               int mode, int encrypt)
+{
+  struct aes_state_s state;
+  uint8_t block[AES_BLOCK_SIZE];
+  int ret;
+
+  mode &= AES_MODE_MASK;
+  if (mode != AES_MODE_CTR && (size % AES_BLOCK_SIZE) != 0)
+    {
+      return -EINVAL;
+    }
+
+  ret = aes_setupkey(&state, key, keysize);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (mode != AES_MODE_CTR && out != in)
+    {
+      memcpy(out, in, size);
+    }
+
+  switch (mode)
+    {
+      case AES_MODE_ECB:
+        if (encrypt)
+          {
+            aes_encipher(&state, out, size / AES_BLOCK_SIZE);
+          }
+        else
+          {
+            aes_decipher(&state, out, size / AES_BLOCK_SIZE);
+          }
+        break;
+
+      case AES_MODE_CBC:
+        memcpy(block, iv, AES_BLOCK_SIZE);
+        if (encrypt)
+          {
+            aes_cbc_encipher(&state, block, out, size / AES_BLOCK_SIZE);
+          }
+        else
+          {
+            aes_cbc_decipher(&state, block, out, size / AES_BLOCK_SIZE);
+          }
+        break;
+
+      case AES_MODE_CTR:
+        memcpy(block, iv, AES_BLOCK_SIZE);
+        aes_ctr_crypt(&state, block, out, in, size);
+        break;
+
+      default:
+        ret = -EINVAL;
+        break;
+    }
 
-  aes_setupkey(&g_aes_state, key, 16);
-  aes_decr(state, g_aes_state.expanded_key);
+  explicit_bzero(&state, sizeof(state));
+  return ret;
 }
+
+#endif /* CONFIG_CRYPTO_SW_AES_CYPHER */
@@ -46,8 +46,12 @@
 #include <errno.h>
 
 #include <nuttx/fs/fs.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/wqueue.h>
 #include <nuttx/drivers/drivers.h>
 
+#include <nuttx/crypto/aes.h>
 #include <nuttx/crypto/crypto.h>
 #include <nuttx/crypto/cryptodev.h>
 
@@ -55,18 +59,71 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
-#ifdef CONFIG_CRYPTO_AES
+/* ECB, CBC and CTR go to aes_cypher() when it is provided by the hardware.
+ * Otherwise all modes use the software library with the key schedule that
+ * was expanded when the session was created.
+ */
+
+#if defined(CONFIG_CRYPTO_AES) && !defined(CONFIG_CRYPTO_SW_AES_CYPHER)
+#  define CRYPTODEV_HWAES 1
+#endif
+
+#ifdef CRYPTODEV_HWAES
 #  define AES_CYPHER(mode) \
   aes_cypher(op->dst, op->src, op->len, op->iv, ses->key, ses->keylen, \
              mode, encrypt)
 #endif
 
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* A session created with CIOCGSESSION */
+
+struct cryptodev_session_s
+{
+  FAR struct cryptodev_session_s *next;
+  uint32_t id;                       /* Session # returned to the user */
+  uint32_t cipher;                   /* i.e. CRYPTO_AES_CBC */
+#ifdef CRYPTODEV_HWAES
+  uint32_t keylen;
+  uint8_t  key[AES256_KEY_SIZE];     /* Key for aes_cypher() */
+#endif
+#ifdef CONFIG_CRYPTO_SW_AES
+  struct aes_state_s state;          /* Expanded key */
+#endif
+};
+
+/* The state of one open file.  Sessions belong to the file that created
+ * them and are freed when it is closed.
+ */
+
+struct cryptodev_file_s
+{
+  sem_t lock;                        /* Exclusive access to this state */
+  FAR struct cryptodev_session_s *sessions;
+  uint32_t nextid;                   /* # of the next session */
+#ifdef CONFIG_CRYPTO_CRYPTODEV_ASYNC
+  struct work_s work;                /* Runs the queued batches */
+  sem_t idle;                        /* Posted when the worker stops */
+  bool busy;                         /* The worker is queued or running */
+  bool closing;                      /* close() waits for the worker */
+  uint8_t head;                      /* Oldest batch in queue[] */
+  uint8_t nqueued;                   /* Batches in queue[] */
+  uint8_t ndone;                     /* Completed batches from head */
+  FAR struct crypt_mop *queue[CONFIG_CRYPTO_CRYPTODEV_NQUEUED];
+  FAR struct pollfd *fds[CONFIG_CRYPTO_CRYPTODEV_NPOLLWAITERS];
+#endif
+};
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
 
 /* Character driver methods */
 
+static int cryptodev_open(FAR struct file *filep);
+static int cryptodev_close(FAR struct file *filep);
 static ssize_t cryptodev_read(FAR struct file *filep,
                               FAR char *buffer,
                               size_t len);
@@ -76,6 +133,11 @@ static ssize_t cryptodev_write(FAR struct file *filep,
 static int cryptodev_ioctl(FAR struct file *filep,
                            int cmd,
                            unsigned long arg);
+#ifdef CONFIG_CRYPTO_CRYPTODEV_ASYNC
+static int cryptodev_poll(FAR struct file *filep,
+                          FAR struct pollfd *fds,
+                          bool setup);
+#endif
 
 /****************************************************************************
  * Private Data
@@ -83,13 +145,17 @@ static int cryptodev_ioctl(FAR struct file *filep,
 
 static const struct file_operations g_cryptodevops =
 {
-  NULL,               /* open   */
-  NULL,               /* close  */
+  cryptodev_open,     /* open   */
+  cryptodev_close,    /* close  */
   cryptodev_read,     /* read   */
   cryptodev_write,    /* write  */
   NULL,               /* seek   */
   cryptodev_ioctl,    /* ioctl  */
+#ifdef CONFIG_CRYPTO_CRYPTODEV_ASYNC
+  cryptodev_poll      /* poll   */
+#else
   NULL                /* poll   */
+#endif
 #ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
   , NULL              /* unlink */
 #endif
@@ -99,6 +165,617 @@ static const struct file_operations g_cryptodevops =
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: cryptodev_findsession
+ ****************************************************************************/
+
+static FAR struct cryptodev_session_s *
+cryptodev_findsession(FAR struct cryptodev_file_s *priv, uint32_t id)
+{
+  FAR struct cryptodev_session_s *ses;
+
+  for (ses = priv->sessions; ses != NULL; ses = ses->next)
+    {
+      if (ses->id == id)
+        {
+          break;
+        }
+    }
+
+  return ses;
+}
+
+/****************************************************************************
+ * Name: cryptodev_freesession
+ ****************************************************************************/
+
+static void cryptodev_freesession(FAR struct cryptodev_session_s *ses)
+{
+  explicit_bzero(ses, sizeof(*ses));
+  kmm_free(ses);
+}
+
+/****************************************************************************
+ * Name: cryptodev_newsession
+ *
+ * Description:
+ *   CIOCGSESSION: Check the cipher and the key and keep them, with the
+ *   expanded key, for the requests of the new session.
+ *
+ ****************************************************************************/
+
+static int cryptodev_newsession(FAR struct cryptodev_file_s *priv,
+                                FAR struct session_op *sop)
+{
+  FAR struct cryptodev_session_s *ses;
+  int ret;
+
+  switch (sop->cipher)
+    {
+#if defined(CRYPTODEV_HWAES) || defined(CONFIG_CRYPTO_SW_AES)
+      case CRYPTO_AES_ECB:
+      case CRYPTO_AES_CBC:
+      case CRYPTO_AES_CTR:
+        break;
+#endif
+
+#ifdef CONFIG_CRYPTO_SW_AES
+      case CRYPTO_AES_GCM:
+        break;
+#endif
+
+      default:
+        return -EINVAL;
+    }
+
+  if (sop->keylen != AES128_KEY_SIZE && sop->keylen != AES192_KEY_SIZE &&
+      sop->keylen != AES256_KEY_SIZE)
+    {
+      return -EINVAL;
+    }
+
+  ses = (FAR struct cryptodev_session_s *)kmm_zalloc(sizeof(*ses));
+  if (ses == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  ses->cipher = sop->cipher;
+
+#ifdef CRYPTODEV_HWAES
+  ses->keylen = sop->keylen;
+  memcpy(ses->key, sop->key, sop->keylen);
+#endif
+
+#ifdef CONFIG_CRYPTO_SW_AES
+  ret = aes_setupkey(&ses->state, (FAR const uint8_t *)sop->key,
+                     sop->keylen);
+  if (ret < 0)
+    {
+      cryptodev_freesession(ses);
+      return ret;
+    }
+#endif
+
+  ret = nxsem_wait(&priv->lock);
+  if (ret < 0)
+    {
+      cryptodev_freesession(ses);
+      return ret;
+    }
+
+  /* Skip # 0 and any # still in use when the counter wraps around */
+
+  do
+    {
+      ses->id = ++priv->nextid;
+    }
+  while (ses->id == 0 || cryptodev_findsession(priv, ses->id) != NULL);
+
+  ses->next      = priv->sessions;
+  priv->sessions = ses;
+  sop->ses       = ses->id;
+
+  nxsem_post(&priv->lock);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: cryptodev_endsession
+ *
+ * Description:
+ *   CIOCFSESSION: Free a session.  Queued requests that still refer to it
+ *   will fail with -EINVAL.
+ *
+ ****************************************************************************/
+
+static int cryptodev_endsession(FAR struct cryptodev_file_s *priv,
+                                uint32_t id)
+{
+  FAR struct cryptodev_session_s **prev;
+  FAR struct cryptodev_session_s *ses;
+  int ret;
+
+  ret = nxsem_wait(&priv->lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = -EINVAL;
+  for (prev = &priv->sessions; (ses = *prev) != NULL; prev = &ses->next)
+    {
+      if (ses->id == id)
+        {
+          *prev = ses->next;
+          cryptodev_freesession(ses);
+          ret = OK;
+          break;
+        }
+    }
+
+  nxsem_post(&priv->lock);
+  return ret;
+}
+
+#ifdef CONFIG_CRYPTO_SW_AES
+/****************************************************************************
+ * Name: cryptodev_swaes
+ *
+ * Description:
+ *   Run a request with the software library and the expanded key of the
+ *   session.  Like aes_cypher(), the IV is not updated.
+ *
+ ****************************************************************************/
+
+static int cryptodev_swaes(FAR struct cryptodev_session_s *ses,
+                           FAR struct crypt_op *op, int encrypt)
+{
+  FAR uint8_t *dst = (FAR uint8_t *)op->dst;
+  uint8_t iv[AES_BLOCK_SIZE];
+  int nblk = op->len / AES_BLOCK_SIZE;
+
+  if (ses->cipher == CRYPTO_AES_GCM)
+    {
+      size_t ivlen = op->ivlen != 0 ? op->ivlen : AES_GCM_IV_SIZE;
+
+      if (encrypt)
+        {
+          return aes_gcm_encrypt(&ses->state, (FAR const uint8_t *)op->iv,
+                                 ivlen,
+                                 (FAR const uint8_t *)op->aad, op->aadlen,
+                                 dst, (FAR const uint8_t *)op->src, op->len,
+                                 (FAR uint8_t *)op->mac);
+        }
+      else
+        {
+          return aes_gcm_decrypt(&ses->state, (FAR const uint8_t *)op->iv,
+                                 ivlen,
+                                 (FAR const uint8_t *)op->aad, op->aadlen,
+                                 dst, (FAR const uint8_t *)op->src, op->len,
+                                 (FAR const uint8_t *)op->mac);
+        }
+    }
+
+  if (ses->cipher == CRYPTO_AES_CTR)
+    {
+      memcpy(iv, op->iv, AES_BLOCK_SIZE);
+      aes_ctr_crypt(&ses->state, iv, dst, (FAR const uint8_t *)op->src,
+                    op->len);
+      return OK;
+    }
+
+  /* ECB and CBC work in place on whole blocks */
+
+  if ((op->len % AES_BLOCK_SIZE) != 0)
+    {
+      return -EINVAL;
+    }
+
+  if (op->dst != op->src)
+    {
+      memcpy(dst, op->src, op->len);
+    }
+
+  if (ses->cipher == CRYPTO_AES_ECB)
+    {
+      if (encrypt)
+        {
+          aes_encipher(&ses->state, dst, nblk);
+        }
+      else
+        {
+          aes_decipher(&ses->state, dst, nblk);
+        }
+    }
+  else
+    {
+      memcpy(iv, op->iv, AES_BLOCK_SIZE);
+      if (encrypt)
+        {
+          aes_cbc_encipher(&ses->state, iv, dst, nblk);
+        }
+      else
+        {
+          aes_cbc_decipher(&ses->state, iv, dst, nblk);
+        }
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: cryptodev_crypt
+ *
+ * Description:
+ *   Run one request.  This is where every request of CIOCCRYPT and
+ *   CIOCCRYPTM, synchronous or not, is dispatched to an implementation.
+ *
+ * Assumptions:
+ *   The caller holds priv->lock, so the session cannot be freed while the
+ *   request runs.
+ *
+ ****************************************************************************/
+
+static int cryptodev_crypt(FAR struct cryptodev_file_s *priv,
+                           FAR struct crypt_op *op)
+{
+  FAR struct cryptodev_session_s *ses;
+  int encrypt;
+
+  switch (op->op)
+    {
+      case COP_ENCRYPT:
+        encrypt = 1;
+        break;
+
+      case COP_DECRYPT:
+        encrypt = 0;
+        break;
+
+      default:
+        return -EINVAL;
+    }
+
+  ses = cryptodev_findsession(priv, op->ses);
+  if (ses == NULL)
+    {
+      return -EINVAL;
+    }
+
+  switch (ses->cipher)
+    {
+#ifdef CRYPTODEV_HWAES
+      case CRYPTO_AES_ECB:
+        return AES_CYPHER(AES_MODE_ECB);
+
+      case CRYPTO_AES_CBC:
+        return AES_CYPHER(AES_MODE_CBC);
+
+      case CRYPTO_AES_CTR:
+        return AES_CYPHER(AES_MODE_CTR);
+#endif
+
+      default:
+#ifdef CONFIG_CRYPTO_SW_AES
+        return cryptodev_swaes(ses, op, encrypt);
+#else
+        UNUSED(encrypt);
+        return -EINVAL;
+#endif
+    }
+}
+
+/****************************************************************************
+ * Name: cryptodev_batch
+ *
+ * Description:
+ *   Run the requests of a CIOCCRYPTM batch and return the result of each
+ *   one in its status field.  priv->lock is only held for one request at a
+ *   time, so sessions can be created and other requests run in between.
+ *
+ ****************************************************************************/
+
+static void cryptodev_batch(FAR struct cryptodev_file_s *priv,
+                            FAR struct crypt_mop *mop)
+{
+  unsigned i;
+
+  for (i = 0; i < mop->count; i++)
+    {
+      nxsem_wait_uninterruptible(&priv->lock);
+      mop->reqs[i].status = cryptodev_crypt(priv, &mop->reqs[i]);
+      nxsem_post(&priv->lock);
+    }
+}
+
+#ifdef CONFIG_CRYPTO_CRYPTODEV_ASYNC
+/****************************************************************************
+ * Name: cryptodev_pollnotify
+ *
+ * Assumptions:
+ *   The caller holds priv->lock.
+ *
+ ****************************************************************************/
+
+static void cryptodev_pollnotify(FAR struct cryptodev_file_s *priv)
+{
+  pollevent_t eventset = 0;
+  int i;
+
+  if (priv->ndone > 0)
+    {
+      eventset |= POLLIN;
+    }
+
+  if (priv->nqueued < CONFIG_CRYPTO_CRYPTODEV_NQUEUED)
+    {
+      eventset |= POLLOUT;
+    }
+
+  for (i = 0; i < CONFIG_CRYPTO_CRYPTODEV_NPOLLWAITERS; i++)
+    {
+      FAR struct pollfd *fds = priv->fds[i];
+
+      if (fds != NULL)
+        {
+          fds->revents |= (fds->events & eventset);
+          if (fds->revents != 0)
+            {
+              poll_notify(fds);
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: cryptodev_worker
+ *
+ * Description:
+ *   Run the queued batches in order, on the low priority work queue.  The
+ *   lock is not held while a batch runs, so new batches can be queued and
+ *   completed ones taken meanwhile.  The running batch stays in queue[]
+ *   until it is counted as done, and close() stops the worker after it.
+ *
+ ****************************************************************************/
+
+static void cryptodev_worker(FAR void *arg)
+{
+  FAR struct cryptodev_file_s *priv = (FAR struct cryptodev_file_s *)arg;
+  FAR struct crypt_mop *mop;
+  bool closing;
+
+  nxsem_wait_uninterruptible(&priv->lock);
+  while (!priv->closing && priv->ndone < priv->nqueued)
+    {
+      mop = priv->queue[(priv->head + priv->ndone) %
+                        CONFIG_CRYPTO_CRYPTODEV_NQUEUED];
+      nxsem_post(&priv->lock);
+
+      cryptodev_batch(priv, mop);
+
+      nxsem_wait_uninterruptible(&priv->lock);
+      if (!priv->closing)
+        {
+          priv->ndone++;
+          cryptodev_pollnotify(priv);
+        }
+    }
+
+  priv->busy = false;
+  closing    = priv->closing;
+  nxsem_post(&priv->lock);
+
+  /* Nothing may be touched after this: close() frees the state */
+
+  if (closing)
+    {
+      nxsem_post(&priv->idle);
+    }
+}
+
+/****************************************************************************
+ * Name: cryptodev_queue
+ *
+ * Description:
+ *   Queue an asynchronous CIOCCRYPTM batch.
+ *
+ ****************************************************************************/
+
+static int cryptodev_queue(FAR struct cryptodev_file_s *priv,
+                           FAR struct crypt_mop *mop)
+{
+  int ret;
+
+  ret = nxsem_wait(&priv->lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (priv->nqueued >= CONFIG_CRYPTO_CRYPTODEV_NQUEUED)
+    {
+      ret = -EAGAIN;
+    }
+  else
+    {
+      priv->queue[(priv->head + priv->nqueued) %
+                  CONFIG_CRYPTO_CRYPTODEV_NQUEUED] = mop;
+      priv->nqueued++;
+
+      if (!priv->busy)
+        {
+          ret = work_queue(LPWORK, &priv->work, cryptodev_worker, priv, 0);
+          if (ret < 0)
+            {
+              priv->nqueued--;
+            }
+          else
+            {
+              priv->busy = true;
+            }
+        }
+    }
+
+  nxsem_post(&priv->lock);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: cryptodev_dequeue
+ *
+ * Description:
+ *   CIOCCRYPTRET: Return the oldest completed asynchronous batch.
+ *
+ ****************************************************************************/
+
+static int cryptodev_dequeue(FAR struct cryptodev_file_s *priv,
+                             FAR struct crypt_mop **mop)
+{
+  int ret;
+
+  ret = nxsem_wait(&priv->lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (priv->ndone == 0)
+    {
+      ret = -EAGAIN;
+    }
+  else
+    {
+      *mop = priv->queue[priv->head];
+      priv->head = (priv->head + 1) % CONFIG_CRYPTO_CRYPTODEV_NQUEUED;
+      priv->nqueued--;
+      priv->ndone--;
+      cryptodev_pollnotify(priv);
+    }
+
+  nxsem_post(&priv->lock);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: cryptodev_poll
+ ****************************************************************************/
+
+static int cryptodev_poll(FAR struct file *filep,
+                          FAR struct pollfd *fds,
+                          bool setup)
+{
+  FAR struct cryptodev_file_s *priv = filep->f_priv;
+  int ret;
+  int i;
+
+  ret = nxsem_wait(&priv->lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (setup)
+    {
+      for (i = 0; i < CONFIG_CRYPTO_CRYPTODEV_NPOLLWAITERS; i++)
+        {
+          if (priv->fds[i] == NULL)
+            {
+              priv->fds[i] = fds;
+              fds->priv    = &priv->fds[i];
+              break;
+            }
+        }
+
+      if (i >= CONFIG_CRYPTO_CRYPTODEV_NPOLLWAITERS)
+        {
+          fds->priv = NULL;
+          ret       = -EBUSY;
+        }
+      else
+        {
+          /* Report the events that are already pending */
+
+          cryptodev_pollnotify(priv);
+        }
+    }
+  else if (fds->priv != NULL)
+    {
+      FAR struct pollfd **slot = (FAR struct pollfd **)fds->priv;
+
+      *slot     = NULL;
+      fds->priv = NULL;
+    }
+
+  nxsem_post(&priv->lock);
+  return ret;
+}
+#endif /* CONFIG_CRYPTO_CRYPTODEV_ASYNC */
+
+static int cryptodev_open(FAR struct file *filep)
+{
+  FAR struct cryptodev_file_s *priv;
+
+  priv = (FAR struct cryptodev_file_s *)kmm_zalloc(sizeof(*priv));
+  if (priv == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  nxsem_init(&priv->lock, 0, 1);
+#ifdef CONFIG_CRYPTO_CRYPTODEV_ASYNC
+  nxsem_init(&priv->idle, 0, 0);
+  nxsem_set_protocol(&priv->idle, SEM_PRIO_NONE);
+#endif
+
+  filep->f_priv = priv;
+  return OK;
+}
+
+static int cryptodev_close(FAR struct file *filep)
+{
+  FAR struct cryptodev_file_s *priv = filep->f_priv;
+  FAR struct cryptodev_session_s *ses;
+#ifdef CONFIG_CRYPTO_CRYPTODEV_ASYNC
+  bool busy;
+#endif
+
+  nxsem_wait_uninterruptible(&priv->lock);
+
+#ifdef CONFIG_CRYPTO_CRYPTODEV_ASYNC
+  /* Drop the batches that have not been started and wait for the worker
+   * to finish the one that it is running.
+   */
+
+  priv->nqueued = priv->ndone;
+  priv->closing = true;
+  busy          = priv->busy;
+#endif
+
+  nxsem_post(&priv->lock);
+
+#ifdef CONFIG_CRYPTO_CRYPTODEV_ASYNC
+  if (busy)
+    {
+      nxsem_wait_uninterruptible(&priv->idle);
+    }
+
+  nxsem_destroy(&priv->idle);
+#endif
+
+  while ((ses = priv->sessions) != NULL)
+    {
+      priv->sessions = ses->next;
+      cryptodev_freesession(ses);
+    }
+
+  nxsem_destroy(&priv->lock);
+  kmm_free(priv);
+  filep->f_priv = NULL;
+  return OK;
+}
+
 static ssize_t cryptodev_read(FAR struct file *filep,
                               FAR char *buffer,
                               size_t len)
@@ -117,55 +794,54 @@ static int cryptodev_ioctl(FAR struct file *filep,
                            int cmd,
                            unsigned long arg)
 {
+  FAR struct cryptodev_file_s *priv = filep->f_priv;
+  int ret;
+
   switch (cmd)
   {
   case CIOCGSESSION:
     {
-      FAR struct session_op *ses = (FAR struct session_op *)arg;
-      ses->ses = (uint32_t)ses;
-      return OK;
+      return cryptodev_newsession(priv, (FAR struct session_op *)arg);
     }
 
   case CIOCFSESSION:
     {
-      return OK;
+      return cryptodev_endsession(priv, *(FAR uint32_t *)arg);
     }
 
-#ifdef CONFIG_CRYPTO_AES
   case CIOCCRYPT:
     {
-      FAR struct crypt_op *op    = (FAR struct crypt_op *)arg;
-      FAR struct session_op *ses = (FAR struct session_op *)op->ses;
-      int encrypt;
-
-      switch (op->op)
+      ret = nxsem_wait(&priv->lock);
+      if (ret >= 0)
         {
-        case COP_ENCRYPT:
-          encrypt = 1;
-          break;
+          ret = cryptodev_crypt(priv, (FAR struct crypt_op *)arg);
+          nxsem_post(&priv->lock);
+        }
 
-        case COP_DECRYPT:
-          encrypt = 0;
-          break;
+      return ret;
+    }
 
-        default:
-          return -EINVAL;
-        }
+  case CIOCCRYPTM:
+    {
+      FAR struct crypt_mop *mop = (FAR struct crypt_mop *)arg;
 
-      switch (ses->cipher)
+      if ((mop->flags & COP_F_ASYNC) != 0)
         {
-        case CRYPTO_AES_ECB:
-          return AES_CYPHER(AES_MODE_ECB);
-
-        case CRYPTO_AES_CBC:
-          return AES_CYPHER(AES_MODE_CBC);
+#ifdef CONFIG_CRYPTO_CRYPTODEV_ASYNC
+          return cryptodev_queue(priv, mop);
+#else
+          return -ENOSYS;
+#endif
+        }
 
-        case CRYPTO_AES_CTR:
-          return AES_CYPHER(AES_MODE_CTR);
+      cryptodev_batch(priv, mop);
+      return OK;
+    }
 
-        default:
-           return -EINVAL;
-        }
+#ifdef CONFIG_CRYPTO_CRYPTODEV_ASYNC
+  case CIOCCRYPTRET:
+    {
+      return cryptodev_dequeue(priv, (FAR struct crypt_mop **)arg);
     }
 #endif
 
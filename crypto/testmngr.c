@@ -42,13 +42,18 @@
 #include <sys/types.h>
 #include <stdbool.h>
 #include <string.h>
+#include <fcntl.h>
 #include <poll.h>
 #include <errno.h>
 #include <debug.h>
+#include <syslog.h>
 
+#include <nuttx/clock.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/crypto/aes.h>
 #include <nuttx/crypto/crypto.h>
+#include <nuttx/crypto/cryptodev.h>
 
 #ifdef CONFIG_CRYPTO_ALGTEST
 
@@ -62,6 +67,16 @@
 #  define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
 #endif
 
+/* Modes of the software AES library tests */
+
+#define SW_AES_ECB        0
+#define SW_AES_CBC        1
+#define SW_AES_CTR        2
+#define SW_AES_GCM        3
+
+#define SW_AES_BENCHSIZE  4096  /* Bytes per call of the benchmark */
+#define SW_AES_BENCHMSEC  250   /* Duration of each benchmark */
+
 #if defined(CONFIG_CRYPTO_AES)
 
 /****************************************************************************
@@ -123,6 +138,490 @@ static int test_aes(void)
 }
 #endif
 
+#ifdef CONFIG_CRYPTO_SW_AES
+
+/****************************************************************************
+ * Name: sw_aes_crypt
+ *
+ * Description:
+ *   Encrypt or decrypt a buffer in place in one of the block modes of the
+ *   software AES library.
+ *
+ ****************************************************************************/
+
+static void sw_aes_crypt(FAR struct aes_state_s *state, int mode,
+                         int encrypt, FAR uint8_t *iv, FAR uint8_t *buf,
+                         size_t len)
+{
+  int nblk = len / AES_BLOCK_SIZE;
+
+  switch (mode)
+    {
+      case SW_AES_ECB:
+        if (encrypt)
+          {
+            aes_encipher(state, buf, nblk);
+          }
+        else
+          {
+            aes_decipher(state, buf, nblk);
+          }
+        break;
+
+      case SW_AES_CBC:
+        if (encrypt)
+          {
+            aes_cbc_encipher(state, iv, buf, nblk);
+          }
+        else
+          {
+            aes_cbc_decipher(state, iv, buf, nblk);
+          }
+        break;
+
+      case SW_AES_CTR:
+        aes_ctr_crypt(state, iv, buf, buf, len);
+        break;
+    }
+}
+
+static int do_test_sw_aes(FAR const struct cipher_testvec *test,
+                          int mode, int encrypt)
+{
+  struct aes_state_s state;
+  uint8_t iv[AES_BLOCK_SIZE];
+  FAR uint8_t *out;
+  int res;
+
+  out = kmm_malloc(test->ilen);
+  if (out == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  res = aes_setupkey(&state, (FAR const uint8_t *)test->key, test->klen);
+  if (res == OK)
+    {
+      if (test->iv != NULL)
+        {
+          memcpy(iv, test->iv, AES_BLOCK_SIZE);
+        }
+
+      memcpy(out, test->input, test->ilen);
+      sw_aes_crypt(&state, mode, encrypt, iv, out, test->ilen);
+      res = memcmp(out, test->result, test->rlen);
+    }
+
+  kmm_free(out);
+  return res;
+}
+
+static int do_test_sw_aes_gcm(FAR const struct aead_testvec *test)
+{
+  struct aes_state_s state;
+  uint8_t tag[AES_GCM_TAG_SIZE];
+  FAR uint8_t *out;
+  int res;
+
+  out = kmm_malloc(test->ilen);
+  if (out == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  res = aes_setupkey(&state, (FAR const uint8_t *)test->key, test->klen);
+  if (res < 0)
+    {
+      goto errout;
+    }
+
+  /* Encrypt, then decrypt the result in place */
+
+  res = aes_gcm_encrypt(&state, (FAR const uint8_t *)test->iv, test->ivlen,
+                        (FAR const uint8_t *)test->assoc, test->alen, out,
+                        (FAR const uint8_t *)test->input, test->ilen, tag);
+  if (res < 0 || memcmp(out, test->result, test->ilen) != 0 ||
+      memcmp(tag, test->tag, AES_GCM_TAG_SIZE) != 0)
+    {
+      res = -1;
+      goto errout;
+    }
+
+  res = aes_gcm_decrypt(&state, (FAR const uint8_t *)test->iv, test->ivlen,
+                        (FAR const uint8_t *)test->assoc, test->alen, out,
+                        out, test->ilen, tag);
+  if (res < 0 || memcmp(out, test->input, test->ilen) != 0)
+    {
+      res = -1;
+      goto errout;
+    }
+
+  /* A modified tag must be rejected */
+
+  memcpy(out, test->result, test->ilen);
+  tag[0] ^= 1;
+  res = aes_gcm_decrypt(&state, (FAR const uint8_t *)test->iv, test->ivlen,
+                        (FAR const uint8_t *)test->assoc, test->alen, out,
+                        out, test->ilen, tag);
+  res = res == -EBADMSG ? OK : -1;
+
+errout:
+  kmm_free(out);
+  return res;
+}
+
+static int test_sw_aes_template(FAR const char *name,
+                                FAR const struct cipher_testvec *template,
+                                int count, int mode, int encrypt)
+{
+  int i;
+
+  for (i = 0; i < count; i++)
+    {
+      if (do_test_sw_aes(template + i, mode, encrypt))
+        {
+          crypterr("ERROR: Failed software %s %s test #%i\n", name,
+                   encrypt ? "encrypt" : "decrypt", i);
+          return -1;
+        }
+    }
+
+  return OK;
+}
+
+static int test_sw_aes(void)
+{
+  int i;
+
+  if (test_sw_aes_template("ECB", aes_enc_tv_template,
+                           ARRAY_SIZE(aes_enc_tv_template),
+                           SW_AES_ECB, CYPHER_ENCRYPT) ||
+      test_sw_aes_template("ECB", aes_dec_tv_template,
+                           ARRAY_SIZE(aes_dec_tv_template),
+                           SW_AES_ECB, CYPHER_DECRYPT) ||
+      test_sw_aes_template("CBC", aes_cbc_enc_tv_template,
+                           ARRAY_SIZE(aes_cbc_enc_tv_template),
+                           SW_AES_CBC, CYPHER_ENCRYPT) ||
+      test_sw_aes_template("CBC", aes_cbc_dec_tv_template,
+                           ARRAY_SIZE(aes_cbc_dec_tv_template),
+                           SW_AES_CBC, CYPHER_DECRYPT) ||
+      test_sw_aes_template("CTR", aes_ctr_enc_tv_template,
+                           ARRAY_SIZE(aes_ctr_enc_tv_template),
+                           SW_AES_CTR, CYPHER_ENCRYPT) ||
+      test_sw_aes_template("CTR", aes_ctr_dec_tv_template,
+                           ARRAY_SIZE(aes_ctr_dec_tv_template),
+                           SW_AES_CTR, CYPHER_DECRYPT))
+    {
+      return -1;
+    }
+
+  for (i = 0; i < ARRAY_SIZE(aes_gcm_tv_template); i++)
+    {
+      if (do_test_sw_aes_gcm(aes_gcm_tv_template + i))
+        {
+          crypterr("ERROR: Failed software GCM test #%i\n", i);
+          return -1;
+        }
+    }
+
+  return OK;
+}
+
+#ifdef CONFIG_CRYPTO_ALGTEST_BENCHMARK
+
+/****************************************************************************
+ * Name: bench_sw_aes_mode
+ *
+ * Description:
+ *   Report how many bytes per second one mode of the software AES library
+ *   processes with a 128-bit key.
+ *
+ ****************************************************************************/
+
+static void bench_sw_aes_mode(FAR const char *name, int mode, int encrypt,
+                              FAR uint8_t *buf)
+{
+  struct aes_state_s state;
+  uint8_t key[AES128_KEY_SIZE];
+  uint8_t iv[AES_BLOCK_SIZE];
+  uint8_t tag[AES_GCM_TAG_SIZE];
+  uint64_t nbytes = 0;
+  clock_t start;
+  clock_t elapsed;
+
+  memset(key, 0x5a, sizeof(key));
+  memset(iv, 0xa5, sizeof(iv));
+  aes_setupkey(&state, key, sizeof(key));
+
+  start = clock_systime_ticks();
+  do
+    {
+      if (mode == SW_AES_GCM)
+        {
+          aes_gcm_encrypt(&state, iv, AES_GCM_IV_SIZE, NULL, 0, buf, buf,
+                          SW_AES_BENCHSIZE, tag);
+        }
+      else
+        {
+          sw_aes_crypt(&state, mode, encrypt, iv, buf, SW_AES_BENCHSIZE);
+        }
+
+      nbytes += SW_AES_BENCHSIZE;
+      elapsed = clock_systime_ticks() - start;
+    }
+  while (TICK2MSEC(elapsed) < SW_AES_BENCHMSEC);
+
+  syslog(LOG_INFO, "aes-128 %-11s %lu KiB/s\n", name,
+         (unsigned long)(nbytes * 1000 / TICK2MSEC(elapsed) / 1024));
+}
+
+static void bench_sw_aes(void)
+{
+  FAR uint8_t *buf;
+
+  buf = kmm_zalloc(SW_AES_BENCHSIZE);
+  if (buf == NULL)
+    {
+      return;
+    }
+
+  bench_sw_aes_mode("ECB encrypt", SW_AES_ECB, CYPHER_ENCRYPT, buf);
+  bench_sw_aes_mode("ECB decrypt", SW_AES_ECB, CYPHER_DECRYPT, buf);
+  bench_sw_aes_mode("CBC encrypt", SW_AES_CBC, CYPHER_ENCRYPT, buf);
+  bench_sw_aes_mode("CBC decrypt", SW_AES_CBC, CYPHER_DECRYPT, buf);
+  bench_sw_aes_mode("CTR", SW_AES_CTR, CYPHER_ENCRYPT, buf);
+  bench_sw_aes_mode("GCM", SW_AES_GCM, CYPHER_ENCRYPT, buf);
+
+  kmm_free(buf);
+}
+
+#endif /* CONFIG_CRYPTO_ALGTEST_BENCHMARK */
+#endif /* CONFIG_CRYPTO_SW_AES */
+
+#if defined(CONFIG_CRYPTO_CRYPTODEV) && \
+    (defined(CONFIG_CRYPTO_AES) || defined(CONFIG_CRYPTO_SW_AES))
+
+/****************************************************************************
+ * Name: test_cryptodev_session
+ *
+ * Description:
+ *   Create a /dev/crypto session with the key of a test vector.
+ *
+ ****************************************************************************/
+
+static int test_cryptodev_session(int fd, uint32_t cipher,
+                                  FAR const struct cipher_testvec *test,
+                                  FAR uint32_t *ses)
+{
+  struct session_op sop;
+  int ret;
+
+  memset(&sop, 0, sizeof(sop));
+  sop.cipher = cipher;
+  sop.keylen = test->klen;
+  sop.key    = test->key;
+
+  ret  = nx_ioctl(fd, CIOCGSESSION, (unsigned long)&sop);
+  *ses = sop.ses;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: test_cryptodev_setop
+ *
+ * Description:
+ *   Set up a request to encrypt a test vector into 'out'.
+ *
+ ****************************************************************************/
+
+static void test_cryptodev_setop(FAR struct crypt_op *op, uint32_t ses,
+                                 FAR const struct cipher_testvec *test,
+                                 FAR char *out)
+{
+  memset(op, 0, sizeof(*op));
+  memset(out, 0, test->rlen);
+  op->ses = ses;
+  op->op  = COP_ENCRYPT;
+  op->len = test->ilen;
+  op->src = test->input;
+  op->dst = out;
+  op->iv  = test->iv;
+}
+
+/****************************************************************************
+ * Name: test_cryptodev_checkop
+ ****************************************************************************/
+
+static bool test_cryptodev_checkop(FAR const struct crypt_op *op,
+                                   FAR const struct cipher_testvec *test)
+{
+  return op->status == OK && memcmp(op->dst, test->result, test->rlen) == 0;
+}
+
+/****************************************************************************
+ * Name: test_cryptodev_batch
+ *
+ * Description:
+ *   Run a CIOCCRYPTM batch with a request on each of two sessions and one
+ *   on a session that does not exist.  The batch is run synchronously or,
+ *   with COP_F_ASYNC, taken back with CIOCCRYPTRET once poll() reports it
+ *   complete.
+ *
+ ****************************************************************************/
+
+static int test_cryptodev_batch(int fd, uint16_t flags,
+                                uint32_t sesecb, uint32_t sescbc)
+{
+  FAR const struct cipher_testvec *ecb = &aes_enc_tv_template[0];
+  FAR const struct cipher_testvec *cbc = &aes_cbc_enc_tv_template[0];
+#ifdef CONFIG_CRYPTO_CRYPTODEV_ASYNC
+  FAR struct crypt_mop *done;
+  struct pollfd pfd;
+#endif
+  struct crypt_mop mop;
+  struct crypt_op ops[3];
+  char out[3][AES_BLOCK_SIZE];
+  int ret;
+
+  test_cryptodev_setop(&ops[0], sesecb, ecb, out[0]);
+  test_cryptodev_setop(&ops[1], sescbc, cbc, out[1]);
+  test_cryptodev_setop(&ops[2], 0, cbc, out[2]);
+
+  mop.flags = flags;
+  mop.count = 3;
+  mop.reqs  = ops;
+
+  ret = nx_ioctl(fd, CIOCCRYPTM, (unsigned long)&mop);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+#ifdef CONFIG_CRYPTO_CRYPTODEV_ASYNC
+  if ((flags & COP_F_ASYNC) != 0)
+    {
+      pfd.fd     = fd;
+      pfd.events = POLLIN;
+
+      ret = nx_poll(&pfd, 1, 1000);
+      if (ret <= 0)
+        {
+          return ret < 0 ? ret : -ETIMEDOUT;
+        }
+
+      ret = nx_ioctl(fd, CIOCCRYPTRET, (unsigned long)&done);
+      if (ret < 0 || done != &mop)
+        {
+          return ret < 0 ? ret : -EINVAL;
+        }
+    }
+#endif
+
+  if (!test_cryptodev_checkop(&ops[0], ecb) ||
+      !test_cryptodev_checkop(&ops[1], cbc) || ops[2].status != -EINVAL)
+    {
+      return -EINVAL;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: test_cryptodev
+ *
+ * Description:
+ *   Check the session handling of /dev/crypto and CIOCCRYPTM batches.
+ *
+ ****************************************************************************/
+
+static int test_cryptodev(int fd)
+{
+  FAR const struct cipher_testvec *ecb = &aes_enc_tv_template[0];
+  FAR const struct cipher_testvec *cbc = &aes_cbc_enc_tv_template[0];
+  struct crypt_op op;
+  char out[AES_BLOCK_SIZE];
+  uint32_t sesecb;
+  uint32_t sescbc;
+  int ret;
+
+  /* Two sessions of one open file get different numbers */
+
+  ret = test_cryptodev_session(fd, CRYPTO_AES_ECB, ecb, &sesecb);
+  if (ret >= 0)
+    {
+      ret = test_cryptodev_session(fd, CRYPTO_AES_CBC, cbc, &sescbc);
+    }
+
+  if (ret < 0 || sesecb == 0 || sescbc == 0 || sesecb == sescbc)
+    {
+      crypterr("ERROR: Failed cryptodev session test\n");
+      return -1;
+    }
+
+  /* CIOCCRYPT uses the cipher and key of the session */
+
+  test_cryptodev_setop(&op, sescbc, cbc, out);
+  op.status = nx_ioctl(fd, CIOCCRYPT, (unsigned long)&op);
+  if (!test_cryptodev_checkop(&op, cbc))
+    {
+      crypterr("ERROR: Failed cryptodev CIOCCRYPT test\n");
+      return -1;
+    }
+
+  ret = test_cryptodev_batch(fd, 0, sesecb, sescbc);
+  if (ret < 0)
+    {
+      crypterr("ERROR: Failed cryptodev CIOCCRYPTM test: %d\n", ret);
+      return -1;
+    }
+
+#ifdef CONFIG_CRYPTO_CRYPTODEV_ASYNC
+  ret = test_cryptodev_batch(fd, COP_F_ASYNC, sesecb, sescbc);
+  if (ret < 0)
+    {
+      crypterr("ERROR: Failed cryptodev async CIOCCRYPTM test: %d\n", ret);
+      return -1;
+    }
+#endif
+
+  /* CIOCFSESSION takes a pointer to the session number.  A freed session
+   * can neither be used nor freed again, the other one is not affected.
+   */
+
+  ret = nx_ioctl(fd, CIOCFSESSION, (unsigned long)&sesecb);
+  if (ret < 0 ||
+      nx_ioctl(fd, CIOCFSESSION, (unsigned long)&sesecb) != -EINVAL)
+    {
+      crypterr("ERROR: Failed cryptodev CIOCFSESSION test\n");
+      return -1;
+    }
+
+  test_cryptodev_setop(&op, sesecb, ecb, out);
+  ret = nx_ioctl(fd, CIOCCRYPT, (unsigned long)&op);
+  if (ret != -EINVAL)
+    {
+      crypterr("ERROR: Freed cryptodev session still usable\n");
+      return -1;
+    }
+
+  test_cryptodev_setop(&op, sescbc, cbc, out);
+  op.status = nx_ioctl(fd, CIOCCRYPT, (unsigned long)&op);
+  if (!test_cryptodev_checkop(&op, cbc) ||
+      nx_ioctl(fd, CIOCFSESSION, (unsigned long)&sescbc) < 0)
+    {
+      crypterr("ERROR: Failed cryptodev CIOCFSESSION test\n");
+      return -1;
+    }
+
+  return OK;
+}
+
+#endif /* CONFIG_CRYPTO_CRYPTODEV && (CONFIG_CRYPTO_AES || CRYPTO_SW_AES) */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
 int crypto_test(void)
 {
 #if defined(CONFIG_CRYPTO_AES)
@@ -132,9 +631,46 @@ int crypto_test(void)
     }
 #endif
 
+#ifdef CONFIG_CRYPTO_SW_AES
+  if (test_sw_aes())
+    {
+      return -1;
+    }
+
+#ifdef CONFIG_CRYPTO_ALGTEST_BENCHMARK
+  bench_sw_aes();
+#endif
+#endif
+
   return OK;
 }
 
+#if defined(CONFIG_CRYPTO_CRYPTODEV) && \
+    (defined(CONFIG_CRYPTO_AES) || defined(CONFIG_CRYPTO_SW_AES))
+int cryptodev_test(void)
+{
+  int ret;
+  int fd;
+
+  if (ARRAY_SIZE(aes_enc_tv_template) == 0 ||
+      ARRAY_SIZE(aes_cbc_enc_tv_template) == 0)
+    {
+      return OK;
+    }
+
+  fd = nx_open("/dev/crypto", O_RDWR);
+  if (fd < 0)
+    {
+      crypterr("ERROR: Failed to open /dev/crypto: %d\n", fd);
+      return fd;
+    }
+
+  ret = test_cryptodev(fd);
+  nx_close(fd);
+  return ret;
+}
+#endif
+
 #else /* CONFIG_CRYPTO_ALGTEST */
 
 int crypto_test(void)
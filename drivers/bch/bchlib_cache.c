@@ -74,10 +74,11 @@ static void bch_xor(uint32_t *R, uint32_t *A, uint32_t *B)
  ****************************************************************************/
 
 #if defined(CONFIG_BCH_ENCRYPTION)
-static int bch_cypher(FAR struct bchlib_s *bch, int encrypt)
+static int bch_cypher(FAR struct bchlib_s *bch, FAR uint8_t *sectbuffer,
+                      size_t sector, int encrypt)
 {
   int blocks = bch->sectsize / 16;
-  FAR uint32_t *buffer = (FAR uint32_t *)bch->buffer;
+  FAR uint32_t *buffer = (FAR uint32_t *)sectbuffer;
   int i;
 
   for (i = 0; i < blocks; i++, buffer += 16 / sizeof(uint32_t) )
@@ -85,7 +86,7 @@ static int bch_cypher(FAR struct bchlib_s *bch, int encrypt)
       uint32_t T[4];
       uint32_t X[4] =
       {
-        bch->sector, 0, 0, i
+        sector, 0, 0, i
       };
 
       aes_cypher(X, X, 16, NULL, bch->key, CONFIG_BCH_ENCRYPTION_KEY_SIZE,
@@ -101,6 +102,19 @@ static int bch_cypher(FAR struct bchlib_s *bch, int encrypt)
 
   return OK;
 }
+
+/****************************************************************************
+ * Name: bch_cypherrange
+ ****************************************************************************/
+
+static void bch_cypherrange(FAR struct bchlib_s *bch, size_t sector,
+                            size_t nsectors, int encrypt)
+{
+  for (; nsectors > 0; sector++, nsectors--)
+    {
+      bch_cypher(bch, bchlib_sectbuffer(bch, sector), sector, encrypt);
+    }
+}
 #endif
 
 /****************************************************************************
@@ -111,7 +125,8 @@ static int bch_cypher(FAR struct bchlib_s *bch, int encrypt)
  * Name: bchlib_flushsector
  *
  * Description:
- *   Flush the current contents of the sector buffer (if dirty)
+ *   Flush the modified sectors of the sector buffer (if dirty).  All
+ *   modified sectors are written with a single transfer.
  *
  * Assumptions:
  *   Caller must assume mutual exclusion
@@ -121,28 +136,32 @@ static int bch_cypher(FAR struct bchlib_s *bch, int encrypt)
 int bchlib_flushsector(FAR struct bchlib_s *bch)
 {
   FAR struct inode *inode;
+  size_t nsectors;
   ssize_t ret = OK;
 
-  /* Check if the sector has been modified and is out of synch with the
+  /* Check if the sectors have been modified and are out of synch with the
    * media.
    */
 
   if (bch->dirty)
     {
-      inode = bch->inode;
+      inode    = bch->inode;
+      nsectors = bch->dirtyend - bch->dirtystart + 1;
 
 #if defined(CONFIG_BCH_ENCRYPTION)
       /* Encrypt data as necessary */
 
-      bch_cypher(bch, CYPHER_ENCRYPT);
+      bch_cypherrange(bch, bch->dirtystart, nsectors, CYPHER_ENCRYPT);
 #endif
 
-      /* Write the sector to the media */
+      /* Write the sectors to the media */
 
-      ret = inode->u.i_bops->write(inode, bch->buffer, bch->sector, 1);
+      ret = inode->u.i_bops->write(inode,
+                                   bchlib_sectbuffer(bch, bch->dirtystart),
+                                   bch->dirtystart, nsectors);
       if (ret < 0)
         {
-          ferr("Write failed: %d\n");
+          ferr("Write failed: %d\n", (int)ret);
         }
 
 #if defined(CONFIG_BCH_ENCRYPTION)
@@ -150,22 +169,26 @@ int bchlib_flushsector(FAR struct bchlib_s *bch)
        * TODO: Add configuration switch for extra sector buffer
        */
 
-      bch_cypher(bch, CYPHER_DECRYPT);
+      bch_cypherrange(bch, bch->dirtystart, nsectors, CYPHER_DECRYPT);
 #endif
 
-      /* The sector is now in sync with the media */
+      /* The sectors are now in sync with the media */
 
       bch->dirty = false;
     }
 
-  return (int)ret;
+  return ret < 0 ? (int)ret : OK;
 }
 
 /****************************************************************************
  * Name: bchlib_readsector
  *
  * Description:
- *   Flush the current contents of the sector buffer (if dirty)
+ *   Make sure that a sector is in the sector buffer.  A sector that follows
+ *   the buffered sectors continues a sequential access:  The rest of the
+ *   buffer is then read ahead with the same transfer.  If there is room,
+ *   the new sectors are appended so that modified sectors can be combined
+ *   into one write.
  *
  * Assumptions:
  *   Caller must assume mutual exclusion
@@ -175,26 +198,139 @@ int bchlib_flushsector(FAR struct bchlib_s *bch)
 int bchlib_readsector(FAR struct bchlib_s *bch, size_t sector)
 {
   FAR struct inode *inode;
-  ssize_t ret = OK;
+  size_t nsectors = 1;
+  size_t index = 0;
+  ssize_t ret;
 
-  if (bch->sector != sector)
+  if (bch->nbuffered > 0 && sector >= bch->sector &&
+      sector < bch->sector + bch->nbuffered)
     {
-      inode = bch->inode;
+      return OK;
+    }
 
-      bchlib_flushsector(bch);
-      bch->sector = (size_t)-1;
+  inode = bch->inode;
 
-      ret = inode->u.i_bops->read(inode, bch->buffer, sector, 1);
+  if (bch->nbuffered > 0 && sector == bch->sector + bch->nbuffered)
+    {
+      if (bch->nbuffered < CONFIG_BCH_CACHE_NSECTORS)
+        {
+          index = bch->nbuffered;
+        }
+
+      nsectors = CONFIG_BCH_CACHE_NSECTORS - index;
+      if (nsectors > bch->nsectors - sector)
+        {
+          nsectors = bch->nsectors - sector;
+        }
+    }
+
+  if (index == 0)
+    {
+      ret = bchlib_flushsector(bch);
       if (ret < 0)
         {
-          ferr("Read failed: %d\n");
+          return (int)ret;
         }
 
-      bch->sector = sector;
+      bch->sector    = sector;
+      bch->nbuffered = 0;
+    }
+
+  ret = inode->u.i_bops->read(inode, &bch->buffer[index * bch->sectsize],
+                              sector, nsectors);
+  if (ret <= 0)
+    {
+      ferr("Read failed: %d\n", (int)ret);
+      if (index == 0)
+        {
+          bch->sector = (size_t)-1;
+        }
+
+      return ret < 0 ? (int)ret : -EIO;
+    }
+
+  bch->nbuffered = index + ret;
+
 #if defined(CONFIG_BCH_ENCRYPTION)
-      bch_cypher(bch, CYPHER_DECRYPT);
+  bch_cypherrange(bch, sector, ret, CYPHER_DECRYPT);
 #endif
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bchlib_dirtysector
+ *
+ * Description:
+ *   Mark a sector in the sector buffer as modified
+ *
+ * Assumptions:
+ *   Caller must assume mutual exclusion
+ *
+ ****************************************************************************/
+
+void bchlib_dirtysector(FAR struct bchlib_s *bch, size_t sector)
+{
+  if (!bch->dirty)
+    {
+      bch->dirtystart = sector;
+      bch->dirtyend   = sector;
+      bch->dirty      = true;
+    }
+  else if (sector < bch->dirtystart)
+    {
+      bch->dirtystart = sector;
+    }
+  else if (sector > bch->dirtyend)
+    {
+      bch->dirtyend = sector;
+    }
+}
+
+/****************************************************************************
+ * Name: bchlib_flushrange
+ *
+ * Description:
+ *   Flush the sector buffer if it is dirty and overlaps a range of sectors
+ *   that is about to be read directly from the media.
+ *
+ * Assumptions:
+ *   Caller must assume mutual exclusion
+ *
+ ****************************************************************************/
+
+int bchlib_flushrange(FAR struct bchlib_s *bch, size_t sector,
+                      size_t nsectors)
+{
+  if (bch->dirty && sector <= bch->dirtyend &&
+      bch->dirtystart < sector + nsectors)
+    {
+      return bchlib_flushsector(bch);
     }
 
-  return (int)ret;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bchlib_invalidate
+ *
+ * Description:
+ *   Discard the sector buffer if it overlaps a range of sectors that was
+ *   written directly to the media.  The buffer must have been flushed.
+ *
+ * Assumptions:
+ *   Caller must assume mutual exclusion
+ *
+ ****************************************************************************/
+
+void bchlib_invalidate(FAR struct bchlib_s *bch, size_t sector,
+                       size_t nsectors)
+{
+  if (bch->nbuffered > 0 && sector < bch->sector + bch->nbuffered &&
+      bch->sector < sector + nsectors)
+    {
+      DEBUGASSERT(!bch->dirty);
+      bch->sector    = (size_t)-1;
+      bch->nbuffered = 0;
+    }
 }
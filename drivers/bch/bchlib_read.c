@@ -114,7 +114,11 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset,
     {
       /* Read the sector into the sector buffer */
 
-      bchlib_readsector(bch, sector);
+      ret = bchlib_readsector(bch, sector);
+      if (ret < 0)
+        {
+          return ret;
+        }
 
       /* Copy the tail end of the sector to the user buffer */
 
@@ -127,7 +131,7 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset,
           nbytes = len;
         }
 
-      memcpy(buffer, &bch->buffer[sectoffset], nbytes);
+      memcpy(buffer, bchlib_sectbuffer(bch, sector) + sectoffset, nbytes);
 
       /* Adjust pointers and counts */
 
@@ -155,6 +159,14 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset,
           nsectors = bch->nsectors - sector;
         }
 
+      /* Write back any buffered changes to these sectors first */
+
+      ret = bchlib_flushrange(bch, sector, nsectors);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
       ret = bch->inode->u.i_bops->read(bch->inode, (FAR uint8_t *)buffer,
                                        sector, nsectors);
       if (ret < 0)
@@ -184,11 +196,15 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset,
     {
       /* Read the sector into the sector buffer */
 
-      bchlib_readsector(bch, sector);
+      ret = bchlib_readsector(bch, sector);
+      if (ret < 0)
+        {
+          return bytesread > 0 ? bytesread : ret;
+        }
 
       /* Copy the head end of the sector to the user buffer */
 
-      memcpy(buffer, bch->buffer, len);
+      memcpy(buffer, bchlib_sectbuffer(bch, sector), len);
 
       /* Adjust counts */
 
@@ -127,7 +127,8 @@ int bchlib_setup(const char *blkdev, bool readonly, FAR void **handle)
 
   /* Allocate the sector I/O buffer */
 
-  bch->buffer = (FAR uint8_t *)kmm_malloc(bch->sectsize);
+  bch->buffer = (FAR uint8_t *)
+    kmm_malloc(bch->sectsize * CONFIG_BCH_CACHE_NSECTORS);
   if (!bch->buffer)
     {
       ferr("ERROR: Failed to allocate sector buffer\n");
@@ -99,7 +99,11 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset,
     {
       /* Read the full sector into the sector buffer */
 
-      bchlib_readsector(bch, sector);
+      ret = bchlib_readsector(bch, sector);
+      if (ret < 0)
+        {
+          return ret;
+        }
 
       /* Copy the tail end of the sector from the user buffer */
 
@@ -112,8 +116,8 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset,
           nbytes = len;
         }
 
-      memcpy(&bch->buffer[sectoffset], buffer, nbytes);
-      bch->dirty = true;
+      memcpy(bchlib_sectbuffer(bch, sector) + sectoffset, buffer, nbytes);
+      bchlib_dirtysector(bch, sector);
 
       /* Adjust pointers and counts */
 
@@ -160,6 +164,10 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset,
           return ret;
         }
 
+      /* Drop the buffered copies of the sectors just written */
+
+      bchlib_invalidate(bch, sector, nsectors);
+
       /* Adjust pointers and counts */
 
       sector       += nsectors;
@@ -181,12 +189,16 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset,
     {
       /* Read the sector into the sector buffer */
 
-      bchlib_readsector(bch, sector);
+      ret = bchlib_readsector(bch, sector);
+      if (ret < 0)
+        {
+          return byteswritten > 0 ? byteswritten : ret;
+        }
 
       /* Copy the head end of the sector from the user buffer */
 
-      memcpy(bch->buffer, buffer, len);
-      bch->dirty = true;
+      memcpy(bchlib_sectbuffer(bch, sector), buffer, len);
+      bchlib_dirtysector(bch, sector);
 
       /* Adjust counts */
 
@@ -235,7 +235,15 @@ static int skel_transmit(FAR struct skel_driver_s *priv)
 
   NETDEV_TXPACKETS(priv->sk_dev);
 
-  /* Send the packet: address=priv->sk_dev.d_buf, length=priv->sk_dev.d_len */
+  /* Send the packet: address=priv->sk_dev.d_buf, length=priv->sk_dev.d_len
+   *
+   * With CONFIG_NETDEV_IOB_TX and d_txsg set, d_txiob may be non-NULL.
+   * Then only the first d_len - d_txlen bytes are in d_buf and the
+   * hardware must gather the remaining d_txlen bytes from the I/O buffer
+   * chain d_txiob, starting at offset d_txoffset (one DMA descriptor per
+   * I/O buffer).  Hardware that runs short of descriptors can call
+   * netdev_iob_txflatten() to get the whole packet into d_buf.
+   */
 
   /* Enable Tx interrupts */
 
@@ -412,6 +420,12 @@ static void skel_receive(FAR struct skel_driver_s *priv)
 
       /* Copy the data data from the hardware to priv->sk_dev.d_buf.  Set
        * amount of data in priv->sk_dev.d_len
+       *
+       * With CONFIG_NETDEV_IOB_RX, the hardware may instead receive into an
+       * I/O buffer (e.g., one taken from a ring of I/O buffers used as DMA
+       * receive descriptors) that is then passed to the network with
+       * netdev_iob_prepare(&priv->sk_dev, iob).  This sets up d_buf and
+       * d_len and lets the network keep received data without copying it.
        */
 
 #ifdef CONFIG_NET_PKT
@@ -484,6 +498,14 @@ static void skel_receive(FAR struct skel_driver_s *priv)
         {
           NETDEV_RXDROPPED(&priv->sk_dev);
         }
+
+#ifdef CONFIG_NETDEV_IOB_RX
+      /* Free the I/O buffer passed to netdev_iob_prepare() (if any) and
+       * restore d_buf.  Any reply must have been copied to the hardware.
+       */
+
+      netdev_iob_release(&priv->sk_dev);
+#endif
     }
   while (); /* While there are more packets to be processed */
 }
@@ -1189,6 +1211,9 @@ int skel_initialize(int intf)
   priv->sk_dev.d_ioctl   = skel_ioctl;    /* Handle network IOCTL commands */
 #endif
   priv->sk_dev.d_private = g_skel;        /* Used to recover private state from dev */
+#ifdef CONFIG_NETDEV_IOB_TX
+  priv->sk_dev.d_txsg    = true;          /* Hardware can gather TX packets */
+#endif
 
   /* Put the interface in the down state.  This usually amounts to resetting
    * the device and/or calling skel_ifdown().
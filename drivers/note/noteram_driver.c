@@ -40,29 +40,125 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdint.h>
+#include <string.h>
 #include <sched.h>
 #include <fcntl.h>
 #include <assert.h>
 #include <errno.h>
 
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/sched.h>
 #include <nuttx/spinlock.h>
+#include <nuttx/semaphore.h>
 #include <nuttx/sched_note.h>
 #include <nuttx/note/noteram_driver.h>
 #include <nuttx/fs/fs.h>
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* There is one circular buffer per CPU.  Each buffer is written only by its
+ * own CPU with interrupts disabled, so the producer side needs no lock.
+ */
+
+#ifdef CONFIG_SMP
+#  define NOTERAM_NCPUS         CONFIG_SMP_NCPUS
+#  define noteram_cpu()         up_cpu_index()
+#else
+#  define NOTERAM_NCPUS         1
+#  define noteram_cpu()         (0)
+#endif
+
+/* Without SMP, the note is added with interrupts disabled on the only CPU
+ * and the reader cannot observe a partial update, so no barrier is needed.
+ */
+
+#ifndef CONFIG_SPINLOCK
+#  define SP_DMB()
+#endif
+
+/* Each note is time stamped so that the per-CPU buffers can be merged into
+ * a single, time-ordered stream.  The note itself carries only the coarse
+ * system tick.  The high resolution timer of the critical section monitor
+ * is used instead when available; it must be common to all CPUs.
+ */
+
+#ifdef CONFIG_SCHED_CRITMONITOR
+#  define noteram_timestamp()   up_critmon_gettime()
+#else
+#  define noteram_timestamp()   ((uint32_t)clock_systime_ticks())
+#endif
+
+/* A record in the buffer is either a four byte time stamp followed by the
+ * note as passed to sched_note_add() or, with CONFIG_DRIVER_NOTERAM_COMPACT,
+ * the compact encoding described in include/nuttx/note/noteram_driver.h
+ * without the CPU index.
+ */
+
+#define NOTERAM_STAMPSIZE       sizeof(uint32_t)
+#define NOTERAM_VARINTSIZE      ((sizeof(uintptr_t) * 8 + 6) / 7)
+
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+#  define NOTERAM_MAXREC        UINT8_MAX
+#else
+#  define NOTERAM_MAXREC        (NOTERAM_STAMPSIZE + UINT8_MAX)
+#endif
+
+/* The buffer positions are free running counters.  The buffer size is a
+ * power of two so that the buffer index is the low bits of the position,
+ * which stays continuous across the wrap of the 32-bit counters.  Distances
+ * are computed with unsigned arithmetic for the same reason.
+ */
+
+#if (CONFIG_DRIVER_NOTERAM_BUFSIZE & (CONFIG_DRIVER_NOTERAM_BUFSIZE - 1)) != 0
+#  error CONFIG_DRIVER_NOTERAM_BUFSIZE must be a power of two
+#endif
+
+#define noteram_index(p)        ((p) & (CONFIG_DRIVER_NOTERAM_BUFSIZE - 1))
+#define noteram_after(a,b)      ((int32_t)((a) - (b)) > 0)
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+/* The state of one per-CPU buffer.  The positions are only modified by the
+ * CPU owning the buffer, except ni_read and ni_readstamp which belong to
+ * the reader.  Reading does not free space:  Like a flight recorder, the
+ * buffer retains the latest (or, without overwrite, the first) notes until
+ * it is cleared.
+ */
+
 struct noteram_info_s
 {
-  volatile unsigned int ni_head;
-  volatile unsigned int ni_tail;
-  volatile unsigned int ni_read;
-  unsigned int ni_overwrite;
+  volatile uint32_t ni_head;      /* Position of the next note written */
+  volatile uint32_t ni_tail;      /* Position of the oldest retained note */
+  volatile uint32_t ni_read;      /* Position of the next note read */
+  volatile unsigned int ni_overwrite;
+  volatile bool ni_clear;         /* Reader request to discard all notes */
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+  volatile uint32_t ni_seq;       /* Odd while the fields below change */
+  volatile uint32_t ni_headstamp; /* Time stamp of the last note written */
+  volatile uint32_t ni_tailstamp; /* Time stamp preceding the oldest note */
+  uint32_t ni_readstamp;          /* Time stamp preceding the next read */
+#endif
   uint8_t ni_buffer[CONFIG_DRIVER_NOTERAM_BUFSIZE];
 };
 
+/* A note already removed from a per-CPU buffer but not yet returned to the
+ * user because an older note from another CPU comes first.
+ */
+
+struct noteram_pending_s
+{
+  uint32_t np_stamp;              /* Time stamp of the note */
+  uint8_t np_offset;              /* Offset of the note in np_record */
+  uint8_t np_length;              /* Length of the note, zero if none */
+  uint8_t np_record[NOTERAM_MAXREC];
+};
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -90,17 +186,20 @@ static const struct file_operations g_noteram_fops =
 #endif
 };
 
-static struct noteram_info_s g_noteram_info =
-{
-#ifdef CONFIG_DRIVER_NOTERAM_DEFAULT_NOOVERWRITE
-  .ni_overwrite = NOTERAM_MODE_OVERWRITE_DISABLE
-#else
-  .ni_overwrite = NOTERAM_MODE_OVERWRITE_ENABLE
-#endif
-};
+static struct noteram_info_s g_noteram_info[NOTERAM_NCPUS];
+static struct noteram_pending_s g_noteram_pending[NOTERAM_NCPUS];
 
-#ifdef CONFIG_SMP
-static volatile spinlock_t g_noteram_lock;
+/* Serializes the readers of /dev/note */
+
+static sem_t g_noteram_readsem = SEM_INITIALIZER(1);
+
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+/* The time stamp of the last note returned and whether the stream header
+ * still has to be returned.
+ */
+
+static uint32_t g_noteram_stamp;
+static bool g_noteram_header;
 #endif
 
 /****************************************************************************
@@ -108,302 +207,714 @@ static volatile spinlock_t g_noteram_lock;
  ****************************************************************************/
 
 /****************************************************************************
- * Name: noteram_buffer_clear
+ * Name: noteram_copyout
  *
  * Description:
- *   Clear all contents of the circular buffer.
- *
- * Input Parameters:
- *   None.
- *
- * Returned Value:
- *   None.
+ *   Copy 'len' bytes at position 'pos' out of the circular buffer, handling
+ *   wraparound.
  *
  ****************************************************************************/
 
-static void noteram_buffer_clear(void)
+static void noteram_copyout(FAR struct noteram_info_s *ni, uint32_t pos,
+                            FAR uint8_t *buffer, size_t len)
 {
-  irqstate_t flags;
+  unsigned int ndx = noteram_index(pos);
+  size_t chunk = CONFIG_DRIVER_NOTERAM_BUFSIZE - ndx;
+
+  if (chunk > len)
+    {
+      chunk = len;
+    }
+
+  memcpy(buffer, &ni->ni_buffer[ndx], chunk);
+  memcpy(buffer + chunk, ni->ni_buffer, len - chunk);
+}
 
-  flags = enter_critical_section();
+/****************************************************************************
+ * Name: noteram_copyin
+ *
+ * Description:
+ *   Copy 'len' bytes into the circular buffer at position 'pos', handling
+ *   wraparound.
+ *
+ ****************************************************************************/
 
-  g_noteram_info.ni_tail = g_noteram_info.ni_head;
-  g_noteram_info.ni_read = g_noteram_info.ni_head;
+static void noteram_copyin(FAR struct noteram_info_s *ni, uint32_t pos,
+                           FAR const uint8_t *buffer, size_t len)
+{
+  unsigned int ndx = noteram_index(pos);
+  size_t chunk = CONFIG_DRIVER_NOTERAM_BUFSIZE - ndx;
 
-  if (g_noteram_info.ni_overwrite == NOTERAM_MODE_OVERWRITE_OVERFLOW)
+  if (chunk > len)
     {
-      g_noteram_info.ni_overwrite = NOTERAM_MODE_OVERWRITE_DISABLE;
+      chunk = len;
     }
 
-  leave_critical_section(flags);
+  memcpy(&ni->ni_buffer[ndx], buffer, chunk);
+  memcpy(ni->ni_buffer, buffer + chunk, len - chunk);
 }
 
 /****************************************************************************
- * Name: noteram_next
+ * Name: noteram_reclen
  *
  * Description:
- *   Return the circular buffer index at offset from the specified index
- *   value, handling wraparound
+ *   Return the size of the record at position 'pos'.
  *
- * Input Parameters:
- *   ndx - Old circular buffer index
+ ****************************************************************************/
+
+static inline size_t noteram_reclen(FAR struct noteram_info_s *ni,
+                                    uint32_t pos)
+{
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+  return ni->ni_buffer[noteram_index(pos)];
+#else
+  return NOTERAM_STAMPSIZE +
+         ni->ni_buffer[noteram_index(pos + NOTERAM_STAMPSIZE)];
+#endif
+}
+
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+
+/****************************************************************************
+ * Name: noteram_putvarint
+ *
+ * Description:
+ *   Encode 'value' as an unsigned LEB128 varint.
  *
  * Returned Value:
- *   New circular buffer index
+ *   A pointer to the byte following the varint.
  *
  ****************************************************************************/
 
-static inline unsigned int noteram_next(unsigned int ndx,
-                                        unsigned int offset)
+static FAR uint8_t *noteram_putvarint(FAR uint8_t *ptr, uintptr_t value)
 {
-  ndx += offset;
-  if (ndx >= CONFIG_DRIVER_NOTERAM_BUFSIZE)
+  while (value >= 0x80)
     {
-      ndx -= CONFIG_DRIVER_NOTERAM_BUFSIZE;
+      *ptr++ = (uint8_t)(value | 0x80);
+      value >>= 7;
     }
 
-  return ndx;
+  *ptr++ = (uint8_t)value;
+  return ptr;
 }
 
 /****************************************************************************
- * Name: noteram_length
+ * Name: noteram_getvarint
  *
  * Description:
- *   Length of data currently in circular buffer.
- *
- * Input Parameters:
- *   None
+ *   Decode an unsigned LEB128 varint of at most 'len' bytes.
  *
  * Returned Value:
- *   Length of data currently in circular buffer.
+ *   The number of bytes used by the varint or zero if it is malformed.
  *
  ****************************************************************************/
 
-#ifdef CONFIG_DEBUG_ASSERTIONS
-static unsigned int noteram_length(void)
+static size_t noteram_getvarint(FAR const uint8_t *ptr, size_t len,
+                                FAR uint32_t *value)
 {
-  unsigned int head = g_noteram_info.ni_head;
-  unsigned int tail = g_noteram_info.ni_tail;
+  uint32_t result = 0;
+  size_t i;
 
-  if (tail > head)
+  for (i = 0; i < len && i < NOTERAM_VARINTSIZE; i++)
     {
-      head += CONFIG_DRIVER_NOTERAM_BUFSIZE;
+      result |= (uint32_t)(ptr[i] & 0x7f) << (7 * i);
+      if ((ptr[i] & 0x80) == 0)
+        {
+          *value = result;
+          return i + 1;
+        }
     }
 
-  return head - tail;
+  return 0;
 }
+
+/****************************************************************************
+ * Name: noteram_state
+ *
+ * Description:
+ *   Map a task state to its configuration independent NOTERAM_STATE_*
+ *   code.
+ *
+ ****************************************************************************/
+
+static uint8_t noteram_state(uint8_t state)
+{
+  switch (state)
+    {
+      case TSTATE_TASK_PENDING:
+      case TSTATE_TASK_READYTORUN:
+#ifdef CONFIG_SMP
+      case TSTATE_TASK_ASSIGNED:
 #endif
+      case TSTATE_TASK_RUNNING:
+        return NOTERAM_STATE_READY;
+
+      case TSTATE_WAIT_SEM:
+        return NOTERAM_STATE_WAIT_SEM;
+
+      case TSTATE_WAIT_SIG:
+        return NOTERAM_STATE_WAIT_SIG;
+
+#ifndef CONFIG_DISABLE_MQUEUE
+      case TSTATE_WAIT_MQNOTEMPTY:
+      case TSTATE_WAIT_MQNOTFULL:
+        return NOTERAM_STATE_WAIT_MQ;
+#endif
+
+      default:
+        return NOTERAM_STATE_OTHER;
+    }
+}
 
 /****************************************************************************
- * Name: noteram_unread_length
+ * Name: noteram_encode
  *
  * Description:
- *   Length of unread data currently in circular buffer.
+ *   Encode a note in the compact format.  The CPU index is implied by the
+ *   buffer the record is added to.
  *
  * Input Parameters:
- *   None
+ *   note   - The note as passed to sched_note_add()
+ *   delta  - The time since the previous note in the same buffer
+ *   record - The location to return the record
  *
  * Returned Value:
- *   Length of unread data currently in circular buffer.
+ *   The length of the record.
  *
  ****************************************************************************/
 
-static unsigned int noteram_unread_length(void)
+static size_t noteram_encode(FAR const struct note_common_s *note,
+                             uint32_t delta, FAR uint8_t *record)
 {
-  unsigned int head = g_noteram_info.ni_head;
-  unsigned int read = g_noteram_info.ni_read;
+  FAR uint8_t *ptr = record + 1;
+  uint8_t type = note->nc_type;
+
+  ptr    = noteram_putvarint(ptr, delta);
+  *ptr++ = type;
+  ptr    = noteram_putvarint(ptr, note->nc_pid[0] | note->nc_pid[1] << 8);
 
-  if (read > head)
+  switch (type)
     {
-      head += CONFIG_DRIVER_NOTERAM_BUFSIZE;
+      case NOTE_START:
+        {
+#if CONFIG_TASK_NAME_SIZE > 0
+          FAR const struct note_start_s *nst =
+            (FAR const struct note_start_s *)note;
+          size_t namelen;
+          size_t maxlen;
+
+          *ptr++ = note->nc_priority;
+#ifdef CONFIG_SMP
+          *ptr++ = note->nc_cpu;
+#endif
+
+          /* Truncate the name so that the record still fits when the CPU
+           * index and a longer time stamp are added by noteram_read().
+           */
+
+          namelen = note->nc_length - sizeof(struct note_start_s);
+          maxlen  = NOTERAM_MAXREC - NOTERAM_VARINTSIZE - 1 -
+                    (ptr - record);
+          if (namelen > maxlen)
+            {
+              namelen = maxlen;
+            }
+
+          memcpy(ptr, nst->nst_name, namelen);
+          ptr   += namelen;
+#else
+          *ptr++ = note->nc_priority;
+#ifdef CONFIG_SMP
+          *ptr++ = note->nc_cpu;
+#endif
+#endif
+        }
+        break;
+
+      case NOTE_STOP:
+      case NOTE_RESUME:
+        *ptr++ = note->nc_priority;
+#ifdef CONFIG_SMP
+        *ptr++ = note->nc_cpu;
+#endif
+        break;
+
+      case NOTE_SUSPEND:
+        *ptr++ = note->nc_priority;
+#ifdef CONFIG_SMP
+        *ptr++ = note->nc_cpu;
+#endif
+        *ptr++ = noteram_state(((FAR const struct note_suspend_s *)note)->
+                               nsu_state);
+        break;
+
+#ifdef CONFIG_SMP
+      case NOTE_CPU_START:
+      case NOTE_CPU_PAUSE:
+      case NOTE_CPU_RESUME:
+        *ptr++ = ((FAR const struct note_cpu_start_s *)note)->ncs_target;
+        break;
+#endif
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_PREEMPTION
+      case NOTE_PREEMPT_LOCK:
+      case NOTE_PREEMPT_UNLOCK:
+        {
+          FAR const struct note_preempt_s *npr =
+            (FAR const struct note_preempt_s *)note;
+
+          ptr = noteram_putvarint(ptr, npr->npr_count[0] |
+                                       npr->npr_count[1] << 8);
+        }
+        break;
+#endif
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_SPINLOCKS
+      case NOTE_SPINLOCK_LOCK:
+      case NOTE_SPINLOCK_LOCKED:
+      case NOTE_SPINLOCK_UNLOCK:
+      case NOTE_SPINLOCK_ABORT:
+        {
+          FAR const struct note_spinlock_s *nsp =
+            (FAR const struct note_spinlock_s *)note;
+
+          ptr    = noteram_putvarint(ptr, (uintptr_t)nsp->nsp_spinlock);
+          *ptr++ = nsp->nsp_value;
+        }
+        break;
+#endif
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_SYSCALL
+      case NOTE_SYSCALL_ENTER:
+        *ptr++ = ((FAR const struct note_syscall_enter_s *)note)->nsc_nr;
+        break;
+
+      case NOTE_SYSCALL_LEAVE:
+        {
+          FAR const struct note_syscall_leave_s *nsc =
+            (FAR const struct note_syscall_leave_s *)note;
+          intptr_t result = (intptr_t)nsc->nsc_result;
+
+          /* Zigzag encode the result so that small negated errno values
+           * stay short.
+           */
+
+          *ptr++ = nsc->nsc_nr;
+          ptr    = noteram_putvarint(ptr, ((uintptr_t)result << 1) ^
+                                     (uintptr_t)(result < 0 ? -1 : 0));
+        }
+        break;
+#endif
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_IRQHANDLER
+      case NOTE_IRQ_ENTER:
+      case NOTE_IRQ_LEAVE:
+        *ptr++ = ((FAR const struct note_irqhandler_s *)note)->nih_irq;
+        break;
+#endif
+
+      default:
+        break;
     }
 
-  return head - read;
+  record[0] = ptr - record;
+  return ptr - record;
 }
 
 /****************************************************************************
- * Name: noteram_remove
+ * Name: noteram_snapshot
  *
  * Description:
- *   Remove the variable length note from the tail of the circular buffer
+ *   Get a consistent view of the head and tail positions and their time
+ *   stamps of one buffer.
+ *
+ ****************************************************************************/
+
+static void noteram_snapshot(FAR struct noteram_info_s *ni,
+                             FAR uint32_t *head, FAR uint32_t *headstamp,
+                             FAR uint32_t *tail, FAR uint32_t *tailstamp)
+{
+  uint32_t seq;
+
+  do
+    {
+      seq = ni->ni_seq;
+      SP_DMB();
+
+      *head      = ni->ni_head;
+      *headstamp = ni->ni_headstamp;
+      *tail      = ni->ni_tail;
+      *tailstamp = ni->ni_tailstamp;
+
+      SP_DMB();
+    }
+  while ((seq & 1) != 0 || seq != ni->ni_seq);
+}
+#endif /* CONFIG_DRIVER_NOTERAM_COMPACT */
+
+/****************************************************************************
+ * Name: noteram_reserve
+ *
+ * Description:
+ *   Make room for a record of reclen bytes at the head of the buffer.  Only
+ *   the retained notes, from the tail to the head, occupy space:  Notes that
+ *   were already read stay retained until they are overwritten or the
+ *   reader clears the buffer, so the read position does not free anything.
+ *   A pending clear request discards all retained notes first.  If there is
+ *   still no room, the oldest notes are dropped in overwrite mode;
+ *   otherwise recording stops.
+ *
+ *   Called by the writer with interrupts disabled.
  *
  * Input Parameters:
- *   None
+ *   ni     - The buffer of the current CPU
+ *   reclen - The length of the record to be added
  *
  * Returned Value:
- *   None
- *
- * Assumptions:
- *   We are within a critical section.
+ *   True if there is room for the record; false if recording stopped.
  *
  ****************************************************************************/
 
-static void noteram_remove(void)
+static bool noteram_reserve(FAR struct noteram_info_s *ni, size_t reclen)
 {
-  FAR struct note_common_s *note;
-  unsigned int tail;
-  unsigned int length;
+  uint32_t head = ni->ni_head;
+  uint32_t tail = ni->ni_tail;
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+  uint32_t tailstamp;
+  uint32_t delta;
+#endif
 
-  /* Get the tail index of the circular buffer */
+  /* Discard all retained notes if the reader cleared the buffer */
 
-  tail = g_noteram_info.ni_tail;
-  DEBUGASSERT(tail < CONFIG_DRIVER_NOTERAM_BUFSIZE);
+  if (ni->ni_clear)
+    {
+      tail = head;
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+      ni->ni_tailstamp = ni->ni_headstamp;
+#endif
+      ni->ni_tail  = tail;
+      ni->ni_clear = false;
+    }
 
-  /* Get the length of the note at the tail index */
+  if (head - tail + reclen <= CONFIG_DRIVER_NOTERAM_BUFSIZE)
+    {
+      return true;
+    }
+
+  if (ni->ni_overwrite == NOTERAM_MODE_OVERWRITE_DISABLE)
+    {
+      /* Stop recording if not in overwrite mode */
 
-  note   = (FAR struct note_common_s *)&g_noteram_info.ni_buffer[tail];
-  length = note->nc_length;
-  DEBUGASSERT(length <= noteram_length());
+      ni->ni_overwrite = NOTERAM_MODE_OVERWRITE_OVERFLOW;
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+      SP_DMB();
+      ni->ni_seq++;
+#endif
+      return false;
+    }
 
-  /* Increment the tail index to remove the entire note from the circular
-   * buffer.
+  /* Remove the oldest notes until there is room.  The new tail must be
+   * visible before the old notes are overwritten.
    */
 
-  if (g_noteram_info.ni_read == g_noteram_info.ni_tail)
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+  /* Keep track of the time stamp preceding the tail */
+
+  tailstamp = ni->ni_tailstamp;
+
+  do
     {
-      /* The read index also needs increment. */
+      uint8_t varint[NOTERAM_VARINTSIZE];
+
+      noteram_copyout(ni, tail + 1, varint, NOTERAM_VARINTSIZE);
+      if (noteram_getvarint(varint, NOTERAM_VARINTSIZE, &delta) > 0)
+        {
+          tailstamp += delta;
+        }
 
-      g_noteram_info.ni_read = noteram_next(tail, length);
+      tail += noteram_reclen(ni, tail);
     }
+  while (head - tail + reclen > CONFIG_DRIVER_NOTERAM_BUFSIZE);
+
+  ni->ni_tailstamp = tailstamp;
+#else
+  do
+    {
+      tail += noteram_reclen(ni, tail);
+    }
+  while (head - tail + reclen > CONFIG_DRIVER_NOTERAM_BUFSIZE);
+#endif
 
-  g_noteram_info.ni_tail = noteram_next(tail, length);
+  ni->ni_tail = tail;
+  SP_DMB();
+  return true;
 }
 
 /****************************************************************************
  * Name: noteram_get
  *
  * Description:
- *   Get the next note from the read index of the circular buffer.
+ *   Remove the next note from one per-CPU buffer into its pending slot.
+ *   This runs concurrently with sched_note_add() on the owning CPU.  If
+ *   that CPU overwrites the note while it is being copied, which is
+ *   detected by the tail moving past the note, the copy is discarded and
+ *   the reader continues with the oldest note still retained.
  *
  * Input Parameters:
- *   buffer - Location to return the next note
- *   buflen - The length of the user provided buffer.
+ *   cpu - The index of the buffer
  *
  * Returned Value:
- *   On success, the positive, non-zero length of the return note is
- *   provided.  Zero is returned only if the circular buffer is empty.  A
- *   negated errno value is returned in the event of any failure.
+ *   True if a note was moved to the pending slot; false if the buffer is
+ *   empty.
  *
  ****************************************************************************/
 
-static ssize_t noteram_get(FAR uint8_t *buffer, size_t buflen)
+static bool noteram_get(int cpu)
 {
-  FAR struct note_common_s *note;
-  irqstate_t flags;
-  unsigned int remaining;
-  unsigned int read;
-  ssize_t notelen;
-  size_t circlen;
+  FAR struct noteram_info_s *ni = &g_noteram_info[cpu];
+  FAR struct noteram_pending_s *np = &g_noteram_pending[cpu];
+  FAR uint8_t *record = np->np_record;
+  uint32_t head;
+  uint32_t tail;
+  uint32_t pos;
+  uint32_t stamp;
+  size_t reclen;
+  size_t offset;
+  bool valid;
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+  uint32_t headstamp;
+  uint32_t tailstamp;
+  uint32_t base;
+#endif
 
-  DEBUGASSERT(buffer != NULL);
-  flags = enter_critical_section();
+  for (; ; )
+    {
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+      noteram_snapshot(ni, &head, &headstamp, &tail, &tailstamp);
 
-  /* Verify that the circular buffer is not empty */
+      pos  = ni->ni_read;
+      base = ni->ni_readstamp;
+      if (noteram_after(tail, pos))
+        {
+          pos  = tail;
+          base = tailstamp;
+        }
+#else
+      head = ni->ni_head;
+      SP_DMB();
+      tail = ni->ni_tail;
 
-  circlen = noteram_unread_length();
-  if (circlen <= 0)
-    {
-      notelen = 0;
-      goto errout_with_csection;
-    }
+      pos = ni->ni_read;
+      if (noteram_after(tail, pos))
+        {
+          pos = tail;
+        }
+#endif
 
-  /* Get the read index of the circular buffer */
+      if (pos == head)
+        {
+          ni->ni_read = pos;
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+          ni->ni_readstamp = base;
+#endif
+          return false;
+        }
 
-  read    = g_noteram_info.ni_read;
-  DEBUGASSERT(read < CONFIG_DRIVER_NOTERAM_BUFSIZE);
+      reclen = noteram_reclen(ni, pos);
+      valid  = reclen > 0 && reclen <= NOTERAM_MAXREC &&
+               !noteram_after(pos + reclen, head);
+      if (valid)
+        {
+          noteram_copyout(ni, pos, record, reclen);
+        }
 
-  /* Get the length of the note at the read index */
+      /* Was the note overwritten while it was being copied?  If so, the
+       * next pass starts over at the new tail.
+       */
 
-  note    = (FAR struct note_common_s *)&g_noteram_info.ni_buffer[read];
-  notelen = note->nc_length;
-  DEBUGASSERT(notelen <= circlen);
+      SP_DMB();
+      if (noteram_after(ni->ni_tail, pos))
+        {
+          continue;
+        }
 
-  /* Is the user buffer large enough to hold the note? */
+      /* Decode the time stamp */
 
-  if (buflen < notelen)
-    {
-      /* Skip the large note so that we do not get constipated. */
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+      stamp  = 0;
+      offset = valid ? noteram_getvarint(record + 1, reclen - 1, &stamp) : 0;
+      valid  = offset > 0 && 1 + offset < reclen;
+      stamp += base;
+      offset++;
+#else
+      offset = NOTERAM_STAMPSIZE;
+      valid  = valid && reclen >= offset + sizeof(struct note_common_s);
+      stamp  = (uint32_t)record[0] | (uint32_t)record[1] << 8 |
+               (uint32_t)record[2] << 16 | (uint32_t)record[3] << 24;
+#endif
 
-      g_noteram_info.ni_read = noteram_next(read, notelen);
+      /* A note that was not overwritten must be well formed.  Otherwise
+       * the buffer is corrupted; drop everything up to the head.
+       */
 
-      /* and return an error */
+      DEBUGASSERT(valid);
+      if (!valid)
+        {
+          ni->ni_read = head;
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+          ni->ni_readstamp = headstamp;
+#endif
+          return false;
+        }
 
-      notelen = -EFBIG;
-      goto errout_with_csection;
-    }
+      ni->ni_read = pos + reclen;
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+      ni->ni_readstamp = stamp;
+#endif
 
-  /* Loop until the note has been transferred to the user buffer */
+      np->np_stamp  = stamp;
+      np->np_offset = offset;
+      np->np_length = reclen - offset;
+      return true;
+    }
+}
 
-  remaining = (unsigned int)notelen;
-  while (remaining > 0)
-    {
-      /* Copy the next byte at the read index */
+/****************************************************************************
+ * Name: noteram_next
+ *
+ * Description:
+ *   Select the oldest note among the per-CPU buffers, refilling the pending
+ *   slot of each buffer as needed.
+ *
+ * Returned Value:
+ *   The pending slot holding the oldest note or NULL if all buffers are
+ *   empty.
+ *
+ ****************************************************************************/
 
-      *buffer++ = g_noteram_info.ni_buffer[read];
+static FAR struct noteram_pending_s *noteram_next(void)
+{
+  FAR struct noteram_pending_s *oldest = NULL;
+  FAR struct noteram_pending_s *np;
+  int cpu;
 
-      /* Adjust indices and counts */
+  for (cpu = 0; cpu < NOTERAM_NCPUS; cpu++)
+    {
+      np = &g_noteram_pending[cpu];
+      if (np->np_length == 0 && !noteram_get(cpu))
+        {
+          continue;
+        }
 
-      read = noteram_next(read, 1);
-      remaining--;
+      if (oldest == NULL ||
+          noteram_after(oldest->np_stamp, np->np_stamp))
+        {
+          oldest = np;
+        }
     }
 
-  g_noteram_info.ni_read = read;
-
-errout_with_csection:
-  leave_critical_section(flags);
-  return notelen;
+  return oldest;
 }
 
 /****************************************************************************
- * Name: noteram_size
+ * Name: noteram_rewind
  *
  * Description:
- *   Return the size of the next note at the read index of the circular
- *   buffer.
+ *   Move the read position of every buffer, dropping the pending notes.
  *
  * Input Parameters:
- *   None.
- *
- * Returned Value:
- *   Zero is returned if the circular buffer is empty.  Otherwise, the size
- *   of the next note is returned.
+ *   clear - True:  Discard everything buffered so far.  False:  Start
+ *           over with the oldest note retained.
  *
  ****************************************************************************/
 
-static ssize_t noteram_size(void)
+static void noteram_rewind(bool clear)
 {
-  FAR struct note_common_s *note;
-  irqstate_t flags;
-  unsigned int read;
-  ssize_t notelen;
-  size_t circlen;
+  FAR struct noteram_info_s *ni;
+  int cpu;
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+  uint32_t head;
+  uint32_t headstamp;
+  uint32_t tail;
+  uint32_t tailstamp;
+#endif
 
-  flags = enter_critical_section();
+  for (cpu = 0; cpu < NOTERAM_NCPUS; cpu++)
+    {
+      ni = &g_noteram_info[cpu];
 
-  /* Verify that the circular buffer is not empty */
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+      noteram_snapshot(ni, &head, &headstamp, &tail, &tailstamp);
+      ni->ni_read      = clear ? head : tail;
+      ni->ni_readstamp = clear ? headstamp : tailstamp;
+#else
+      ni->ni_read = clear ? ni->ni_head : ni->ni_tail;
+#endif
 
-  circlen = noteram_unread_length();
-  if (circlen <= 0)
-    {
-      notelen = 0;
-      goto errout_with_csection;
+      g_noteram_pending[cpu].np_length = 0;
+
+      /* The owning CPU discards the retained notes when it adds the next
+       * note.  The request must be visible before recording resumes.
+       */
+
+      if (clear)
+        {
+          ni->ni_clear = true;
+          SP_DMB();
+
+          if (ni->ni_overwrite == NOTERAM_MODE_OVERWRITE_OVERFLOW)
+            {
+              ni->ni_overwrite = NOTERAM_MODE_OVERWRITE_DISABLE;
+            }
+        }
     }
 
-  /* Get the read index of the circular buffer */
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+  /* The stream starts over with the header */
+
+  g_noteram_stamp  = 0;
+  g_noteram_header = true;
+#endif
+}
+
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+/****************************************************************************
+ * Name: noteram_header
+ *
+ * Description:
+ *   Format the header record of the compact stream.
+ *
+ * Returned Value:
+ *   The length of the record.
+ *
+ ****************************************************************************/
+
+static size_t noteram_header(FAR uint8_t *record)
+{
+  FAR uint8_t *ptr = record + 1;
+  uint64_t nsec;
+#ifdef CONFIG_SCHED_CRITMONITOR
+  struct timespec ts;
 
-  read = g_noteram_info.ni_read;
-  DEBUGASSERT(read < CONFIG_DRIVER_NOTERAM_BUFSIZE);
+  up_critmon_convert(1024, &ts);
+  nsec = (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+#else
+  nsec = (uint64_t)USEC_PER_TICK * NSEC_PER_USEC * 1024;
+#endif
 
-  /* Get the length of the note at the read index */
+  *ptr++ = NOTERAM_CPU_HEADER;
+  *ptr++ = NOTERAM_COMPACT_VERSION;
+  *ptr++ = NOTERAM_NCPUS;
 
-  note    = (FAR struct note_common_s *)&g_noteram_info.ni_buffer[read];
-  notelen = note->nc_length;
-  DEBUGASSERT(notelen <= circlen);
+  /* The resolution may exceed what one varint holds on 32-bit targets */
 
-errout_with_csection:
-  leave_critical_section(flags);
-  return notelen;
+  ptr = noteram_putvarint(ptr, (uintptr_t)(nsec & 0xffffffff));
+  ptr = noteram_putvarint(ptr, (uintptr_t)(nsec >> 32));
+
+  record[0] = ptr - record;
+  return ptr - record;
 }
+#endif
 
 /****************************************************************************
  * Name: noteram_open
@@ -411,11 +922,18 @@ errout_with_csection:
 
 static int noteram_open(FAR struct file *filep)
 {
-  /* Reset the read index of the circular buffer */
+  int ret;
+
+  /* Reset the read index of the circular buffers */
 
-  g_noteram_info.ni_read = g_noteram_info.ni_tail;
+  ret = nxsem_wait(&g_noteram_readsem);
+  if (ret >= 0)
+    {
+      noteram_rewind(false);
+      nxsem_post(&g_noteram_readsem);
+    }
 
-  return OK;
+  return ret;
 }
 
 /****************************************************************************
@@ -425,56 +943,98 @@ static int noteram_open(FAR struct file *filep)
 static ssize_t noteram_read(FAR struct file *filep,
                             FAR char *buffer, size_t buflen)
 {
-  ssize_t notelen;
-  ssize_t retlen ;
+  FAR struct noteram_pending_s *np;
+  ssize_t retlen;
+  size_t notelen;
+  int ret;
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+  uint8_t prefix[2 + NOTERAM_VARINTSIZE];
+  size_t prefixlen;
+#endif
 
   DEBUGASSERT(filep != 0 && buffer != NULL && buflen > 0);
 
-  /* Then loop, adding as many notes as possible to the user buffer. */
+  ret = nxsem_wait(&g_noteram_readsem);
+  if (ret < 0)
+    {
+      return ret;
+    }
 
   retlen = 0;
-  sched_lock();
-  do
+
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+  /* Start the stream with the header record */
+
+  if (g_noteram_header)
     {
-      /* Get the next note (removing it from the buffer) */
+      prefixlen = noteram_header(prefix);
+      if (prefixlen > buflen)
+        {
+          nxsem_post(&g_noteram_readsem);
+          return -EFBIG;
+        }
+
+      memcpy(buffer, prefix, prefixlen);
+      g_noteram_header = false;
+
+      retlen += prefixlen;
+      buffer += prefixlen;
+      buflen -= prefixlen;
+    }
+#endif
+
+  /* Then loop, adding as many notes as possible to the user buffer.  The
+   * notes of all CPUs are returned in time stamp order.
+   */
+
+  while ((np = noteram_next()) != NULL)
+    {
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+      /* Add the CPU index and the time since the previous note of the
+       * stream in front of the note.
+       */
 
-      notelen = noteram_get((FAR uint8_t *)buffer, buflen);
-      if (notelen < 0)
+      prefix[1] = np - g_noteram_pending;
+      prefixlen = noteram_putvarint(&prefix[2], np->np_stamp -
+                                    g_noteram_stamp) - prefix;
+      prefix[0] = prefixlen + np->np_length;
+      notelen   = prefixlen + np->np_length;
+#else
+      notelen   = np->np_length;
+#endif
+
+      if (notelen > buflen)
         {
-          /* We were unable to read the next note, probably because it will
-           * not fit into the user buffer.
+          /* The note will not fit.  If nothing was read then drop the
+           * large note so that we do not get constipated and report the
+           * error.  Otherwise, keep it for the next read.
            */
 
           if (retlen == 0)
             {
-              /* If nothing was read then report the error.  Otherwise,
-               * just silently drop the note.
-               */
-
-              retlen = notelen;
+              np->np_length = 0;
+              retlen = -EFBIG;
             }
 
           break;
         }
 
-      /* Update pointers from the note that was transferred */
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+      memcpy(buffer, prefix, prefixlen);
+      memcpy(buffer + prefixlen, &np->np_record[np->np_offset],
+             np->np_length);
+      g_noteram_stamp = np->np_stamp;
+#else
+      memcpy(buffer, &np->np_record[np->np_offset], np->np_length);
+#endif
 
       retlen += notelen;
       buffer += notelen;
       buflen -= notelen;
-
-      /* Will the next note fit?  There is a race here and even if the next
-       * note will fit, it may fail still when noteram_get() is called.
-       *
-       * It won't fit (or an error occurred).  Return what we have without
-       * trying to get the next note (which would cause it to be deleted).
-       */
-
-      notelen = noteram_size();
+      np->np_length = 0;
     }
-  while (notelen > 0 && notelen <= buflen);
 
-  sched_unlock();
+  nxsem_post(&g_noteram_readsem);
   return retlen;
 }
 
@@ -484,7 +1044,9 @@ static ssize_t noteram_read(FAR struct file *filep,
 
 static int noteram_ioctl(struct file *filep, int cmd, unsigned long arg)
 {
+  FAR struct noteram_cpumode_s *cpumode;
   int ret = -ENOSYS;
+  int cpu;
 
   /* Handle the ioctl commands */
 
@@ -496,8 +1058,12 @@ static int noteram_ioctl(struct file *filep, int cmd, unsigned long arg)
        */
 
       case NOTERAM_CLEAR:
-        noteram_buffer_clear();
-        ret = OK;
+        ret = nxsem_wait(&g_noteram_readsem);
+        if (ret >= 0)
+          {
+            noteram_rewind(true);
+            nxsem_post(&g_noteram_readsem);
+          }
         break;
 
       /* NOTERAM_GETMODE
@@ -512,13 +1078,24 @@ static int noteram_ioctl(struct file *filep, int cmd, unsigned long arg)
           }
         else
           {
-            *(unsigned int *)arg = g_noteram_info.ni_overwrite;
+            /* Report overflow if any of the buffers overflowed */
+
+            *(unsigned int *)arg = g_noteram_info[0].ni_overwrite;
+            for (cpu = 1; cpu < NOTERAM_NCPUS; cpu++)
+              {
+                if (g_noteram_info[cpu].ni_overwrite ==
+                    NOTERAM_MODE_OVERWRITE_OVERFLOW)
+                  {
+                    *(unsigned int *)arg = NOTERAM_MODE_OVERWRITE_OVERFLOW;
+                  }
+              }
+
             ret = OK;
           }
         break;
 
       /* NOTERAM_SETMODE
-       *      - Set overwrite mode
+       *      - Set overwrite mode of all buffers
        *        Argument: A read-only pointer to unsigned int
        */
 
@@ -529,7 +1106,47 @@ static int noteram_ioctl(struct file *filep, int cmd, unsigned long arg)
           }
         else
           {
-            g_noteram_info.ni_overwrite = *(unsigned int *)arg;
+            for (cpu = 0; cpu < NOTERAM_NCPUS; cpu++)
+              {
+                g_noteram_info[cpu].ni_overwrite = *(unsigned int *)arg;
+              }
+
+            ret = OK;
+          }
+        break;
+
+      /* NOTERAM_GETCPUMODE
+       *      - Get overwrite mode of one CPU's buffer
+       *        Argument: A pointer to struct noteram_cpumode_s
+       */
+
+      case NOTERAM_GETCPUMODE:
+        cpumode = (FAR struct noteram_cpumode_s *)arg;
+        if (cpumode == NULL || cpumode->cpu >= NOTERAM_NCPUS)
+          {
+            ret = -EINVAL;
+          }
+        else
+          {
+            cpumode->mode = g_noteram_info[cpumode->cpu].ni_overwrite;
+            ret = OK;
+          }
+        break;
+
+      /* NOTERAM_SETCPUMODE
+       *      - Set overwrite mode of one CPU's buffer
+       *        Argument: A pointer to struct noteram_cpumode_s
+       */
+
+      case NOTERAM_SETCPUMODE:
+        cpumode = (FAR struct noteram_cpumode_s *)arg;
+        if (cpumode == NULL || cpumode->cpu >= NOTERAM_NCPUS)
+          {
+            ret = -EINVAL;
+          }
+        else
+          {
+            g_noteram_info[cpumode->cpu].ni_overwrite = cpumode->mode;
             ret = OK;
           }
         break;
@@ -549,7 +1166,9 @@ static int noteram_ioctl(struct file *filep, int cmd, unsigned long arg)
  * Name: sched_note_add
  *
  * Description:
- *   Add the variable length note to the transport layer
+ *   Add the variable length note to the buffer of the current CPU.  No lock
+ *   is taken:  Only this CPU writes to the buffer and the reader detects
+ *   notes that were overwritten while it copied them.
  *
  * Input Parameters:
  *   note    - The note buffer
@@ -558,79 +1177,78 @@ static int noteram_ioctl(struct file *filep, int cmd, unsigned long arg)
  * Returned Value:
  *   None
  *
- * Assumptions:
- *   We are within a critical section.
- *
  ****************************************************************************/
 
 void sched_note_add(FAR const void *note, size_t notelen)
 {
-  FAR const char *buf = note;
-  unsigned int head;
-  unsigned int next;
+  FAR struct noteram_info_s *ni;
+  uint8_t record[NOTERAM_MAXREC];
+  uint32_t systime;
+  uint32_t head;
+  size_t reclen;
   irqstate_t flags;
 
-  flags = up_irq_save();
-#ifdef CONFIG_SMP
-  spin_lock_wo_note(&g_noteram_lock);
-#endif
+  DEBUGASSERT(note != NULL && notelen <= UINT8_MAX);
+
+  flags   = up_irq_save();
+  ni      = &g_noteram_info[noteram_cpu()];
+  systime = noteram_timestamp();
 
-  if (g_noteram_info.ni_overwrite == NOTERAM_MODE_OVERWRITE_OVERFLOW)
+  if (ni->ni_overwrite == NOTERAM_MODE_OVERWRITE_OVERFLOW)
     {
-#ifdef CONFIG_SMP
-      spin_unlock_wo_note(&g_noteram_lock);
-#endif
       up_irq_restore(flags);
       return;
     }
 
-  /* Get the index to the head of the circular buffer */
-
-  DEBUGASSERT(note != NULL && notelen < CONFIG_DRIVER_NOTERAM_BUFSIZE);
-  head = g_noteram_info.ni_head;
+  /* A clear request is posted before the overflow mode is reset */
 
-  /* Loop until all bytes have been transferred to the circular buffer */
-
-  while (notelen > 0)
-    {
-      /* Get the next head index.  Would it collide with the current tail
-       * index?
-       */
+  SP_DMB();
 
-      next = noteram_next(head, 1);
-      if (next == g_noteram_info.ni_tail)
-        {
-          if (g_noteram_info.ni_overwrite == NOTERAM_MODE_OVERWRITE_DISABLE)
-            {
-              /* Stop recording if not in overwrite mode */
+  /* Format the record */
 
-              g_noteram_info.ni_overwrite = NOTERAM_MODE_OVERWRITE_OVERFLOW;
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+  reclen = noteram_encode(note, systime - ni->ni_headstamp, record);
+#else
+  record[0] = (uint8_t)(systime         & 0xff);
+  record[1] = (uint8_t)((systime >> 8)  & 0xff);
+  record[2] = (uint8_t)((systime >> 16) & 0xff);
+  record[3] = (uint8_t)((systime >> 24) & 0xff);
 
-#ifdef CONFIG_SMP
-              spin_unlock_wo_note(&g_noteram_lock);
+  memcpy(&record[NOTERAM_STAMPSIZE], note, notelen);
+  reclen = NOTERAM_STAMPSIZE + notelen;
 #endif
-              up_irq_restore(flags);
-              return;
-            }
 
-          /* Yes, then remove the note at the tail index */
+  DEBUGASSERT(reclen < CONFIG_DRIVER_NOTERAM_BUFSIZE);
 
-          noteram_remove();
-        }
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+  /* Let the reader know that the positions are about to change */
 
-      /* Save the next byte at the head index */
+  ni->ni_seq++;
+  SP_DMB();
+#endif
 
-      g_noteram_info.ni_buffer[head] = *buf++;
+  /* Make room for the record */
 
-      head = next;
-      notelen--;
+  head = ni->ni_head;
+  if (!noteram_reserve(ni, reclen))
+    {
+      up_irq_restore(flags);
+      return;
     }
 
-  g_noteram_info.ni_head = head;
+  /* Save the record, then publish the new head */
 
-#ifdef CONFIG_SMP
-  spin_unlock_wo_note(&g_noteram_lock);
+  noteram_copyin(ni, head, record, reclen);
+
+  SP_DMB();
+  ni->ni_head = head + reclen;
+
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+  ni->ni_headstamp = systime;
+  SP_DMB();
+  ni->ni_seq++;
 #endif
+
   up_irq_restore(flags);
 }
 
@@ -651,5 +1269,17 @@ void sched_note_add(FAR const void *note, size_t notelen)
 
 int noteram_register(void)
 {
+#ifdef CONFIG_DRIVER_NOTERAM_DEFAULT_NOOVERWRITE
+  unsigned int mode = NOTERAM_MODE_OVERWRITE_DISABLE;
+#else
+  unsigned int mode = NOTERAM_MODE_OVERWRITE_ENABLE;
+#endif
+  int cpu;
+
+  for (cpu = 0; cpu < NOTERAM_NCPUS; cpu++)
+    {
+      g_noteram_info[cpu].ni_overwrite = mode;
+    }
+
   return register_driver("/dev/note", &g_noteram_fops, 0666, NULL);
 }
@@ -42,6 +42,7 @@
 #endif
 #include <nuttx/kmalloc.h>
 #include <nuttx/semaphore.h>
+#include <nuttx/drivers/drivers.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/ioctl.h>
 
@@ -108,12 +109,390 @@ static void pipecommon_pollnotify(FAR struct pipe_dev_s *dev,
           if (fds->revents != 0)
             {
               finfo("Report events: %02x\n", fds->revents);
-              nxsem_post(fds->sem);
+              poll_notify(fds);
             }
         }
     }
 }
 
+/****************************************************************************
+ * Name: pipecommon_bufused
+ *
+ * Description:
+ *   Return the number of bytes waiting in the circular buffer.
+ *
+ ****************************************************************************/
+
+static size_t pipecommon_bufused(FAR struct pipe_dev_s *dev)
+{
+  if (dev->d_wrndx >= dev->d_rdndx)
+    {
+      return dev->d_wrndx - dev->d_rdndx;
+    }
+
+  return dev->d_bufsize + dev->d_wrndx - dev->d_rdndx;
+}
+
+/****************************************************************************
+ * Name: pipecommon_bufcopyout
+ *
+ * Description:
+ *   Remove up to 'len' bytes from the circular buffer.  The data is moved
+ *   in at most two contiguous chunks:  From d_rdndx to the end of the
+ *   buffer, then from the beginning of the buffer.
+ *
+ * Returned Value:
+ *   The number of bytes removed from the buffer.
+ *
+ ****************************************************************************/
+
+static size_t pipecommon_bufcopyout(FAR struct pipe_dev_s *dev,
+                                    FAR char *buffer, size_t len)
+{
+  size_t nread = 0;
+  size_t chunk;
+
+  while (nread < len && dev->d_wrndx != dev->d_rdndx)
+    {
+      /* The contiguous data ends at the write index or at the end of the
+       * buffer if the data wraps.
+       */
+
+      if (dev->d_wrndx > dev->d_rdndx)
+        {
+          chunk = dev->d_wrndx - dev->d_rdndx;
+        }
+      else
+        {
+          chunk = dev->d_bufsize - dev->d_rdndx;
+        }
+
+      if (chunk > len - nread)
+        {
+          chunk = len - nread;
+        }
+
+      memcpy(&buffer[nread], &dev->d_buffer[dev->d_rdndx], chunk);
+
+      dev->d_rdndx += chunk;
+      if (dev->d_rdndx >= dev->d_bufsize)
+        {
+          dev->d_rdndx = 0;
+        }
+
+      nread += chunk;
+    }
+
+  return nread;
+}
+
+/****************************************************************************
+ * Name: pipecommon_bufcopyin
+ *
+ * Description:
+ *   Add up to 'len' bytes to the circular buffer.  One byte is always left
+ *   unused so that a full buffer can be distinguished from an empty one.
+ *   Like pipecommon_bufcopyout(), this needs at most two memcpy() calls.
+ *
+ * Returned Value:
+ *   The number of bytes added to the buffer.
+ *
+ ****************************************************************************/
+
+static size_t pipecommon_bufcopyin(FAR struct pipe_dev_s *dev,
+                                   FAR const char *buffer, size_t len)
+{
+  size_t nwritten = 0;
+  size_t space;
+  size_t chunk;
+
+  space = dev->d_bufsize - 1 - pipecommon_bufused(dev);
+  if (len > space)
+    {
+      len = space;
+    }
+
+  while (nwritten < len)
+    {
+      /* The contiguous free space ends at the end of the buffer unless the
+       * read index is in the way.
+       */
+
+      chunk = dev->d_bufsize - dev->d_wrndx;
+      if (chunk > len - nwritten)
+        {
+          chunk = len - nwritten;
+        }
+
+      memcpy(&dev->d_buffer[dev->d_wrndx], &buffer[nwritten], chunk);
+
+      dev->d_wrndx += chunk;
+      if (dev->d_wrndx >= dev->d_bufsize)
+        {
+          dev->d_wrndx = 0;
+        }
+
+      nwritten += chunk;
+    }
+
+  return nwritten;
+}
+
+/****************************************************************************
+ * Name: pipecommon_wakeup
+ *
+ * Description:
+ *   Wake up all threads waiting on 'sem' and report 'eventset', if any, to
+ *   the poll waiters.  This is done once per transfer, after all of the
+ *   data has been moved, rather than for each byte.
+ *
+ ****************************************************************************/
+
+static void pipecommon_wakeup(FAR struct pipe_dev_s *dev, FAR sem_t *sem,
+                              pollevent_t eventset)
+{
+  int sval;
+
+  while (nxsem_get_value(sem, &sval) == 0 && sval < 0)
+    {
+      nxsem_post(sem);
+    }
+
+  if (eventset != 0)
+    {
+      pipecommon_pollnotify(dev, eventset);
+    }
+}
+
+/****************************************************************************
+ * Name: pipecommon_splice
+ *
+ * Description:
+ *   Handle the PIPEIOC_SPLICEOUT and PIPEIOC_SPLICEIN commands.  The data
+ *   is passed directly from the circular buffer to nx_write() or from
+ *   nx_read() into the circular buffer, one call per contiguous chunk.
+ *
+ *   Like read() and write(), this blocks until at least one byte can be
+ *   moved unless O_NONBLOCK is set on the pipe.  The pipe is not locked
+ *   while the other descriptor is accessed.  Instead, the chunk is reserved
+ *   with PIPE_FLAG_SPLICEOUT or PIPE_FLAG_SPLICEIN:  The indices are only
+ *   advanced after the transfer, so the other side of the pipe leaves the
+ *   chunk alone, and the readers (or writers) of this side wait for the
+ *   splice just as they wait for an empty (or full) pipe.  Two splices in
+ *   opposite directions between two pipes therefore do not deadlock.
+ *
+ * Returned Value:
+ *   The number of bytes moved, zero on end of file, or a negated errno
+ *   value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_DEV_PIPE_SPLICE
+static int pipecommon_splice(FAR struct file *filep,
+                             FAR struct pipe_dev_s *dev,
+                             FAR struct pipe_splice_s *ps, bool out)
+{
+  FAR struct file *peer;
+  uint8_t flag = out ? PIPE_FLAG_SPLICEOUT : PIPE_FLAG_SPLICEIN;
+  size_t nmoved = 0;
+  size_t chunk;
+  ssize_t nbytes;
+  int ret;
+
+  if (ps == NULL)
+    {
+      return -EINVAL;
+    }
+
+  if ((filep->f_oflags & (out ? O_RDOK : O_WROK)) == 0)
+    {
+      return -EBADF;
+    }
+
+  /* Splicing a pipe to itself would wait for its own reservation */
+
+  if ((unsigned int)ps->fd < CONFIG_NFILE_DESCRIPTORS &&
+      fs_getfilep(ps->fd, &peer) >= 0 && peer->f_inode != NULL &&
+      peer->f_inode->i_private == dev)
+    {
+      return -EINVAL;
+    }
+
+  if (ps->len == 0)
+    {
+      return 0;
+    }
+
+  ret = nxsem_wait(&dev->d_bfsem);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* Wait for data to send or for space to receive into, just as
+   * pipecommon_read() and pipecommon_write() do, and for any other splice
+   * in the same direction to finish.
+   */
+
+  while (out ? (pipecommon_bufused(dev) == 0 ||
+                PIPE_IS_SPLICEOUT(dev->d_flags)) :
+               (pipecommon_bufused(dev) >= (size_t)dev->d_bufsize - 1 ||
+                PIPE_IS_SPLICEIN(dev->d_flags)))
+    {
+      if (out && dev->d_nwriters <= 0 && pipecommon_bufused(dev) == 0)
+        {
+          nxsem_post(&dev->d_bfsem);
+          return 0;
+        }
+
+      if (!out && dev->d_nreaders <= 0)
+        {
+          nxsem_post(&dev->d_bfsem);
+          return -EPIPE;
+        }
+
+      if (filep->f_oflags & O_NONBLOCK)
+        {
+          nxsem_post(&dev->d_bfsem);
+          return -EAGAIN;
+        }
+
+      sched_lock();
+      nxsem_post(&dev->d_bfsem);
+      ret = nxsem_wait(out ? &dev->d_rdsem : &dev->d_wrsem);
+      sched_unlock();
+
+      if (ret < 0 || (ret = nxsem_wait(&dev->d_bfsem)) < 0)
+        {
+          return ret;
+        }
+    }
+
+  /* Move at most two contiguous chunks:  Up to the end of the buffer and
+   * then from the beginning of the buffer.
+   */
+
+  while (nmoved < ps->len)
+    {
+      if (out)
+        {
+          if (dev->d_wrndx == dev->d_rdndx)
+            {
+              break;
+            }
+
+          chunk = dev->d_wrndx > dev->d_rdndx ?
+                  dev->d_wrndx - dev->d_rdndx :
+                  dev->d_bufsize - dev->d_rdndx;
+        }
+      else
+        {
+          /* Keep one byte free so that full and empty differ */
+
+          if (dev->d_wrndx >= dev->d_rdndx)
+            {
+              chunk = dev->d_bufsize - dev->d_wrndx;
+              if (dev->d_rdndx == 0)
+                {
+                  chunk--;
+                }
+            }
+          else
+            {
+              chunk = dev->d_rdndx - dev->d_wrndx - 1;
+            }
+
+          if (chunk == 0)
+            {
+              break;
+            }
+        }
+
+      if (chunk > ps->len - nmoved)
+        {
+          chunk = ps->len - nmoved;
+        }
+
+      /* Reserve the chunk and access the other descriptor unlocked */
+
+      dev->d_flags |= flag;
+      nxsem_post(&dev->d_bfsem);
+
+      if (out)
+        {
+          nbytes = nx_write(ps->fd, &dev->d_buffer[dev->d_rdndx], chunk);
+        }
+      else
+        {
+          nbytes = nx_read(ps->fd, &dev->d_buffer[dev->d_wrndx], chunk);
+        }
+
+      /* The reservation must be released, so do not give up on signals */
+
+      nxsem_wait_uninterruptible(&dev->d_bfsem);
+      dev->d_flags &= ~flag;
+
+      if (nbytes <= 0)
+        {
+          /* Report an error only if nothing was moved yet */
+
+          if (nmoved == 0)
+            {
+              ret = (int)nbytes;
+            }
+
+          break;
+        }
+
+      if (out)
+        {
+          dev->d_rdndx += nbytes;
+          if (dev->d_rdndx >= dev->d_bufsize)
+            {
+              dev->d_rdndx = 0;
+            }
+        }
+      else
+        {
+          dev->d_wrndx += nbytes;
+          if (dev->d_wrndx >= dev->d_bufsize)
+            {
+              dev->d_wrndx = 0;
+            }
+        }
+
+      nmoved += nbytes;
+      if ((size_t)nbytes < chunk)
+        {
+          break;
+        }
+    }
+
+  /* Report the moved data to the other side and wake up the threads of
+   * this side that waited for the reservation.
+   */
+
+  if (out)
+    {
+      pipecommon_wakeup(dev, &dev->d_wrsem, nmoved > 0 ? POLLOUT : 0);
+      pipecommon_wakeup(dev, &dev->d_rdsem, 0);
+    }
+  else
+    {
+      pipecommon_wakeup(dev, &dev->d_rdsem, nmoved > 0 ? POLLIN : 0);
+      pipecommon_wakeup(dev, &dev->d_wrsem, 0);
+    }
+
+  if (nmoved > 0)
+    {
+      ret = (int)nmoved;
+    }
+
+  nxsem_post(&dev->d_bfsem);
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -399,7 +778,6 @@ ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
   FAR uint8_t           *start  = (FAR uint8_t *)buffer;
 #endif
   ssize_t                nread  = 0;
-  int                    sval;
   int                    ret;
 
   DEBUGASSERT(dev);
@@ -421,13 +799,15 @@ ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
       return ret;
     }
 
-  /* If the pipe is empty, then wait for something to be written to it */
+  /* If the pipe is empty, then wait for something to be written to it.
+   * Data reserved by a splice is not available either.
+   */
 
-  while (dev->d_wrndx == dev->d_rdndx)
+  while (dev->d_wrndx == dev->d_rdndx || PIPE_IS_SPLICEOUT(dev->d_flags))
     {
       /* If there are no writers on the pipe, then return end of file */
 
-      if (dev->d_nwriters <= 0)
+      if (dev->d_nwriters <= 0 && dev->d_wrndx == dev->d_rdndx)
         {
           nxsem_post(&dev->d_bfsem);
           return 0;
@@ -462,30 +842,13 @@ ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
    * byte).
    */
 
-  nread = 0;
-  while ((size_t)nread < len && dev->d_wrndx != dev->d_rdndx)
-    {
-      *buffer++ = dev->d_buffer[dev->d_rdndx];
-      if (++dev->d_rdndx >= dev->d_bufsize)
-        {
-          dev->d_rdndx = 0;
-        }
-
-      nread++;
-    }
+  nread = pipecommon_bufcopyout(dev, buffer, len);
 
-  /* Notify all waiting writers that bytes have been removed from the
-   * buffer.
+  /* Notify all waiting writers and all poll/select waiters that bytes have
+   * been removed from the buffer.
    */
 
-  while (nxsem_get_value(&dev->d_wrsem, &sval) == 0 && sval < 0)
-    {
-      nxsem_post(&dev->d_wrsem);
-    }
-
-  /* Notify all poll/select waiters that they can write to the FIFO */
-
-  pipecommon_pollnotify(dev, POLLOUT);
+  pipecommon_wakeup(dev, &dev->d_wrsem, POLLOUT);
 
   nxsem_post(&dev->d_bfsem);
   pipe_dumpbuffer("From PIPE:", start, nread);
@@ -503,8 +866,6 @@ ssize_t pipecommon_write(FAR struct file *filep, FAR const char *buffer,
   FAR struct pipe_dev_s *dev      = inode->i_private;
   ssize_t                nwritten = 0;
   ssize_t                last;
-  int                    nxtwrndx;
-  int                    sval;
   int                    ret;
 
   DEBUGASSERT(dev);
@@ -560,107 +921,78 @@ ssize_t pipecommon_write(FAR struct file *filep, FAR const char *buffer,
   last = 0;
   for (; ; )
     {
-      /* Calculate the write index AFTER the next byte is written */
+      /* Copy as much as fits into the buffer in one pass, unless a splice
+       * owns the free space.
+       */
 
-      nxtwrndx = dev->d_wrndx + 1;
-      if (nxtwrndx >= dev->d_bufsize)
+      if (!PIPE_IS_SPLICEIN(dev->d_flags))
         {
-          nxtwrndx = 0;
+          nwritten += pipecommon_bufcopyin(dev, &buffer[nwritten],
+                                           len - nwritten);
         }
 
-      /* Would the next write overflow the circular buffer? */
+      /* Is the write complete? */
 
-      if (nxtwrndx != dev->d_rdndx)
+      if ((size_t)nwritten >= len)
         {
-          /* No... copy the byte */
-
-          dev->d_buffer[dev->d_wrndx] = *buffer++;
-          dev->d_wrndx = nxtwrndx;
-
-          /* Is the write complete? */
-
-          nwritten++;
-          if ((size_t)nwritten >= len)
-            {
-              /* Yes.. Notify all of the waiting readers that more data is
-               * available.
-               */
+          /* Yes.. Notify all of the waiting readers and all poll/select
+           * waiters that more data is available.
+           */
 
-              while (nxsem_get_value(&dev->d_rdsem, &sval) == 0 && sval < 0)
-                {
-                  nxsem_post(&dev->d_rdsem);
-                }
+          pipecommon_wakeup(dev, &dev->d_rdsem, POLLIN);
 
-              /* Notify all poll/select waiters that they can read from the
-               * FIFO.
-               */
+          /* Return the number of bytes written */
 
-              pipecommon_pollnotify(dev, POLLIN);
+          nxsem_post(&dev->d_bfsem);
+          return len;
+        }
 
-              /* Return the number of bytes written */
+      /* There is not enough room for the rest of the data.  Was anything
+       * written in this pass?
+       */
 
-              nxsem_post(&dev->d_bfsem);
-              return len;
-            }
-        }
-      else
+      if (last < nwritten)
         {
-          /* There is not enough room for the next byte.  Was anything
-           * written in this pass?
+          /* Yes.. Notify all of the waiting readers that more data is
+           * available.
            */
 
-          if (last < nwritten)
-            {
-              /* Yes.. Notify all of the waiting readers that more data is
-               * available.
-               */
+          pipecommon_wakeup(dev, &dev->d_rdsem, POLLIN);
+        }
 
-              while (nxsem_get_value(&dev->d_rdsem, &sval) == 0 && sval < 0)
-                {
-                  nxsem_post(&dev->d_rdsem);
-                }
+      last = nwritten;
 
-              /* Notify all poll/select waiters that they can read from the
-               * FIFO.
-               */
+      /* If O_NONBLOCK was set, then return partial bytes written or
+       * EGAIN.
+       */
 
-              pipecommon_pollnotify(dev, POLLIN);
+      if (filep->f_oflags & O_NONBLOCK)
+        {
+          if (nwritten == 0)
+            {
+              nwritten = -EAGAIN;
             }
 
-          last = nwritten;
-
-          /* If O_NONBLOCK was set, then return partial bytes written or
-           * EGAIN.
-           */
+          nxsem_post(&dev->d_bfsem);
+          return nwritten;
+        }
 
-          if (filep->f_oflags & O_NONBLOCK)
-            {
-              if (nwritten == 0)
-                {
-                  nwritten = -EAGAIN;
-                }
+      /* There is more to be written.. wait for data to be removed from the
+       * pipe
+       */
 
-              nxsem_post(&dev->d_bfsem);
-              return nwritten;
-            }
+      sched_lock();
+      nxsem_post(&dev->d_bfsem);
+      ret = nxsem_wait(&dev->d_wrsem);
+      sched_unlock();
 
-          /* There is more to be written.. wait for data to be removed fro
-           * the pipe
+      if (ret < 0 || (ret = nxsem_wait(&dev->d_bfsem)) < 0)
+        {
+          /* Either call nxsem_wait may fail because a signal was received
+           * or if the task was canceled.
            */
 
-          sched_lock();
-          nxsem_post(&dev->d_bfsem);
-          ret = nxsem_wait(&dev->d_wrsem);
-          sched_unlock();
-
-          if (ret < 0 || (ret = nxsem_wait(&dev->d_bfsem)) < 0)
-            {
-              /* Either call nxsem_wait may fail because a signal was
-               * received or if the task was canceled.
-               */
-
-              return nwritten == 0 ? (ssize_t)ret : nwritten;
-            }
+          return nwritten == 0 ? (ssize_t)ret : nwritten;
         }
     }
 }
@@ -720,14 +1052,7 @@ int pipecommon_poll(FAR struct file *filep, FAR struct pollfd *fds,
        * First, determine how many bytes are in the buffer
        */
 
-      if (dev->d_wrndx >= dev->d_rdndx)
-        {
-          nbytes = dev->d_wrndx - dev->d_rdndx;
-        }
-      else
-        {
-          nbytes = dev->d_bufsize + dev->d_wrndx - dev->d_rdndx;
-        }
+      nbytes = pipecommon_bufused(dev);
 
       /* Notify the POLLOUT event if the pipe is not full, but only if
        * there is readers.
@@ -811,6 +1136,17 @@ int pipecommon_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
     }
 #endif
 
+#ifdef CONFIG_DEV_PIPE_SPLICE
+  /* The splice commands manage the lock themselves since they may block */
+
+  if (cmd == PIPEIOC_SPLICEOUT || cmd == PIPEIOC_SPLICEIN)
+    {
+      return pipecommon_splice(filep, dev,
+                               (FAR struct pipe_splice_s *)((uintptr_t)arg),
+                               cmd == PIPEIOC_SPLICEOUT);
+    }
+#endif
+
   ret = pipecommon_semtake(&dev->d_bfsem);
   if (ret < 0)
     {
@@ -847,14 +1183,7 @@ int pipecommon_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
            *   d_wrndx - Index to next location to add a byte to the buffer.
            */
 
-          if (dev->d_wrndx < dev->d_rdndx)
-            {
-              count = (dev->d_bufsize - dev->d_rdndx) + dev->d_wrndx;
-            }
-          else
-            {
-              count = dev->d_wrndx - dev->d_rdndx;
-            }
+          count = pipecommon_bufused(dev);
 
           *(FAR int *)((uintptr_t)arg) = count;
           ret = 0;
@@ -174,7 +174,7 @@ static void uart_pollnotify(FAR uart_dev_t *dev, pollevent_t eventset)
               nxsem_get_value(fds->sem, &semcount);
               if (semcount < 1)
                 {
-                  nxsem_post(fds->sem);
+                  poll_notify(fds);
                 }
 
               leave_critical_section(flags);
@@ -51,6 +51,214 @@
 
 #include <nuttx/serial/serial.h>
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: uart_xmitblock
+ *
+ * Description:
+ *   Hand the contiguous runs of the TX buffer to the lower half sendbuf()
+ *   method until the buffer is empty or the lower half stops accepting
+ *   data.  Returns the number of bytes removed from the buffer.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SERIAL_BLOCKIO
+static uint16_t uart_xmitblock(FAR uart_dev_t *dev)
+{
+  FAR struct uart_buffer_s *txbuf = &dev->xmit;
+  uint16_t nbytes = 0;
+  size_t len;
+  size_t ret;
+
+  while (txbuf->head != txbuf->tail)
+    {
+      /* Send up to the head or up to the end of the buffer */
+
+      if (txbuf->tail < txbuf->head)
+        {
+          len = txbuf->head - txbuf->tail;
+        }
+      else
+        {
+          len = txbuf->size - txbuf->tail;
+        }
+
+      ret = uart_sendbuf(dev, &txbuf->buffer[txbuf->tail], len);
+      nbytes += ret;
+
+      txbuf->tail += ret;
+      if (txbuf->tail >= txbuf->size)
+        {
+          txbuf->tail = 0;
+        }
+
+      /* A short count means that the TX FIFO is full */
+
+      if (ret < len)
+        {
+          break;
+        }
+    }
+
+  return nbytes;
+}
+#endif
+
+/****************************************************************************
+ * Name: uart_recvsignals
+ *
+ * Description:
+ *   Remove the SIGINT and SIGSTP characters from a block of newly received
+ *   data and note the signal to send.  SIGINT takes precedence over SIGSTP
+ *   as in the per-character path.  Returns the number of bytes left.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_SERIAL_BLOCKIO) && \
+   (defined(CONFIG_TTY_SIGINT) || defined(CONFIG_TTY_SIGSTP))
+static size_t uart_recvsignals(FAR char *buffer, size_t len,
+                               FAR int *signo)
+{
+  size_t nkept = 0;
+  size_t i;
+
+  for (i = 0; i < len; i++)
+    {
+#ifdef CONFIG_TTY_SIGINT
+      if (buffer[i] == CONFIG_TTY_SIGINT_CHAR)
+        {
+          *signo = SIGINT;
+          continue;
+        }
+#endif
+
+#ifdef CONFIG_TTY_SIGSTP
+      if (buffer[i] == CONFIG_TTY_SIGSTP_CHAR)
+        {
+          if (*signo == 0)
+            {
+              *signo = SIGSTP;
+            }
+
+          continue;
+        }
+#endif
+
+      buffer[nkept++] = buffer[i];
+    }
+
+  return nkept;
+}
+#endif
+
+/****************************************************************************
+ * Name: uart_recvblock
+ *
+ * Description:
+ *   Let the lower half recvbuf() method fill the contiguous free runs of
+ *   the RX buffer until the receiver is drained or the buffer has no more
+ *   room.  With RX flow control, the buffer is only filled up to the level
+ *   that the per-character path reports to the lower half, so that
+ *   crossing that level is still handled there.  Returns the number of
+ *   bytes added to the buffer.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SERIAL_BLOCKIO
+static uint16_t uart_recvblock(FAR uart_dev_t *dev, FAR int *signo)
+{
+  FAR struct uart_buffer_s *rxbuf = &dev->recv;
+#ifdef CONFIG_SERIAL_IFLOWCONTROL_WATERMARKS
+  unsigned int watermark;
+#endif
+  unsigned int nbuffered;
+  uint16_t nbytes = 0;
+  size_t nstored;
+  size_t len;
+  size_t ret;
+
+#ifdef CONFIG_SERIAL_IFLOWCONTROL_WATERMARKS
+  watermark = (CONFIG_SERIAL_IFLOWCONTROL_UPPER_WATERMARK * rxbuf->size) /
+              100;
+#endif
+
+  for (; ; )
+    {
+      if (rxbuf->head >= rxbuf->tail)
+        {
+          nbuffered = rxbuf->head - rxbuf->tail;
+        }
+      else
+        {
+          nbuffered = rxbuf->size - rxbuf->tail + rxbuf->head;
+        }
+
+      /* Room left in the buffer, always keeping one slot empty */
+
+      len = rxbuf->size - 1 - nbuffered;
+
+#ifdef CONFIG_SERIAL_IFLOWCONTROL_WATERMARKS
+      if (nbuffered >= watermark)
+        {
+          len = 0;
+        }
+      else if (len > watermark - nbuffered)
+        {
+          len = watermark - nbuffered;
+        }
+#endif
+
+      /* Receive no further than the end of the buffer */
+
+      if (len > rxbuf->size - rxbuf->head)
+        {
+          len = rxbuf->size - rxbuf->head;
+        }
+
+      if (len == 0)
+        {
+          break;
+        }
+
+      ret = uart_recvbuf(dev, &rxbuf->buffer[rxbuf->head], len);
+      if (ret == 0)
+        {
+          break;
+        }
+
+      nstored = ret;
+
+#if defined(CONFIG_TTY_SIGINT) || defined(CONFIG_TTY_SIGSTP)
+      if (dev->pid >= 0 && (dev->tc_lflag & ISIG))
+        {
+          nstored = uart_recvsignals(&rxbuf->buffer[rxbuf->head], ret,
+                                     signo);
+        }
+#endif
+
+      nbytes += nstored;
+
+      rxbuf->head += nstored;
+      if (rxbuf->head >= rxbuf->size)
+        {
+          rxbuf->head = 0;
+        }
+
+      /* A short count means that the receiver is drained */
+
+      if (ret < len)
+        {
+          break;
+        }
+    }
+
+  return nbytes;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -75,6 +283,16 @@ void uart_xmitchars(FAR uart_dev_t *dev)
   irqstate_t flags = enter_critical_section();
 #endif
 
+#ifdef CONFIG_SERIAL_BLOCKIO
+  /* Send whole runs of the TX buffer if the lower half supports it */
+
+  if (dev->ops->sendbuf != NULL)
+    {
+      nbytes = uart_xmitblock(dev);
+    }
+  else
+#endif
+
   /* Send while we still have data in the TX buffer & room in the fifo */
 
   while (dev->xmit.head != dev->xmit.tail && uart_txready(dev))
@@ -138,12 +356,29 @@ void uart_recvchars(FAR uart_dev_t *dev)
   unsigned int watermark;
 #endif
   unsigned int status;
-  int nexthead = rxbuf->head + 1;
+  int nexthead;
 #if defined(CONFIG_TTY_SIGINT) || defined(CONFIG_TTY_SIGSTP)
   int signo = 0;
 #endif
   uint16_t nbytes = 0;
 
+#ifdef CONFIG_SERIAL_BLOCKIO
+  /* Move whole blocks into the free space of the RX buffer first if the
+   * lower half supports it.  The character loop below then only sees what
+   * is left when the buffer fills up or reaches the flow control level.
+   */
+
+  if (dev->ops->recvbuf != NULL)
+    {
+#if defined(CONFIG_TTY_SIGINT) || defined(CONFIG_TTY_SIGSTP)
+      nbytes = uart_recvblock(dev, &signo);
+#else
+      nbytes = uart_recvblock(dev, NULL);
+#endif
+    }
+#endif
+
+  nexthead = rxbuf->head + 1;
   if (nexthead >= rxbuf->size)
     {
       nexthead = 0;
@@ -62,6 +62,23 @@
  * Pre-processor definitions
  ****************************************************************************/
 
+/* With block transfers, let the RX FIFO fill up further before it
+ * interrupts.  The character timeout interrupt still delivers the tail of
+ * a burst once the line goes idle.  The TX FIFO can be filled completely
+ * whenever THRE is set, but only if this driver enabled the FIFOs.
+ */
+
+#ifdef CONFIG_SERIAL_BLOCKIO
+#  define U16550_RXTRIGGER     UART_FCR_RXTRIGGER_14
+#  ifdef CONFIG_16550_SUPRESS_CONFIG
+#    define U16550_TXFIFO_SIZE 1
+#  else
+#    define U16550_TXFIFO_SIZE 16
+#  endif
+#else
+#  define U16550_RXTRIGGER     UART_FCR_RXTRIGGER_8
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -110,6 +127,12 @@ static void u16550_dmatxavail(FAR struct uart_dev_s *dev);
 static void u16550_dmareceive(FAR struct uart_dev_s *dev);
 static void u16550_dmarxfree(FAR struct uart_dev_s *dev);
 #endif
+#ifdef CONFIG_SERIAL_BLOCKIO
+static size_t u16550_recvbuf(FAR struct uart_dev_s *dev, FAR char *buffer,
+                             size_t buflen);
+static size_t u16550_sendbuf(FAR struct uart_dev_s *dev,
+                             FAR const char *buffer, size_t buflen);
+#endif
 static void u16550_send(FAR struct uart_dev_s *dev, int ch);
 static void u16550_txint(FAR struct uart_dev_s *dev, bool enable);
 static bool u16550_txready(FAR struct uart_dev_s *dev);
@@ -146,6 +169,10 @@ static const struct uart_ops_s g_uart_ops =
   .txint          = u16550_txint,
   .txready        = u16550_txready,
   .txempty        = u16550_txempty,
+#ifdef CONFIG_SERIAL_BLOCKIO
+  .recvbuf        = u16550_recvbuf,
+  .sendbuf        = u16550_sendbuf,
+#endif
 };
 
 /* I/O buffers */
@@ -642,7 +669,7 @@ static int u16550_setup(FAR struct uart_dev_s *dev)
   /* Set trigger */
 
   u16550_serialout(priv, UART_FCR_OFFSET,
-                   (UART_FCR_FIFOEN | UART_FCR_RXTRIGGER_8));
+                   (UART_FCR_FIFOEN | U16550_RXTRIGGER));
 
   /* Set up the IER */
 
@@ -702,7 +729,7 @@ static int u16550_setup(FAR struct uart_dev_s *dev)
   /* Configure the FIFOs */
 
   u16550_serialout(priv, UART_FCR_OFFSET,
-                   (UART_FCR_RXTRIGGER_8 | UART_FCR_TXRST | UART_FCR_RXRST |
+                   (U16550_RXTRIGGER | UART_FCR_TXRST | UART_FCR_RXRST |
                     UART_FCR_FIFOEN));
 
   /* Set up the auto flow control */
@@ -1191,6 +1218,68 @@ static void u16550_dmatxavail(FAR struct uart_dev_s *dev)
 }
 #endif
 
+/****************************************************************************
+ * Name: u16550_recvbuf
+ *
+ * Description:
+ *   Drain the receive FIFO into a buffer
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SERIAL_BLOCKIO
+static size_t u16550_recvbuf(FAR struct uart_dev_s *dev, FAR char *buffer,
+                             size_t buflen)
+{
+  FAR struct u16550_s *priv = (FAR struct u16550_s *)dev->priv;
+  size_t nbytes = 0;
+
+  while (nbytes < buflen &&
+         (u16550_serialin(priv, UART_LSR_OFFSET) & UART_LSR_DR) != 0)
+    {
+      buffer[nbytes++] = (char)u16550_serialin(priv, UART_RBR_OFFSET);
+    }
+
+  return nbytes;
+}
+
+/****************************************************************************
+ * Name: u16550_sendbuf
+ *
+ * Description:
+ *   Fill the empty transmit FIFO from a buffer
+ *
+ ****************************************************************************/
+
+static size_t u16550_sendbuf(FAR struct uart_dev_s *dev,
+                             FAR const char *buffer, size_t buflen)
+{
+  FAR struct u16550_s *priv = (FAR struct u16550_s *)dev->priv;
+  size_t nbytes;
+
+  /* THRE only tells that the whole FIFO is empty, not how much room is
+   * left in it, so only fill it when it is empty.
+   */
+
+  if ((u16550_serialin(priv, UART_LSR_OFFSET) & UART_LSR_THRE) == 0)
+    {
+      return 0;
+    }
+
+  if (buflen > U16550_TXFIFO_SIZE)
+    {
+      buflen = U16550_TXFIFO_SIZE;
+    }
+
+  for (nbytes = 0; nbytes < buflen; nbytes++)
+    {
+      u16550_serialout(priv, UART_THR_OFFSET,
+                       (uart_datawidth_t)buffer[nbytes]);
+    }
+
+  return nbytes;
+}
+#endif
+
 /****************************************************************************
  * Name: u16550_send
  *
@@ -1440,6 +1440,15 @@ static int fat_sync(FAR struct file *filep)
       ret          = fat_updatefsinfo(fs);
     }
 
+#ifdef CONFIG_FAT_SECTORCACHE
+  /* Write back the dirty sectors of the sector cache */
+
+  if (ret >= 0)
+    {
+      ret = fat_cacheflush(fs);
+    }
+#endif
+
 errout_with_semaphore:
   fat_semgive(fs);
   return ret;
@@ -2243,6 +2252,17 @@ static int fat_unbind(FAR void *handle, FAR struct inode **blkdriver,
         }
     }
 
+#ifdef CONFIG_FAT_SECTORCACHE
+  /* Write back the mountpoint buffer and the dirty sectors of the sector
+   * cache before the cache goes away.
+   */
+
+  if (fs->fs_mounted && fat_fscacheflush(fs) >= 0)
+    {
+      fat_cacheflush(fs);
+    }
+#endif
+
   /* Unmount ... close the block driver */
 
   if (fs->fs_blkdriver)
@@ -2275,6 +2295,10 @@ static int fat_unbind(FAR void *handle, FAR struct inode **blkdriver,
       fat_io_free(fs->fs_buffer, fs->fs_hwsectorsize);
     }
 
+#ifdef CONFIG_FAT_SECTORCACHE
+  fat_cacheuninit(fs);
+#endif
+
   nxsem_destroy(&fs->fs_sem);
   kmm_free(fs);
   return OK;
@@ -30,6 +30,7 @@
 #include <sys/types.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <queue.h>
 #include <time.h>
 
 #include <nuttx/kmalloc.h>
@@ -852,6 +853,26 @@
  * Public Types
  ****************************************************************************/
 
+#ifdef CONFIG_FAT_SECTORCACHE
+/* This structure describes one sector of the sector cache.  The cache is
+ * shared by the FAT, directory and data sectors of a mountpoint.  Sectors
+ * are found through a hash table and replaced in LRU order.
+ */
+
+struct fat_cachesect_s
+{
+  dq_entry_t cs_link;              /* LRU list, most recently used first */
+  off_t    cs_sector;              /* The sector number held in cs_buffer */
+  bool     cs_valid;               /* true: cs_buffer holds cs_sector */
+  bool     cs_dirty;               /* true: cs_buffer must be written */
+  uint8_t *cs_buffer;              /* The sector data */
+
+  /* Next sector in the same hash chain */
+
+  struct fat_cachesect_s *cs_hnext;
+};
+#endif
+
 /* This structure represents the overall mountpoint state.  An instance of
  * this structure is retained as inode private data on each mountpoint that
  * is mounted with a fat32 filesystem.
@@ -886,6 +907,20 @@ struct fat_mountpt_s
   uint8_t  fs_fatsecperclus;       /* MBR: Sectors per allocation unit: 2**n, n=0..7 */
   uint8_t *fs_buffer;              /* This is an allocated buffer to hold one
                                     * sector from the device */
+#ifdef CONFIG_FAT_SECTORCACHE
+  dq_queue_t fs_cachelru;          /* The cached sectors in LRU order */
+  uint8_t *fs_cachebuffer;         /* Data of all cached sectors */
+  uint8_t *fs_burstbuffer;         /* Read-ahead and write-back bursts */
+  off_t    fs_cachenext;           /* Next sector of a sequential read */
+
+  /* The sectors of the sector cache, their hash table and the scratch
+   * array used to sort the dirty sectors when they are written back.
+   */
+
+  struct fat_cachesect_s *fs_cache;
+  struct fat_cachesect_s **fs_cachehash;
+  struct fat_cachesect_s **fs_cachedirty;
+#endif
 };
 
 /* This structure represents on open file under the mountpoint.  An instance
@@ -1039,6 +1074,18 @@ EXTERN int    fat_hwread(struct fat_mountpt_s *fs, uint8_t *buffer,
 EXTERN int    fat_hwwrite(struct fat_mountpt_s *fs, uint8_t *buffer,
                           off_t sector, unsigned int nsectors);
 
+/* Sector cache below the hardware access */
+
+#ifdef CONFIG_FAT_SECTORCACHE
+EXTERN int    fat_cacheinit(struct fat_mountpt_s *fs);
+EXTERN void   fat_cacheuninit(struct fat_mountpt_s *fs);
+EXTERN int    fat_cacheread(struct fat_mountpt_s *fs, uint8_t *buffer,
+                            off_t sector, unsigned int nsectors);
+EXTERN int    fat_cachewrite(struct fat_mountpt_s *fs, uint8_t *buffer,
+                             off_t sector, unsigned int nsectors);
+EXTERN int    fat_cacheflush(struct fat_mountpt_s *fs);
+#endif
+
 /* Cluster / cluster chain access helpers */
 
 EXTERN off_t  fat_cluster2sector(struct fat_mountpt_s *fs, uint32_t cluster);
@@ -0,0 +1,662 @@
+/****************************************************************************
+ * fs/fat/fs_fat32cache.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <queue.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
+
+#include "inode/inode.h"
+#include "fs_fat32.h"
+
+#ifdef CONFIG_FAT_SECTORCACHE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define FAT_CACHE_NSECTORS  CONFIG_FAT_SECTORCACHE_NSECTORS
+#define FAT_CACHE_BURST     MIN(CONFIG_FAT_SECTORCACHE_BURST, \
+                                CONFIG_FAT_SECTORCACHE_NSECTORS)
+
+#define fat_cachehash(s)    ((uint32_t)(s) % FAT_CACHE_NSECTORS)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fat_blkread
+ *
+ * Description:
+ *   Read sectors from the block driver, bypassing the cache
+ *
+ ****************************************************************************/
+
+static int fat_blkread(FAR struct fat_mountpt_s *fs, FAR uint8_t *buffer,
+                       off_t sector, unsigned int nsectors)
+{
+  FAR struct inode *inode = fs->fs_blkdriver;
+  ssize_t nsectorsread;
+
+  if (inode == NULL || inode->u.i_bops == NULL ||
+      inode->u.i_bops->read == NULL)
+    {
+      return -ENODEV;
+    }
+
+  nsectorsread = inode->u.i_bops->read(inode, buffer, sector, nsectors);
+  if (nsectorsread == nsectors)
+    {
+      return OK;
+    }
+
+  return nsectorsread < 0 ? (int)nsectorsread : -EIO;
+}
+
+/****************************************************************************
+ * Name: fat_blkwrite
+ *
+ * Description:
+ *   Write sectors to the block driver, bypassing the cache
+ *
+ ****************************************************************************/
+
+static int fat_blkwrite(FAR struct fat_mountpt_s *fs, FAR uint8_t *buffer,
+                        off_t sector, unsigned int nsectors)
+{
+  FAR struct inode *inode = fs->fs_blkdriver;
+  ssize_t nsectorswritten;
+
+  if (inode == NULL || inode->u.i_bops == NULL ||
+      inode->u.i_bops->write == NULL)
+    {
+      return -ENODEV;
+    }
+
+  nsectorswritten = inode->u.i_bops->write(inode, buffer, sector, nsectors);
+  if (nsectorswritten == nsectors)
+    {
+      return OK;
+    }
+
+  return nsectorswritten < 0 ? (int)nsectorswritten : -EIO;
+}
+
+/****************************************************************************
+ * Name: fat_cachefind
+ *
+ * Description:
+ *   Return the cache entry holding a sector or NULL if it is not cached
+ *
+ ****************************************************************************/
+
+static FAR struct fat_cachesect_s *
+fat_cachefind(FAR struct fat_mountpt_s *fs, off_t sector)
+{
+  FAR struct fat_cachesect_s *cs;
+
+  for (cs = fs->fs_cachehash[fat_cachehash(sector)];
+       cs != NULL;
+       cs = cs->cs_hnext)
+    {
+      if (cs->cs_sector == sector)
+        {
+          return cs;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: fat_cacheunhash
+ ****************************************************************************/
+
+static void fat_cacheunhash(FAR struct fat_mountpt_s *fs,
+                            FAR struct fat_cachesect_s *cs)
+{
+  FAR struct fat_cachesect_s **prev;
+
+  for (prev = &fs->fs_cachehash[fat_cachehash(cs->cs_sector)];
+       *prev != NULL;
+       prev = &(*prev)->cs_hnext)
+    {
+      if (*prev == cs)
+        {
+          *prev = cs->cs_hnext;
+          break;
+        }
+    }
+
+  cs->cs_hnext = NULL;
+  cs->cs_valid = false;
+}
+
+/****************************************************************************
+ * Name: fat_cachetouch
+ *
+ * Description:
+ *   Make a cache entry the most recently used one
+ *
+ ****************************************************************************/
+
+static void fat_cachetouch(FAR struct fat_mountpt_s *fs,
+                           FAR struct fat_cachesect_s *cs)
+{
+  if (fs->fs_cachelru.head != &cs->cs_link)
+    {
+      dq_rem(&cs->cs_link, &fs->fs_cachelru);
+      dq_addfirst(&cs->cs_link, &fs->fs_cachelru);
+    }
+}
+
+/****************************************************************************
+ * Name: fat_cachecompare
+ *
+ * Description:
+ *   qsort() comparison of two cache entries by sector number
+ *
+ ****************************************************************************/
+
+static int fat_cachecompare(FAR const void *a, FAR const void *b)
+{
+  off_t sa = (*(FAR struct fat_cachesect_s * const *)a)->cs_sector;
+  off_t sb = (*(FAR struct fat_cachesect_s * const *)b)->cs_sector;
+
+  return sa < sb ? -1 : sa > sb ? 1 : 0;
+}
+
+/****************************************************************************
+ * Name: fat_cachewriterun
+ *
+ * Description:
+ *   Write a run of dirty sectors with contiguous sector numbers with one
+ *   transfer and mark them clean.
+ *
+ ****************************************************************************/
+
+static int fat_cachewriterun(FAR struct fat_mountpt_s *fs,
+                             FAR struct fat_cachesect_s **run,
+                             unsigned int nsectors)
+{
+  unsigned int i;
+  int ret;
+
+  if (nsectors == 1)
+    {
+      ret = fat_blkwrite(fs, run[0]->cs_buffer, run[0]->cs_sector, 1);
+    }
+  else
+    {
+      for (i = 0; i < nsectors; i++)
+        {
+          memcpy(&fs->fs_burstbuffer[i * fs->fs_hwsectorsize],
+                 run[i]->cs_buffer, fs->fs_hwsectorsize);
+        }
+
+      ret = fat_blkwrite(fs, fs->fs_burstbuffer, run[0]->cs_sector,
+                         nsectors);
+    }
+
+  if (ret < 0)
+    {
+      ferr("ERROR: Failed to write sector %ld: %d\n",
+           (long)run[0]->cs_sector, ret);
+      return ret;
+    }
+
+  for (i = 0; i < nsectors; i++)
+    {
+      run[i]->cs_dirty = false;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_cacheget
+ *
+ * Description:
+ *   Return the entry for a sector, allocating the least recently used entry
+ *   if the sector is not cached.  The entry is made the most recently used
+ *   one.  A newly allocated entry is not valid.
+ *
+ ****************************************************************************/
+
+static FAR struct fat_cachesect_s *
+fat_cacheget(FAR struct fat_mountpt_s *fs, off_t sector, FAR int *result)
+{
+  FAR struct fat_cachesect_s *cs;
+  int ret;
+
+  *result = OK;
+  cs = fat_cachefind(fs, sector);
+  if (cs == NULL)
+    {
+      cs = (FAR struct fat_cachesect_s *)fs->fs_cachelru.tail;
+
+      /* Replacing a dirty sector: write back all dirty sectors so that they
+       * are coalesced into as few transfers as possible.
+       */
+
+      if (cs->cs_dirty)
+        {
+          ret = fat_cacheflush(fs);
+          if (ret < 0)
+            {
+              *result = ret;
+              return NULL;
+            }
+        }
+
+      if (cs->cs_valid)
+        {
+          fat_cacheunhash(fs, cs);
+        }
+
+      cs->cs_sector = sector;
+      cs->cs_hnext  = fs->fs_cachehash[fat_cachehash(sector)];
+      fs->fs_cachehash[fat_cachehash(sector)] = cs;
+    }
+
+  fat_cachetouch(fs, cs);
+  return cs;
+}
+
+/****************************************************************************
+ * Name: fat_cachefill
+ *
+ * Description:
+ *   Read a sector that is not cached.  If the read continues a sequential
+ *   access, read ahead the following sectors with the same transfer.
+ *
+ ****************************************************************************/
+
+static int fat_cachefill(FAR struct fat_mountpt_s *fs,
+                         FAR struct fat_cachesect_s *cs)
+{
+  FAR struct fat_cachesect_s *ra;
+  off_t sector = cs->cs_sector;
+  unsigned int nsectors = 1;
+  unsigned int i;
+  int ret;
+
+  if (fs->fs_burstbuffer != NULL && sector == fs->fs_cachenext)
+    {
+      nsectors = FAT_CACHE_BURST;
+      if (sector + (off_t)nsectors > fs->fs_hwnsectors)
+        {
+          nsectors = fs->fs_hwnsectors - sector;
+        }
+    }
+
+  if (nsectors <= 1)
+    {
+      return fat_blkread(fs, cs->cs_buffer, sector, 1);
+    }
+
+  ret = fat_blkread(fs, fs->fs_burstbuffer, sector, nsectors);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  memcpy(cs->cs_buffer, fs->fs_burstbuffer, fs->fs_hwsectorsize);
+  cs->cs_valid = true;
+
+  /* Insert the read-ahead sectors right behind the requested one.  Only
+   * clean sectors are replaced, so no write-back is needed here.
+   */
+
+  for (i = 1; i < nsectors; i++)
+    {
+      if (fat_cachefind(fs, sector + i) != NULL)
+        {
+          continue;
+        }
+
+      ra = (FAR struct fat_cachesect_s *)fs->fs_cachelru.tail;
+      if (ra == cs || ra->cs_dirty)
+        {
+          break;
+        }
+
+      if (ra->cs_valid)
+        {
+          fat_cacheunhash(fs, ra);
+        }
+
+      ra->cs_sector = sector + i;
+      ra->cs_hnext  = fs->fs_cachehash[fat_cachehash(sector + i)];
+      fs->fs_cachehash[fat_cachehash(sector + i)] = ra;
+      memcpy(ra->cs_buffer, &fs->fs_burstbuffer[i * fs->fs_hwsectorsize],
+             fs->fs_hwsectorsize);
+      ra->cs_valid = true;
+      fat_cachetouch(fs, ra);
+    }
+
+  fat_cachetouch(fs, cs);
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fat_cacheinit
+ *
+ * Description:
+ *   Allocate the sector cache of a mountpoint.  fs_hwsectorsize and
+ *   fs_hwnsectors must be valid.
+ *
+ ****************************************************************************/
+
+int fat_cacheinit(FAR struct fat_mountpt_s *fs)
+{
+  FAR struct fat_cachesect_s *cs;
+  int i;
+
+  /* The entries are followed by the hash table and the dirty sector array */
+
+  fs->fs_cache = (FAR struct fat_cachesect_s *)
+    kmm_zalloc(FAT_CACHE_NSECTORS *
+               (sizeof(struct fat_cachesect_s) +
+                2 * sizeof(FAR struct fat_cachesect_s *)));
+  if (fs->fs_cache == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  fs->fs_cachehash = (FAR struct fat_cachesect_s **)
+    &fs->fs_cache[FAT_CACHE_NSECTORS];
+  fs->fs_cachedirty = &fs->fs_cachehash[FAT_CACHE_NSECTORS];
+
+  fs->fs_cachebuffer = (FAR uint8_t *)
+    fat_io_alloc(FAT_CACHE_NSECTORS * fs->fs_hwsectorsize);
+  if (fs->fs_cachebuffer == NULL)
+    {
+      goto errout_with_cache;
+    }
+
+  if (FAT_CACHE_BURST > 1)
+    {
+      fs->fs_burstbuffer = (FAR uint8_t *)
+        fat_io_alloc(FAT_CACHE_BURST * fs->fs_hwsectorsize);
+      if (fs->fs_burstbuffer == NULL)
+        {
+          goto errout_with_buffer;
+        }
+    }
+
+  dq_init(&fs->fs_cachelru);
+  for (i = 0; i < FAT_CACHE_NSECTORS; i++)
+    {
+      cs = &fs->fs_cache[i];
+      cs->cs_buffer = &fs->fs_cachebuffer[i * fs->fs_hwsectorsize];
+      dq_addlast(&cs->cs_link, &fs->fs_cachelru);
+    }
+
+  fs->fs_cachenext = -1;
+  return OK;
+
+errout_with_buffer:
+  fat_io_free(fs->fs_cachebuffer, FAT_CACHE_NSECTORS * fs->fs_hwsectorsize);
+  fs->fs_cachebuffer = NULL;
+
+errout_with_cache:
+  kmm_free(fs->fs_cache);
+  fs->fs_cache = NULL;
+  return -ENOMEM;
+}
+
+/****************************************************************************
+ * Name: fat_cacheuninit
+ *
+ * Description:
+ *   Free the sector cache of a mountpoint.  Dirty sectors are discarded,
+ *   call fat_cacheflush() first to keep them.
+ *
+ ****************************************************************************/
+
+void fat_cacheuninit(FAR struct fat_mountpt_s *fs)
+{
+  if (fs->fs_cache != NULL)
+    {
+      if (fs->fs_burstbuffer != NULL)
+        {
+          fat_io_free(fs->fs_burstbuffer,
+                      FAT_CACHE_BURST * fs->fs_hwsectorsize);
+          fs->fs_burstbuffer = NULL;
+        }
+
+      fat_io_free(fs->fs_cachebuffer,
+                  FAT_CACHE_NSECTORS * fs->fs_hwsectorsize);
+      fs->fs_cachebuffer = NULL;
+
+      kmm_free(fs->fs_cache);
+      fs->fs_cache = NULL;
+    }
+}
+
+/****************************************************************************
+ * Name: fat_cacheread
+ *
+ * Description:
+ *   Read sectors through the cache.  Single sectors are served from and
+ *   loaded into the cache.  Larger transfers go directly to the media;
+ *   sectors with unwritten changes are then taken from the cache.
+ *
+ ****************************************************************************/
+
+int fat_cacheread(FAR struct fat_mountpt_s *fs, FAR uint8_t *buffer,
+                  off_t sector, unsigned int nsectors)
+{
+  FAR struct fat_cachesect_s *cs;
+  int ret;
+  int i;
+
+  if (nsectors == 1)
+    {
+      cs = fat_cacheget(fs, sector, &ret);
+      if (cs == NULL)
+        {
+          return ret;
+        }
+
+      if (!cs->cs_valid)
+        {
+          ret = fat_cachefill(fs, cs);
+          if (ret < 0)
+            {
+              fat_cacheunhash(fs, cs);
+              return ret;
+            }
+
+          cs->cs_valid = true;
+        }
+
+      memcpy(buffer, cs->cs_buffer, fs->fs_hwsectorsize);
+      fs->fs_cachenext = sector + 1;
+      return OK;
+    }
+
+  ret = fat_blkread(fs, buffer, sector, nsectors);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  for (i = 0; i < FAT_CACHE_NSECTORS; i++)
+    {
+      cs = &fs->fs_cache[i];
+      if (cs->cs_dirty && cs->cs_sector >= sector &&
+          cs->cs_sector < sector + (off_t)nsectors)
+        {
+          memcpy(&buffer[(cs->cs_sector - sector) * fs->fs_hwsectorsize],
+                 cs->cs_buffer, fs->fs_hwsectorsize);
+        }
+    }
+
+  fs->fs_cachenext = sector + nsectors;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_cachewrite
+ *
+ * Description:
+ *   Write sectors through the cache.  With write-back, single sectors are
+ *   only written to the cache.  Larger transfers go directly to the media
+ *   and update the cached copies.
+ *
+ ****************************************************************************/
+
+int fat_cachewrite(FAR struct fat_mountpt_s *fs, FAR uint8_t *buffer,
+                   off_t sector, unsigned int nsectors)
+{
+  FAR struct fat_cachesect_s *cs;
+  int ret;
+  int i;
+
+  if (nsectors == 1)
+    {
+      cs = fat_cacheget(fs, sector, &ret);
+      if (cs == NULL)
+        {
+          return ret;
+        }
+
+#ifndef CONFIG_FAT_SECTORCACHE_WRITEBACK
+      ret = fat_blkwrite(fs, buffer, sector, 1);
+      if (ret < 0)
+        {
+          fat_cacheunhash(fs, cs);
+          return ret;
+        }
+#endif
+
+      memcpy(cs->cs_buffer, buffer, fs->fs_hwsectorsize);
+      cs->cs_valid = true;
+#ifdef CONFIG_FAT_SECTORCACHE_WRITEBACK
+      cs->cs_dirty = true;
+#endif
+      return OK;
+    }
+
+  ret = fat_blkwrite(fs, buffer, sector, nsectors);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  for (i = 0; i < FAT_CACHE_NSECTORS; i++)
+    {
+      cs = &fs->fs_cache[i];
+      if (cs->cs_valid && cs->cs_sector >= sector &&
+          cs->cs_sector < sector + (off_t)nsectors)
+        {
+          memcpy(cs->cs_buffer,
+                 &buffer[(cs->cs_sector - sector) * fs->fs_hwsectorsize],
+                 fs->fs_hwsectorsize);
+          cs->cs_dirty = false;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_cacheflush
+ *
+ * Description:
+ *   Write all dirty sectors of the cache to the media.  The dirty sectors
+ *   are sorted once, so that contiguous dirty sectors are adjacent and are
+ *   written with one transfer.
+ *
+ ****************************************************************************/
+
+int fat_cacheflush(FAR struct fat_mountpt_s *fs)
+{
+  FAR struct fat_cachesect_s **dirty = fs->fs_cachedirty;
+  FAR struct fat_cachesect_s *cs;
+  unsigned int ndirty = 0;
+  unsigned int nsectors;
+  unsigned int i;
+  int ret;
+
+  if (fs->fs_cache == NULL)
+    {
+      return OK;
+    }
+
+  for (i = 0; i < FAT_CACHE_NSECTORS; i++)
+    {
+      cs = &fs->fs_cache[i];
+      if (cs->cs_dirty)
+        {
+          dirty[ndirty++] = cs;
+        }
+    }
+
+  if (ndirty > 1)
+    {
+      qsort(dirty, ndirty, sizeof(FAR struct fat_cachesect_s *),
+            fat_cachecompare);
+    }
+
+  for (i = 0; i < ndirty; i += nsectors)
+    {
+      nsectors = 1;
+      if (fs->fs_burstbuffer != NULL)
+        {
+          while (i + nsectors < ndirty && nsectors < FAT_CACHE_BURST &&
+                 dirty[i + nsectors]->cs_sector ==
+                 dirty[i]->cs_sector + (off_t)nsectors)
+            {
+              nsectors++;
+            }
+        }
+
+      ret = fat_cachewriterun(fs, &dirty[i], nsectors);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  return OK;
+}
+
+#endif /* CONFIG_FAT_SECTORCACHE */
@@ -525,6 +525,16 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
       goto errout;
     }
 
+#ifdef CONFIG_FAT_SECTORCACHE
+  /* Allocate the sector cache */
+
+  ret = fat_cacheinit(fs);
+  if (ret < 0)
+    {
+      goto errout_with_buffer;
+    }
+#endif
+
   /* Search FAT boot record on the drive.  First check the MBR at sector
    * zero.  This could be either the boot record or a partition that refers
    * to the boot record.
@@ -653,6 +663,9 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
   return OK;
 
 errout_with_buffer:
+#ifdef CONFIG_FAT_SECTORCACHE
+  fat_cacheuninit(fs);
+#endif
   fat_io_free(fs->fs_buffer, fs->fs_hwsectorsize);
   fs->fs_buffer = 0;
 
@@ -718,6 +731,14 @@ int fat_hwread(struct fat_mountpt_s *fs, uint8_t *buffer,  off_t sector,
                unsigned int nsectors)
 {
   int ret = -ENODEV;
+
+#ifdef CONFIG_FAT_SECTORCACHE
+  if (fs && fs->fs_cache)
+    {
+      return fat_cacheread(fs, buffer, sector, nsectors);
+    }
+#endif
+
   if (fs && fs->fs_blkdriver)
     {
       struct inode *inode = fs->fs_blkdriver;
@@ -751,6 +772,14 @@ int fat_hwwrite(struct fat_mountpt_s *fs, uint8_t *buffer, off_t sector,
                 unsigned int nsectors)
 {
   int ret = -ENODEV;
+
+#ifdef CONFIG_FAT_SECTORCACHE
+  if (fs && fs->fs_cache)
+    {
+      return fat_cachewrite(fs, buffer, sector, nsectors);
+    }
+#endif
+
   if (fs && fs->fs_blkdriver)
     {
       struct inode *inode = fs->fs_blkdriver;
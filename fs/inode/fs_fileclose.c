@@ -80,6 +80,10 @@ int file_close(FAR struct file *filep)
 
   if (inode)
     {
+      /* Remove the epoll registrations while the driver is still open */
+
+      epoll_detach(filep);
+
       /* Close the file, driver, or mountpoint. */
 
       if (inode->u.i_ops && inode->u.i_ops->close)
@@ -25,8 +25,11 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdint.h>
 #include <string.h>
+#include <strings.h>
 #include <assert.h>
+#include <fcntl.h>
 #include <sched.h>
 #include <errno.h>
 
@@ -36,6 +39,19 @@
 
 #include "inode/inode.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define FILES_PERBLOCK   FILELIST_PERBLOCK
+#define FILES_MAXROWS    FILELIST_MAXROWS
+
+#if FILES_PERBLOCK >= 32
+#  define FILES_ROWMASK  UINT32_MAX
+#else
+#  define FILES_ROWMASK  ((UINT32_C(1) << FILES_PERBLOCK) - 1)
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -55,6 +71,99 @@ static int _files_semtake(FAR struct filelist *list)
 
 #define _files_semgive(list) nxsem_post(&list->fl_sem)
 
+/****************************************************************************
+ * Name: files_fgetalloc
+ *
+ * Description:
+ *   Like files_fget(), but allocate the block of 'fd' if it is not there
+ *   yet.  Returns NULL if out of memory.
+ *
+ * Assumptions:
+ *   Caller holds the list semaphore.
+ *
+ ****************************************************************************/
+
+static FAR struct file *files_fgetalloc(FAR struct filelist *list, int fd)
+{
+  FAR struct file *block;
+  int row = fd / FILES_PERBLOCK;
+
+  DEBUGASSERT(row < FILES_MAXROWS);
+
+  block = list->fl_files[row];
+  if (block == NULL)
+    {
+      /* Publish the block only once it is cleared, files_fget() may look
+       * at it at any time.
+       */
+
+      block = kmm_zalloc(FILES_PERBLOCK * sizeof(struct file));
+      if (block == NULL)
+        {
+          return NULL;
+        }
+
+      list->fl_files[row] = block;
+    }
+
+  return &block[fd % FILES_PERBLOCK];
+}
+
+/****************************************************************************
+ * Name: files_findfree
+ *
+ * Description:
+ *   Return the lowest free file descriptor that is not below 'minfd'.  The
+ *   result may lie in a block that has not been allocated yet or beyond
+ *   CONFIG_NFILE_DESCRIPTORS.
+ *
+ * Assumptions:
+ *   Caller holds the list semaphore.
+ *
+ ****************************************************************************/
+
+static int files_findfree(FAR struct filelist *list, int minfd)
+{
+  int row = minfd / FILES_PERBLOCK;
+  uint32_t mask;
+  int word;
+
+  if (row >= FILES_MAXROWS)
+    {
+      return minfd;
+    }
+
+  /* Look in the block of 'minfd' first, ignoring the descriptors below */
+
+  mask = ~list->fl_used[row] & FILES_ROWMASK &
+         ~((UINT32_C(1) << (minfd % FILES_PERBLOCK)) - 1);
+  if (mask != 0)
+    {
+      return row * FILES_PERBLOCK + ffs((int)mask) - 1;
+    }
+
+  /* Then find the first block above it that is not full */
+
+  for (row++; row < FILES_MAXROWS; row = (word + 1) * 32)
+    {
+      word = row / 32;
+      mask = ~list->fl_full[word] & ~((UINT32_C(1) << (row % 32)) - 1);
+      if (mask != 0)
+        {
+          row = word * 32 + ffs((int)mask) - 1;
+          if (row >= FILES_MAXROWS)
+            {
+              break;
+            }
+
+          mask = ~list->fl_used[row] & FILES_ROWMASK;
+          return row * FILES_PERBLOCK + ffs((int)mask) - 1;
+        }
+    }
+
+  return FILES_MAXROWS * FILES_PERBLOCK;
+}
+
 /****************************************************************************
  * Name: _files_close
  *
@@ -76,6 +185,10 @@ static int _files_close(FAR struct file *filep)
 
   if (inode)
     {
+      /* Remove the epoll registrations while the driver is still open */
+
+      epoll_detach(filep);
+
       /* Close the file, driver, or mountpoint. */
 
       if (inode->u.i_ops && inode->u.i_ops->close)
@@ -129,6 +242,12 @@ void files_initlist(FAR struct filelist *list)
   /* Initialize the list access mutex */
 
   nxsem_init(&list->fl_sem, 0, 1);
+
+  /* No file descriptor blocks are allocated until they are used */
+
+  memset(list->fl_used, 0, sizeof(list->fl_used));
+  memset(list->fl_full, 0, sizeof(list->fl_full));
+  memset(list->fl_files, 0, sizeof(list->fl_files));
 }
 
 /****************************************************************************
@@ -150,16 +269,133 @@ void files_releaselist(FAR struct filelist *list)
    * because there should not be any references in this context.
    */
 
-  for (i = 0; i < CONFIG_NFILE_DESCRIPTORS; i++)
+  for (i = 0; i < FILES_MAXROWS; i++)
     {
-      _files_close(&list->fl_files[i]);
+      FAR struct file *block = list->fl_files[i];
+      int j;
+
+      if (block != NULL)
+        {
+          for (j = 0; j < FILES_PERBLOCK; j++)
+            {
+              _files_close(&block[j]);
+            }
+
+          list->fl_files[i] = NULL;
+          kmm_free(block);
+        }
     }
 
+  memset(list->fl_used, 0, sizeof(list->fl_used));
+  memset(list->fl_full, 0, sizeof(list->fl_full));
+
   /* Destroy the semaphore */
 
   nxsem_destroy(&list->fl_sem);
 }
 
+/****************************************************************************
+ * Name: files_fget
+ *
+ * Description:
+ *   Return the file that underlies the file descriptor 'fd' in 'list', or
+ *   NULL if no descriptor in its block has been used yet.
+ *
+ ****************************************************************************/
+
+FAR struct file *files_fget(FAR struct filelist *list, int fd)
+{
+  FAR struct file *block;
+
+  if ((unsigned int)fd >= CONFIG_NFILE_DESCRIPTORS)
+    {
+      return NULL;
+    }
+
+  /* A block is only set up once and never moves until the list is
+   * released, so no lock is needed to look it up.
+   */
+
+  block = list->fl_files[fd / FILES_PERBLOCK];
+  return block != NULL ? &block[fd % FILES_PERBLOCK] : NULL;
+}
+
+/****************************************************************************
+ * Name: files_setused
+ *
+ * Description:
+ *   Mark the file descriptor 'fd' as used or free in the allocation bitmaps
+ *   of 'list'.
+ *
+ * Assumptions:
+ *   Caller holds the list semaphore.
+ *
+ ****************************************************************************/
+
+void files_setused(FAR struct filelist *list, int fd, bool used)
+{
+  int row = fd / FILES_PERBLOCK;
+  uint32_t rowbit = UINT32_C(1) << (row % 32);
+
+  DEBUGASSERT(row < FILES_MAXROWS);
+
+  if (used)
+    {
+      list->fl_used[row] |= UINT32_C(1) << (fd % FILES_PERBLOCK);
+      if (list->fl_used[row] == FILES_ROWMASK)
+        {
+          list->fl_full[row / 32] |= rowbit;
+        }
+    }
+  else
+    {
+      list->fl_used[row] &= ~(UINT32_C(1) << (fd % FILES_PERBLOCK));
+      list->fl_full[row / 32] &= ~rowbit;
+    }
+}
+
+/****************************************************************************
+ * Name: files_duplist
+ *
+ * Description:
+ *   Duplicate the first 'nfds' file descriptors of the parent list that are
+ *   open and not marked O_CLOEXEC into the child list.
+ *
+ ****************************************************************************/
+
+void files_duplist(FAR struct filelist *plist, FAR struct filelist *clist,
+                   int nfds)
+{
+  FAR struct file *parent;
+  FAR struct file *child;
+  int fd;
+
+  /* The child list is not shared with anybody yet */
+
+  for (fd = 0; fd < nfds && fd < CONFIG_NFILE_DESCRIPTORS; fd++)
+    {
+      parent = files_fget(plist, fd);
+      if (parent == NULL)
+        {
+          /* Skip the rest of the unused block */
+
+          fd = (fd / FILES_PERBLOCK + 1) * FILES_PERBLOCK - 1;
+          continue;
+        }
+
+      if (parent->f_inode == NULL || (parent->f_oflags & O_CLOEXEC) != 0)
+        {
+          continue;
+        }
+
+      child = files_fgetalloc(clist, fd);
+      if (child != NULL && file_dup2(parent, child) >= 0)
+        {
+          files_setused(clist, fd, true);
+        }
+    }
+}
+
 /****************************************************************************
  * Name: file_dup2
  *
@@ -289,6 +525,67 @@ errout_with_sem:
   return ret;
 }
 
+/****************************************************************************
+ * Name: files_dup2
+ *
+ * Description:
+ *   Clone a file structure into the file descriptor 'fd2' of the current
+ *   task, allocating the block of 'fd2' if needed.
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is return on
+ *   any failure.
+ *
+ ****************************************************************************/
+
+int files_dup2(FAR struct file *filep1, int fd2)
+{
+  FAR struct filelist *list;
+  FAR struct file *filep2;
+  int ret;
+
+  if ((unsigned int)fd2 >= CONFIG_NFILE_DESCRIPTORS)
+    {
+      return -EBADF;
+    }
+
+  list = nxsched_get_files();
+  if (list == NULL)
+    {
+      return -EAGAIN;
+    }
+
+  /* Reserve 'fd2' so that it cannot be allocated while it is set up */
+
+  ret = _files_semtake(list);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  filep2 = files_fgetalloc(list, fd2);
+  if (filep2 == NULL)
+    {
+      _files_semgive(list);
+      return -ENOMEM;
+    }
+
+  files_setused(list, fd2, true);
+  _files_semgive(list);
+
+  ret = file_dup2(filep1, filep2);
+
+  /* Free the descriptor again if nothing is open on it now */
+
+  if (filep2->f_inode == NULL && _files_semtake(list) >= 0)
+    {
+      files_setused(list, fd2, false);
+      _files_semgive(list);
+    }
+
+  return ret;
+}
+
 /****************************************************************************
  * Name: files_allocate
  *
@@ -301,8 +598,9 @@ errout_with_sem:
 int files_allocate(FAR struct inode *inode, int oflags, off_t pos, int minfd)
 {
   FAR struct filelist *list;
+  FAR struct file *filep;
   int ret;
-  int i;
+  int fd;
 
   /* Get the file descriptor list.  It should not be NULL in this context. */
 
@@ -317,21 +615,24 @@ int files_allocate(FAR struct inode *inode, int oflags, off_t pos, int minfd)
       return ret;
     }
 
-  for (i = minfd; i < CONFIG_NFILE_DESCRIPTORS; i++)
+  /* Find the lowest free descriptor and allocate its block if needed */
+
+  fd = files_findfree(list, minfd);
+  if (fd >= CONFIG_NFILE_DESCRIPTORS ||
+      (filep = files_fgetalloc(list, fd)) == NULL)
     {
-      if (!list->fl_files[i].f_inode)
-        {
-          list->fl_files[i].f_oflags = oflags;
-          list->fl_files[i].f_pos    = pos;
-          list->fl_files[i].f_inode  = inode;
-          list->fl_files[i].f_priv   = NULL;
-          _files_semgive(list);
-          return i;
-        }
+      _files_semgive(list);
+      return ERROR;
     }
 
+  filep->f_oflags = oflags;
+  filep->f_pos    = pos;
+  filep->f_inode  = inode;
+  filep->f_priv   = NULL;
+  files_setused(list, fd, true);
+
   _files_semgive(list);
-  return ERROR;
+  return fd;
 }
 
 /****************************************************************************
@@ -349,6 +650,7 @@ int files_allocate(FAR struct inode *inode, int oflags, off_t pos, int minfd)
 int files_close(int fd)
 {
   FAR struct filelist *list;
+  FAR struct file     *filep;
   int                  ret;
 
   /* Get the thread-specific file list.  It should never be NULL in this
@@ -358,23 +660,30 @@ int files_close(int fd)
   list = nxsched_get_files();
   DEBUGASSERT(list != NULL);
 
+  ret = _files_semtake(list);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
   /* If the file was properly opened, there should be an inode assigned */
 
-  if (fd < 0 || fd >= CONFIG_NFILE_DESCRIPTORS ||
-      !list->fl_files[fd].f_inode)
+  filep = files_fget(list, fd);
+  if (filep == NULL || filep->f_inode == NULL)
     {
+      _files_semgive(list);
       return -EBADF;
     }
 
-  /* Perform the protected close operation */
+  /* Perform the protected close operation and free the descriptor */
 
-  ret = _files_semtake(list);
-  if (ret >= 0)
+  ret = _files_close(filep);
+  if (filep->f_inode == NULL)
     {
-      ret = _files_close(&list->fl_files[fd]);
-      _files_semgive(list);
+      files_setused(list, fd, false);
     }
 
+  _files_semgive(list);
   return ret;
 }
 
@@ -390,20 +699,24 @@ int files_close(int fd)
 void files_release(int fd)
 {
   FAR struct filelist *list;
+  FAR struct file *filep;
   int ret;
 
   list = nxsched_get_files();
   DEBUGASSERT(list != NULL);
 
-  if (fd >= 0 && fd < CONFIG_NFILE_DESCRIPTORS)
+  ret = _files_semtake(list);
+  if (ret >= 0)
     {
-      ret = _files_semtake(list);
-      if (ret >= 0)
+      filep = files_fget(list, fd);
+      if (filep != NULL)
         {
-          list->fl_files[fd].f_oflags  = 0;
-          list->fl_files[fd].f_pos     = 0;
-          list->fl_files[fd].f_inode = NULL;
-          _files_semgive(list);
+          filep->f_oflags = 0;
+          filep->f_pos    = 0;
+          filep->f_inode  = NULL;
+          files_setused(list, fd, false);
         }
+
+      _files_semgive(list);
     }
 }
@@ -0,0 +1,232 @@
+/****************************************************************************
+ * fs/inode/fs_inodecache.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <nuttx/fs/fs.h>
+
+#include "inode/inode.h"
+
+#ifdef CONFIG_FS_INODE_CACHE
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One cached search of a path segment among the children of a directory.
+ * An entry is forgotten whenever the children of 'parent' change and when
+ * 'parent' itself is unlinked, so the pointers stay valid for as long as
+ * the entry is.
+ */
+
+struct inode_cache_s
+{
+  FAR struct inode *parent;  /* The directory that was searched */
+  FAR struct inode *node;    /* The child found, NULL if there is none */
+  FAR struct inode *peer;    /* The child to the "left" of the name */
+  char              name[CONFIG_FS_INODE_CACHE_NAMELEN + 1];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct inode_cache_s g_inode_cache[CONFIG_FS_INODE_CACHE_SIZE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inode_cache_hash
+ *
+ * Description:
+ *   Hash the path segment 'name' together with its directory.  Returns the
+ *   cache slot, or NULL if the segment is too long to be cached.
+ *
+ ****************************************************************************/
+
+static FAR struct inode_cache_s *
+inode_cache_hash(FAR struct inode *parent, FAR const char *name,
+                 FAR size_t *namelen)
+{
+  uint32_t hash = 2166136261u ^ (uint32_t)((uintptr_t)parent >> 4);
+  size_t len;
+
+  for (len = 0; name[len] != '\0' && name[len] != '/'; len++)
+    {
+      if (len >= CONFIG_FS_INODE_CACHE_NAMELEN)
+        {
+          return NULL;
+        }
+
+      hash = (hash ^ (uint8_t)name[len]) * 16777619u;
+    }
+
+  *namelen = len;
+  return &g_inode_cache[hash % CONFIG_FS_INODE_CACHE_SIZE];
+}
+
+/****************************************************************************
+ * Name: inode_cache_forget
+ *
+ * Description:
+ *   Forget the cached searches among the children of 'parent'.
+ *
+ ****************************************************************************/
+
+static void inode_cache_forget(FAR struct inode *parent)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_FS_INODE_CACHE_SIZE; i++)
+    {
+      if (g_inode_cache[i].parent == parent)
+        {
+          g_inode_cache[i].parent = NULL;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: inode_cache_forgettree
+ *
+ * Description:
+ *   Forget the cached searches among the children of 'node' and of all of
+ *   the directories below it.
+ *
+ ****************************************************************************/
+
+static void inode_cache_forgettree(FAR struct inode *node)
+{
+  FAR struct inode *child;
+
+  inode_cache_forget(node);
+
+  for (child = node->i_child; child != NULL; child = child->i_peer)
+    {
+      inode_cache_forgettree(child);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inode_cache_lookup
+ *
+ * Description:
+ *   Look up the outcome of a previous search for the path segment 'name'
+ *   among the children of 'parent'.  On a hit, return true with the child
+ *   (NULL if there is none) and the child to the "left" of the name.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore
+ *
+ ****************************************************************************/
+
+bool inode_cache_lookup(FAR struct inode *parent, FAR const char *name,
+                        FAR struct inode **node, FAR struct inode **peer)
+{
+  FAR struct inode_cache_s *entry;
+  size_t len;
+
+  entry = inode_cache_hash(parent, name, &len);
+  if (entry == NULL || entry->parent != parent ||
+      entry->name[len] != '\0' || strncmp(entry->name, name, len) != 0)
+    {
+      return false;
+    }
+
+  *node = entry->node;
+  *peer = entry->peer;
+  return true;
+}
+
+/****************************************************************************
+ * Name: inode_cache_add
+ *
+ * Description:
+ *   Remember the outcome of searching for the path segment 'name' among
+ *   the children of 'parent'.  'node' is NULL if the name was not found.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore
+ *
+ ****************************************************************************/
+
+void inode_cache_add(FAR struct inode *parent, FAR const char *name,
+                     FAR struct inode *node, FAR struct inode *peer)
+{
+  FAR struct inode_cache_s *entry;
+  size_t len;
+
+  entry = inode_cache_hash(parent, name, &len);
+  if (entry != NULL)
+    {
+      entry->parent = parent;
+      entry->node   = node;
+      entry->peer   = peer;
+      memcpy(entry->name, name, len);
+      entry->name[len] = '\0';
+    }
+}
+
+/****************************************************************************
+ * Name: inode_cache_invalidate
+ *
+ * Description:
+ *   Forget the cached lookups that a change to the tree affects:  Those
+ *   among the children of 'parent', into or from which 'node' was linked
+ *   or unlinked, and those of every path that has 'node' as a prefix.
+ *   Lookups in the rest of the tree stay cached.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore
+ *
+ ****************************************************************************/
+
+void inode_cache_invalidate(FAR struct inode *parent,
+                            FAR struct inode *node)
+{
+  /* Searches of the root directory are never cached */
+
+  if (parent != NULL)
+    {
+      inode_cache_forget(parent);
+    }
+
+  /* A node that is unlinked may be freed and its memory reused by a new
+   * inode, so nothing below it may stay cached either.
+   */
+
+  inode_cache_forgettree(node);
+}
+
+#endif /* CONFIG_FS_INODE_CACHE */
@@ -109,6 +109,7 @@ FAR struct inode *inode_unlink(FAR const char *path)
         }
 
       node->i_peer = NULL;
+      inode_cache_invalidate(desc.parent, node);
     }
 
   RELEASE_SEARCH(&desc);
@@ -126,6 +126,8 @@ static void inode_insert(FAR struct inode *node,
       node->i_peer    = parent->i_child;
       parent->i_child = node;
     }
+
+  inode_cache_invalidate(parent, node);
 }
 
 /****************************************************************************
@@ -239,6 +239,9 @@ static int _inode_search(FAR struct inode_search_s *desc)
   FAR struct inode *left    = NULL;
   FAR struct inode *above   = NULL;
   FAR const char   *relpath = NULL;
+#ifdef CONFIG_FS_INODE_CACHE
+  bool cached = false;
+#endif
   int ret = -ENOENT;
 
   /* Get the search path, skipping over the leading '/'.  The leading '/' is
@@ -298,6 +301,13 @@ static int _inode_search(FAR struct inode_search_s *desc)
            *       below this one
            */
 
+#ifdef CONFIG_FS_INODE_CACHE
+          if (above != NULL && !cached)
+            {
+              inode_cache_add(above, name, node, left);
+            }
+#endif
+
           name = inode_nextname(name);
           if (*name == '\0' || INODE_IS_MOUNTPT(node))
             {
@@ -403,10 +413,25 @@ static int _inode_search(FAR struct inode_search_s *desc)
               above = node;
               left  = NULL;
               node  = node->i_child;
+
+#ifdef CONFIG_FS_INODE_CACHE
+              /* Skip the walk along the peers if its outcome is cached */
+
+              cached = inode_cache_lookup(above, name, &node, &left);
+#endif
             }
         }
     }
 
+#ifdef CONFIG_FS_INODE_CACHE
+  /* Remember that the name does not exist below this parent */
+
+  if (node == NULL && above != NULL && !cached)
+    {
+      inode_cache_add(above, name, NULL, left);
+    }
+#endif
+
   /* The node may or may not be null as per one of the following four cases:
    *
    * With node = NULL
@@ -263,6 +263,57 @@ void inode_free(FAR struct inode *node);
 
 const char *inode_nextname(FAR const char *name);
 
+/****************************************************************************
+ * Name: inode_cache_lookup
+ *
+ * Description:
+ *   Look up the outcome of a previous search for the path segment 'name'
+ *   among the children of 'parent'.  On a hit, return true with the child
+ *   (NULL if there is none) and the child to the "left" of the name.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_INODE_CACHE
+bool inode_cache_lookup(FAR struct inode *parent, FAR const char *name,
+                        FAR struct inode **node, FAR struct inode **peer);
+
+/****************************************************************************
+ * Name: inode_cache_add
+ *
+ * Description:
+ *   Remember the outcome of searching for the path segment 'name' among
+ *   the children of 'parent'.  'node' is NULL if the name was not found.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore
+ *
+ ****************************************************************************/
+
+void inode_cache_add(FAR struct inode *parent, FAR const char *name,
+                     FAR struct inode *node, FAR struct inode *peer);
+
+/****************************************************************************
+ * Name: inode_cache_invalidate
+ *
+ * Description:
+ *   Forget the cached lookups among the children of 'parent' and below
+ *   'node'.  Must be called whenever 'node' is linked into or unlinked from
+ *   the children of 'parent'.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore
+ *
+ ****************************************************************************/
+
+void inode_cache_invalidate(FAR struct inode *parent,
+                            FAR struct inode *node);
+#else
+#  define inode_cache_invalidate(parent, node)
+#endif
+
 /****************************************************************************
  * Name: inode_root_reserve
  *
@@ -414,6 +465,31 @@ int files_close(int fd);
 
 void files_release(int fd);
 
+/****************************************************************************
+ * Name: files_setused
+ *
+ * Description:
+ *   Mark the file descriptor 'fd' as used or free in the allocation bitmaps
+ *   of 'list'.
+ *
+ * Assumptions:
+ *   Caller holds the list semaphore.
+ *
+ ****************************************************************************/
+
+void files_setused(FAR struct filelist *list, int fd, bool used);
+
+/****************************************************************************
+ * Name: files_dup2
+ *
+ * Description:
+ *   Clone 'filep1' to the specific file descriptor 'fd2' of the current
+ *   task, closing 'fd2' first if it is open.  This is the heart of dup2.
+ *
+ ****************************************************************************/
+
+int files_dup2(FAR struct file *filep1, int fd2);
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
@@ -207,7 +207,7 @@ FAR void *mmap(FAR void *start, size_t length, int prot, int flags,
        * do much better in the KERNEL build using the MMU.
        */
 
-      return rammap(fd, length, offset);
+      return rammap(fd, length, offset, flags);
 #else
       /* Error out.  The errno value was already set by ioctl() */
 
@@ -0,0 +1,125 @@
+/****************************************************************************
+ * fs/mmap/fs_msync.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/mman.h>
+
+#include <stdint.h>
+#include <errno.h>
+#include <debug.h>
+
+#include "inode/inode.h"
+#include "fs_rammap.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: msync
+ *
+ * Description:
+ *   Write the changes of a MAP_SHARED file mapping in the range [addr,
+ *   addr + len) back to the file.  Mappings of XIP media are the media
+ *   itself and MAP_PRIVATE mappings are never written back, so there is
+ *   nothing to do for them.
+ *
+ * Input Parameters:
+ *   addr  - The start of the range
+ *   len   - The length of the range
+ *   flags - MS_ASYNC, MS_SYNC and/or MS_INVALIDATE.  The write-back is
+ *           always synchronous and MS_INVALIDATE has no effect because
+ *           each file has a single copy in memory.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -1 (ERROR) on failure with errno set:
+ *
+ *     EINVAL
+ *       'flags' is invalid.
+ *     ENOMEM
+ *       The range is not mapped by rammap().
+ *
+ ****************************************************************************/
+
+int msync(FAR void *addr, size_t len, int flags)
+{
+#ifdef CONFIG_FS_RAMMAP
+  FAR struct fs_rammap_s *curr;
+  int errcode;
+  int ret;
+
+  if ((flags & ~(MS_ASYNC | MS_SYNC | MS_INVALIDATE)) != 0 ||
+      (flags & (MS_ASYNC | MS_SYNC)) == (MS_ASYNC | MS_SYNC))
+    {
+      errcode = EINVAL;
+      goto errout;
+    }
+
+  rammap_initialize();
+  ret = nxsem_wait(&g_rammaps.exclsem);
+  if (ret < 0)
+    {
+      errcode = -ret;
+      goto errout;
+    }
+
+  /* Find the region containing the range */
+
+  for (curr = g_rammaps.head; curr; curr = curr->flink)
+    {
+      if ((uintptr_t)addr >= (uintptr_t)curr->addr &&
+          (uintptr_t)addr < (uintptr_t)curr->addr + curr->length)
+        {
+          break;
+        }
+    }
+
+  if (!curr)
+    {
+      errcode = ENOMEM;
+      goto errout_with_semaphore;
+    }
+
+  ret = rammap_writeback(curr, addr, len);
+  if (ret < 0)
+    {
+      errcode = -ret;
+      goto errout_with_semaphore;
+    }
+
+  nxsem_post(&g_rammaps.exclsem);
+  return OK;
+
+errout_with_semaphore:
+  nxsem_post(&g_rammaps.exclsem);
+
+errout:
+  set_errno(errcode);
+  return ERROR;
+#else
+  return OK;
+#endif /* CONFIG_FS_RAMMAP */
+}
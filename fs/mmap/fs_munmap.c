@@ -48,10 +48,59 @@
 #include <debug.h>
 
 #include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
 
 #include "inode/inode.h"
 #include "fs_rammap.h"
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: rammap_findrange
+ *
+ * Description:
+ *   Find the range of one mmap() call on a shared region that is unmapped
+ *   by [start, start + length).  A range that matches exactly is preferred,
+ *   otherwise the first range that lies within the unmapped range is
+ *   returned.  The range before it in the list is returned in 'prev'.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_RAMMAP
+static FAR struct fs_rammap_range_s *
+rammap_findrange(FAR struct fs_rammap_s *map, FAR void *start, size_t length,
+                 FAR struct fs_rammap_range_s **prev)
+{
+  FAR struct fs_rammap_range_s *within = NULL;
+  FAR struct fs_rammap_range_s *wprev = NULL;
+  FAR struct fs_rammap_range_s *range;
+  uintptr_t first = (uintptr_t)start;
+  uintptr_t addr;
+
+  for (*prev = NULL, range = map->ranges; range != NULL;
+       *prev = range, range = range->flink)
+    {
+      addr = (uintptr_t)map->addr + range->offset;
+      if (addr == first && range->length == length)
+        {
+          return range;
+        }
+
+      if (within == NULL && addr >= first &&
+          addr + range->length <= first + length)
+        {
+          within = range;
+          wprev  = *prev;
+        }
+    }
+
+  *prev = wprev;
+  return within;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -97,7 +146,8 @@
  *   start   The start address of the mapping to delete.  For this
  *           simplified munmap() implementation, the *must* be the start
  *           address of the memory region (the same address returned by
- *           mmap()).
+ *           mmap()).  For a MAP_SHARED mapping, [start, start + length)
+ *           must contain the whole range returned by one mmap() call.
  *   length  The length region to be umapped.
  *
  * Returned Value:
@@ -109,6 +159,8 @@
 int munmap(FAR void *start, size_t length)
 {
 #ifdef CONFIG_FS_RAMMAP
+  FAR struct fs_rammap_range_s *rprev;
+  FAR struct fs_rammap_range_s *range;
   FAR struct fs_rammap_s *prev;
   FAR struct fs_rammap_s *curr;
   FAR void *newaddr;
@@ -122,7 +174,7 @@ int munmap(FAR void *start, size_t length)
   ret = nxsem_wait(&g_rammaps.exclsem);
   if (ret < 0)
     {
-      errcode = ret;
+      errcode = -ret;
       goto errout;
     }
 
@@ -149,6 +201,62 @@ int munmap(FAR void *start, size_t length)
       goto errout_with_semaphore;
     }
 
+  /* A shared region is used by several mmap() callers, each of which may
+   * have mapped a different part of it.  The callers cannot be told apart,
+   * so each munmap() must remove the whole range of one mmap() call.  The
+   * region is unmapped with the last range.
+   */
+
+  if (curr->shared)
+    {
+      range = rammap_findrange(curr, start, length, &rprev);
+      if (range == NULL)
+        {
+          ferr("ERROR: Cannot unmap part of a shared mapping\n");
+          errcode = ENOSYS;
+          goto errout_with_semaphore;
+        }
+
+      if (rprev != NULL || range->flink != NULL)
+        {
+          /* Write back the changes and keep the region for the others */
+
+          ret = rammap_writeback(curr,
+                                 (FAR uint8_t *)curr->addr + range->offset,
+                                 range->length);
+          if (ret < 0)
+            {
+              errcode = -ret;
+              goto errout_with_semaphore;
+            }
+
+          if (rprev != NULL)
+            {
+              rprev->flink = range->flink;
+            }
+          else
+            {
+              curr->ranges = range->flink;
+            }
+
+          kmm_free(range);
+          nxsem_post(&g_rammaps.exclsem);
+          return OK;
+        }
+
+      start  = curr->addr;
+      length = curr->length;
+    }
+
+  /* Write back the changes of a MAP_SHARED mapping */
+
+  ret = rammap_writeback(curr, start, length);
+  if (ret < 0)
+    {
+      errcode = -ret;
+      goto errout_with_semaphore;
+    }
+
   /* Get the offset from the beginning of the region and the actual number
    * of bytes to "unmap".  All mappings must extend to the end of the region.
    * There is no support for free a block of memory but leaving a block of
@@ -185,7 +293,17 @@ int munmap(FAR void *start, size_t length)
           g_rammaps.head = curr->flink;
         }
 
-      /* Then free the region */
+      /* Then release the file and free the region */
+
+      if (curr->shared)
+        {
+          file_close(&curr->file);
+          kmm_free(curr->ranges);
+          if (curr->saved != NULL)
+            {
+              kmm_free(curr->saved);
+            }
+        }
 
       kumm_free(curr);
     }
@@ -201,6 +319,10 @@ int munmap(FAR void *start, size_t length)
       DEBUGASSERT(newaddr == (FAR void *)(curr->addr));
       UNUSED(newaddr); /* May not be used */
       curr->length = length;
+      if (curr->filelen > length)
+        {
+          curr->filelen = length;
+        }
     }
 
   nxsem_post(&g_rammaps.exclsem);
@@ -41,13 +41,17 @@
 
 #include <sys/types.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 
+#include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
-#include <unistd.h>
+#include <fcntl.h>
 #include <errno.h>
 #include <debug.h>
 
 #include <nuttx/fs/fs.h>
+#include <nuttx/fs/ioctl.h>
 #include <nuttx/kmalloc.h>
 
 #include "inode/inode.h"
@@ -55,6 +59,14 @@
 
 #ifdef CONFIG_FS_RAMMAP
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef MIN
+#  define MIN(a,b) ((a) < (b) ? (a) : (b))
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -63,6 +75,278 @@
 
 struct fs_allmaps_s g_rammaps;
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: rammap_fileid
+ *
+ * Description:
+ *   Identify a file in a mountpoint.  All files of a mountpoint have the
+ *   same inode, so the name returned by FIOC_FILENAME or, if the file
+ *   system does not support it, the serial number reported by fstat() is
+ *   used to tell them apart.  Both are left NULL and zero if the file
+ *   cannot be identified.
+ *
+ ****************************************************************************/
+
+static void rammap_fileid(FAR struct file *filep, FAR const char **name,
+                          FAR ino_t *ino)
+{
+  struct stat buf;
+
+  *name = NULL;
+  *ino  = 0;
+
+  if (INODE_IS_MOUNTPT(filep->f_inode))
+    {
+      if (file_ioctl(filep, FIOC_FILENAME,
+                     (unsigned long)((uintptr_t)name)) < 0)
+        {
+          *name = NULL;
+          if (file_fstat(filep, &buf) >= 0)
+            {
+              *ino = buf.st_ino;
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: rammap_find
+ *
+ * Description:
+ *   Find a MAP_SHARED mapping of the same file that covers the requested
+ *   range.
+ *
+ ****************************************************************************/
+
+static FAR struct fs_rammap_s *rammap_find(FAR struct inode *inode,
+                                           FAR const char *name, ino_t ino,
+                                           size_t length, off_t offset)
+{
+  FAR struct fs_rammap_s *map;
+
+  /* Files in a mountpoint can only be identified by name or serial
+   * number.
+   */
+
+  if (INODE_IS_MOUNTPT(inode) && name == NULL && ino == 0)
+    {
+      return NULL;
+    }
+
+  for (map = g_rammaps.head; map != NULL; map = map->flink)
+    {
+      if (map->shared && map->inode == inode &&
+          (name != NULL ?
+           (map->name != NULL && strcmp(map->name, name) == 0) :
+           map->ino == ino) &&
+          offset >= map->offset &&
+          offset + length <= map->offset + map->length)
+        {
+          return map;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: rammap_read
+ *
+ * Description:
+ *   Read up to 'length' bytes of the file at 'offset' into 'buffer'.
+ *   Return the number of bytes read, which is less than 'length' at the
+ *   end of the file, or a negated errno value.
+ *
+ ****************************************************************************/
+
+static ssize_t rammap_read(FAR struct file *filep, FAR uint8_t *buffer,
+                           size_t length, off_t offset)
+{
+  size_t total = 0;
+  ssize_t nread;
+
+  while (total < length)
+    {
+      nread = file_pread(filep, buffer + total, length - total,
+                         offset + total);
+      if (nread < 0)
+        {
+          /* Handle the special case where the read was interrupted by a
+           * signal.
+           */
+
+          if (nread != -EINTR)
+            {
+              /* All other read errors are bad. */
+
+              ferr("ERROR: Read failed: offset=%d errno=%d\n",
+                   (int)offset, (int)nread);
+              return nread;
+            }
+
+          continue;
+        }
+
+      /* Check for end of file. */
+
+      if (nread == 0)
+        {
+          break;
+        }
+
+      total += nread;
+    }
+
+  return total;
+}
+
+/****************************************************************************
+ * Name: rammap_save
+ *
+ * Description:
+ *   Keep a copy of the file data of a shared region that will be written
+ *   back, so that the pages that changed can be found.  The copy is read
+ *   from the file, because the region may already have been changed by
+ *   users that mapped the file from a read-only descriptor.
+ *
+ ****************************************************************************/
+
+static int rammap_save(FAR struct fs_rammap_s *map, FAR struct file *filep)
+{
+  ssize_t nread;
+
+  if (map->filelen == 0)
+    {
+      return OK;
+    }
+
+  map->saved = (FAR uint8_t *)kmm_malloc(map->filelen);
+  if (map->saved == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  nread = rammap_read(filep, map->saved, map->filelen, map->offset);
+  if (nread < 0)
+    {
+      kmm_free(map->saved);
+      map->saved = NULL;
+      return (int)nread;
+    }
+
+  /* Data that is no longer in the file counts as changed */
+
+  if ((size_t)nread < map->filelen)
+    {
+      memset(map->saved + nread, 0, map->filelen - nread);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: rammap_upgrade
+ *
+ * Description:
+ *   Make the detached file of a shared region writable when the region is
+ *   shared with a user that mapped the file from a writable descriptor, so
+ *   that the changes of that user are written back.
+ *
+ ****************************************************************************/
+
+static int rammap_upgrade(FAR struct fs_rammap_s *map,
+                          FAR struct file *filep)
+{
+  struct file file;
+  int ret;
+
+  if ((filep->f_oflags & O_WROK) == 0 ||
+      (map->file.f_oflags & O_WROK) != 0)
+    {
+      return OK;
+    }
+
+  ret = rammap_save(map, filep);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  memset(&file, 0, sizeof(struct file));
+  ret = file_dup2(filep, &file);
+  if (ret < 0)
+    {
+      if (map->saved != NULL)
+        {
+          kmm_free(map->saved);
+          map->saved = NULL;
+        }
+
+      return ret;
+    }
+
+  file_close(&map->file);
+  memcpy(&map->file, &file, sizeof(struct file));
+  return OK;
+}
+
+/****************************************************************************
+ * Name: rammap_pagedirty
+ *
+ * Description:
+ *   Return true if one page of the file data of a region differs from the
+ *   saved copy.
+ *
+ ****************************************************************************/
+
+static bool rammap_pagedirty(FAR struct fs_rammap_s *map, size_t page)
+{
+  size_t start = page * RAMMAP_PAGESIZE;
+
+  return memcmp((FAR const uint8_t *)map->addr + start, map->saved + start,
+                MIN(map->filelen - start, RAMMAP_PAGESIZE)) != 0;
+}
+
+/****************************************************************************
+ * Name: rammap_writerun
+ *
+ * Description:
+ *   Write the file data of a region in the range [start, end) to the file
+ *
+ ****************************************************************************/
+
+static int rammap_writerun(FAR struct fs_rammap_s *map, size_t start,
+                           size_t end)
+{
+  FAR uint8_t *wrbuffer = (FAR uint8_t *)map->addr + start;
+  ssize_t nwritten;
+
+  while (start < end)
+    {
+      nwritten = file_pwrite(&map->file, wrbuffer, end - start,
+                             map->offset + start);
+      if (nwritten < 0)
+        {
+          if (nwritten == -EINTR)
+            {
+              continue;
+            }
+
+          ferr("ERROR: Write back failed: %d\n", (int)nwritten);
+          return (int)nwritten;
+        }
+
+      wrbuffer += nwritten;
+      start    += nwritten;
+    }
+
+  return OK;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -101,6 +385,8 @@ void rammap_initialize(void)
  *   length  The length of the mapping.  For exception #1 above, this length
  *           ignored:  The entire underlying media is always accessible.
  *   offset  The offset into the file to map
+ *   flags   The mmap() flags.  MAP_SHARED mappings of the same file are
+ *           shared and written back by msync() and munmap().
  *
  * Returned Value:
  *   On success, rammmap() returns a pointer to the mapped area. On error, the
@@ -115,29 +401,89 @@ void rammap_initialize(void)
  *
  ****************************************************************************/
 
-FAR void *rammap(int fd, size_t length, off_t offset)
+FAR void *rammap(int fd, size_t length, off_t offset, int flags)
 {
+  FAR struct fs_rammap_range_s *range = NULL;
   FAR struct fs_rammap_s *map;
+  FAR struct file *filep;
   FAR uint8_t *alloc;
-  FAR uint8_t *rdbuffer;
+  FAR const char *name;
+  bool shared = (flags & MAP_SHARED) != 0;
   ssize_t nread;
-  off_t fpos;
+  ino_t ino;
   int errcode;
   int ret;
 
-  /* There is a major design flaw that I have not yet thought of fix for:
-   * The goal is to have a single region of memory that represents a single
-   * file and can be shared by many threads.  That is, given a filename a
-   * thread should be able to open the file, get a file descriptor, and
-   * call mmap() to get a memory region.  Different file descriptors opened
-   * with the same file path should get the same memory region when mapped.
-   *
-   * The design flaw is that I don't have sufficient knowledge to know that
-   * these different file descriptors map to the same file.  So, for the time
-   * being, a new memory region is created each time that rammap() is called.
-   * Not very useful!
+  ret = fs_getfilep(fd, &filep);
+  if (ret < 0)
+    {
+      errcode = -ret;
+      goto errout;
+    }
+
+  /* Hold the list while the file is read so that concurrent MAP_SHARED
+   * mappings of the same file end up in the same region.
    */
 
+  rammap_initialize();
+  ret = nxsem_wait(&g_rammaps.exclsem);
+  if (ret < 0)
+    {
+      errcode = -ret;
+      goto errout;
+    }
+
+  if (shared)
+    {
+      /* A writable shared mapping of a file that cannot be identified
+       * would get a region of its own, and its write-back would overwrite
+       * the changes of other mappings of the same file.
+       */
+
+      rammap_fileid(filep, &name, &ino);
+      if (INODE_IS_MOUNTPT(filep->f_inode) && name == NULL && ino == 0 &&
+          (filep->f_oflags & O_WROK) != 0)
+        {
+          ferr("ERROR: Cannot share a mapping of this file\n");
+          errcode = ENODEV;
+          goto errout_with_semaphore;
+        }
+
+      /* Record the range of this mmap() call for munmap() */
+
+      range = (FAR struct fs_rammap_range_s *)
+        kmm_malloc(sizeof(struct fs_rammap_range_s));
+      if (range == NULL)
+        {
+          errcode = ENOMEM;
+          goto errout_with_semaphore;
+        }
+
+      range->length = length;
+
+      /* Is there already a shared mapping of the same file covering the
+       * range?
+       */
+
+      map = rammap_find(filep->f_inode, name, ino, length, offset);
+      if (map != NULL)
+        {
+          ret = rammap_upgrade(map, filep);
+          if (ret < 0)
+            {
+              errcode = -ret;
+              goto errout_with_range;
+            }
+
+          range->offset = offset - map->offset;
+          range->flink  = map->ranges;
+          map->ranges   = range;
+
+          nxsem_post(&g_rammaps.exclsem);
+          return (FAR uint8_t *)map->addr + range->offset;
+        }
+    }
+
   /* Allocate a region of memory of the specified size */
 
   alloc = (FAR uint8_t *)kumm_malloc(sizeof(struct fs_rammap_s) + length);
@@ -145,7 +491,7 @@ FAR void *rammap(int fd, size_t length, off_t offset)
     {
       ferr("ERROR: Region allocation failed, length: %d\n", (int)length);
       errcode = ENOMEM;
-      goto errout;
+      goto errout_with_range;
     }
 
   /* Initialize the region */
@@ -156,83 +502,164 @@ FAR void *rammap(int fd, size_t length, off_t offset)
   map->length = length;
   map->offset = offset;
 
-  /* Seek to the specified file offset */
+  /* Read the file data into the memory region */
 
-  fpos = lseek(fd, offset,  SEEK_SET);
-  if (fpos == (off_t)-1)
+  nread = rammap_read(filep, map->addr, length, offset);
+  if (nread < 0)
     {
-      /* Seek failed... errno has already been set, but EINVAL is probably
-       * the correct response.
-       */
-
-      ferr("ERROR: Seek to position %d failed\n", (int)offset);
-      errcode = EINVAL;
+      errcode = (int)-nread;
       goto errout_with_region;
     }
 
-  /* Read the file data into the memory region */
+  /* Zero any memory beyond the amount read from the file */
 
-  rdbuffer = map->addr;
-  while (length > 0)
+  memset((FAR uint8_t *)map->addr + nread, 0, length - nread);
+  map->filelen = nread;
+
+  /* A shared mapping keeps its own reference to the file for the write-
+   * back and, if it is writable, a copy of the file data to find the
+   * pages that changed.
+   */
+
+  if (shared)
     {
-      nread = nx_read(fd, rdbuffer, length);
-      if (nread < 0)
+      if ((filep->f_oflags & O_WROK) != 0 && map->filelen > 0)
         {
-          /* Handle the special case where the read was interrupted by a
-           * signal.
-           */
-
-          if (nread != -EINTR)
+          map->saved = (FAR uint8_t *)kmm_malloc(map->filelen);
+          if (map->saved == NULL)
             {
-              /* All other read errors are bad. */
-
-              ferr("ERROR: Read failed: offset=%d errno=%d\n",
-                   (int)offset, (int)nread);
-
-              errcode = (int)-nread;
+              errcode = ENOMEM;
               goto errout_with_region;
             }
-        }
 
-      /* Check for end of file. */
+          memcpy(map->saved, map->addr, map->filelen);
+        }
 
-      if (nread == 0)
+      ret = file_dup2(filep, &map->file);
+      if (ret < 0)
         {
-          break;
+          errcode = -ret;
+          goto errout_with_saved;
         }
 
-      /* Increment number of bytes read */
+      range->offset = 0;
+      range->flink  = NULL;
 
-      rdbuffer += nread;
-      length   -= nread;
+      map->ranges = range;
+      map->inode  = filep->f_inode;
+      map->name   = name;
+      map->ino    = ino;
+      map->shared = true;
     }
 
-  /* Zero any memory beyond the amount read from the file */
-
-  memset(rdbuffer, 0, length);
-
   /* Add the buffer to the list of regions */
 
-  rammap_initialize();
-  ret = nxsem_wait(&g_rammaps.exclsem);
-  if (ret < 0)
-    {
-      errcode = -ret;
-      goto errout_with_region;
-    }
-
-  map->flink  = g_rammaps.head;
+  map->flink     = g_rammaps.head;
   g_rammaps.head = map;
 
   nxsem_post(&g_rammaps.exclsem);
   return map->addr;
 
+errout_with_saved:
+  if (map->saved != NULL)
+    {
+      kmm_free(map->saved);
+    }
+
 errout_with_region:
   kumm_free(alloc);
 
+errout_with_range:
+  if (range != NULL)
+    {
+      kmm_free(range);
+    }
+
+errout_with_semaphore:
+  nxsem_post(&g_rammaps.exclsem);
+
 errout:
   set_errno(errcode);
   return MAP_FAILED;
 }
 
+/****************************************************************************
+ * Name: rammap_writeback
+ *
+ * Description:
+ *   Write the pages of a MAP_SHARED mapping in the range [start,
+ *   start + length) that changed since they were read or last written back
+ *   to the file.  Nothing is written for MAP_PRIVATE mappings or files that
+ *   are not open for writing.
+ *
+ ****************************************************************************/
+
+int rammap_writeback(FAR struct fs_rammap_s *map, FAR void *start,
+                     size_t length)
+{
+  FAR uint8_t *addr = map->addr;
+  size_t npages;
+  size_t first;
+  size_t last;
+  size_t page;
+  size_t run;
+  int ret;
+
+  if (!map->shared || map->saved == NULL ||
+      (map->file.f_oflags & O_WROK) == 0)
+    {
+      return OK;
+    }
+
+  /* Only the pages that came from the file are written, the mapping does
+   * not extend the file.
+   */
+
+  if ((FAR uint8_t *)start + length <= addr ||
+      (FAR uint8_t *)start >= addr + map->filelen)
+    {
+      return OK;
+    }
+
+  npages = (map->filelen + RAMMAP_PAGESIZE - 1) / RAMMAP_PAGESIZE;
+  first  = (FAR uint8_t *)start > addr ?
+           ((FAR uint8_t *)start - addr) / RAMMAP_PAGESIZE : 0;
+  last   = ((FAR uint8_t *)start + length - addr + RAMMAP_PAGESIZE - 1) /
+           RAMMAP_PAGESIZE;
+  last   = MIN(last, npages);
+
+  /* Write each run of consecutive changed pages with one write and update
+   * the saved copy once they reached the file.
+   */
+
+  for (page = first; page < last; page = run)
+    {
+      run = page;
+      while (run < last && rammap_pagedirty(map, run))
+        {
+          run++;
+        }
+
+      if (run == page)
+        {
+          run++;
+          continue;
+        }
+
+      ret = rammap_writerun(map, page * RAMMAP_PAGESIZE,
+                            MIN(run * RAMMAP_PAGESIZE, map->filelen));
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      memcpy(map->saved + page * RAMMAP_PAGESIZE,
+             addr + page * RAMMAP_PAGESIZE,
+             MIN(run * RAMMAP_PAGESIZE, map->filelen) -
+             page * RAMMAP_PAGESIZE);
+    }
+
+  return OK;
+}
+
 #endif /* CONFIG_FS_RAMMAP */
@@ -45,7 +45,11 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+
 #include <nuttx/semaphore.h>
+#include <nuttx/fs/fs.h>
 
 #ifdef CONFIG_FS_RAMMAP
 
@@ -65,17 +69,51 @@
  * - All of the file must be present in memory.  This limits the size of
  *   files that may be memory mapped (especially on MCUs with no significant
  *   RAM resources).
- * - All mapped files are read-only.  You can write to the in-memory image,
- *   but the file contents will not change.
+ * - Changes to a MAP_SHARED mapping reach the file only when msync() or
+ *   munmap() is called.  Changes to a MAP_PRIVATE mapping never do.
  * - There are not access privileges.
+ *
+ * MAP_SHARED mappings of the same file are shared:  mmap() returns the
+ * existing region if it covers the requested range and records the range
+ * of each mmap() call.  munmap() must remove one of these ranges as a
+ * whole and the region is freed with the last one.  Such a mapping keeps a
+ * detached open file for the write-back, which is reopened for writing if
+ * a later user maps the file from a writable descriptor.  Without an MMU,
+ * writes to the region cannot be trapped, so a writable mapping keeps a
+ * copy of the file data and only the pages that differ from it are
+ * written back.
  */
 
+#define RAMMAP_PAGESIZE 512
+
+/* The range of one mmap() call on a MAP_SHARED region */
+
+struct fs_rammap_range_s
+{
+  /* Next range of the same region */
+
+  FAR struct fs_rammap_range_s *flink;
+  size_t offset;                   /* Offset of the range in the region */
+  size_t length;                   /* Length of the range */
+};
+
 struct fs_rammap_s
 {
   struct fs_rammap_s *flink;       /* Implements a singly linked list */
   FAR void           *addr;        /* Start of allocated memory */
   size_t              length;      /* Length of region */
   off_t               offset;      /* File offset */
+  size_t              filelen;     /* Bytes read from the file */
+  FAR struct inode   *inode;       /* Inode of the mapped file (MAP_SHARED) */
+  FAR const char     *name;        /* File name in a mountpoint or NULL */
+  ino_t               ino;         /* File serial number in a mountpoint or 0 */
+  FAR uint8_t        *saved;       /* File data as last read or written back */
+  struct file         file;        /* Detached file for the write-back */
+  bool                shared;      /* True: MAP_SHARED mapping */
+
+  /* The ranges of the mmap() calls on a MAP_SHARED region */
+
+  FAR struct fs_rammap_range_s *ranges;
 };
 
 /* This structure defines all "mapped" files */
@@ -126,6 +164,8 @@ void rammap_initialize(void);
  *   length  The length of the mapping.  For exception #1 above, this length
  *           ignored:  The entire underlying media is always accessible.
  *   offset  The offset into the file to map
+ *   flags   The mmap() flags.  MAP_SHARED mappings of the same file are
+ *           shared and written back by msync() and munmap().
  *
  * Returned Value:
  *   On success, rammmap() returns a pointer to the mapped area. On error, the
@@ -135,12 +175,40 @@ void rammap_initialize(void);
  *      'fd' is not a valid file descriptor.
  *     EINVAL
  *       'length' or 'offset' are invalid
+ *     ENODEV
+ *       MAP_SHARED was requested from a writable descriptor of a file
+ *       whose file system cannot identify it.
  *     ENOMEM
  *       Insufficient memory is available to map the file.
  *
  ****************************************************************************/
 
-FAR void *rammap(int fd, size_t length, off_t offset);
+FAR void *rammap(int fd, size_t length, off_t offset, int flags);
+
+/****************************************************************************
+ * Name: rammap_writeback
+ *
+ * Description:
+ *   Write the pages of a MAP_SHARED mapping in the range [start,
+ *   start + length) that changed since they were read or last written back
+ *   to the file.  Nothing is written for MAP_PRIVATE mappings or files that
+ *   are not open for writing.
+ *
+ * Input Parameters:
+ *   map     The mapping
+ *   start   The start of the range to write back
+ *   length  The length of the range
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ * Assumptions:
+ *   The caller holds g_rammaps.exclsem.
+ *
+ ****************************************************************************/
+
+int rammap_writeback(FAR struct fs_rammap_s *map, FAR void *start,
+                     size_t length);
 
 #endif /* CONFIG_FS_RAMMAP */
 #endif /* __FS_MMAP_RAMMAP_H */
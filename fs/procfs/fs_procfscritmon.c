@@ -195,6 +195,34 @@ static int critmon_close(FAR struct file *filep)
   return OK;
 }
 
+/****************************************************************************
+ * Name: critmon_convert
+ *
+ * Description:
+ *   Like up_critmon_convert(), but for a 64-bit elapsed time.
+ *
+ ****************************************************************************/
+
+static void critmon_convert(uint64_t elapsed, FAR struct timespec *ts)
+{
+  struct timespec chunk;
+  uint32_t nchunks = (uint32_t)(elapsed >> 31);
+  uint64_t nsec;
+
+  up_critmon_convert((uint32_t)(elapsed & 0x7fffffff), ts);
+
+  /* Add the time of the 2^31 unit chunks */
+
+  if (nchunks > 0)
+    {
+      up_critmon_convert(UINT32_C(1) << 31, &chunk);
+
+      nsec         = (uint64_t)chunk.tv_nsec * nchunks + ts->tv_nsec;
+      ts->tv_sec  += chunk.tv_sec * nchunks + nsec / NSEC_PER_SEC;
+      ts->tv_nsec  = nsec % NSEC_PER_SEC;
+    }
+}
+
 /****************************************************************************
  * Name: critmon_read_cpu
  ****************************************************************************/
@@ -204,6 +232,7 @@ static ssize_t critmon_read_cpu(FAR struct critmon_file_s *attr,
                                 FAR off_t *offset, int cpu)
 {
   struct timespec maxtime;
+  uint32_t count;
   size_t remaining;
   size_t linesize;
   size_t copysize;
@@ -262,11 +291,41 @@ static ssize_t critmon_read_cpu(FAR struct critmon_file_s *attr,
 
   /* Generate output for maximum time in a critical section */
 
-  linesize = snprintf(attr->line, CRITMON_LINELEN, "%lu.%09lu\n",
+  linesize = snprintf(attr->line, CRITMON_LINELEN, "%lu.%09lu,",
                      (unsigned long)maxtime.tv_sec,
                      (unsigned long)maxtime.tv_nsec);
   copysize = procfs_memcpy(attr->line, linesize, buffer, buflen, offset);
 
+  totalsize += copysize;
+  buffer    += copysize;
+  remaining -= copysize;
+
+  if (totalsize >= buflen)
+    {
+      return totalsize;
+    }
+
+  /* Convert the total time in critical sections and reset it along with
+   * the number of critical sections.  On SMP, this is how long the CPU
+   * held the global lock.
+   */
+
+  critmon_convert(g_crit_total[cpu], &maxtime);
+  count = g_crit_count[cpu];
+
+  g_crit_total[cpu] = 0;
+  g_crit_count[cpu] = 0;
+
+  /* Generate output for the total time and the number of critical
+   * sections.
+   */
+
+  linesize = snprintf(attr->line, CRITMON_LINELEN, "%lu.%09lu,%lu\n",
+                     (unsigned long)maxtime.tv_sec,
+                     (unsigned long)maxtime.tv_nsec,
+                     (unsigned long)count);
+  copysize = procfs_memcpy(attr->line, linesize, buffer, buflen, offset);
+
   totalsize += copysize;
   return totalsize;
 }
@@ -75,23 +75,19 @@
 int fs_dupfd2(int fd1, int fd2)
 {
   FAR struct file *filep1;
-  FAR struct file *filep2 = NULL;
   int ret;
 
-  /* Get the file structures corresponding to the file descriptors. */
+  /* Get the file structure corresponding to the first file descriptor.
+   * The second one may not have been allocated yet.
+   */
 
   ret = fs_getfilep(fd1, &filep1);
-  if (ret >= 0)
-    {
-      ret = fs_getfilep(fd2, &filep2);
-    }
-
   if (ret < 0)
     {
       return ret;
     }
 
-  DEBUGASSERT(filep1 != NULL && filep2 != NULL);
+  DEBUGASSERT(filep1 != NULL);
 
   /* Verify that fd1 is a valid, open file descriptor */
 
@@ -109,5 +105,5 @@ int fs_dupfd2(int fd1, int fd2)
 
   /* Perform the dup2 operation */
 
-  return file_dup2(filep1, filep2);
+  return files_dup2(filep1, fd2);
 }
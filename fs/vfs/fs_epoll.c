@@ -42,25 +42,383 @@
 #include <sys/epoll.h>
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <poll.h>
+#include <queue.h>
+#include <signal.h>
 #include <errno.h>
-#include <string.h>
 #include <debug.h>
 
+#include <nuttx/irq.h>
+#include <nuttx/clock.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/signal.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/net/net.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The states of a registration */
+
+#define EPOLL_NODE_FREE     0 /* Not in use */
+#define EPOLL_NODE_ARMED    1 /* Set up with the driver */
+#define EPOLL_NODE_DISABLED 2 /* Torn down, e.g. EPOLLONESHOT fired */
+
+/* The events which are always reported */
+
+#define EPOLL_ALWAYS        (POLLERR | POLLHUP)
 
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+struct epoll_head;
+
+/* One persistent registration.  The pollfd stays set up with the driver
+ * between the calls to epoll_wait() and the driver notifies it through
+ * poll_notify(), which queues it in the ready list of the instance.  So
+ * epoll_wait() only visits the descriptors that reported an event.
+ *
+ * The pollfd is marked with POLLEPOLL and pfd.ptr holds the struct file or
+ * struct socket it was set up with, so the registration is always torn
+ * down through the same driver, even after the descriptor was reused.
+ */
+
+struct epoll_node
+{
+  struct pollfd           pfd;    /* The poll registration (must be first) */
+  dq_entry_t              link;   /* Link in the ready list */
+  FAR struct epoll_head  *eph;    /* The owning instance */
+  epoll_data_t            data;   /* Returned along with the events */
+  uint32_t                events; /* The requested events and flags */
+  uint8_t                 state;  /* See EPOLL_NODE_* definitions */
+  bool                    sock;   /* pfd.ptr is a struct socket */
+  bool                    queued; /* In the ready list */
+  bool                    rearm;  /* EPOLLET: Ignore the current level */
+};
+
 struct epoll_head
 {
-  int size;
-  int occupied;
-  FAR epoll_data_t *data;
-  FAR struct pollfd *poll;
+  dq_entry_t link;                /* Link in g_epoll_list */
+  int size;                       /* Number of registrations */
+  int occupied;                   /* Number of registrations in use */
+  bool waiting;                   /* epoll_wait() waits on sem */
+  sem_t lock;                     /* Serializes epoll_ctl()/epoll_wait() */
+  sem_t sem;                      /* Posted when there are events */
+  dq_queue_t ready;               /* The registrations with events */
+  FAR struct epoll_node *node;    /* The registrations */
 };
 
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* All of the epoll instances, so that closing a file or a socket can remove
+ * its registrations.  g_epoll_lock is taken before the lock of an instance.
+ */
+
+static dq_queue_t g_epoll_list;
+static sem_t g_epoll_lock = SEM_INITIALIZER(1);
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: epoll_head_from
+ ****************************************************************************/
+
+static inline FAR struct epoll_head *epoll_head_from(int epfd)
+{
+  /* REVISIT: This will not work on machines where:
+   * sizeof(struct epoll_head *) > sizeof(int)
+   */
+
+  return (FAR struct epoll_head *)((intptr_t)epfd);
+}
+
+/****************************************************************************
+ * Name: epoll_find
+ *
+ * Description:
+ *   Find the registration of a descriptor.
+ *
+ ****************************************************************************/
+
+static FAR struct epoll_node *epoll_find(FAR struct epoll_head *eph, int fd)
+{
+  int i;
+
+  for (i = 0; i < eph->size; i++)
+    {
+      if (eph->node[i].state != EPOLL_NODE_FREE && eph->node[i].pfd.fd == fd)
+        {
+          return &eph->node[i];
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: epoll_enqueue
+ *
+ * Description:
+ *   Add a registration to the ready list, if it is not there yet, and wake
+ *   up epoll_wait().  This may be called from interrupt handlers.
+ *
+ ****************************************************************************/
+
+static void epoll_enqueue(FAR struct epoll_node *node)
+{
+  FAR struct epoll_head *eph = node->eph;
+  irqstate_t flags;
+
+  flags = enter_critical_section();
+  if (!node->queued)
+    {
+      node->queued = true;
+      dq_addlast(&node->link, &eph->ready);
+
+      if (eph->waiting)
+        {
+          eph->waiting = false;
+          nxsem_post(&eph->sem);
+        }
+    }
+
+  leave_critical_section(flags);
+}
+
+/****************************************************************************
+ * Name: epoll_dequeue
+ ****************************************************************************/
+
+static void epoll_dequeue(FAR struct epoll_node *node)
+{
+  irqstate_t flags;
+
+  flags = enter_critical_section();
+  if (node->queued)
+    {
+      node->queued = false;
+      dq_rem(&node->link, &node->eph->ready);
+    }
+
+  leave_critical_section(flags);
+}
+
+/****************************************************************************
+ * Name: epoll_fdpoll
+ *
+ * Description:
+ *   Set up or tear down the registration with the driver of the file or
+ *   the socket it was created for.
+ *
+ ****************************************************************************/
+
+static int epoll_fdpoll(FAR struct epoll_node *node, bool setup)
+{
+#ifdef CONFIG_NET
+  if (node->sock)
+    {
+      return psock_poll(node->pfd.ptr, &node->pfd, setup);
+    }
+#endif
+
+  return file_poll(node->pfd.ptr, &node->pfd, setup);
+}
+
+/****************************************************************************
+ * Name: epoll_getptr
+ *
+ * Description:
+ *   Look up the struct file or struct socket of a descriptor.
+ *
+ ****************************************************************************/
+
+static int epoll_getptr(int fd, FAR struct epoll_node *node)
+{
+  FAR struct file *filep;
+  int ret;
+
+  if (fd >= CONFIG_NFILE_DESCRIPTORS)
+    {
+#ifdef CONFIG_NET
+      if (fd < (CONFIG_NFILE_DESCRIPTORS + CONFIG_NSOCKET_DESCRIPTORS))
+        {
+          node->pfd.ptr = sockfd_socket(fd);
+          node->sock    = true;
+          return node->pfd.ptr != NULL ? OK : -EBADF;
+        }
+#endif
+
+      return -EBADF;
+    }
+
+  ret = fs_getfilep(fd, &filep);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  node->pfd.ptr = filep;
+  node->sock    = false;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: epoll_setup
+ *
+ * Description:
+ *   Set up the registration with the driver.  The driver notifies it
+ *   right away if one of the events is already pending.
+ *
+ ****************************************************************************/
+
+static int epoll_setup(FAR struct epoll_node *node)
+{
+  int ret;
+
+  node->pfd.events  = (pollevent_t)((node->events | EPOLL_ALWAYS) &
+                                     ~POLLMASK) | POLLEPOLL;
+  node->pfd.revents = 0;
+  node->pfd.sem     = &node->eph->sem;
+  node->pfd.priv    = NULL;
+
+  ret = epoll_fdpoll(node, true);
+  node->state = ret < 0 ? EPOLL_NODE_DISABLED : EPOLL_NODE_ARMED;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: epoll_teardown
+ *
+ * Description:
+ *   Tear down the registration and return the pending events.
+ *
+ ****************************************************************************/
+
+static uint32_t epoll_teardown(FAR struct epoll_node *node)
+{
+  uint32_t revents = 0;
+
+  if (node->state == EPOLL_NODE_ARMED)
+    {
+      epoll_fdpoll(node, false);
+      revents = node->pfd.revents & (node->events | EPOLL_ALWAYS) &
+                ~POLLMASK;
+      node->state = EPOLL_NODE_DISABLED;
+    }
+
+  return revents;
+}
+
+/****************************************************************************
+ * Name: epoll_rescan
+ *
+ * Description:
+ *   Out-of-tree drivers which do not use poll_notify() post the semaphore
+ *   directly, so the registration which got the event is not known.  Queue
+ *   all of the registrations with pending events.
+ *
+ ****************************************************************************/
+
+static void epoll_rescan(FAR struct epoll_head *eph)
+{
+  FAR struct epoll_node *node;
+  int i;
+
+  for (i = 0; i < eph->size; i++)
+    {
+      node = &eph->node[i];
+      if (node->state == EPOLL_NODE_ARMED && !node->queued &&
+          (node->pfd.revents & (node->events | EPOLL_ALWAYS) &
+           ~POLLMASK) != 0)
+        {
+          epoll_enqueue(node);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: epoll_collect
+ *
+ * Description:
+ *   Return the events of the registrations in the ready list and re-arm
+ *   them.  The registrations which are still ready after being re-armed
+ *   (level-triggered) are queued again for the next call.
+ *
+ ****************************************************************************/
+
+static int epoll_collect(FAR struct epoll_head *eph,
+                         FAR struct epoll_event *evs, int maxevents)
+{
+  FAR struct epoll_node *node;
+  dq_queue_t pending;
+  irqstate_t flags;
+  uint32_t revents;
+  int num = 0;
+
+  /* Take over the ready list.  The registrations remain marked as queued
+   * until they are processed, so the callback leaves them alone.
+   */
+
+  flags = enter_critical_section();
+  pending = eph->ready;
+  dq_init(&eph->ready);
+  leave_critical_section(flags);
+
+  while (num < maxevents &&
+         (node = (FAR struct epoll_node *)dq_remfirst(&pending)) != NULL)
+    {
+      flags = enter_critical_section();
+      node->queued = false;
+      leave_critical_section(flags);
+
+      revents = epoll_teardown(node);
+      if (revents != 0)
+        {
+          evs[num].events = revents;
+          evs[num].data   = node->data;
+          num++;
+
+          /* EPOLLONESHOT: Stay disabled until EPOLL_CTL_MOD */
+
+          if ((node->events & EPOLLONESHOT) != 0)
+            {
+              continue;
+            }
+        }
+
+      node->rearm = revents != 0 && (node->events & EPOLLET) != 0;
+      if (epoll_setup(node) < 0)
+        {
+          ferr("ERROR: Failed to re-arm fd=%d\n", node->pfd.fd);
+        }
+
+      node->rearm = false;
+    }
+
+  /* Put back what did not fit in the event array */
+
+  if (!dq_empty(&pending))
+    {
+      flags = enter_critical_section();
+      while ((node = (FAR struct epoll_node *)dq_remlast(&pending)) != NULL)
+        {
+          dq_addfirst(&node->link, &eph->ready);
+        }
+
+      leave_critical_section(flags);
+    }
+
+  return num;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -69,24 +427,51 @@ struct epoll_head
  * Name: epoll_create
  *
  * Description:
+ *   Create an epoll instance with room for 'size' descriptors.
  *
  * Input Parameters:
+ *   size - The maximum number of registered descriptors
  *
  * Returned Value:
+ *   The epoll handle on success; -1 (ERROR) with errno set on failure.
  *
  ****************************************************************************/
 
 int epoll_create(int size)
 {
-  FAR struct epoll_head *eph =
-    (FAR struct epoll_head *)kmm_malloc(sizeof(struct epoll_head) +
-                                        sizeof(epoll_data_t) * size +
-                                        sizeof(struct pollfd) * size);
+  FAR struct epoll_head *eph;
+
+  if (size <= 0)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  eph = (FAR struct epoll_head *)
+    kmm_zalloc(sizeof(struct epoll_head) +
+               sizeof(struct epoll_node) * size);
+  if (eph == NULL)
+    {
+      set_errno(ENOMEM);
+      return ERROR;
+    }
 
   eph->size = size;
-  eph->occupied = 0;
-  eph->data = (FAR epoll_data_t *)(eph + 1);
-  eph->poll = (FAR struct pollfd *)(eph->data + size);
+  eph->node = (FAR struct epoll_node *)(eph + 1);
+  dq_init(&eph->ready);
+
+  nxsem_init(&eph->lock, 0, 1);
+  nxsem_init(&eph->sem, 0, 0);
+
+  /* The semaphore is used for signaling and, hence, should not have
+   * priority inheritance enabled.
+   */
+
+  nxsem_set_protocol(&eph->sem, SEM_PRIO_NONE);
+
+  nxsem_wait_uninterruptible(&g_epoll_lock);
+  dq_addlast(&eph->link, &g_epoll_list);
+  nxsem_post(&g_epoll_lock);
 
   /* REVISIT: This will not work on machines where:
    * sizeof(struct epoll_head *) > sizeof(int)
@@ -124,169 +509,366 @@ int epoll_create1(int flags)
  * Name: epoll_close
  *
  * Description:
+ *   Tear down all of the registrations and free the epoll instance.
  *
  * Input Parameters:
+ *   epfd - The epoll handle
  *
  * Returned Value:
+ *   None
  *
  ****************************************************************************/
 
 void epoll_close(int epfd)
 {
-  /* REVISIT: This will not work on machines where:
-   * sizeof(struct epoll_head *) > sizeof(int)
-   */
+  FAR struct epoll_head *eph = epoll_head_from(epfd);
+  int i;
+
+  nxsem_wait_uninterruptible(&g_epoll_lock);
+  dq_rem(&eph->link, &g_epoll_list);
+  nxsem_post(&g_epoll_lock);
+
+  nxsem_wait_uninterruptible(&eph->lock);
 
-  FAR struct epoll_head *eph = (FAR struct epoll_head *)((intptr_t)epfd);
+  for (i = 0; i < eph->size; i++)
+    {
+      epoll_teardown(&eph->node[i]);
+    }
 
+  nxsem_destroy(&eph->sem);
+  nxsem_destroy(&eph->lock);
   kmm_free(eph);
 }
 
+/****************************************************************************
+ * Name: epoll_notify
+ *
+ * Description:
+ *   Queue an epoll registration on the ready list of its instance.  This is
+ *   called by poll_notify(), possibly from interrupt handlers.
+ *
+ * Input Parameters:
+ *   fds - The poll descriptor of the registration
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void epoll_notify(FAR struct pollfd *fds)
+{
+  FAR struct epoll_node *node = (FAR struct epoll_node *)fds;
+
+  /* While an edge-triggered registration is re-armed, the driver reports
+   * the current level, which was already returned.
+   */
+
+  if (!node->rearm)
+    {
+      epoll_enqueue(node);
+    }
+}
+
+/****************************************************************************
+ * Name: epoll_detach
+ *
+ * Description:
+ *   Remove the registrations of a file or socket that is being closed from
+ *   all of the epoll instances, while its driver is still open.
+ *
+ * Input Parameters:
+ *   ptr - The struct file or struct socket being closed
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void epoll_detach(FAR const void *ptr)
+{
+  FAR struct epoll_head *eph;
+  FAR struct epoll_node *node;
+  int i;
+
+  if (dq_empty(&g_epoll_list))
+    {
+      return;
+    }
+
+  nxsem_wait_uninterruptible(&g_epoll_lock);
+
+  for (eph = (FAR struct epoll_head *)dq_peek(&g_epoll_list);
+       eph != NULL;
+       eph = (FAR struct epoll_head *)dq_next(&eph->link))
+    {
+      nxsem_wait_uninterruptible(&eph->lock);
+
+      for (i = 0; i < eph->size; i++)
+        {
+          node = &eph->node[i];
+          if (node->state != EPOLL_NODE_FREE && node->pfd.ptr == ptr)
+            {
+              epoll_teardown(node);
+              epoll_dequeue(node);
+              node->state = EPOLL_NODE_FREE;
+              eph->occupied--;
+            }
+        }
+
+      nxsem_post(&eph->lock);
+    }
+
+  nxsem_post(&g_epoll_lock);
+}
+
 /****************************************************************************
  * Name: epoll_ctl
  *
  * Description:
+ *   Add, modify or remove the registration of a descriptor.  The
+ *   registrations stay set up with the driver until they are removed or
+ *   the descriptor is closed.
  *
  * Input Parameters:
+ *   epfd - The epoll handle
+ *   op   - EPOLL_CTL_ADD, EPOLL_CTL_DEL or EPOLL_CTL_MOD
+ *   fd   - The descriptor
+ *   ev   - The events to monitor and the data to return with them
  *
  * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
  *
  ****************************************************************************/
 
 int epoll_ctl(int epfd, int op, int fd, struct epoll_event *ev)
 {
-  /* REVISIT: This will not work on machines where:
-   * sizeof(struct epoll_head *) > sizeof(int)
-   */
+  FAR struct epoll_head *eph = epoll_head_from(epfd);
+  FAR struct epoll_node *node;
+  int ret = OK;
+  int i;
 
-  FAR struct epoll_head *eph = (FAR struct epoll_head *)((intptr_t)epfd);
+  nxsem_wait_uninterruptible(&eph->lock);
 
+  node = epoll_find(eph, fd);
   switch (op)
     {
       case EPOLL_CTL_ADD:
         finfo("%08x CTL ADD(%d): fd=%d ev=%08x\n",
               epfd, eph->occupied, fd, ev->events);
 
-        eph->data[eph->occupied]        = ev->data;
-        eph->poll[eph->occupied].events = ev->events | POLLERR | POLLHUP;
-        eph->poll[eph->occupied++].fd   = fd;
-        return 0;
+        if (node != NULL)
+          {
+            ret = -EEXIST;
+            break;
+          }
+
+        for (i = 0; i < eph->size; i++)
+          {
+            if (eph->node[i].state == EPOLL_NODE_FREE)
+              {
+                node = &eph->node[i];
+                break;
+              }
+          }
+
+        if (node == NULL)
+          {
+            ret = -ENOMEM;
+            break;
+          }
+
+        ret = epoll_getptr(fd, node);
+        if (ret < 0)
+          {
+            break;
+          }
+
+        node->eph    = eph;
+        node->pfd.fd = fd;
+        node->data   = ev->data;
+        node->events = ev->events;
+
+        ret = epoll_setup(node);
+        if (ret < 0)
+          {
+            node->state = EPOLL_NODE_FREE;
+            break;
+          }
+
+        eph->occupied++;
+        break;
 
       case EPOLL_CTL_DEL:
-        {
-          int i;
+        if (node == NULL)
+          {
+            ret = -ENOENT;
+            break;
+          }
+
+        epoll_teardown(node);
+        epoll_dequeue(node);
+        node->state = EPOLL_NODE_FREE;
+        eph->occupied--;
+        break;
 
-          for (i = 0; i < eph->occupied; i++)
-            {
-              if (eph->poll[i].fd == fd)
-                {
-                  if (i != eph->occupied - 1)
-                    {
-                      memmove(&eph->data[i], &eph->data[i + 1],
-                              sizeof(epoll_data_t) * (eph->occupied - i));
-                      memmove(&eph->poll[i], &eph->poll[i + 1],
-                              sizeof(struct pollfd) * (eph->occupied - i));
-                    }
-
-                  eph->occupied--;
-                  return 0;
-                }
-            }
+      case EPOLL_CTL_MOD:
+        finfo("%08x CTL MOD(%d): fd=%d ev=%08x\n",
+              epfd, eph->occupied, fd, ev->events);
 
-          return -ENOENT;
-        }
+        if (node == NULL)
+          {
+            ret = -ENOENT;
+            break;
+          }
 
-      case EPOLL_CTL_MOD:
-        {
-          int i;
+        /* Re-arm with the new events, which also re-enables an
+         * EPOLLONESHOT registration.
+         */
 
-          finfo("%08x CTL MOD(%d): fd=%d ev=%08x\n",
-                epfd, eph->occupied, fd, ev->events);
+        epoll_teardown(node);
+        epoll_dequeue(node);
 
-          for (i = 0; i < eph->occupied; i++)
-            {
-              if (eph->poll[i].fd == fd)
-                {
-                  eph->data[i]        = ev->data;
-                  eph->poll[i].events = ev->events | POLLERR | POLLHUP;
-                  return 0;
-                }
-            }
+        node->data   = ev->data;
+        node->events = ev->events;
+        ret = epoll_setup(node);
+        break;
 
-          return -ENOENT;
-        }
+      default:
+        ret = -EINVAL;
+        break;
     }
 
-  return -EINVAL;
+  nxsem_post(&eph->lock);
+  return ret;
 }
 
 /****************************************************************************
  * Name: epoll_pwait
+ *
+ * Description:
+ *   Wait for events on the registered descriptors.  Only the descriptors
+ *   with pending events are visited.
+ *
+ * Input Parameters:
+ *   epfd      - The epoll handle
+ *   evs       - The array receiving the events
+ *   maxevents - The size of evs
+ *   timeout   - The timeout in milliseconds; -1 waits forever
+ *   sigmask   - The signal mask to use during the wait, may be NULL
+ *
+ * Returned Value:
+ *   The number of events on success; -1 (ERROR) with errno set on failure.
+ *
  ****************************************************************************/
 
 int epoll_pwait(int epfd, FAR struct epoll_event *evs,
                 int maxevents, int timeout, FAR const sigset_t *sigmask)
 {
-  /* REVISIT: This will not work on machines where:
-   * sizeof(struct epoll_head *) > sizeof(int)
-   */
+  FAR struct epoll_head *eph = epoll_head_from(epfd);
+  sigset_t oldmask;
+  irqstate_t flags;
+  clock_t start;
+  clock_t ticks = 0;
+  bool rescan = false;
+  int ret;
+
+  if (maxevents <= 0)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
 
-  FAR struct epoll_head *eph = (FAR struct epoll_head *)((intptr_t)epfd);
-  int counter;
-  int rc;
-  int i;
+  if (timeout > 0)
+    {
+      /* Round timeout up to next full tick, as poll() does */
+
+#if (MSEC_PER_TICK * USEC_PER_MSEC) != USEC_PER_TICK && \
+    defined(CONFIG_HAVE_LONG_LONG)
+      ticks = (((unsigned long long)timeout * USEC_PER_MSEC) +
+               (USEC_PER_TICK - 1)) /
+              USEC_PER_TICK;
+#else
+      ticks = ((unsigned int)timeout + (MSEC_PER_TICK - 1)) /
+              MSEC_PER_TICK;
+#endif
+    }
 
-  if (timeout < 0)
+  if (sigmask != NULL)
     {
-      rc = ppoll(eph->poll, eph->occupied, NULL, sigmask);
+      nxsig_procmask(SIG_SETMASK, sigmask, &oldmask);
     }
-  else
+
+  start = clock_systime_ticks();
+  for (; ; )
     {
-      struct timespec timeout_ts;
+      ret = nxsem_wait(&eph->lock);
+      if (ret < 0)
+        {
+          break;
+        }
 
-      timeout_ts.tv_sec  = timeout / 1000;
-      timeout_ts.tv_nsec = timeout % 1000 * 1000;
+      /* Left over counts of the semaphore come from drivers which post it
+       * directly.  Find the registrations they reported.
+       */
 
-      rc = ppoll(eph->poll, eph->occupied, &timeout_ts, sigmask);
-    }
+      if (rescan || nxsem_trywait(&eph->sem) >= 0)
+        {
+          epoll_rescan(eph);
+          rescan = false;
+        }
 
-  if (rc <= 0)
-    {
-      if (rc < 0)
+      ret = epoll_collect(eph, evs, maxevents);
+      nxsem_post(&eph->lock);
+
+      if (ret > 0 || timeout == 0)
         {
-          ferr("ERROR: %08x poll fail: %d for %d, %d msecs\n",
-               epfd, rc, eph->occupied, timeout);
+          break;
+        }
 
-          for (i = 0; i < eph->occupied; i++)
+      flags = enter_critical_section();
+      if (dq_empty(&eph->ready))
+        {
+          eph->waiting = true;
+          if (timeout > 0)
+            {
+              ret = nxsem_tickwait(&eph->sem, start, ticks);
+            }
+          else
             {
-              ferr("  %02d: fd=%d\n", i, eph->poll[i].fd);
+              ret = nxsem_wait(&eph->sem);
             }
+
+          eph->waiting = false;
+          rescan = dq_empty(&eph->ready);
         }
 
-      return rc;
-    }
+      leave_critical_section(flags);
+
+      if (ret < 0)
+        {
+          /* Return zero in the event of a timeout */
 
-  /* Iterate over non NULL event fds */
+          if (ret == -ETIMEDOUT)
+            {
+              ret = 0;
+            }
+
+          break;
+        }
+    }
 
-  if (rc > maxevents)
+  if (sigmask != NULL)
     {
-      rc = maxevents;
+      nxsig_procmask(SIG_SETMASK, &oldmask, NULL);
     }
 
-  for (i = 0, counter = 0; i < rc && counter < eph->occupied; counter++)
+  if (ret < 0)
     {
-      if (eph->poll[counter].revents != 0)
-        {
-          evs[i].data     = eph->data[counter];
-          evs[i++].events = eph->poll[counter].revents;
-          if (eph->poll[counter].events & EPOLLONESHOT)
-            {
-              eph->poll[counter].events = 0; /* Disable oneshot internally */
-            }
-        }
+      set_errno(-ret);
+      return ERROR;
     }
 
-  return i;
+  return ret;
 }
 
 /****************************************************************************
@@ -33,6 +33,8 @@
 #include <sys/ioctl.h>
 #include <sys/eventfd.h>
 
+#include <nuttx/fs/fs.h>
+
 #include "inode/inode.h"
 
 /****************************************************************************
@@ -169,7 +171,7 @@ static void eventfd_pollnotify(FAR struct eventfd_priv_s *dev,
 
           if (fds->revents != 0)
             {
-              nxsem_post(fds->sem);
+              poll_notify(fds);
             }
         }
     }
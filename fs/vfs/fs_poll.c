@@ -293,6 +293,37 @@ static inline int poll_teardown(FAR struct pollfd *fds, nfds_t nfds,
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: poll_notify
+ *
+ * Description:
+ *   Notify the waiter of a poll descriptor that one of the events it
+ *   monitors occurred.  revents must have been updated by the caller.  This
+ *   queues an epoll registration on the ready list of its instance,
+ *   otherwise it posts the semaphore.  It may be called from interrupt
+ *   handlers.
+ *
+ ****************************************************************************/
+
+void poll_notify(FAR struct pollfd *fds)
+{
+  if ((fds->events & POLLMASK) == POLLEPOLL)
+    {
+      epoll_notify(fds);
+    }
+  else if (fds->sem != NULL)
+    {
+      nxsem_post(fds->sem);
+    }
+  else if (fds->ptr != NULL)
+    {
+      FAR struct pollfd *parent = (FAR struct pollfd *)fds->ptr;
+
+      parent->revents |= fds->revents;
+      poll_notify(parent);
+    }
+}
+
 /****************************************************************************
  * Name: file_poll
  *
@@ -347,7 +378,7 @@ int file_poll(FAR struct file *filep, FAR struct pollfd *fds, bool setup)
               fds->revents |= (fds->events & (POLLIN | POLLOUT));
               if (fds->revents != 0)
                 {
-                  nxsem_post(fds->sem);
+                  poll_notify(fds);
                 }
             }
 
@@ -47,6 +47,7 @@
 #include <debug.h>
 
 #include <nuttx/irq.h>
+#include <nuttx/fs/fs.h>
 
 #include "nxterm.h"
 
@@ -78,7 +79,7 @@ static void nxterm_pollnotify(FAR struct nxterm_state_s *priv,
           fds->revents |= (fds->events & eventset);
           if (fds->revents != 0)
             {
-              nxsem_post(fds->sem);
+              poll_notify(fds);
             }
         }
 
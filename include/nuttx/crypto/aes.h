@@ -42,6 +42,7 @@
  ****************************************************************************/
 
 #include <nuttx/config.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /****************************************************************************
@@ -49,6 +50,12 @@
  ****************************************************************************/
 
 #define AES128_KEY_SIZE    16
+#define AES192_KEY_SIZE    24
+#define AES256_KEY_SIZE    32
+
+#define AES_BLOCK_SIZE     16
+#define AES_GCM_IV_SIZE    12  /* Recommended GCM IV size */
+#define AES_GCM_TAG_SIZE   16
 
 /****************************************************************************
  * Public Types
@@ -56,7 +63,13 @@
 
 struct aes_state_s
 {
-  uint8_t expanded_key[176];
+#ifdef CONFIG_CRYPTO_SW_AES_BITSLICE
+  uint32_t skey[120];   /* Bitsliced round keys */
+#else
+  uint32_t ekey[60];    /* Encryption round keys */
+  uint32_t dkey[60];    /* Decryption round keys */
+#endif
+  int nrounds;          /* 10, 12 or 14 */
 };
 
 /****************************************************************************
@@ -118,14 +131,12 @@ void aes_decrypt(FAR uint8_t *state, FAR const uint8_t *key);
  *
  * Input Parameters:
  *  state  an AES context that can be used for AES operations
- *  key    a pointer to a 16-byte buffer holding the AES-128 key
- *  len    length of the key, must be 16
- *
- * TODO: Support other key lengths of 24 (AES-192) and 32 (AES-256)
+ *  key    a pointer to a buffer holding the AES key
+ *  len    length of the key, must be 16, 24 or 32
  *
  * Returned Value:
  *   0 if OK
- *   -EINVAL if len is not 16
+ *   -EINVAL if len is not 16, 24 or 32
  *
  ****************************************************************************/
 
@@ -164,6 +175,94 @@ void aes_encipher(FAR struct aes_state_s *state, FAR uint8_t *blocks,
 void aes_decipher(FAR struct aes_state_s *state, FAR uint8_t *blocks,
                   int nblk);
 
+/****************************************************************************
+ * Name: aes_cbc_encipher
+ *
+ * Description:
+ *   Encipher some 16-byte blocks in CBC mode.  'iv' is updated to the last
+ *   cipher text block so that the next call continues the chain.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void aes_cbc_encipher(FAR struct aes_state_s *state, FAR uint8_t *iv,
+                      FAR uint8_t *blocks, int nblk);
+
+/****************************************************************************
+ * Name: aes_cbc_decipher
+ *
+ * Description:
+ *   Decipher some 16-byte blocks in CBC mode.  'iv' is updated to the last
+ *   cipher text block so that the next call continues the chain.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void aes_cbc_decipher(FAR struct aes_state_s *state, FAR uint8_t *iv,
+                      FAR uint8_t *blocks, int nblk);
+
+/****************************************************************************
+ * Name: aes_ctr_crypt
+ *
+ * Description:
+ *   Encrypt or decrypt 'len' bytes in CTR mode.  The 16-byte counter block
+ *   'ctr' is incremented as a 128-bit big endian integer for each block,
+ *   including a partial last block, so that the next call continues the
+ *   key stream at the next block.  'out' may be the same as 'in'.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void aes_ctr_crypt(FAR struct aes_state_s *state, FAR uint8_t *ctr,
+                   FAR uint8_t *out, FAR const uint8_t *in, size_t len);
+
+/****************************************************************************
+ * Name: aes_gcm_encrypt
+ *
+ * Description:
+ *   Encrypt 'len' bytes in GCM mode and compute the AES_GCM_TAG_SIZE byte
+ *   authentication tag over the additional data 'aad' and the cipher text.
+ *   'out' may be the same as 'in'.
+ *
+ * Returned Value:
+ *   0 if OK
+ *   -EINVAL if the IV is empty
+ *
+ ****************************************************************************/
+
+int aes_gcm_encrypt(FAR struct aes_state_s *state,
+                    FAR const uint8_t *iv, size_t ivlen,
+                    FAR const uint8_t *aad, size_t aadlen,
+                    FAR uint8_t *out, FAR const uint8_t *in, size_t len,
+                    FAR uint8_t *tag);
+
+/****************************************************************************
+ * Name: aes_gcm_decrypt
+ *
+ * Description:
+ *   Decrypt 'len' bytes in GCM mode and check the AES_GCM_TAG_SIZE byte
+ *   authentication tag.  'out' may be the same as 'in'.  If the tag does
+ *   not match, the output is cleared.
+ *
+ * Returned Value:
+ *   0 if OK
+ *   -EINVAL if the IV is empty
+ *   -EBADMSG if the tag does not match
+ *
+ ****************************************************************************/
+
+int aes_gcm_decrypt(FAR struct aes_state_s *state,
+                    FAR const uint8_t *iv, size_t ivlen,
+                    FAR const uint8_t *aad, size_t aadlen,
+                    FAR uint8_t *out, FAR const uint8_t *in, size_t len,
+                    FAR const uint8_t *tag);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
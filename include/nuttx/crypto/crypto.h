@@ -96,6 +96,15 @@ int aes_cypher(FAR void *out, FAR const void *in, uint32_t size,
 int crypto_test(void);
 #endif
 
+/* Test /dev/crypto.  Unlike crypto_test(), which runs when the hardware is
+ * initialized, this needs task context and the registered driver.
+ */
+
+#if defined(CONFIG_CRYPTO_ALGTEST) && defined(CONFIG_CRYPTO_CRYPTODEV) && \
+    (defined(CONFIG_CRYPTO_AES) || defined(CONFIG_CRYPTO_SW_AES))
+int cryptodev_test(void);
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
@@ -53,7 +53,8 @@
 #define CRYPTO_AES_ECB          1
 #define CRYPTO_AES_CBC          2
 #define CRYPTO_AES_CTR          3
-#define CRYPTO_ALGORITHM_MAX    1
+#define CRYPTO_AES_GCM          4  /* ivlen-byte IV, 16-byte tag in mac */
+#define CRYPTO_ALGORITHM_MAX    4
 
 #define CRYPTO_FLAG_HARDWARE    0x01000000 /* hardware accelerated */
 #define CRYPTO_FLAG_SOFTWARE    0x02000000 /* software implementation */
@@ -61,10 +62,14 @@
 #define COP_ENCRYPT             1
 #define COP_DECRYPT             2
 #define COP_F_BATCH             0x0008 /* Batch op if possible */
+#define COP_F_ASYNC             0x0010 /* CIOCCRYPTM: complete in the
+                                        * background, see CIOCCRYPTRET */
 
-#define CIOCGSESSION            101
-#define CIOCFSESSION            102
-#define CIOCCRYPT               103
+#define CIOCGSESSION            101    /* Arg: struct session_op * */
+#define CIOCFSESSION            102    /* Arg: uint32_t *, the session # */
+#define CIOCCRYPT               103    /* Arg: struct crypt_op * */
+#define CIOCCRYPTM              104    /* Arg: struct crypt_mop * */
+#define CIOCCRYPTRET            105    /* Arg: struct crypt_mop ** */
 
 typedef char* caddr_t;
 
@@ -90,6 +95,28 @@ struct crypt_op
   caddr_t src, dst;   /* become iov[] inside kernel */
   caddr_t mac;        /* must be big enough for chosen MAC */
   caddr_t iv;
+  unsigned ivlen;     /* GCM only: IV length, 0 for the 12-byte default */
+  caddr_t aad;        /* additional authenticated data (GCM) */
+  unsigned aadlen;
+  int status;         /* returns: CIOCCRYPTM result of this request */
+};
+
+/* A batch of requests for CIOCCRYPTM.  Each request may use a different
+ * session.  The requests are run in order and the result of each one is
+ * returned in its status field.
+ *
+ * With COP_F_ASYNC, CIOCCRYPTM only queues the batch and returns.  The
+ * batch and the requests, including their buffers, must then stay valid
+ * until CIOCCRYPTRET has returned the batch.  poll() reports POLLIN when a
+ * completed batch can be taken with CIOCCRYPTRET and POLLOUT when another
+ * batch can be queued.
+ */
+
+struct crypt_mop
+{
+  uint16_t flags;     /* i.e. COP_F_ASYNC */
+  unsigned count;     /* number of requests */
+  FAR struct crypt_op *reqs;
 };
 
 #endif /* __INCLUDE_NUTTX_CRYPTO_CRYPTODEV_H */
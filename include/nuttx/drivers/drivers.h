@@ -46,6 +46,23 @@
 #include <sys/types.h>
 #include <stdbool.h>
 
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+#ifdef CONFIG_DEV_PIPE_SPLICE
+/* Argument of the PIPEIOC_SPLICEOUT and PIPEIOC_SPLICEIN ioctl commands.
+ * Data is moved directly between the pipe's circular buffer and the file or
+ * socket descriptor 'fd' without an intermediate user buffer.
+ */
+
+struct pipe_splice_s
+{
+  int    fd;   /* File or socket descriptor at the other end */
+  size_t len;  /* Maximum number of bytes to move */
+};
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -102,6 +102,21 @@
 #define __FS_FLAG_LBF   (1 << 2) /* Line buffered */
 #define __FS_FLAG_UBF   (1 << 3) /* Buffer allocated by caller of setvbuf */
 
+/* The file descriptors of a task are allocated in blocks.  struct filelist
+ * holds a pointer to each block that can exist.
+ */
+
+#define FILELIST_PERBLOCK CONFIG_NFILE_DESCRIPTORS_PER_BLOCK
+#define FILELIST_MAXROWS  ((CONFIG_NFILE_DESCRIPTORS + FILELIST_PERBLOCK - 1) / \
+                           FILELIST_PERBLOCK)
+
+/* The descriptor type of the persistent poll registrations of epoll.  poll()
+ * rejects this combination of the POLLMASK bits, so poll_notify() can tell
+ * the registrations apart from the descriptors of poll() and select().
+ */
+
+#define POLLEPOLL       (POLLFILE | POLLSOCK)
+
 /* Inode i_flags values:
  *
  *   Bit 0-3: Inode type (Bit 3 indicates internal OS types)
@@ -412,12 +427,27 @@ struct file
   void             *f_priv;     /* Per file driver private data */
 };
 
-/* This defines a list of files indexed by the file descriptor */
+/* This defines a list of files indexed by the file descriptor.  The files
+ * are allocated in blocks of CONFIG_NFILE_DESCRIPTORS_PER_BLOCK when a
+ * descriptor in the block is first used, so a task only pays for the
+ * descriptors that it actually uses.  A block never moves once allocated.
+ * Use files_fget() to get the file of a descriptor.
+ */
 
 struct filelist
 {
-  sem_t   fl_sem;               /* Manage access to the file list */
-  struct file fl_files[CONFIG_NFILE_DESCRIPTORS];
+  sem_t            fl_sem;      /* Manage access to the file list */
+
+  /* Bitmaps of the descriptors in use in each block and of the blocks with
+   * no free descriptor.
+   */
+
+  uint32_t         fl_used[FILELIST_MAXROWS];
+  uint32_t         fl_full[(FILELIST_MAXROWS + 31) / 32];
+
+  /* The blocks of files, NULL until a descriptor in the block is used */
+
+  FAR struct file *fl_files[FILELIST_MAXROWS];
 };
 
 /* The following structure defines the list of files used for standard C I/O.
@@ -744,6 +774,29 @@ void files_initlist(FAR struct filelist *list);
 
 void files_releaselist(FAR struct filelist *list);
 
+/****************************************************************************
+ * Name: files_fget
+ *
+ * Description:
+ *   Return the file that underlies the file descriptor 'fd' in 'list', or
+ *   NULL if no descriptor in its block has been used yet.
+ *
+ ****************************************************************************/
+
+FAR struct file *files_fget(FAR struct filelist *list, int fd);
+
+/****************************************************************************
+ * Name: files_duplist
+ *
+ * Description:
+ *   Duplicate the first 'nfds' file descriptors of the parent list that are
+ *   open and not marked O_CLOEXEC into the child list.
+ *
+ ****************************************************************************/
+
+void files_duplist(FAR struct filelist *plist, FAR struct filelist *clist,
+                   int nfds);
+
 /****************************************************************************
  * Name: file_dup
  *
@@ -1412,6 +1465,65 @@ int fs_poll(int fd, FAR struct pollfd *fds, bool setup);
 
 int nx_poll(FAR struct pollfd *fds, unsigned int nfds, int timeout);
 
+/****************************************************************************
+ * Name: poll_notify
+ *
+ * Description:
+ *   Notify the waiter of a poll descriptor that one of the events it
+ *   monitors occurred.  revents must have been updated by the caller.  This
+ *   queues an epoll registration on the ready list of its instance,
+ *   otherwise it posts the semaphore.  It may be called from interrupt
+ *   handlers.
+ *
+ *   A descriptor with a NULL sem is a shadow that a driver set up with
+ *   other drivers on behalf of the descriptor in its ptr field.  Its
+ *   revents are merged into that descriptor, which is then notified.
+ *
+ * Input Parameters:
+ *   fds - The poll descriptor to notify
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void poll_notify(FAR struct pollfd *fds);
+
+/****************************************************************************
+ * Name: epoll_notify
+ *
+ * Description:
+ *   Queue an epoll registration on the ready list of its instance.  This is
+ *   an internal interface used by poll_notify().
+ *
+ * Input Parameters:
+ *   fds - The poll descriptor of the registration, marked with POLLEPOLL
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void epoll_notify(FAR struct pollfd *fds);
+
+/****************************************************************************
+ * Name: epoll_detach
+ *
+ * Description:
+ *   Remove the registrations of a file or socket from all of the epoll
+ *   instances.  This is called when the file or socket is closed, so that
+ *   no driver is left with a reference to a registration.
+ *
+ * Input Parameters:
+ *   ptr - The struct file or struct socket being closed
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void epoll_detach(FAR const void *ptr);
+
 /****************************************************************************
  * Name: file_fstat
  *
@@ -405,6 +405,14 @@
                                              *       (default)
                                              *     1=fre when empty
                                              * OUT: None */
+#define PIPEIOC_SPLICEOUT _PIPEIOC(0x0002)  /* Move data from the pipe to a
+                                             * descriptor
+                                             * IN:  FAR struct pipe_splice_s
+                                             * OUT: Bytes moved (returned) */
+#define PIPEIOC_SPLICEIN  _PIPEIOC(0x0003)  /* Move data from a descriptor
+                                             * into the pipe
+                                             * IN:  FAR struct pipe_splice_s
+                                             * OUT: Bytes moved (returned) */
 
 /* RTC driver ioctl definitions *********************************************/
 
@@ -46,6 +46,9 @@
 #ifndef __ASSEMBLY__
 # include <stdint.h>
 # include <assert.h>
+# ifdef CONFIG_SPINLOCK_SUBSYS
+#   include <nuttx/spinlock.h>
+# endif
 #endif
 
 /* Now include architecture-specific types */
@@ -120,8 +123,43 @@ typedef uint32_t irq_mapped_t;
 /* This struct defines the form of an interrupt service routine */
 
 typedef CODE int (*xcpt_t)(int irq, FAR void *context, FAR void *arg);
+
+/* A spinlock that protects the data of one subsystem in place of the global
+ * critical section.  Subsystem spinlocks may only be nested in increasing
+ * order of their ranks (IRQSPIN_RANK_*), and the global critical section
+ * must not be entered while one is held.
+ */
+
+#ifdef CONFIG_SPINLOCK_SUBSYS
+typedef struct
+{
+  volatile spinlock_t lock;     /* The spinlock itself */
+#ifdef CONFIG_SPINLOCK_LOCKDEP
+  uint8_t rank;                 /* Nesting order of the lock */
+#endif
+} irqspinlock_t;
+#else
+typedef uint8_t irqspinlock_t;  /* Not used: The global lock is taken */
+#endif
 #endif /* __ASSEMBLY__ */
 
+/* Ranks of the subsystem spinlocks.  A lower ranked lock must be taken
+ * before a higher ranked lock.
+ */
+
+#define IRQSPIN_RANK_WDOG       1
+#define IRQSPIN_RANK_MQUEUE     2
+#define IRQSPIN_RANK_IOB        3
+#define IRQSPIN_RANK_IOBQ       4
+
+#if !defined(CONFIG_SPINLOCK_SUBSYS)
+#  define IRQSPINLOCK_INITIALIZER(r) 0
+#elif defined(CONFIG_SPINLOCK_LOCKDEP)
+#  define IRQSPINLOCK_INITIALIZER(r) { SP_UNLOCKED, (r) }
+#else
+#  define IRQSPINLOCK_INITIALIZER(r) { SP_UNLOCKED }
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -294,6 +332,60 @@ void spin_unlock_irqrestore(irqstate_t flags);
 #  define spin_unlock_irqrestore(f) leave_critical_section(f)
 #endif
 
+/****************************************************************************
+ * Name: irqspin_lock
+ *
+ * Description:
+ *   If SPINLOCK_SUBSYS is enabled:
+ *     Disable local interrupts and take the subsystem spinlock 'lock'.
+ *     The lock is not recursive.  Like spin_lock_irqsave(), do not call
+ *     kernel APIs that may suspend the caller while the lock is held.
+ *
+ *   If SPINLOCK_SUBSYS is not enabled:
+ *     This function is equivalent to enter_critical_section().
+ *
+ * Input Parameters:
+ *   lock - The subsystem spinlock
+ *
+ * Returned Value:
+ *   An opaque, architecture-specific value that represents the state of
+ *   the interrupts prior to the call to irqspin_lock();
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SPINLOCK_SUBSYS
+irqstate_t irqspin_lock(FAR irqspinlock_t *lock);
+#else
+#  define irqspin_lock(l) enter_critical_section()
+#endif
+
+/****************************************************************************
+ * Name: irqspin_unlock
+ *
+ * Description:
+ *   If SPINLOCK_SUBSYS is enabled:
+ *     Release the subsystem spinlock 'lock' and restore the interrupt state
+ *     as it was prior to the matching call to irqspin_lock().
+ *
+ *   If SPINLOCK_SUBSYS is not enabled:
+ *     This function is equivalent to leave_critical_section().
+ *
+ * Input Parameters:
+ *   lock  - The subsystem spinlock
+ *   flags - The architecture-specific value that represents the state of
+ *           the interrupts prior to the call to irqspin_lock();
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SPINLOCK_SUBSYS
+void irqspin_unlock(FAR irqspinlock_t *lock, irqstate_t flags);
+#else
+#  define irqspin_unlock(l,f) leave_critical_section(f)
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -203,6 +203,9 @@ enum iob_user_e
 #ifdef CONFIG_NET_IPFORWARD
   IOBUSER_NET_IPFORWARD,
 #endif
+#ifdef CONFIG_NETDEV_IOB_RX
+  IOBUSER_NET_NETDEV,
+#endif
 #ifdef CONFIG_WIRELESS_IEEE802154
   IOBUSER_WIRELESS_RAD802154,
 #endif
@@ -587,6 +590,24 @@ void iob_dump(FAR const char *msg, FAR struct iob_s *iob, unsigned int len,
 #  define iob_dump(wrb)
 #endif
 
+/****************************************************************************
+ * Name: iob_reassign
+ *
+ * Description:
+ *   Hand an I/O buffer chain over from one IOB user to another.  For the
+ *   IOB statistics, the buffers are counted as freed by the old user and
+ *   allocated by the new one, which must then free them.
+ *
+ ****************************************************************************/
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+    !defined(CONFIG_FS_PROCFS_EXCLUDE_IOBINFO)
+void iob_reassign(FAR struct iob_s *iob, enum iob_user_e producerid,
+                  enum iob_user_e consumerid);
+#else
+#  define iob_reassign(iob,producerid,consumerid)
+#endif
+
 /****************************************************************************
  * Name: iob_getuserstats
  *
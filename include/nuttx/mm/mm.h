@@ -32,6 +32,10 @@
 #include <string.h>
 #include <semaphore.h>
 
+#if defined(CONFIG_MM_FASTBINS) && defined(CONFIG_SMP)
+#  include <nuttx/spinlock.h>
+#endif
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -163,6 +167,60 @@
 #define MM_IS_ALLOCATED(n) \
   ((int)((struct mm_allocnode_s*)(n)->preceding) < 0)
 
+/* Fast bins.  Small chunks that are freed are cached in per-size-class
+ * (and, for SMP, per-CPU) lists in front of the coalescing allocator.  The
+ * fast bins are protected by disabling local interrupts rather than by the
+ * heap semaphore.  That is only possible in the FLAT build or within the
+ * kernel, so user-space copies of the allocator never use the fast path.
+ * The fields in struct mm_heap_s exist in either case so that the heap
+ * layout is the same in the kernel and in user space.
+ */
+
+#ifdef CONFIG_MM_FASTBINS
+#  if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+#    define MM_USE_FASTBINS 1
+#  endif
+
+#  define MM_FASTBIN_MAXCHUNK \
+     MM_ALIGN_UP(CONFIG_MM_FASTBIN_MAXSIZE + SIZEOF_MM_ALLOCNODE)
+#  define MM_FASTBIN_NCLASSES   (MM_FASTBIN_MAXCHUNK >> MM_MIN_SHIFT)
+#  define MM_FASTBIN_CLASS(s)   (((s) >> MM_MIN_SHIFT) - 1)
+
+#  ifdef CONFIG_SMP
+#    define MM_FASTBIN_NCPUS    CONFIG_SMP_NCPUS
+#  else
+#    define MM_FASTBIN_NCPUS    1
+#  endif
+#endif
+
+/* TLSF heap manager.  Free chunk sizes are mapped to a first level index
+ * (the power of two of the size) and a second level index (a linear
+ * subdivision of that power of two into MM_TLSF_SL_COUNT ranges).  Sizes
+ * below MM_TLSF_SMALL_CHUNK all share first level index zero and have one
+ * second level list per granule.  A bitmap of non-empty lists at each
+ * level makes the search for a suitable free chunk constant time.
+ */
+
+#ifdef CONFIG_MM_TLSF_MANAGER
+#  define MM_TLSF_SL_SHIFT      CONFIG_MM_TLSF_SL_SHIFT
+#  define MM_TLSF_SL_COUNT      (1 << MM_TLSF_SL_SHIFT)
+#  define MM_TLSF_FL_SHIFT      (MM_TLSF_SL_SHIFT + MM_MIN_SHIFT)
+#  define MM_TLSF_SMALL_CHUNK   (1 << MM_TLSF_FL_SHIFT)
+
+/* Chunk sizes are limited by the width of mmsize_t less the allocated
+ * bit.
+ */
+
+#  ifdef CONFIG_MM_SMALL
+#    define MM_TLSF_FL_MAX      15
+#  else
+#    define MM_TLSF_FL_MAX      31
+#  endif
+
+#  define MM_TLSF_FL_COUNT      (MM_TLSF_FL_MAX - MM_TLSF_FL_SHIFT + 1)
+#  define MM_TLSF_MAX_CHUNK     ((size_t)1 << MM_TLSF_FL_MAX)
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -214,6 +272,25 @@ struct mm_delaynode_s
   struct mm_delaynode_s *flink;
 };
 
+#ifdef CONFIG_MM_FASTBINS
+/* A chunk cached in a fast bin remains marked as allocated.  The link to
+ * the next cached chunk of the same size class is kept in the payload.
+ */
+
+struct mm_fastnode_s
+{
+  FAR struct mm_fastnode_s *flink;
+};
+
+/* This describes the fast bin of one size class (on one CPU) */
+
+struct mm_fastbin_s
+{
+  FAR struct mm_fastnode_s *head;  /* Most recently freed chunk */
+  uint16_t count;                  /* Number of chunks in the bin */
+};
+#endif
+
 /* What is the size of the freenode? */
 
 #define MM_PTR_SIZE sizeof(FAR struct mm_freenode_s *)
@@ -247,16 +324,39 @@ struct mm_heap_s
   int mm_nregions;
 #endif
 
+#ifdef CONFIG_MM_TLSF_MANAGER
+  /* Free nodes are kept in segregated, doubly linked lists, one for each
+   * (first level, second level) size range.  The bitmaps mark the
+   * non-empty lists.
+   */
+
+  uint32_t mm_flbitmap;
+  uint32_t mm_slbitmap[MM_TLSF_FL_COUNT];
+  FAR struct mm_freenode_s *mm_freelist[MM_TLSF_FL_COUNT][MM_TLSF_SL_COUNT];
+#else
   /* All free nodes are maintained in a doubly linked list.  This
    * array provides some hooks into the list at various points to
    * speed searches for free nodes.
    */
 
   struct mm_freenode_s mm_nodelist[MM_NNODES];
+#endif
 
   /* Free delay list, for some situation can't do free immdiately */
 
   struct mm_delaynode_s *mm_delaylist;
+
+#ifdef CONFIG_MM_FASTBINS
+  /* Small chunks cached in front of the coalescing allocator */
+
+  struct mm_fastbin_s mm_fastbin[MM_FASTBIN_NCPUS][MM_FASTBIN_NCLASSES];
+
+#ifdef CONFIG_SMP
+  /* Protects the fast bins of each CPU against a flush from another CPU */
+
+  spinlock_t mm_fastlock[MM_FASTBIN_NCPUS];
+#endif
+#endif
 };
 
 /****************************************************************************
@@ -370,6 +470,7 @@ FAR void *kmm_malloc(size_t size);
 /* Functions contained in mm_free.c *****************************************/
 
 void mm_free(FAR struct mm_heap_s *heap, FAR void *mem);
+void mm_freechunk(FAR struct mm_heap_s *heap, FAR void *mem);
 
 /* Functions contained in kmm_free.c ****************************************/
 
@@ -501,6 +602,19 @@ void mm_addfreechunk(FAR struct mm_heap_s *heap,
 
 int mm_size2ndx(size_t size);
 
+/* Functions contained in mm_fastbin.c **************************************/
+
+#ifdef CONFIG_MM_FASTBINS
+void mm_fastbin_initialize(FAR struct mm_heap_s *heap);
+#ifdef MM_USE_FASTBINS
+FAR void *mm_fastbin_alloc(FAR struct mm_heap_s *heap, size_t alignsize);
+bool mm_fastbin_free(FAR struct mm_heap_s *heap, FAR void *mem);
+bool mm_fastbin_flush(FAR struct mm_heap_s *heap);
+#endif
+void mm_fastbin_mallinfo(FAR struct mm_heap_s *heap, FAR int *nchunks,
+                         FAR size_t *nbytes);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -39,6 +39,10 @@
 #  include <nuttx/mm/iob.h>
 #endif
 
+#ifdef CONFIG_NET_CONN_LOCK
+#  include <nuttx/mutex.h>
+#endif
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -81,6 +85,28 @@
 #  define _NX_GETERRVAL(r)          (-errno)
 #endif
 
+/* Per-connection locks.  'rdlock' protects the read-ahead queue of a
+ * connection, which is filled by the network (with the network locked) and
+ * drained by recv() without the network lock.  It is only held while the
+ * queue is updated, never while data is copied, so the network never waits
+ * for a copy to the caller.  If both locks are needed, the network lock
+ * must be taken first.
+ *
+ * 'rcvlock' serializes the receivers of a connection so that the one
+ * holding it may copy from the head of the queue without 'rdlock'.  It must
+ * be taken before the network lock and released before waiting for data.
+ */
+
+#ifdef CONFIG_NET_CONN_LOCK
+#  define net_connlock_init(l)  nxmutex_init(l)
+#  define net_connlock(l)       nxmutex_lock(l)
+#  define net_connunlock(l)     nxmutex_unlock(l)
+#else
+#  define net_connlock_init(l)
+#  define net_connlock(l)
+#  define net_connunlock(l)
+#endif
+
 /* Socket descriptors are the index into the TCB sockets list, offset by the
  * following amount. This offset is used to distinguish file descriptors from
  * socket descriptors
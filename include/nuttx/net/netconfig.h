@@ -388,6 +388,14 @@
 #  define CONFIG_NET_MAX_LISTENPORTS 20
 #endif
 
+/* The maximum number of segments that a TCP connection may send during
+ * one poll of the network driver.
+ */
+
+#ifndef CONFIG_NET_TCP_POLL_BATCH
+#  define CONFIG_NET_TCP_POLL_BATCH 1
+#endif
+
 /* Define the maximum number of concurrently active UDP and TCP
  * ports.  This number must be greater than the number of open
  * sockets in order to support multi-threaded read/write operations.
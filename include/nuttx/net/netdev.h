@@ -51,6 +51,7 @@
 
 #include <sys/ioctl.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <queue.h>
 
 #include <net/if.h>
@@ -220,6 +221,7 @@ struct netdev_varaddr_s
  */
 
 struct devif_callback_s; /* Forward reference */
+struct iob_s;            /* Forward reference */
 
 struct net_driver_s
 {
@@ -340,6 +342,34 @@ struct net_driver_s
 
   uint16_t d_sndlen;
 
+#ifdef CONFIG_NETDEV_IOB_RX
+  /* When the driver passes a received packet as an I/O buffer, d_iob is the
+   * I/O buffer that d_buf refers to and d_drvbuf holds the driver's own
+   * packet buffer until netdev_iob_release() is called.
+   */
+
+  FAR struct iob_s *d_iob;
+  FAR uint8_t *d_drvbuf;
+#endif
+
+#ifdef CONFIG_NETDEV_IOB_TX
+  /* A driver that can gather an outgoing packet from several buffers sets
+   * d_txsg before registering the device.  The network may then leave the
+   * payload of an outgoing packet in the I/O buffer chain d_txiob instead
+   * of copying it into d_buf:  The first d_len - d_txlen bytes of the
+   * packet are in d_buf and the remaining d_txlen bytes are in d_txiob,
+   * starting at offset d_txoffset.  d_txiob is NULL if the whole packet is
+   * in d_buf.  The driver must walk the chain while it sends the packet;
+   * the payload data itself stays valid until the peer has acknowledged
+   * it.
+   */
+
+  bool d_txsg;
+  FAR struct iob_s *d_txiob;
+  uint16_t d_txoffset;
+  uint16_t d_txlen;
+#endif
+
   /* Multicast group support */
 
 #ifdef CONFIG_NET_IGMP
@@ -739,4 +769,84 @@ uint16_t ipv4_chksum(FAR struct net_driver_s *dev);
 
 int netdev_lladdrsize(FAR struct net_driver_s *dev);
 
+/****************************************************************************
+ * Name: netdev_iob_prepare
+ *
+ * Description:
+ *   Make a received packet held in an I/O buffer chain the current packet
+ *   of the device.  If the packet is in a single I/O buffer that can also
+ *   hold a response of the device packet size, d_buf is pointed into the
+ *   I/O buffer so that the network can keep the received data without
+ *   copying it.  Otherwise, the packet is copied into d_buf and the I/O
+ *   buffer chain is freed.
+ *
+ *   On return, d_buf and d_len are set up for the input functions
+ *   (ipv4_input(), arp_arpin(), ...).  netdev_iob_release() must be
+ *   called once the driver no longer needs d_buf, i.e., after any
+ *   response has been sent.
+ *
+ * Input Parameters:
+ *   dev - The device that received the packet
+ *   iob - The I/O buffer chain holding the packet, including the link
+ *         layer header.  It must have been allocated for the
+ *         IOBUSER_NET_NETDEV user.  Ownership passes to the network.
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called from the network driver with the network locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_IOB_RX
+void netdev_iob_prepare(FAR struct net_driver_s *dev, FAR struct iob_s *iob);
+#endif
+
+/****************************************************************************
+ * Name: netdev_iob_release
+ *
+ * Description:
+ *   Free the I/O buffer that backs d_buf (if any) and restore the driver's
+ *   own packet buffer.
+ *
+ * Input Parameters:
+ *   dev - The device
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called from the network driver with the network locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_IOB_RX
+void netdev_iob_release(FAR struct net_driver_s *dev);
+#endif
+
+/****************************************************************************
+ * Name: netdev_iob_txflatten
+ *
+ * Description:
+ *   Copy the payload of an outgoing packet that is held in d_txiob into
+ *   d_buf behind the packet headers so that the whole packet is in d_buf.
+ *   A driver that sets d_txsg may use this for packets that it cannot
+ *   gather, e.g., if it runs out of transmit descriptors.
+ *
+ * Input Parameters:
+ *   dev - The device
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called from the network driver with the network locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_IOB_TX
+void netdev_iob_txflatten(FAR struct net_driver_s *dev);
+#endif
+
 #endif /* __INCLUDE_NUTTX_NET_NETDEV_H */
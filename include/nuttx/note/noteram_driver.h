@@ -41,14 +41,22 @@
  *              - Get overwrite mode
  *                Argument: A writable pointer to unsigned int
  * NOTERAM_SETMODE
- *              - Set overwrite mode
+ *              - Set overwrite mode of all per-CPU buffers
  *                Argument: A read-only pointer to unsigned int
+ * NOTERAM_GETCPUMODE
+ *              - Get overwrite mode of one per-CPU buffer
+ *                Argument: A pointer to struct noteram_cpumode_s
+ * NOTERAM_SETCPUMODE
+ *              - Set overwrite mode of one per-CPU buffer
+ *                Argument: A read-only pointer to struct noteram_cpumode_s
  */
 
 #ifdef CONFIG_DRIVER_NOTERAM
 #define NOTERAM_CLEAR           _NOTERAMIOC(0x01)
 #define NOTERAM_GETMODE         _NOTERAMIOC(0x02)
 #define NOTERAM_SETMODE         _NOTERAMIOC(0x03)
+#define NOTERAM_GETCPUMODE      _NOTERAMIOC(0x04)
+#define NOTERAM_SETCPUMODE      _NOTERAMIOC(0x05)
 #endif
 
 /* Overwrite mode definitions */
@@ -59,6 +67,79 @@
 #define NOTERAM_MODE_OVERWRITE_OVERFLOW     2
 #endif
 
+/* Compact note format
+ *
+ * With CONFIG_DRIVER_NOTERAM_COMPACT, the notes are kept in the buffers in
+ * a compact encoding and /dev/note returns a stream of records in this
+ * format instead of the structures of include/nuttx/sched_note.h.  Fields
+ * marked V are unsigned LEB128 varints.
+ *
+ *   Size  Field
+ *   1     Length of the record in bytes, including this field
+ *   1     CPU index or NOTERAM_CPU_HEADER
+ *   V     Time since the previous record in time stamp units
+ *   1     Note type (enum note_type_e)
+ *   V     Thread/task ID
+ *   ...   Type specific data:
+ *         NOTE_START:                      priority (1), CPU (1), task name
+ *                                          (rest of the record)
+ *         NOTE_STOP, NOTE_RESUME:          priority (1), CPU (1)
+ *         NOTE_SUSPEND:                    priority (1), CPU (1),
+ *                                          NOTERAM_STATE_* (1)
+ *         NOTE_CPU_START/PAUSE/RESUME:     target CPU (1)
+ *         NOTE_PREEMPT_LOCK/UNLOCK:        count (V)
+ *         NOTE_SPINLOCK_*:                 spinlock address (V), value (1)
+ *         NOTE_SYSCALL_ENTER:              syscall number (1)
+ *         NOTE_SYSCALL_LEAVE:              syscall number (1), result (V,
+ *                                          zigzag encoded)
+ *         NOTE_IRQ_ENTER/LEAVE:            IRQ number (1)
+ *
+ * The stream starts with a header record instead:
+ *
+ *   1     Length of the record in bytes
+ *   1     NOTERAM_CPU_HEADER
+ *   1     NOTERAM_COMPACT_VERSION
+ *   1     Number of CPUs
+ *   V     Low 32 bits of the duration of 1024 time stamp units in ns
+ *   V     High 32 bits of the same
+ *
+ * The CPU of the task in the NOTE_START/STOP/SUSPEND/RESUME records, which
+ * may differ from the CPU that recorded the note, is only present if there
+ * is more than one CPU.  The time of the first note following the header
+ * is relative to zero.
+ */
+
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+#define NOTERAM_COMPACT_VERSION             1
+#define NOTERAM_CPU_HEADER                  0xff
+#endif
+
+/* Task states reported in the compact NOTE_SUSPEND record */
+
+#ifdef CONFIG_DRIVER_NOTERAM_COMPACT
+#define NOTERAM_STATE_READY                 0  /* Preempted */
+#define NOTERAM_STATE_WAIT_SEM              1  /* Waiting for a semaphore */
+#define NOTERAM_STATE_WAIT_SIG              2  /* Waiting for a signal */
+#define NOTERAM_STATE_WAIT_MQ               3  /* Waiting for a message queue */
+#define NOTERAM_STATE_OTHER                 4  /* Any other blocked state */
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* This is the type of the argument passed to the NOTERAM_GETCPUMODE and
+ * NOTERAM_SETCPUMODE ioctls
+ */
+
+#ifdef CONFIG_DRIVER_NOTERAM
+struct noteram_cpumode_s
+{
+  unsigned int cpu;           /* Index of the CPU owning the buffer */
+  unsigned int mode;          /* NOTERAM_MODE_OVERWRITE_* */
+};
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
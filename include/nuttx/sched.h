@@ -834,6 +834,19 @@ EXTERN uint32_t g_crit_max[CONFIG_SMP_NCPUS];
 EXTERN uint32_t g_premp_max[1];
 EXTERN uint32_t g_crit_max[1];
 #endif
+
+/* Total time within critical sections and number of critical sections
+ * entered by threads.  On SMP, this is the time that the CPU held the
+ * global critical section lock.
+ */
+
+#ifdef CONFIG_SMP_NCPUS
+EXTERN uint64_t g_crit_total[CONFIG_SMP_NCPUS];
+EXTERN uint32_t g_crit_count[CONFIG_SMP_NCPUS];
+#else
+EXTERN uint64_t g_crit_total[1];
+EXTERN uint32_t g_crit_count[1];
+#endif
 #endif /* CONFIG_SCHED_CRITMONITOR */
 
 /********************************************************************************
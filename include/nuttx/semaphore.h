@@ -27,6 +27,7 @@
 
 #include <nuttx/config.h>
 
+#include <stdbool.h>
 #include <errno.h>
 #include <semaphore.h>
 
@@ -686,6 +687,99 @@ int nxsem_clockwait_uninterruptible(FAR sem_t *sem, clockid_t clockid,
 int nxsem_tickwait_uninterruptible(FAR sem_t *sem, clock_t start,
                                    uint32_t delay);
 
+#ifdef CONFIG_SEM_FASTPATH
+/****************************************************************************
+ * Name: sem_wait_slow, sem_trywait_slow, sem_post_slow
+ *
+ * Description:
+ *   The OS implementations of sem_wait(), sem_trywait() and sem_post().
+ *   With CONFIG_SEM_FASTPATH the C library provides the standard
+ *   interfaces, which call these only when the fast path fails.
+ *
+ ****************************************************************************/
+
+int sem_wait_slow(FAR sem_t *sem);
+int sem_trywait_slow(FAR sem_t *sem);
+int sem_post_slow(FAR sem_t *sem);
+
+/****************************************************************************
+ * Name: nxsem_fast_trywait
+ *
+ * Description:
+ *   Take a count of the semaphore with an atomic compare-and-swap if one is
+ *   available.  Returns false if the caller must use the slow path instead:
+ *   no count is available, priority inheritance is enabled on the
+ *   semaphore, or the architecture has no lock-free 16-bit atomics.
+ *
+ ****************************************************************************/
+
+static inline bool nxsem_fast_trywait(FAR sem_t *sem)
+{
+#if __GCC_ATOMIC_SHORT_LOCK_FREE == 2
+  int16_t count;
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+  if ((sem->flags & PRIOINHERIT_FLAGS_DISABLE) == 0)
+    {
+      return false;
+    }
+#endif
+
+  count = sem->semcount;
+  while (count > 0)
+    {
+      if (__atomic_compare_exchange_n(&sem->semcount, &count, count - 1,
+                                      false, __ATOMIC_ACQUIRE,
+                                      __ATOMIC_RELAXED))
+        {
+          return true;
+        }
+    }
+#endif
+
+  return false;
+}
+
+/****************************************************************************
+ * Name: nxsem_fast_post
+ *
+ * Description:
+ *   Give a count to the semaphore with an atomic compare-and-swap if no
+ *   thread is waiting for it.  Returns false if the caller must use the
+ *   slow path instead: there are waiters to wake, the count would
+ *   overflow, priority inheritance is enabled on the semaphore, or the
+ *   architecture has no lock-free 16-bit atomics.
+ *
+ ****************************************************************************/
+
+static inline bool nxsem_fast_post(FAR sem_t *sem)
+{
+#if __GCC_ATOMIC_SHORT_LOCK_FREE == 2
+  int16_t count;
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+  if ((sem->flags & PRIOINHERIT_FLAGS_DISABLE) == 0)
+    {
+      return false;
+    }
+#endif
+
+  count = sem->semcount;
+  while (count >= 0 && count < SEM_VALUE_MAX)
+    {
+      if (__atomic_compare_exchange_n(&sem->semcount, &count, count + 1,
+                                      false, __ATOMIC_RELEASE,
+                                      __ATOMIC_RELAXED))
+        {
+          return true;
+        }
+    }
+#endif
+
+  return false;
+}
+#endif /* CONFIG_SEM_FASTPATH */
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -121,6 +121,11 @@
   ((dev)->ops->dmarxfree ? (dev)->ops->dmarxfree(dev) : -ENOSYS)
 #endif
 
+#ifdef CONFIG_SERIAL_BLOCKIO
+#define uart_recvbuf(dev,b,n)  dev->ops->recvbuf(dev,b,n)
+#define uart_sendbuf(dev,b,n)  dev->ops->sendbuf(dev,b,n)
+#endif
+
 #ifdef CONFIG_SERIAL_IFLOWCONTROL
 #  define uart_rxflowcontrol(dev,n,u) \
     (dev->ops->rxflowcontrol && dev->ops->rxflowcontrol(dev,n,u))
@@ -270,6 +275,30 @@ struct uart_ops_s
    */
 
   CODE bool (*txempty)(FAR struct uart_dev_s *dev);
+
+  /* The block methods are last so that positional initializers of the
+   * existing lower halves stay valid.
+   */
+
+#ifdef CONFIG_SERIAL_BLOCKIO
+  /* Optional.  Move up to 'buflen' bytes that are already available in the
+   * receive FIFO (or in a completed DMA block) into 'buffer'.  Returns the
+   * number of bytes moved, zero if nothing is available.  Returning fewer
+   * than 'buflen' bytes tells the caller that the receiver is drained.
+   */
+
+  CODE size_t (*recvbuf)(FAR struct uart_dev_s *dev, FAR char *buffer,
+                         size_t buflen);
+
+  /* Optional.  Queue up to 'buflen' bytes from 'buffer' for transmission.
+   * Returns the number of bytes accepted, zero if the transmit FIFO is full.
+   * Accepting fewer than 'buflen' bytes tells the caller to wait for the
+   * next TX interrupt.
+   */
+
+  CODE size_t (*sendbuf)(FAR struct uart_dev_s *dev, FAR const char *buffer,
+                         size_t buflen);
+#endif
 };
 
 /* This is the device structure used by the driver.  The caller of
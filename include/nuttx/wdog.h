@@ -27,6 +27,7 @@
 
 #include <nuttx/config.h>
 
+#include <sys/types.h>
 #include <stdint.h>
 #include <queue.h>
 
@@ -73,11 +74,19 @@ typedef CODE void (*wdentry_t)(wdparm_t arg);
 struct wdog_s
 {
   FAR struct wdog_s *next;       /* Support for singly linked lists. */
+#ifdef CONFIG_WDOG_TIMINGWHEEL
+  FAR struct wdog_s *prev;       /* Support for doubly linked wheel slots */
+#endif
   wdentry_t          func;       /* Function to execute when delay expires */
 #ifdef CONFIG_PIC
   FAR void          *picbase;    /* PIC base address */
 #endif
+#ifdef CONFIG_WDOG_TIMINGWHEEL
+  clock_t            expired;    /* Tick at which the watchdog expires */
+  uint8_t            slot;       /* Wheel level and slot holding the wdog */
+#else
   int                lag;        /* Timer associated with the delay */
+#endif
   uint8_t            flags;      /* See WDOGF_* definitions above */
   wdparm_t           arg;        /* Callback argument */
 };
@@ -58,12 +58,16 @@
 
 #define PRIOINHERIT_FLAGS_DISABLE (1 << 0)  /* Bit 0: Priority inheritance
                                              * is disabled for this semaphore. */
+                                            /* Bit 1: Reserved for the OS */
 
 /****************************************************************************
  * Public Type Declarations
  ****************************************************************************/
 
-/* This structure contains information about the holder of a semaphore */
+/* This structure contains information about the holder of a semaphore.
+ * The first holder is kept in the semaphore itself, so a semaphore that is
+ * used as a mutex never needs another container.
+ */
 
 #ifdef CONFIG_PRIORITY_INHERITANCE
 struct tcb_s; /* Forward reference */
@@ -96,10 +100,9 @@ struct sem_s
 
 #ifdef CONFIG_PRIORITY_INHERITANCE
   uint8_t flags;                 /* See PRIOINHERIT_FLAGS_* definitions */
+  struct semholder_s holder;     /* The first holder of semaphore counts */
 # if CONFIG_SEM_PREALLOCHOLDERS > 0
-  FAR struct semholder_s *hhead; /* List of holders of semaphore counts */
-# else
-  struct semholder_s holder[2];  /* Slot for old and new holder */
+  FAR struct semholder_s *hhead; /* List of further holders */
 # endif
 #endif
 };
@@ -111,10 +114,10 @@ typedef struct sem_s sem_t;
 #ifdef CONFIG_PRIORITY_INHERITANCE
 # if CONFIG_SEM_PREALLOCHOLDERS > 0
 #  define SEM_INITIALIZER(c) \
-    {(c), 0, NULL}               /* semcount, flags, hhead */
+    {(c), 0, SEMHOLDER_INITIALIZER, NULL} /* semcount, flags, holder, hhead */
 # else
 #  define SEM_INITIALIZER(c) \
-    {(c), 0, {SEMHOLDER_INITIALIZER, SEMHOLDER_INITIALIZER}} /* semcount, flags, holder[2] */
+    {(c), 0, SEMHOLDER_INITIALIZER}       /* semcount, flags, holder */
 # endif
 #else
 #  define SEM_INITIALIZER(c) \
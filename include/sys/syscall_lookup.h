@@ -60,11 +60,18 @@ SYSCALL_LOOKUP(sethostname,                2)
 /* Semaphores */
 
 SYSCALL_LOOKUP(sem_destroy,                1)
-SYSCALL_LOOKUP(sem_post,                   1)
 SYSCALL_LOOKUP(sem_clockwait,              3)
 SYSCALL_LOOKUP(sem_timedwait,              2)
-SYSCALL_LOOKUP(sem_trywait,                1)
-SYSCALL_LOOKUP(sem_wait,                   1)
+
+#ifdef CONFIG_SEM_FASTPATH
+  SYSCALL_LOOKUP(sem_post_slow,            1)
+  SYSCALL_LOOKUP(sem_trywait_slow,         1)
+  SYSCALL_LOOKUP(sem_wait_slow,            1)
+#else
+  SYSCALL_LOOKUP(sem_post,                 1)
+  SYSCALL_LOOKUP(sem_trywait,              1)
+  SYSCALL_LOOKUP(sem_wait,                 1)
+#endif
 
 #ifdef CONFIG_PRIORITY_INHERITANCE
   SYSCALL_LOOKUP(sem_setprotocol,          2)
@@ -247,6 +254,7 @@ SYSCALL_LOOKUP(telldir,                    1)
 
 #if defined(CONFIG_FS_RAMMAP)
   SYSCALL_LOOKUP(munmap,                   2)
+  SYSCALL_LOOKUP(msync,                    3)
 #endif
 
 #if defined(CONFIG_PSEUDOFS_SOFTLINKS)
@@ -309,7 +317,9 @@ SYSCALL_LOOKUP(telldir,                    1)
   SYSCALL_LOOKUP(pthread_mutex_init,       2)
   SYSCALL_LOOKUP(pthread_mutex_timedlock,  2)
   SYSCALL_LOOKUP(pthread_mutex_trylock,    1)
+#ifndef CONFIG_PTHREAD_MUTEX_FASTPATH
   SYSCALL_LOOKUP(pthread_mutex_unlock,     1)
+#endif
 #ifndef CONFIG_PTHREAD_MUTEX_UNSAFE
   SYSCALL_LOOKUP(pthread_mutex_consistent, 1)
 #endif
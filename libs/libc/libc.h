@@ -28,6 +28,7 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -99,6 +100,16 @@
 
 #define LIB_BUFLEN_UNKNOWN INT_MAX
 
+/* Helpers for the word-at-a-time string functions.  LIB_HASZERO(w) is
+ * non-zero if any byte of the word 'w' is zero.
+ */
+
+#define LIB_WORDSIZE       sizeof(uintptr_t)
+#define LIB_WORDMASK       (LIB_WORDSIZE - 1)
+#define LIB_ONES           ((uintptr_t)-1 / 0xff)
+#define LIB_HIGHS          (LIB_ONES * 0x80)
+#define LIB_HASZERO(w)     (((w) - LIB_ONES) & ~(w) & LIB_HIGHS)
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
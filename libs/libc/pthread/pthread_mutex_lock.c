@@ -41,6 +41,8 @@
 
 #include <pthread.h>
 
+#include <nuttx/semaphore.h>
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -97,6 +99,18 @@
 
 int pthread_mutex_lock(FAR pthread_mutex_t *mutex)
 {
+#ifdef CONFIG_PTHREAD_MUTEX_FASTPATH
+  /* Take a free mutex without entering the OS.  Only non-robust NORMAL
+   * mutexes are supported, so there is nothing to do but record the owner.
+   */
+
+  if (mutex != NULL && nxsem_fast_trywait(&mutex->sem))
+    {
+      mutex->pid = getpid();
+      return OK;
+    }
+#endif
+
   /* pthread_mutex_lock() is equivalent to pthread_mutex_timedlock() when
    * the absolute time delay is a NULL value.
    */
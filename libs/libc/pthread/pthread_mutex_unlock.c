@@ -0,0 +1,82 @@
+/****************************************************************************
+ * libs/libc/pthread/pthread_mutex_unlock.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <errno.h>
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: pthread_mutex_unlock
+ *
+ * Description:
+ *   The pthread_mutex_unlock() function releases the mutex object referenced
+ *   by mutex.  If there are threads blocked on the mutex object referenced
+ *   by mutex when pthread_mutex_unlock() is called, resulting in the mutex
+ *   becoming available, the scheduling policy is used to determine which
+ *   thread shall acquire the mutex.
+ *
+ *   This version is used with CONFIG_PTHREAD_MUTEX_FASTPATH, where all
+ *   mutexes are non-robust NORMAL mutexes.  A mutex without waiters is
+ *   released without entering the OS.
+ *
+ * Input Parameters:
+ *   mutex - A reference to the mutex to be unlocked.
+ *
+ * Returned Value:
+ *   0 on success or an errno value on failure.
+ *
+ ****************************************************************************/
+
+int pthread_mutex_unlock(FAR pthread_mutex_t *mutex)
+{
+  if (mutex == NULL)
+    {
+      return EINVAL;
+    }
+
+  /* The underlying semaphore has a count of one if the mutex is unlocked.
+   * As in the OS version, any thread may unlock a locked NORMAL mutex.
+   */
+
+  if (mutex->sem.semcount > 0)
+    {
+      return EPERM;
+    }
+
+  /* Nullify the pid then post the semaphore */
+
+  mutex->pid = -1;
+  if (sem_post(&mutex->sem) < 0)
+    {
+      return get_errno();
+    }
+
+  return OK;
+}
@@ -90,13 +90,11 @@ int nxsem_init(FAR sem_t *sem, int pshared, unsigned int value)
 
 #ifdef CONFIG_PRIORITY_INHERITANCE
       sem->flags            = 0;
+      sem->holder.htcb      = NULL;
+      sem->holder.counts    = 0;
 #  if CONFIG_SEM_PREALLOCHOLDERS > 0
+      sem->holder.flink     = NULL;
       sem->hhead            = NULL;
-#  else
-      sem->holder[0].htcb   = NULL;
-      sem->holder[0].counts = 0;
-      sem->holder[1].htcb   = NULL;
-      sem->holder[1].counts = 0;
 #  endif
 #endif
       return OK;
@@ -41,6 +41,8 @@
 #include <sys/types.h>
 #include <string.h>
 
+#include "libc.h"
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -51,6 +53,35 @@ int memcmp(FAR const void *s1, FAR const void *s2, size_t n)
   unsigned char *p1 = (unsigned char *)s1;
   unsigned char *p2 = (unsigned char *)s2;
 
+#ifdef CONFIG_LIBC_STRING_OPTSPEED
+  /* If both buffers have the same alignment, compare the leading bytes up
+   * to a word boundary and then skip over equal words.  The first differing
+   * word (if any) is resolved byte-wise below.
+   */
+
+  if ((((uintptr_t)p1 ^ (uintptr_t)p2) & LIB_WORDMASK) == 0)
+    {
+      for (; n > 0 && ((uintptr_t)p1 & LIB_WORDMASK) != 0; n--)
+        {
+          if (*p1 != *p2)
+            {
+              return *p1 < *p2 ? -1 : 1;
+            }
+
+          p1++;
+          p2++;
+        }
+
+      while (n >= LIB_WORDSIZE &&
+             *(FAR const uintptr_t *)p1 == *(FAR const uintptr_t *)p2)
+        {
+          p1 += LIB_WORDSIZE;
+          p2 += LIB_WORDSIZE;
+          n  -= LIB_WORDSIZE;
+        }
+    }
+#endif
+
   while (n-- > 0)
     {
       if (*p1 < *p2)
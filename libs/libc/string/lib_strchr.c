@@ -41,6 +41,8 @@
 
 #include <string.h>
 
+#include "libc.h"
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -62,8 +64,47 @@
 #ifndef CONFIG_LIBC_ARCH_STRCHR
 FAR char *strchr(FAR const char *s, int c)
 {
+#ifdef CONFIG_LIBC_STRING_OPTSPEED
+  FAR const uintptr_t *wp;
+  uintptr_t cmask;
+  uintptr_t w;
+#endif
+
   if (s)
     {
+#ifdef CONFIG_LIBC_STRING_OPTSPEED
+      /* Check the leading bytes up to a word boundary */
+
+      for (; ((uintptr_t)s & LIB_WORDMASK) != 0; s++)
+        {
+          if (*s == c)
+            {
+              return (FAR char *)s;
+            }
+
+          if (!*s)
+            {
+              return NULL;
+            }
+        }
+
+      /* Then skip words that contain neither the terminator nor 'c'.  The
+       * word holding either is searched byte-wise below.
+       */
+
+      cmask = LIB_ONES * (unsigned char)c;
+      for (wp = (FAR const uintptr_t *)s; ; wp++)
+        {
+          w = *wp;
+          if (LIB_HASZERO(w) || LIB_HASZERO(w ^ cmask))
+            {
+              break;
+            }
+        }
+
+      s = (FAR const char *)wp;
+#endif
+
       for (; ; s++)
         {
           if (*s == c)
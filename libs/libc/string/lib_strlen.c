@@ -41,6 +41,8 @@
 #include <sys/types.h>
 #include <string.h>
 
+#include "libc.h"
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -49,7 +51,33 @@
 size_t strlen(const char *s)
 {
   const char *sc;
-  for (sc = s; *sc != '\0'; ++sc);
+
+#ifdef CONFIG_LIBC_STRING_OPTSPEED
+  FAR const uintptr_t *wp;
+
+  /* Check the leading bytes up to a word boundary */
+
+  for (sc = s; ((uintptr_t)sc & LIB_WORDMASK) != 0; sc++)
+    {
+      if (*sc == '\0')
+        {
+          return sc - s;
+        }
+    }
+
+  /* Then skip words without a zero byte.  An aligned word never crosses a
+   * page or memory region boundary, so reading the bytes that follow the
+   * terminator in the last word is harmless.
+   */
+
+  for (wp = (FAR const uintptr_t *)sc; !LIB_HASZERO(*wp); wp++);
+
+  sc = (FAR const char *)wp;
+#else
+  sc = s;
+#endif
+
+  for (; *sc != '\0'; ++sc);
   return sc - s;
 }
 #endif
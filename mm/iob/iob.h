@@ -44,6 +44,7 @@
 
 #include <debug.h>
 
+#include <nuttx/irq.h>
 #include <nuttx/mm/iob.h>
 #include <nuttx/semaphore.h>
 
@@ -85,14 +86,36 @@ extern FAR struct iob_qentry_s *g_iob_freeqlist;
 extern FAR struct iob_qentry_s *g_iob_qcommitted;
 #endif
 
-/* Counting semaphores that tracks the number of free IOBs/qentries */
+/* g_iob_lock protects the I/O buffer lists and counts and g_iob_qlock the
+ * queue container lists and counts.
+ */
 
-extern sem_t g_iob_sem;       /* Counts free I/O buffers */
+extern irqspinlock_t g_iob_lock;
+#if CONFIG_IOB_NCHAINS > 0
+extern irqspinlock_t g_iob_qlock;
+#endif
+
+/* The number of entries in the free lists */
+
+extern int g_iob_navail;      /* Free I/O buffers */
+#if CONFIG_IOB_NCHAINS > 0
+extern int g_iob_qnavail;     /* Free I/O buffer queue containers */
+#endif
+
+/* Semaphores that allocations wait on when there is nothing to allocate
+ * and the number of waiters that have not been served yet.  Each post of
+ * a semaphore is matched by one entry in the committed list.
+ */
+
+extern sem_t g_iob_sem;       /* Waits for I/O buffers */
+extern int g_iob_nwaiting;
 #if CONFIG_IOB_THROTTLE > 0
-extern sem_t g_throttle_sem;  /* Counts available I/O buffers when throttled */
+extern sem_t g_throttle_sem;  /* Waits for I/O buffers when throttled */
+extern int g_throttle_nwaiting;
 #endif
 #if CONFIG_IOB_NCHAINS > 0
-extern sem_t g_qentry_sem;    /* Counts free I/O buffer queue containers */
+extern sem_t g_qentry_sem;    /* Waits for I/O buffer queue containers */
+extern int g_qentry_nwaiting;
 #endif
 
 /****************************************************************************
@@ -53,6 +53,45 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: iob_alloc_locked
+ *
+ * Description:
+ *   Take the I/O buffer at the head of the free list if the allocation is
+ *   permitted.  A throttled allocation must leave CONFIG_IOB_THROTTLE free
+ *   I/O buffers.
+ *
+ * Assumptions:
+ *   The caller holds g_iob_lock.
+ *
+ ****************************************************************************/
+
+static FAR struct iob_s *iob_alloc_locked(bool throttled,
+                                          enum iob_user_e consumerid)
+{
+  FAR struct iob_s *iob;
+
+  if (g_iob_navail <= (throttled ? CONFIG_IOB_THROTTLE : 0))
+    {
+      return NULL;
+    }
+
+  /* Remove the I/O buffer from the head of the free list */
+
+  iob = g_iob_freelist;
+  DEBUGASSERT(iob != NULL);
+
+  g_iob_freelist = iob->io_flink;
+  g_iob_navail--;
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+    defined(CONFIG_MM_IOB) && !defined(CONFIG_FS_PROCFS_EXCLUDE_IOBINFO)
+  iob_stats_onalloc(consumerid);
+#endif
+
+  return iob;
+}
+
 /****************************************************************************
  * Name: iob_alloc_committed
  *
@@ -67,11 +106,12 @@ static FAR struct iob_s *iob_alloc_committed(enum iob_user_e consumerid)
   FAR struct iob_s *iob = NULL;
   irqstate_t flags;
 
-  /* We don't know what context we are called from so we use extreme measures
-   * to protect the committed list:  We disable interrupts very briefly.
+  /* We don't know what context we are called from, so protect the
+   * committed list with the IOB pool lock, which also disables local
+   * interrupts.
    */
 
-  flags = enter_critical_section();
+  flags = irqspin_lock(&g_iob_lock);
 
   /* Take the I/O buffer from the head of the committed list */
 
@@ -82,20 +122,13 @@ static FAR struct iob_s *iob_alloc_committed(enum iob_user_e consumerid)
 
       g_iob_committed = iob->io_flink;
 
-      /* Put the I/O buffer in a known state */
-
-      iob->io_flink  = NULL; /* Not in a chain */
-      iob->io_len    = 0;    /* Length of the data in the entry */
-      iob->io_offset = 0;    /* Offset to the beginning of data */
-      iob->io_pktlen = 0;    /* Total length of the packet */
-
 #if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
     defined(CONFIG_MM_IOB) && !defined(CONFIG_FS_PROCFS_EXCLUDE_IOBINFO)
       iob_stats_onalloc(consumerid);
 #endif
     }
 
-  leave_critical_section(flags);
+  irqspin_unlock(&g_iob_lock, flags);
   return iob;
 }
 
@@ -112,82 +145,74 @@ static FAR struct iob_s *iob_allocwait(bool throttled,
                                        enum iob_user_e consumerid)
 {
   FAR struct iob_s *iob;
+  FAR int *nwaiting;
   irqstate_t flags;
   FAR sem_t *sem;
-  int ret = OK;
+  int ret;
 
 #if CONFIG_IOB_THROTTLE > 0
-  /* Select the semaphore count to check. */
+  /* Select the semaphore to wait on. */
 
-  sem = (throttled ? &g_throttle_sem : &g_iob_sem);
+  sem      = throttled ? &g_throttle_sem : &g_iob_sem;
+  nwaiting = throttled ? &g_throttle_nwaiting : &g_iob_nwaiting;
 #else
-  sem = &g_iob_sem;
+  sem      = &g_iob_sem;
+  nwaiting = &g_iob_nwaiting;
 #endif
 
-  /* The following must be atomic; interrupt must be disabled so that there
-   * is no conflict with interrupt level I/O buffer allocations.  This is
-   * not as bad as it sounds because interrupts will be re-enabled while
-   * we are waiting for I/O buffers to become free.
+  /* Either take a free I/O buffer or become a waiter.  This must be atomic
+   * so that an I/O buffer that is freed in between is committed to us.
    */
 
-  flags = enter_critical_section();
+  flags = irqspin_lock(&g_iob_lock);
+  iob   = iob_alloc_locked(throttled, consumerid);
+  if (iob == NULL)
+    {
+      (*nwaiting)++;
+    }
 
-  /* Try to get an I/O buffer.  If successful, the semaphore count will be
-   * decremented atomically.
+  irqspin_unlock(&g_iob_lock, flags);
+
+  if (iob != NULL)
+    {
+      return iob;
+    }
+
+  /* Wait for an I/O buffer to be freed and placed in the committed list
+   * for us.
    */
 
-  iob = iob_tryalloc(throttled, consumerid);
-  while (ret == OK && iob == NULL)
+  ret = nxsem_wait_uninterruptible(sem);
+  if (ret >= 0)
     {
-      /* If not successful, then the semaphore count was less than or equal
-       * to zero (meaning that there are no free buffers).  We need to wait
-       * for an I/O buffer to be released and placed in the committed
-       * list.
-       */
-
-      ret = nxsem_wait_uninterruptible(sem);
-      if (ret >= 0)
-        {
-          /* When we wake up from wait successfully, an I/O buffer was
-           * freed and we hold a count for one IOB.
-           */
-
-          iob = iob_alloc_committed(consumerid);
-          if (iob == NULL)
-            {
-              /* We need release our count so that it is available to
-               * iob_tryalloc(), perhaps allowing another thread to take our
-               * count.  In that event, iob_tryalloc() will fail above and
-               * we will have to wait again.
-               */
-
-              nxsem_post(sem);
-              iob = iob_tryalloc(throttled, consumerid);
-            }
-
-          /* REVISIT: I think this logic should be moved inside of
-           * iob_alloc_committed, so that it can exist inside of the critical
-           * section along with all other sem count changes.
-           */
+      iob = iob_alloc_committed(consumerid);
+      DEBUGASSERT(iob != NULL);
+      return iob;
+    }
 
-#if CONFIG_IOB_THROTTLE > 0
-          else
-            {
-              if (throttled)
-                {
-                  g_iob_sem.semcount--;
-                }
-              else
-                {
-                  g_throttle_sem.semcount--;
-                }
-            }
-#endif
+  /* The wait was canceled.  Withdraw unless an I/O buffer has already been
+   * committed to us, in which case it must be freed again.
+   */
+
+  flags = irqspin_lock(&g_iob_lock);
+  if (*nwaiting > 0)
+    {
+      (*nwaiting)--;
+      sem = NULL;
+    }
+
+  irqspin_unlock(&g_iob_lock, flags);
+
+  if (sem != NULL && nxsem_trywait(sem) >= 0)
+    {
+      iob = iob_alloc_committed(consumerid);
+      if (iob != NULL)
+        {
+          iob_free(iob, consumerid);
         }
     }
 
-  leave_critical_section(flags);
-  return iob;
+  return NULL;
 }
 
 /****************************************************************************
@@ -204,6 +229,8 @@ static FAR struct iob_s *iob_allocwait(bool throttled,
 
 FAR struct iob_s *iob_alloc(bool throttled, enum iob_user_e consumerid)
 {
+  FAR struct iob_s *iob;
+
   /* Were we called from the interrupt level? */
 
   if (up_interrupt_context() || sched_idletask())
@@ -212,12 +239,21 @@ FAR struct iob_s *iob_alloc(bool throttled, enum iob_user_e consumerid)
 
       return iob_tryalloc(throttled, consumerid);
     }
-  else
+
+  /* Then allocate an I/O buffer, waiting as necessary */
+
+  iob = iob_allocwait(throttled, consumerid);
+  if (iob != NULL)
     {
-      /* Then allocate an I/O buffer, waiting as necessary */
+      /* Put the I/O buffer in a known state */
 
-      return iob_allocwait(throttled, consumerid);
+      iob->io_flink  = NULL; /* Not in a chain */
+      iob->io_len    = 0;    /* Length of the data in the entry */
+      iob->io_offset = 0;    /* Offset to the beginning of data */
+      iob->io_pktlen = 0;    /* Total length of the packet */
     }
+
+  return iob;
 }
 
 /****************************************************************************
@@ -233,76 +269,24 @@ FAR struct iob_s *iob_tryalloc(bool throttled, enum iob_user_e consumerid)
 {
   FAR struct iob_s *iob;
   irqstate_t flags;
-#if CONFIG_IOB_THROTTLE > 0
-  FAR sem_t *sem;
-#endif
-
-#if CONFIG_IOB_THROTTLE > 0
-  /* Select the semaphore count to check. */
 
-  sem = (throttled ? &g_throttle_sem : &g_iob_sem);
-#endif
-
-  /* We don't know what context we are called from so we use extreme measures
-   * to protect the free list:  We disable interrupts very briefly.
+  /* We don't know what context we are called from, so protect the free
+   * list with the IOB pool lock, which also disables local interrupts.
    */
 
-  flags = enter_critical_section();
-
-#if CONFIG_IOB_THROTTLE > 0
-  /* If there are free I/O buffers for this allocation */
+  flags = irqspin_lock(&g_iob_lock);
+  iob   = iob_alloc_locked(throttled, consumerid);
+  irqspin_unlock(&g_iob_lock, flags);
 
-  if (sem->semcount > 0)
-#endif
+  if (iob != NULL)
     {
-      /* Take the I/O buffer from the head of the free list */
-
-      iob = g_iob_freelist;
-      if (iob != NULL)
-        {
-          /* Remove the I/O buffer from the free list and decrement the
-           * counting semaphore(s) that tracks the number of available
-           * IOBs.
-           */
-
-          g_iob_freelist = iob->io_flink;
-
-          /* Take a semaphore count.  Note that we cannot do this in
-           * in the orthodox way by calling nxsem_wait() or nxsem_trywait()
-           * because this function may be called from an interrupt
-           * handler. Fortunately we know at at least one free buffer
-           * so a simple decrement is all that is needed.
-           */
-
-          g_iob_sem.semcount--;
-          DEBUGASSERT(g_iob_sem.semcount >= 0);
-
-#if CONFIG_IOB_THROTTLE > 0
-          /* The throttle semaphore is a little more complicated because
-           * it can be negative!  Decrementing is still safe, however.
-           */
-
-          g_throttle_sem.semcount--;
-          DEBUGASSERT(g_throttle_sem.semcount >= -CONFIG_IOB_THROTTLE);
-#endif
-
-#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
-    defined(CONFIG_MM_IOB) && !defined(CONFIG_FS_PROCFS_EXCLUDE_IOBINFO)
-          iob_stats_onalloc(consumerid);
-#endif
-
-          leave_critical_section(flags);
-
-          /* Put the I/O buffer in a known state */
+      /* Put the I/O buffer in a known state */
 
-          iob->io_flink  = NULL; /* Not in a chain */
-          iob->io_len    = 0;    /* Length of the data in the entry */
-          iob->io_offset = 0;    /* Offset to the beginning of data */
-          iob->io_pktlen = 0;    /* Total length of the packet */
-          return iob;
-        }
+      iob->io_flink  = NULL; /* Not in a chain */
+      iob->io_len    = 0;    /* Length of the data in the entry */
+      iob->io_offset = 0;    /* Offset to the beginning of data */
+      iob->io_pktlen = 0;    /* Total length of the packet */
     }
 
-  leave_critical_section(flags);
-  return NULL;
+  return iob;
 }
@@ -54,6 +54,35 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: iob_alloc_qlocked
+ *
+ * Description:
+ *   Take the I/O buffer chain container at the head of the free list.
+ *
+ * Assumptions:
+ *   The caller holds g_iob_qlock.
+ *
+ ****************************************************************************/
+
+static FAR struct iob_qentry_s *iob_alloc_qlocked(void)
+{
+  FAR struct iob_qentry_s *iobq = g_iob_freeqlist;
+
+  if (iobq != NULL)
+    {
+      /* Remove the I/O buffer chain container from the free list and
+       * decrement the count of free containers.
+       */
+
+      g_iob_freeqlist = iobq->qe_flink;
+      g_iob_qnavail--;
+      DEBUGASSERT(g_iob_qnavail >= 0);
+    }
+
+  return iobq;
+}
+
 /****************************************************************************
  * Name: iob_alloc_qcommitted
  *
@@ -68,11 +97,12 @@ static FAR struct iob_qentry_s *iob_alloc_qcommitted(void)
   FAR struct iob_qentry_s *iobq = NULL;
   irqstate_t flags;
 
-  /* We don't know what context we are called from so we use extreme measures
-   * to protect the committed list:  We disable interrupts very briefly.
+  /* We don't know what context we are called from, so protect the
+   * committed list with the container pool lock, which also disables local
+   * interrupts.
    */
 
-  flags = enter_critical_section();
+  flags = irqspin_lock(&g_iob_qlock);
 
   /* Take the I/O buffer from the head of the committed list */
 
@@ -82,13 +112,9 @@ static FAR struct iob_qentry_s *iob_alloc_qcommitted(void)
       /* Remove the I/O buffer from the committed list */
 
       g_iob_qcommitted = iobq->qe_flink;
-
-      /* Put the I/O buffer in a known state */
-
-      iobq->qe_head = NULL; /* Nothing is contained */
     }
 
-  leave_critical_section(flags);
+  irqspin_unlock(&g_iob_qlock, flags);
   return iobq;
 }
 
@@ -106,61 +132,62 @@ static FAR struct iob_qentry_s *iob_allocwait_qentry(void)
 {
   FAR struct iob_qentry_s *qentry;
   irqstate_t flags;
-  int ret = OK;
+  int ret;
+
+  /* Either take a free container or become a waiter.  This must be atomic
+   * so that a container that is freed in between is committed to us.
+   */
+
+  flags  = irqspin_lock(&g_iob_qlock);
+  qentry = iob_alloc_qlocked();
+  if (qentry == NULL)
+    {
+      g_qentry_nwaiting++;
+    }
 
-  /* The following must be atomic; interrupt must be disabled so that there
-   * is no conflict with interrupt level I/O buffer chain container
-   * allocations.  This is not as bad as it sounds because interrupts will be
-   * re-enabled while we are waiting for I/O buffers to become free.
+  irqspin_unlock(&g_iob_qlock, flags);
+
+  if (qentry != NULL)
+    {
+      return qentry;
+    }
+
+  /* Wait for a container to be freed and placed in the committed list for
+   * us.
    */
 
-  flags = enter_critical_section();
+  ret = nxsem_wait_uninterruptible(&g_qentry_sem);
+  if (ret >= 0)
+    {
+      qentry = iob_alloc_qcommitted();
+      DEBUGASSERT(qentry != NULL);
+      return qentry;
+    }
 
-  /* Try to get an I/O buffer chain container.  If successful, the semaphore
-   * count will bedecremented atomically.
+  /* The wait was canceled.  Withdraw unless a container has already been
+   * committed to us, in which case it must be freed again.
    */
 
-  qentry = iob_tryalloc_qentry();
-  while (ret == OK && qentry == NULL)
+  flags = irqspin_lock(&g_iob_qlock);
+  if (g_qentry_nwaiting > 0)
     {
-      /* If not successful, then the semaphore count was less than or equal
-       * to zero (meaning that there are no free buffers).  We need to wait
-       * for an I/O buffer chain container to be released when the
-       * semaphore count will be incremented.
-       */
+      g_qentry_nwaiting--;
+      ret = OK;
+    }
 
-      ret = nxsem_wait_uninterruptible(&g_qentry_sem);
-      if (ret >= 0)
+  irqspin_unlock(&g_iob_qlock, flags);
+
+  if (ret < 0 && nxsem_trywait(&g_qentry_sem) >= 0)
+    {
+      qentry = iob_alloc_qcommitted();
+      if (qentry != NULL)
         {
-          /* When we wake up from wait successfully, an I/O buffer chain
-           * container was freed and we hold a count for one IOB.  Unless
-           * something failed, we should have an IOB waiting for us in the
-           * committed list.
-           */
-
-          qentry = iob_alloc_qcommitted();
-          DEBUGASSERT(qentry != NULL);
-
-          if (qentry == NULL)
-            {
-              /* This should not fail, but we allow for that possibility to
-               * handle any potential, non-obvious race condition.  Perhaps
-               * the free IOB ended up in the g_iob_free list?
-               *
-               * We need release our count so that it is available to
-               * iob_tryalloc(), perhaps allowing another thread to take our
-               * count.  In that event, iob_tryalloc() will fail above and
-               * we will have to wait again.
-               */
-
-              nxsem_post(&g_qentry_sem);
-              qentry = iob_tryalloc_qentry();
-            }
+          qentry->qe_head = NULL;
+          iob_free_qentry(qentry);
         }
     }
 
-  leave_critical_section(flags);
-  return qentry;
+  return NULL;
 }
 
 /****************************************************************************
@@ -179,6 +206,8 @@ static FAR struct iob_qentry_s *iob_allocwait_qentry(void)
 
 FAR struct iob_qentry_s *iob_alloc_qentry(void)
 {
+  FAR struct iob_qentry_s *iobq;
+
   /* Were we called from the interrupt level? */
 
   if (up_interrupt_context() || sched_idletask())
@@ -187,12 +216,18 @@ FAR struct iob_qentry_s *iob_alloc_qentry(void)
 
       return iob_tryalloc_qentry();
     }
-  else
+
+  /* Then allocate an I/O buffer, waiting as necessary */
+
+  iobq = iob_allocwait_qentry();
+  if (iobq != NULL)
     {
-      /* Then allocate an I/O buffer, waiting as necessary */
+      /* Put the I/O buffer in a known state */
 
-      return iob_allocwait_qentry();
+      iobq->qe_head = NULL; /* Nothing is contained */
     }
+
+  return iobq;
 }
 
 /****************************************************************************
@@ -210,37 +245,21 @@ FAR struct iob_qentry_s *iob_tryalloc_qentry(void)
   FAR struct iob_qentry_s *iobq;
   irqstate_t flags;
 
-  /* We don't know what context we are called from so we use extreme measures
-   * to protect the free list:  We disable interrupts very briefly.
+  /* We don't know what context we are called from, so protect the free
+   * list with the container pool lock, which also disables local interrupts.
    */
 
-  flags = enter_critical_section();
-  iobq  = g_iob_freeqlist;
-  if (iobq)
-    {
-      /* Remove the I/O buffer chain container from the free list and
-       * decrement the counting semaphore that tracks the number of free
-       * containers.
-       */
-
-      g_iob_freeqlist = iobq->qe_flink;
-
-      /* Take a semaphore count.  Note that we cannot do this in
-       * in the orthodox way by calling nxsem_wait() or nxsem_trywait()
-       * because this function may be called from an interrupt
-       * handler. Fortunately we know at at least one free buffer
-       * so a simple decrement is all that is needed.
-       */
-
-      g_qentry_sem.semcount--;
-      DEBUGASSERT(g_qentry_sem.semcount >= 0);
+  flags = irqspin_lock(&g_iob_qlock);
+  iobq  = iob_alloc_qlocked();
+  irqspin_unlock(&g_iob_qlock, flags);
 
+  if (iobq != NULL)
+    {
       /* Put the I/O buffer in a known state */
 
       iobq->qe_head = NULL; /* Nothing is contained */
     }
 
-  leave_critical_section(flags);
   return iobq;
 }
 
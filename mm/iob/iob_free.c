@@ -90,9 +90,10 @@ FAR struct iob_s *iob_free(FAR struct iob_s *iob,
                            enum iob_user_e producerid)
 {
   FAR struct iob_s *next = iob->io_flink;
+  FAR sem_t *sem = NULL;
   irqstate_t flags;
 #ifdef CONFIG_IOB_NOTIFIER
-  int16_t navail;
+  int navail;
 #endif
 
   iobinfo("iob=%p io_pktlen=%u io_len=%u next=%p\n",
@@ -129,20 +130,33 @@ FAR struct iob_s *iob_free(FAR struct iob_s *iob,
     }
 
   /* Free the I/O buffer by adding it to the head of the free or the
-   * committed list. We don't know what context we are called from so
-   * we use extreme measures to protect the free list:  We disable
-   * interrupts very briefly.
+   * committed list. We don't know what context we are called from, so
+   * protect the lists with the IOB pool lock, which also disables local
+   * interrupts.
    */
 
-  flags = enter_critical_section();
+  flags = irqspin_lock(&g_iob_lock);
 
   /* Which list?  If there is a task waiting for an IOB, then put
-   * the IOB on either the free list or on the committed list where
-   * it is reserved for that allocation (and not available to
-   * iob_tryalloc()).
+   * the IOB on the committed list where it is reserved for that
+   * allocation (and not available to iob_tryalloc()).  A throttled
+   * waiter is only served once the reserve is in the free list.
    */
 
-  if (g_iob_sem.semcount < 0)
+  if (g_iob_nwaiting > 0)
+    {
+      g_iob_nwaiting--;
+      sem = &g_iob_sem;
+    }
+#if CONFIG_IOB_THROTTLE > 0
+  else if (g_throttle_nwaiting > 0 && g_iob_navail >= CONFIG_IOB_THROTTLE)
+    {
+      g_throttle_nwaiting--;
+      sem = &g_throttle_sem;
+    }
+#endif
+
+  if (sem != NULL)
     {
       iob->io_flink   = g_iob_committed;
       g_iob_committed = iob;
@@ -151,46 +165,41 @@ FAR struct iob_s *iob_free(FAR struct iob_s *iob,
     {
       iob->io_flink   = g_iob_freelist;
       g_iob_freelist  = iob;
+      g_iob_navail++;
+      DEBUGASSERT(g_iob_navail <= CONFIG_IOB_NBUFFERS);
     }
 
-  /* Signal that an IOB is available.  If there is a thread blocked,
-   * waiting for an IOB, this will wake up exactly one thread.  The
-   * semaphore count will correctly indicated that the awakened task
-   * owns an IOB and should find it in the committed list.
-   */
-
-  nxsem_post(&g_iob_sem);
-  DEBUGASSERT(g_iob_sem.semcount <= CONFIG_IOB_NBUFFERS);
-
 #if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
     defined(CONFIG_MM_IOB) && !defined(CONFIG_FS_PROCFS_EXCLUDE_IOBINFO)
   iob_stats_onfree(producerid);
 #endif
 
-#if CONFIG_IOB_THROTTLE > 0
-  nxsem_post(&g_throttle_sem);
-  DEBUGASSERT(g_throttle_sem.semcount <=
-              (CONFIG_IOB_NBUFFERS - CONFIG_IOB_THROTTLE));
+#ifdef CONFIG_IOB_NOTIFIER
+  navail = g_iob_navail;
 #endif
 
+  irqspin_unlock(&g_iob_lock, flags);
+
+  /* Wake up exactly one waiter.  It will find the I/O buffer in the
+   * committed list.
+   */
+
+  if (sem != NULL)
+    {
+      nxsem_post(sem);
+    }
+
 #ifdef CONFIG_IOB_NOTIFIER
-  /* Check if the IOB was claimed by a thread that is blocked waiting
-   * for an IOB.
+  /* Signal any threads that have requested a signal notification
+   * when an IOB becomes available.
    */
 
-  navail = iob_navail(false);
   if (navail > 0 && (navail & IOB_MASK) == 0)
     {
-      /* Signal any threads that have requested a signal notification
-       * when an IOB becomes available.
-       */
-
       iob_notifier_signal();
     }
 #endif
 
-  leave_critical_section(flags);
-
   /* And return the I/O buffer after the one that was freed */
 
   return next;
@@ -65,24 +65,27 @@
 FAR struct iob_qentry_s *iob_free_qentry(FAR struct iob_qentry_s *iobq)
 {
   FAR struct iob_qentry_s *nextq = iobq->qe_flink;
+  FAR sem_t *sem = NULL;
   irqstate_t flags;
 
   /* Free the I/O buffer chain container by adding it to the head of the
    * free or the committed list. We don't know what context we are called
-   * from so we use extreme measures to protect the free list:  We disable
-   * interrupts very briefly.
+   * from, so protect the lists with the container pool lock, which also
+   * disables local interrupts.
    */
 
-  flags = enter_critical_section();
+  flags = irqspin_lock(&g_iob_qlock);
 
   /* Which list?  If there is a task waiting for an IOB chain, then put
-   * the IOB chain on either the free list or on the committed list where
-   * it is reserved for that allocation (and not available to
-   * iob_tryalloc_qentry()).
+   * the IOB chain on the committed list where it is reserved for that
+   * allocation (and not available to iob_tryalloc_qentry()).
    */
 
-  if (g_qentry_sem.semcount < 0)
+  if (g_qentry_nwaiting > 0)
     {
+      g_qentry_nwaiting--;
+      sem = &g_qentry_sem;
+
       iobq->qe_flink   = g_iob_qcommitted;
       g_iob_qcommitted = iobq;
     }
@@ -90,17 +93,20 @@ FAR struct iob_qentry_s *iob_free_qentry(FAR struct iob_qentry_s *iobq)
     {
       iobq->qe_flink   = g_iob_freeqlist;
       g_iob_freeqlist  = iobq;
+      g_iob_qnavail++;
+      DEBUGASSERT(g_iob_qnavail <= CONFIG_IOB_NCHAINS);
     }
 
-  /* Signal that an I/O buffer chain container is available.  If there
-   * is a thread waiting for an I/O buffer chain container, this will
-   * wake up exactly one thread.  The semaphore count will correctly
-   * indicated that the awakened task owns an I/O buffer chain container
-   * and should find it in the committed list.
+  irqspin_unlock(&g_iob_qlock, flags);
+
+  /* Wake up exactly one waiter.  It will find the I/O buffer chain
+   * container in the committed list.
    */
 
-  nxsem_post(&g_qentry_sem);
-  leave_critical_section(flags);
+  if (sem != NULL)
+    {
+      nxsem_post(sem);
+    }
 
   /* And return the I/O buffer chain container after the one that was freed */
 
@@ -86,14 +86,35 @@ FAR struct iob_qentry_s *g_iob_freeqlist;
 FAR struct iob_qentry_s *g_iob_qcommitted;
 #endif
 
-/* Counting semaphores that tracks the number of free IOBs/qentries */
+/* g_iob_lock protects the I/O buffer lists and counts and g_iob_qlock the
+ * queue container lists and counts.
+ */
 
-sem_t g_iob_sem;            /* Counts free I/O buffers */
+irqspinlock_t g_iob_lock = IRQSPINLOCK_INITIALIZER(IRQSPIN_RANK_IOB);
+#if CONFIG_IOB_NCHAINS > 0
+irqspinlock_t g_iob_qlock = IRQSPINLOCK_INITIALIZER(IRQSPIN_RANK_IOBQ);
+#endif
+
+/* The number of entries in the free lists */
+
+int g_iob_navail;           /* Free I/O buffers */
+#if CONFIG_IOB_NCHAINS > 0
+int g_iob_qnavail;          /* Free I/O buffer queue containers */
+#endif
+
+/* Semaphores that allocations wait on and the number of waiters that have
+ * not been served yet.
+ */
+
+sem_t g_iob_sem;            /* Waits for I/O buffers */
+int g_iob_nwaiting;
 #if CONFIG_IOB_THROTTLE > 0
-sem_t g_throttle_sem;       /* Counts available I/O buffers when throttled */
+sem_t g_throttle_sem;       /* Waits for I/O buffers when throttled */
+int g_throttle_nwaiting;
 #endif
 #if CONFIG_IOB_NCHAINS > 0
-sem_t g_qentry_sem;         /* Counts free I/O buffer queue containers */
+sem_t g_qentry_sem;         /* Waits for I/O buffer queue containers */
+int g_qentry_nwaiting;
 #endif
 
 /****************************************************************************
@@ -130,10 +151,17 @@ void iob_initialize(void)
         }
 
       g_iob_committed = NULL;
+      g_iob_navail    = CONFIG_IOB_NBUFFERS;
+
+      /* The wait semaphores are used for signaling and, hence, should not
+       * have priority inheritance enabled.
+       */
 
-      nxsem_init(&g_iob_sem, 0, CONFIG_IOB_NBUFFERS);
+      nxsem_init(&g_iob_sem, 0, 0);
+      nxsem_set_protocol(&g_iob_sem, SEM_PRIO_NONE);
 #if CONFIG_IOB_THROTTLE > 0
-      nxsem_init(&g_throttle_sem, 0, CONFIG_IOB_NBUFFERS - CONFIG_IOB_THROTTLE);
+      nxsem_init(&g_throttle_sem, 0, 0);
+      nxsem_set_protocol(&g_throttle_sem, SEM_PRIO_NONE);
 #endif
 
 #if CONFIG_IOB_NCHAINS > 0
@@ -150,8 +178,10 @@ void iob_initialize(void)
         }
 
       g_iob_qcommitted = NULL;
+      g_iob_qnavail    = CONFIG_IOB_NCHAINS;
 
-      nxsem_init(&g_qentry_sem, 0, CONFIG_IOB_NCHAINS);
+      nxsem_init(&g_qentry_sem, 0, 0);
+      nxsem_set_protocol(&g_qentry_sem, SEM_PRIO_NONE);
 #endif
 
       initialized = true;
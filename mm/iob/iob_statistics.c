@@ -46,6 +46,8 @@
 
 #include <nuttx/mm/iob.h>
 
+#include "iob.h"
+
 #if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
     !defined(CONFIG_FS_PROCFS_EXCLUDE_IOBINFO)
 
@@ -109,6 +111,34 @@ void iob_stats_onfree(enum iob_user_e producerid)
   g_iobuserstats[IOBUSER_GLOBAL].totalproduced++;
 }
 
+/****************************************************************************
+ * Name: iob_reassign
+ *
+ * Description:
+ *   Hand an I/O buffer chain over from one IOB user to another.  For the
+ *   IOB statistics, the buffers are counted as freed by the old user and
+ *   allocated by the new one, which must then free them.
+ *
+ * Input Parameters:
+ *   iob        - The I/O buffer chain
+ *   producerid - id representing the user giving up the IOBs
+ *   consumerid - id representing the user taking over the IOBs
+ *
+ * Returned Value:
+ *   None.
+ *
+ ****************************************************************************/
+
+void iob_reassign(FAR struct iob_s *iob, enum iob_user_e producerid,
+                  enum iob_user_e consumerid)
+{
+  for (; iob != NULL; iob = iob->io_flink)
+    {
+      iob_stats_onfree(producerid);
+      iob_stats_onalloc(consumerid);
+    }
+}
+
 /****************************************************************************
  * Name: iob_getuserstats
  *
@@ -0,0 +1,326 @@
+/****************************************************************************
+ * mm/mm_heap/mm_fastbin.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/irq.h>
+#include <nuttx/mm/mm.h>
+
+#ifdef CONFIG_MM_FASTBINS
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The fast bins of a CPU are only used by that CPU with interrupts
+ * disabled, so that the caller cannot migrate to another CPU while using
+ * them.  In the SMP case, each CPU's bins are also protected by a spinlock
+ * so that a failed allocation on any CPU can flush them.  That lock is only
+ * contended during a flush.
+ */
+
+#ifdef CONFIG_SMP
+#  define mm_fastbin_this_cpu()     up_cpu_index()
+#  define mm_fastbin_lock(h,c)      spin_lock_wo_note(&(h)->mm_fastlock[c])
+#  define mm_fastbin_unlock(h,c)    spin_unlock_wo_note(&(h)->mm_fastlock[c])
+#else
+#  define mm_fastbin_this_cpu()     0
+#  define mm_fastbin_lock(h,c)
+#  define mm_fastbin_unlock(h,c)
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_fastbin_cached
+ *
+ * Description:
+ *   Return true if 'mem' is already cached in 'bin'.  Cached chunks keep
+ *   MM_ALLOC_BIT, so this is the only way to detect that a cached chunk
+ *   is freed again.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_DEBUG_MM) && defined(MM_USE_FASTBINS)
+static bool mm_fastbin_cached(FAR struct mm_fastbin_s *bin, FAR void *mem)
+{
+  FAR struct mm_fastnode_s *node;
+
+  for (node = bin->head; node != NULL; node = node->flink)
+    {
+      if (node == mem)
+        {
+          return true;
+        }
+    }
+
+  return false;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_fastbin_initialize
+ *
+ * Description:
+ *   Mark all fast bins of a heap as empty.
+ *
+ ****************************************************************************/
+
+void mm_fastbin_initialize(FAR struct mm_heap_s *heap)
+{
+#ifdef CONFIG_SMP
+  int cpu;
+#endif
+
+  memset(heap->mm_fastbin, 0, sizeof(heap->mm_fastbin));
+
+#ifdef CONFIG_SMP
+  for (cpu = 0; cpu < MM_FASTBIN_NCPUS; cpu++)
+    {
+      spin_initialize(&heap->mm_fastlock[cpu], SP_UNLOCKED);
+    }
+#endif
+}
+
+#ifdef MM_USE_FASTBINS
+/****************************************************************************
+ * Name: mm_fastbin_alloc
+ *
+ * Description:
+ *   Take a cached chunk of exactly the size class of 'alignsize' from the
+ *   fast bins of the current CPU.  This does not take the heap semaphore.
+ *
+ * Input Parameters:
+ *   heap      - The heap to allocate from
+ *   alignsize - The aligned chunk size, including the chunk header
+ *
+ * Returned Value:
+ *   The allocated memory or NULL if there is no cached chunk of that size.
+ *
+ ****************************************************************************/
+
+FAR void *mm_fastbin_alloc(FAR struct mm_heap_s *heap, size_t alignsize)
+{
+  FAR struct mm_fastbin_s *bin;
+  FAR struct mm_fastnode_s *node;
+  irqstate_t flags;
+  int cpu;
+
+  if (alignsize > MM_FASTBIN_MAXCHUNK)
+    {
+      return NULL;
+    }
+
+  flags = up_irq_save();
+  cpu   = mm_fastbin_this_cpu();
+  mm_fastbin_lock(heap, cpu);
+
+  bin  = &heap->mm_fastbin[cpu][MM_FASTBIN_CLASS(alignsize)];
+  node = bin->head;
+  if (node != NULL)
+    {
+      bin->head = node->flink;
+      bin->count--;
+    }
+
+  mm_fastbin_unlock(heap, cpu);
+  up_irq_restore(flags);
+  return node;
+}
+
+/****************************************************************************
+ * Name: mm_fastbin_free
+ *
+ * Description:
+ *   Cache a small chunk in the fast bins of the current CPU.  The chunk
+ *   stays allocated as far as the coalescing allocator is concerned.  This
+ *   may be called from interrupt handlers.
+ *
+ * Input Parameters:
+ *   heap - The heap that the memory belongs to
+ *   mem  - The memory to be freed
+ *
+ * Returned Value:
+ *   true if the chunk was cached; false if the chunk is too large or if
+ *   the fast bin is full and the chunk must be returned to the heap.
+ *
+ ****************************************************************************/
+
+bool mm_fastbin_free(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+  FAR struct mm_allocnode_s *node;
+  FAR struct mm_fastbin_s *bin;
+  irqstate_t flags;
+  bool ret = false;
+  int cpu;
+
+  node = (FAR struct mm_allocnode_s *)
+         ((FAR char *)mem - SIZEOF_MM_ALLOCNODE);
+
+  /* Sanity check against double-frees */
+
+  DEBUGASSERT(node->preceding & MM_ALLOC_BIT);
+
+  if (node->size > MM_FASTBIN_MAXCHUNK)
+    {
+      return false;
+    }
+
+  flags = up_irq_save();
+  cpu   = mm_fastbin_this_cpu();
+  mm_fastbin_lock(heap, cpu);
+
+  bin = &heap->mm_fastbin[cpu][MM_FASTBIN_CLASS(node->size)];
+
+#ifdef CONFIG_DEBUG_MM
+  /* A chunk that is freed again while cached on this CPU would corrupt the
+   * bin, or the heap if the bin is full.  Only this CPU is checked so that
+   * the other CPUs' bins are not locked on every free.
+   */
+
+  DEBUGASSERT(!mm_fastbin_cached(bin, mem));
+#endif
+
+  if (bin->count < CONFIG_MM_FASTBIN_DEPTH)
+    {
+      FAR struct mm_fastnode_s *fnode = (FAR struct mm_fastnode_s *)mem;
+
+      fnode->flink = bin->head;
+      bin->head    = fnode;
+      bin->count++;
+      ret = true;
+    }
+
+  mm_fastbin_unlock(heap, cpu);
+  up_irq_restore(flags);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: mm_fastbin_flush
+ *
+ * Description:
+ *   Return all chunks cached in the fast bins of all CPUs to the
+ *   coalescing allocator.  This is done when an allocation fails so that
+ *   the cached memory is available for larger allocations.
+ *
+ * Input Parameters:
+ *   heap - The heap whose fast bins will be flushed
+ *
+ * Returned Value:
+ *   true if any chunk was returned to the heap.
+ *
+ ****************************************************************************/
+
+bool mm_fastbin_flush(FAR struct mm_heap_s *heap)
+{
+  FAR struct mm_fastnode_s *node;
+  FAR struct mm_fastnode_s *next;
+  FAR struct mm_fastbin_s *bin;
+  irqstate_t flags;
+  bool ret = false;
+  int cpu;
+  int ndx;
+
+  for (cpu = 0; cpu < MM_FASTBIN_NCPUS; cpu++)
+    {
+      for (ndx = 0; ndx < MM_FASTBIN_NCLASSES; ndx++)
+        {
+          /* Detach the list with interrupts disabled and, in the SMP
+           * case, with the bins of that CPU locked.
+           */
+
+          flags = up_irq_save();
+          mm_fastbin_lock(heap, cpu);
+
+          bin        = &heap->mm_fastbin[cpu][ndx];
+          node       = bin->head;
+          bin->head  = NULL;
+          bin->count = 0;
+
+          mm_fastbin_unlock(heap, cpu);
+          up_irq_restore(flags);
+
+          /* Then return each chunk to the heap under the heap semaphore */
+
+          for (; node != NULL; node = next)
+            {
+              next = node->flink;
+              mm_freechunk(heap, node);
+              ret = true;
+            }
+        }
+    }
+
+  return ret;
+}
+#endif /* MM_USE_FASTBINS */
+
+/****************************************************************************
+ * Name: mm_fastbin_mallinfo
+ *
+ * Description:
+ *   Return the number of chunks and the number of bytes cached in the fast
+ *   bins.  These are counted as allocated by the coalescing allocator but
+ *   are reported as free by mm_mallinfo().
+ *
+ ****************************************************************************/
+
+void mm_fastbin_mallinfo(FAR struct mm_heap_s *heap, FAR int *nchunks,
+                         FAR size_t *nbytes)
+{
+  size_t bytes = 0;
+  int chunks = 0;
+  int count;
+  int cpu;
+  int ndx;
+
+  /* Every chunk in a bin has exactly the size of the bin's size class */
+
+  for (cpu = 0; cpu < MM_FASTBIN_NCPUS; cpu++)
+    {
+      for (ndx = 0; ndx < MM_FASTBIN_NCLASSES; ndx++)
+        {
+          count   = heap->mm_fastbin[cpu][ndx].count;
+          chunks += count;
+          bytes  += (size_t)count * ((size_t)(ndx + 1) << MM_MIN_SHIFT);
+        }
+    }
+
+  *nchunks = chunks;
+  *nbytes  = bytes;
+}
+
+#endif /* CONFIG_MM_FASTBINS */
@@ -81,12 +81,6 @@ static void mm_add_delaylist(FAR struct mm_heap_s *heap, FAR void *mem)
 
 void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
 {
-  FAR struct mm_freenode_s *node;
-  FAR struct mm_freenode_s *prev;
-  FAR struct mm_freenode_s *next;
-  int ret;
-
-  UNUSED(ret);
   minfo("Freeing %p\n", mem);
 
   /* Protect against attempts to free a NULL reference */
@@ -96,6 +90,36 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
       return;
     }
 
+#ifdef MM_USE_FASTBINS
+  /* Small chunks are cached in the fast bins if there is room */
+
+  if (mm_fastbin_free(heap, mem))
+    {
+      return;
+    }
+#endif
+
+  mm_freechunk(heap, mem);
+}
+
+/****************************************************************************
+ * Name: mm_freechunk
+ *
+ * Description:
+ *   Returns a chunk of memory to the list of free nodes, bypassing the fast
+ *   bins.  'mem' must not be NULL.
+ *
+ ****************************************************************************/
+
+void mm_freechunk(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+  FAR struct mm_freenode_s *node;
+  FAR struct mm_freenode_s *prev;
+  FAR struct mm_freenode_s *next;
+  int ret;
+
+  UNUSED(ret);
+
 #if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
   /* Check current environment */
 
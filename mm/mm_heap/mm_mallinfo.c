@@ -145,6 +145,23 @@ int mm_mallinfo(FAR struct mm_heap_s *heap, FAR struct mallinfo *info)
     }
 #undef region
 
+#ifdef CONFIG_MM_FASTBINS
+  /* Chunks cached in the fast bins are still marked as allocated in the
+   * heap, but they are available for allocation and are reported as free.
+   */
+
+    {
+      size_t nbytes;
+      int nchunks;
+
+      mm_fastbin_mallinfo(heap, &nchunks, &nbytes);
+
+      ordblks  += nchunks;
+      uordblks -= nbytes;
+      fordblks += nbytes;
+    }
+#endif
+
   DEBUGASSERT(uordblks + fordblks == heap->mm_heapsize);
 
   info->arena    = heap->mm_heapsize;
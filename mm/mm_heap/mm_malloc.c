@@ -136,6 +136,19 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
   DEBUGASSERT(alignsize >= MM_MIN_CHUNK);
   DEBUGASSERT(alignsize >= SIZEOF_MM_FREENODE);
 
+#ifdef MM_USE_FASTBINS
+  /* Try the fast bins first.  They do not require the MM semaphore. */
+
+  ret = mm_fastbin_alloc(heap, alignsize);
+  if (ret != NULL)
+    {
+#ifdef CONFIG_MM_FILL_ALLOCATIONS
+      memset(ret, 0xaa, alignsize - SIZEOF_MM_ALLOCNODE);
+#endif
+      return ret;
+    }
+#endif
+
   /* We need to hold the MM semaphore while we muck with the nodelist. */
 
   mm_takesemaphore(heap);
@@ -236,6 +249,17 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
   DEBUGASSERT(ret == NULL || mm_heapmember(heap, ret));
   mm_givesemaphore(heap);
 
+#ifdef MM_USE_FASTBINS
+  /* If the allocation failed, return the chunks cached in the fast bins to
+   * the heap and try again.
+   */
+
+  if (ret == NULL && mm_fastbin_flush(heap))
+    {
+      return mm_malloc(heap, size);
+    }
+#endif
+
 #ifdef CONFIG_MM_FILL_ALLOCATIONS
   if (ret)
     {
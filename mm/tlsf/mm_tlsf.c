@@ -0,0 +1,963 @@
+/****************************************************************************
+ * mm/tlsf/mm_tlsf.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <malloc.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/irq.h>
+#include <nuttx/mm/mm.h>
+
+/* The TLSF heap manager uses the same chunk layout as the default heap
+ * manager:  Each chunk begins with a struct mm_allocnode_s that holds the
+ * size of the chunk and the size of the physically preceding chunk.
+ * MM_ALLOC_BIT in 'preceding' marks the chunk as allocated.  Free chunks
+ * additionally hold the links of the segregated free list that they are in.
+ * This lets mm_heapmember(), mm_brkaddr(), mm_extend() and
+ * malloc_usable_size() be shared with the default heap manager.
+ *
+ * All free chunks are fully coalesced, so a free chunk never has a free
+ * physical neighbor.
+ */
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_tlsf_mapping
+ *
+ * Description:
+ *   Map a chunk size to the first and second level indices of the free
+ *   list that holds chunks of that size.
+ *
+ ****************************************************************************/
+
+static inline void mm_tlsf_mapping(size_t size, FAR int *fl, FAR int *sl)
+{
+  int bit;
+
+  if (size < MM_TLSF_SMALL_CHUNK)
+    {
+      *fl = 0;
+      *sl = (int)(size >> MM_MIN_SHIFT);
+    }
+  else
+    {
+      bit = fls((int)size) - 1;
+      *fl = bit - MM_TLSF_FL_SHIFT + 1;
+      *sl = (int)(size >> (bit - MM_TLSF_SL_SHIFT)) - MM_TLSF_SL_COUNT;
+    }
+}
+
+/****************************************************************************
+ * Name: mm_tlsf_insert
+ *
+ * Description:
+ *   Add a free chunk to the head of the free list of its size range.
+ *
+ ****************************************************************************/
+
+static void mm_tlsf_insert(FAR struct mm_heap_s *heap,
+                           FAR struct mm_freenode_s *node)
+{
+  FAR struct mm_freenode_s *head;
+  int fl;
+  int sl;
+
+  mm_tlsf_mapping(node->size, &fl, &sl);
+
+  head        = heap->mm_freelist[fl][sl];
+  node->flink = head;
+  node->blink = NULL;
+
+  if (head != NULL)
+    {
+      head->blink = node;
+    }
+
+  heap->mm_freelist[fl][sl] = node;
+  heap->mm_flbitmap        |= UINT32_C(1) << fl;
+  heap->mm_slbitmap[fl]    |= UINT32_C(1) << sl;
+}
+
+/****************************************************************************
+ * Name: mm_tlsf_remove
+ *
+ * Description:
+ *   Remove a free chunk from the free list of its size range.
+ *
+ ****************************************************************************/
+
+static void mm_tlsf_remove(FAR struct mm_heap_s *heap,
+                           FAR struct mm_freenode_s *node)
+{
+  int fl;
+  int sl;
+
+  if (node->flink != NULL)
+    {
+      node->flink->blink = node->blink;
+    }
+
+  if (node->blink != NULL)
+    {
+      node->blink->flink = node->flink;
+      return;
+    }
+
+  /* This was the head of the list */
+
+  mm_tlsf_mapping(node->size, &fl, &sl);
+  DEBUGASSERT(heap->mm_freelist[fl][sl] == node);
+
+  heap->mm_freelist[fl][sl] = node->flink;
+  if (node->flink == NULL)
+    {
+      heap->mm_slbitmap[fl] &= ~(UINT32_C(1) << sl);
+      if (heap->mm_slbitmap[fl] == 0)
+        {
+          heap->mm_flbitmap &= ~(UINT32_C(1) << fl);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: mm_tlsf_search
+ *
+ * Description:
+ *   Find a free chunk of at least 'size' bytes.  The size is rounded up to
+ *   the next size range so that any chunk of the range that is found is
+ *   large enough ("good fit").  The chunk is not removed from its list.
+ *
+ ****************************************************************************/
+
+static FAR struct mm_freenode_s *mm_tlsf_search(FAR struct mm_heap_s *heap,
+                                                size_t size)
+{
+  uint32_t map;
+  size_t round;
+  int fl;
+  int sl;
+
+  if (size >= MM_TLSF_SMALL_CHUNK)
+    {
+      round = ((size_t)1 << (fls((int)size) - 1 - MM_TLSF_SL_SHIFT)) - 1;
+      if (size + round >= MM_TLSF_MAX_CHUNK)
+        {
+          return NULL;
+        }
+
+      size += round;
+    }
+
+  mm_tlsf_mapping(size, &fl, &sl);
+
+  /* Look for a non-empty list in the same first level range first */
+
+  map = heap->mm_slbitmap[fl] & ~((UINT32_C(1) << sl) - 1);
+  if (map == 0)
+    {
+      /* Then use the smallest larger first level range */
+
+      map = heap->mm_flbitmap & ~((UINT32_C(1) << (fl + 1)) - 1);
+      if (map == 0)
+        {
+          return NULL;
+        }
+
+      fl  = ffs((int)map) - 1;
+      map = heap->mm_slbitmap[fl];
+    }
+
+  sl = ffs((int)map) - 1;
+  return heap->mm_freelist[fl][sl];
+}
+
+/****************************************************************************
+ * Name: mm_tlsf_trim
+ *
+ * Description:
+ *   Reduce the size of an allocated chunk to 'size', returning the excess
+ *   to the free lists.
+ *
+ * Assumptions:
+ *   The caller holds the MM semaphore.
+ *
+ ****************************************************************************/
+
+static void mm_tlsf_trim(FAR struct mm_heap_s *heap,
+                         FAR struct mm_allocnode_s *node, size_t size)
+{
+  FAR struct mm_freenode_s *newnode;
+  FAR struct mm_freenode_s *next;
+  FAR struct mm_allocnode_s *andbeyond;
+
+  DEBUGASSERT(node->size >= size);
+  if (node->size == size)
+    {
+      return;
+    }
+
+  next = (FAR struct mm_freenode_s *)((FAR char *)node + node->size);
+  if ((next->preceding & MM_ALLOC_BIT) == 0)
+    {
+      /* The next chunk is free.  Give the excess to it. */
+
+      mm_tlsf_remove(heap, next);
+
+      andbeyond = (FAR struct mm_allocnode_s *)
+                  ((FAR char *)next + next->size);
+
+      newnode            = (FAR struct mm_freenode_s *)
+                           ((FAR char *)node + size);
+      newnode->size      = next->size + node->size - size;
+      newnode->preceding = size;
+      node->size         = size;
+
+      andbeyond->preceding = newnode->size |
+                             (andbeyond->preceding & MM_ALLOC_BIT);
+
+      mm_tlsf_insert(heap, newnode);
+    }
+  else if (node->size >= size + SIZEOF_MM_FREENODE)
+    {
+      /* The excess is large enough to be a free chunk of its own */
+
+      newnode            = (FAR struct mm_freenode_s *)
+                           ((FAR char *)node + size);
+      newnode->size      = node->size - size;
+      newnode->preceding = size;
+      node->size         = size;
+
+      next->preceding = newnode->size | MM_ALLOC_BIT;
+
+      mm_tlsf_insert(heap, newnode);
+    }
+}
+
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+/****************************************************************************
+ * Name: mm_tlsf_add_delaylist
+ ****************************************************************************/
+
+static void mm_tlsf_add_delaylist(FAR struct mm_heap_s *heap,
+                                  FAR void *mem)
+{
+  FAR struct mm_delaynode_s *tmp = mem;
+  irqstate_t flags;
+
+  /* Delay the deallocation until a more appropriate time. */
+
+  flags = enter_critical_section();
+
+  tmp->flink = heap->mm_delaylist;
+  heap->mm_delaylist = tmp;
+
+  leave_critical_section(flags);
+}
+#endif
+
+/****************************************************************************
+ * Name: mm_tlsf_free_delaylist
+ ****************************************************************************/
+
+static void mm_tlsf_free_delaylist(FAR struct mm_heap_s *heap)
+{
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+  FAR struct mm_delaynode_s *tmp;
+  irqstate_t flags;
+
+  /* Move the delay list to local */
+
+  flags = enter_critical_section();
+
+  tmp = heap->mm_delaylist;
+  heap->mm_delaylist = NULL;
+
+  leave_critical_section(flags);
+
+  /* Test if the delayed is empty */
+
+  while (tmp)
+    {
+      FAR void *address;
+
+      /* Get the first delayed deallocation */
+
+      address = tmp;
+      tmp = tmp->flink;
+
+      /* The address should always be non-NULL since that was checked in the
+       * 'while' condition above.
+       */
+
+      mm_free(heap, address);
+    }
+#endif
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_addregion
+ *
+ * Description:
+ *   This function adds a region of contiguous memory to the selected heap.
+ *
+ * Input Parameters:
+ *   heap      - The selected heap
+ *   heapstart - Start of the heap region
+ *   heapsize  - Size of the heap region
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void mm_addregion(FAR struct mm_heap_s *heap, FAR void *heapstart,
+                  size_t heapsize)
+{
+  FAR struct mm_freenode_s *node;
+  uintptr_t heapbase;
+  uintptr_t heapend;
+#if CONFIG_MM_REGIONS > 1
+  int IDX = heap->mm_nregions;
+
+  /* Writing past CONFIG_MM_REGIONS would have catastrophic consequences */
+
+  DEBUGASSERT(IDX < CONFIG_MM_REGIONS);
+  if (IDX >= CONFIG_MM_REGIONS)
+    {
+      return;
+    }
+
+#else
+# define IDX 0
+#endif
+
+  /* A free chunk can be no larger than MM_TLSF_MAX_CHUNK */
+
+  DEBUGASSERT(heapsize < MM_TLSF_MAX_CHUNK);
+
+  mm_takesemaphore(heap);
+
+  /* Adjust the provide heap start and size so that they are both aligned
+   * with the MM_MIN_CHUNK size.
+   */
+
+  heapbase = MM_ALIGN_UP((uintptr_t)heapstart);
+  heapend  = MM_ALIGN_DOWN((uintptr_t)heapstart + (uintptr_t)heapsize);
+  heapsize = heapend - heapbase;
+
+  minfo("Region %d: base=%p size=%u\n", IDX + 1, heapstart, heapsize);
+
+  /* Add the size of this region to the total size of the heap */
+
+  heap->mm_heapsize += heapsize;
+
+  /* Create two "allocated" guard nodes at the beginning and end of
+   * the heap and one free node between them that contains all available
+   * memory.
+   */
+
+  heap->mm_heapstart[IDX]            = (FAR struct mm_allocnode_s *)heapbase;
+  heap->mm_heapstart[IDX]->size      = SIZEOF_MM_ALLOCNODE;
+  heap->mm_heapstart[IDX]->preceding = MM_ALLOC_BIT;
+
+  node                               = (FAR struct mm_freenode_s *)
+                                       (heapbase + SIZEOF_MM_ALLOCNODE);
+  node->size                         = heapsize - 2*SIZEOF_MM_ALLOCNODE;
+  node->preceding                    = SIZEOF_MM_ALLOCNODE;
+
+  heap->mm_heapend[IDX]              = (FAR struct mm_allocnode_s *)
+                                       (heapend - SIZEOF_MM_ALLOCNODE);
+  heap->mm_heapend[IDX]->size        = SIZEOF_MM_ALLOCNODE;
+  heap->mm_heapend[IDX]->preceding   = node->size | MM_ALLOC_BIT;
+
+#undef IDX
+
+#if CONFIG_MM_REGIONS > 1
+  heap->mm_nregions++;
+#endif
+
+  /* Add the single, large free node to the free lists */
+
+  mm_tlsf_insert(heap, node);
+
+  mm_givesemaphore(heap);
+}
+
+/****************************************************************************
+ * Name: mm_initialize
+ *
+ * Description:
+ *   Initialize the selected heap data structures, providing the initial
+ *   heap region.
+ *
+ * Input Parameters:
+ *   heap      - The selected heap
+ *   heapstart - Start of the initial heap region
+ *   heapsize  - Size of the initial heap region
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void mm_initialize(FAR struct mm_heap_s *heap, FAR void *heapstart,
+                   size_t heapsize)
+{
+  minfo("Heap: start=%p size=%u\n", heapstart, heapsize);
+
+#ifndef __ZILOG__
+  CHECK_ALLOCNODE_SIZE;
+  CHECK_FREENODE_SIZE;
+#endif
+  DEBUGASSERT(MM_MIN_CHUNK >= SIZEOF_MM_FREENODE);
+  DEBUGASSERT(MM_TLSF_SL_COUNT <= 32 && MM_TLSF_FL_COUNT <= 32);
+
+  /* Set up global variables */
+
+  heap->mm_heapsize = 0;
+
+#if CONFIG_MM_REGIONS > 1
+  heap->mm_nregions = 0;
+#endif
+
+  /* Initialize mm_delaylist */
+
+  heap->mm_delaylist = NULL;
+
+  /* All free lists are empty */
+
+  heap->mm_flbitmap = 0;
+  memset(heap->mm_slbitmap, 0, sizeof(heap->mm_slbitmap));
+  memset(heap->mm_freelist, 0, sizeof(heap->mm_freelist));
+
+  /* Initialize the malloc semaphore to one (to support one-at-
+   * a-time access to private data sets).
+   */
+
+  mm_seminitialize(heap);
+
+  /* Add the initial region of memory to the heap */
+
+  mm_addregion(heap, heapstart, heapsize);
+}
+
+/****************************************************************************
+ * Name: mm_malloc
+ *
+ * Description:
+ *   Take the memory from the first chunk of the smallest size range that is
+ *   guaranteed to satisfy the request and return the remainder (if any) to
+ *   the free lists.  This takes constant time.
+ *
+ ****************************************************************************/
+
+FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
+{
+  FAR struct mm_freenode_s *node;
+  size_t alignsize;
+  FAR void *ret = NULL;
+
+  /* Firstly, free mm_delaylist */
+
+  mm_tlsf_free_delaylist(heap);
+
+  /* Ignore zero-length allocations */
+
+  if (size < 1)
+    {
+      return NULL;
+    }
+
+  /* Adjust the size to account for (1) the size of the allocated node and
+   * (2) to make sure that it is an even multiple of our granule size.
+   */
+
+  alignsize = MM_ALIGN_UP(size + SIZEOF_MM_ALLOCNODE);
+  if (alignsize < size || alignsize >= MM_TLSF_MAX_CHUNK)
+    {
+      mwarn("WARNING: Allocation too large, size %u\n", size);
+      return NULL;
+    }
+
+  DEBUGASSERT(alignsize >= SIZEOF_MM_FREENODE);
+
+  /* We need to hold the MM semaphore while we muck with the free lists. */
+
+  mm_takesemaphore(heap);
+
+  node = mm_tlsf_search(heap, alignsize);
+  if (node != NULL)
+    {
+      DEBUGASSERT(node->size >= alignsize);
+
+      /* Remove the chunk from its free list, mark it allocated and return
+       * any excess to the free lists.
+       */
+
+      mm_tlsf_remove(heap, node);
+
+      node->preceding |= MM_ALLOC_BIT;
+      mm_tlsf_trim(heap, (FAR struct mm_allocnode_s *)node, alignsize);
+
+      ret = (FAR void *)((FAR char *)node + SIZEOF_MM_ALLOCNODE);
+    }
+
+  DEBUGASSERT(ret == NULL || mm_heapmember(heap, ret));
+  mm_givesemaphore(heap);
+
+#ifdef CONFIG_MM_FILL_ALLOCATIONS
+  if (ret)
+    {
+       memset(ret, 0xaa, alignsize - SIZEOF_MM_ALLOCNODE);
+    }
+#endif
+
+#ifdef CONFIG_DEBUG_MM
+  if (!ret)
+    {
+      mwarn("WARNING: Allocation failed, size %d\n", alignsize);
+    }
+  else
+    {
+      minfo("Allocated %p, size %d\n", ret, alignsize);
+    }
+#endif
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: mm_free
+ *
+ * Description:
+ *   Returns a chunk of memory to the free lists, merging it with adjacent
+ *   free chunks.  This takes constant time.
+ *
+ ****************************************************************************/
+
+void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+  FAR struct mm_freenode_s *node;
+  FAR struct mm_freenode_s *prev;
+  FAR struct mm_freenode_s *next;
+  int ret;
+
+  UNUSED(ret);
+  minfo("Freeing %p\n", mem);
+
+  /* Protect against attempts to free a NULL reference */
+
+  if (!mem)
+    {
+      return;
+    }
+
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+  /* Check current environment */
+
+  if (up_interrupt_context())
+    {
+      /* We are in ISR, add to mm_delaylist */
+
+      mm_tlsf_add_delaylist(heap, mem);
+      return;
+    }
+  else if ((ret = mm_trysemaphore(heap)) == 0)
+    {
+      /* Got the sem, do free immediately */
+    }
+  else if (ret == -ESRCH || sched_idletask())
+    {
+      /* We are in IDLE task & can't get sem, or meet -ESRCH return,
+       * which means we are in situations during context switching(See
+       * mm_trysemaphore() & getpid()). Then add to mm_delaylist.
+       */
+
+      mm_tlsf_add_delaylist(heap, mem);
+      return;
+    }
+  else
+#endif
+    {
+      /* We need to hold the MM semaphore while we muck with the free
+       * lists.
+       */
+
+      mm_takesemaphore(heap);
+    }
+
+  DEBUGASSERT(mm_heapmember(heap, mem));
+
+  /* Map the memory chunk into a free node */
+
+  node = (FAR struct mm_freenode_s *)((FAR char *)mem - SIZEOF_MM_ALLOCNODE);
+
+  /* Sanity check against double-frees */
+
+  DEBUGASSERT(node->preceding & MM_ALLOC_BIT);
+
+  node->preceding &= ~MM_ALLOC_BIT;
+
+  /* Merge with the following node if it is free */
+
+  next = (FAR struct mm_freenode_s *)((FAR char *)node + node->size);
+  DEBUGASSERT((next->preceding & ~MM_ALLOC_BIT) == node->size);
+  if ((next->preceding & MM_ALLOC_BIT) == 0)
+    {
+      mm_tlsf_remove(heap, next);
+      node->size += next->size;
+    }
+
+  /* Merge with the preceding node if it is free */
+
+  prev = (FAR struct mm_freenode_s *)((FAR char *)node - node->preceding);
+  DEBUGASSERT(node->preceding == prev->size);
+  if ((prev->preceding & MM_ALLOC_BIT) == 0)
+    {
+      mm_tlsf_remove(heap, prev);
+      prev->size += node->size;
+      node = prev;
+    }
+
+  /* Fix up the preceding size of the node that follows the merged chunk */
+
+  next = (FAR struct mm_freenode_s *)((FAR char *)node + node->size);
+  next->preceding = node->size | (next->preceding & MM_ALLOC_BIT);
+
+  mm_tlsf_insert(heap, node);
+  mm_givesemaphore(heap);
+}
+
+/****************************************************************************
+ * Name: mm_realloc
+ *
+ * Description:
+ *   If the reallocation is for less space, then the excess is returned to
+ *   the heap.  If the request is for more space and the chunk that follows
+ *   is free and large enough, the chunk is extended in place.  Otherwise, a
+ *   new chunk is allocated, the data is copied and the old chunk is freed.
+ *
+ ****************************************************************************/
+
+FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
+                     size_t size)
+{
+  FAR struct mm_allocnode_s *oldnode;
+  FAR struct mm_freenode_s *next;
+  FAR void *newmem;
+  size_t newsize;
+  size_t oldsize;
+
+  /* If oldmem is NULL, then realloc is equivalent to malloc */
+
+  if (oldmem == NULL)
+    {
+      return mm_malloc(heap, size);
+    }
+
+  /* If size is zero, then realloc is equivalent to free */
+
+  if (size < 1)
+    {
+      mm_free(heap, oldmem);
+      return NULL;
+    }
+
+  /* Adjust the size to account for (1) the size of the allocated node and
+   * (2) to make sure that it is an even multiple of our granule size.
+   */
+
+  newsize = MM_ALIGN_UP(size + SIZEOF_MM_ALLOCNODE);
+  if (newsize < size || newsize >= MM_TLSF_MAX_CHUNK)
+    {
+      mwarn("WARNING: Allocation too large, size %u\n", size);
+      return NULL;
+    }
+
+  /* Map the memory chunk into an allocated node structure */
+
+  oldnode = (FAR struct mm_allocnode_s *)
+            ((FAR char *)oldmem - SIZEOF_MM_ALLOCNODE);
+
+  /* We need to hold the MM semaphore while we muck with the free lists. */
+
+  mm_takesemaphore(heap);
+  DEBUGASSERT(oldnode->preceding & MM_ALLOC_BIT);
+  DEBUGASSERT(mm_heapmember(heap, oldmem));
+
+  oldsize = oldnode->size;
+  if (newsize > oldsize)
+    {
+      /* Try to grow into the following chunk */
+
+      next = (FAR struct mm_freenode_s *)((FAR char *)oldnode + oldsize);
+      if ((next->preceding & MM_ALLOC_BIT) != 0 ||
+          oldsize + next->size < newsize)
+        {
+          /* Allocate a new chunk, copy the data and free the old one */
+
+          mm_givesemaphore(heap);
+
+          newmem = mm_malloc(heap, size);
+          if (newmem != NULL)
+            {
+              memcpy(newmem, oldmem, oldsize - SIZEOF_MM_ALLOCNODE);
+              mm_free(heap, oldmem);
+            }
+
+          return newmem;
+        }
+
+      mm_tlsf_remove(heap, next);
+      oldnode->size = oldsize + next->size;
+
+      next = (FAR struct mm_freenode_s *)
+             ((FAR char *)oldnode + oldnode->size);
+      next->preceding = oldnode->size | (next->preceding & MM_ALLOC_BIT);
+    }
+
+  /* Return any excess to the free lists */
+
+  mm_tlsf_trim(heap, oldnode, newsize);
+  mm_givesemaphore(heap);
+  return oldmem;
+}
+
+/****************************************************************************
+ * Name: mm_memalign
+ *
+ * Description:
+ *   memalign requests more than enough space from malloc, finds a region
+ *   within that chunk that meets the alignment request and then frees any
+ *   leading or trailing space.
+ *
+ *   The alignment argument must be a power of two (not checked).  8-byte
+ *   alignment is guaranteed by normal malloc calls.
+ *
+ ****************************************************************************/
+
+FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
+                      size_t size)
+{
+  FAR struct mm_allocnode_s *node;
+  size_t rawchunk;
+  size_t alignedchunk;
+  size_t mask = (size_t)(alignment - 1);
+  size_t allocsize;
+
+  /* If this requested alignment is less than or equal to the natural
+   * alignment of malloc, then just let malloc do the work.
+   */
+
+  if (alignment <= MM_MIN_CHUNK)
+    {
+      return mm_malloc(heap, size);
+    }
+
+  /* Allocate enough memory for two alignment points so that the leading
+   * space can always be made into a free chunk.
+   */
+
+  size      = MM_ALIGN_UP(size);
+  allocsize = size + 2*alignment;
+  if (allocsize < size || allocsize >= MM_TLSF_MAX_CHUNK)
+    {
+      return NULL;
+    }
+
+  rawchunk = (size_t)mm_malloc(heap, allocsize);
+  if (rawchunk == 0)
+    {
+      return NULL;
+    }
+
+  /* We need to hold the MM semaphore while we muck with the chunks and
+   * free lists.
+   */
+
+  mm_takesemaphore(heap);
+
+  node = (FAR struct mm_allocnode_s *)(rawchunk - SIZEOF_MM_ALLOCNODE);
+  alignedchunk = (rawchunk + mask) & ~mask;
+
+  /* Check if there is free space at the beginning of the aligned chunk */
+
+  if (alignedchunk != rawchunk)
+    {
+      FAR struct mm_allocnode_s *newnode;
+      FAR struct mm_allocnode_s *next;
+      FAR struct mm_freenode_s *prev;
+      size_t precedingsize;
+
+      next = (FAR struct mm_allocnode_s *)((FAR char *)node + node->size);
+
+      newnode = (FAR struct mm_allocnode_s *)
+                (alignedchunk - SIZEOF_MM_ALLOCNODE);
+      precedingsize = (size_t)newnode - (size_t)node;
+
+      /* The leading space must be large enough to be a free chunk.  If it
+       * is not, use the second alignment point.
+       */
+
+      if (precedingsize < SIZEOF_MM_FREENODE)
+        {
+          alignedchunk += alignment;
+          newnode       = (FAR struct mm_allocnode_s *)
+                          (alignedchunk - SIZEOF_MM_ALLOCNODE);
+          precedingsize = (size_t)newnode - (size_t)node;
+        }
+
+      /* Set up the new, aligned node */
+
+      newnode->size      = (size_t)next - (size_t)newnode;
+      newnode->preceding = precedingsize | MM_ALLOC_BIT;
+      next->preceding    = newnode->size | (next->preceding & MM_ALLOC_BIT);
+
+      /* Free the leading space.  The chunk before it may have been freed
+       * while the semaphore was not held, so merge with it if it is free.
+       */
+
+      node->size       = precedingsize;
+      node->preceding &= ~MM_ALLOC_BIT;
+
+      prev = (FAR struct mm_freenode_s *)
+             ((FAR char *)node - node->preceding);
+      DEBUGASSERT(node->preceding == prev->size);
+      if ((prev->preceding & MM_ALLOC_BIT) == 0)
+        {
+          mm_tlsf_remove(heap, prev);
+          prev->size        += precedingsize;
+          newnode->preceding = prev->size | MM_ALLOC_BIT;
+          node               = (FAR struct mm_allocnode_s *)prev;
+        }
+
+      mm_tlsf_insert(heap, (FAR struct mm_freenode_s *)node);
+
+      node = newnode;
+    }
+
+  /* Return any trailing space to the free lists */
+
+  mm_tlsf_trim(heap, node, MM_ALIGN_UP(size + SIZEOF_MM_ALLOCNODE));
+
+  mm_givesemaphore(heap);
+  return (FAR void *)alignedchunk;
+}
+
+/****************************************************************************
+ * Name: mm_mallinfo
+ *
+ * Description:
+ *   mallinfo returns a copy of updated current heap information.
+ *
+ ****************************************************************************/
+
+int mm_mallinfo(FAR struct mm_heap_s *heap, FAR struct mallinfo *info)
+{
+  FAR struct mm_allocnode_s *node;
+  size_t mxordblk = 0;
+  int    ordblks  = 0;  /* Number of non-inuse chunks */
+  size_t uordblks = 0;  /* Total allocated space */
+  size_t fordblks = 0;  /* Total non-inuse space */
+#if CONFIG_MM_REGIONS > 1
+  int region;
+#else
+# define region 0
+#endif
+
+  DEBUGASSERT(info);
+
+  /* Visit each region */
+
+#if CONFIG_MM_REGIONS > 1
+  for (region = 0; region < heap->mm_nregions; region++)
+#endif
+    {
+      /* Visit each node in the region
+       * Retake the semaphore for each region to reduce latencies
+       */
+
+      mm_takesemaphore(heap);
+
+      for (node = heap->mm_heapstart[region];
+           node < heap->mm_heapend[region];
+           node = (FAR struct mm_allocnode_s *)
+                  ((FAR char *)node + node->size))
+        {
+          if ((node->preceding & MM_ALLOC_BIT) != 0)
+            {
+              DEBUGASSERT(node->size >= SIZEOF_MM_ALLOCNODE);
+              uordblks += node->size;
+            }
+          else
+            {
+#ifdef CONFIG_DEBUG_ASSERTIONS
+              FAR struct mm_freenode_s *fnode = (FAR void *)node;
+#endif
+              DEBUGASSERT(node->size >= SIZEOF_MM_FREENODE);
+              DEBUGASSERT(fnode->blink == NULL ||
+                          fnode->blink->flink == fnode);
+              DEBUGASSERT(fnode->flink == NULL ||
+                          fnode->flink->blink == fnode);
+
+              ordblks++;
+              fordblks += node->size;
+              if (node->size > mxordblk)
+                {
+                  mxordblk = node->size;
+                }
+            }
+        }
+
+      DEBUGASSERT(node == heap->mm_heapend[region]);
+
+      mm_givesemaphore(heap);
+
+      uordblks += SIZEOF_MM_ALLOCNODE; /* account for the tail node */
+    }
+#undef region
+
+  DEBUGASSERT(uordblks + fordblks == heap->mm_heapsize);
+
+  info->arena    = heap->mm_heapsize;
+  info->ordblks  = ordblks;
+  info->mxordblk = mxordblk;
+  info->uordblks = uordblks;
+  info->fordblks = fordblks;
+  return OK;
+}
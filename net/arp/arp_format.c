@@ -51,6 +51,7 @@
 #include <nuttx/net/netdev.h>
 #include <nuttx/net/arp.h>
 
+#include "netdev/netdev.h"
 #include "arp/arp.h"
 
 #ifdef CONFIG_NET_ARP
@@ -86,6 +87,10 @@ void arp_format(FAR struct net_driver_s *dev, in_addr_t ipaddr)
   FAR struct arp_hdr_s *arp = ARPBUF;
   FAR struct eth_hdr_s *eth = ETHBUF;
 
+  /* The ARP request replaces the outgoing packet */
+
+  netdev_iob_txreset(dev);
+
   /* Construct the ARP packet.  Creating both the Ethernet and ARP headers */
 
   memset(eth->dest, 0xff, ETHER_ADDR_LEN);
@@ -481,6 +481,29 @@ void devif_iob_send(FAR struct net_driver_s *dev, FAR struct iob_s *buf,
                     unsigned int len, unsigned int offset);
 #endif
 
+/****************************************************************************
+ * Name: devif_iob_sendsg
+ *
+ * Description:
+ *   Like devif_iob_send(), but if the device can gather an outgoing packet
+ *   from several buffers (d_txsg), the data is left in the I/O buffer
+ *   chain and only referenced by d_txiob instead of being copied into
+ *   d_buf.  The caller must keep the I/O buffer chain until the data has
+ *   been acknowledged by the peer, as the TCP write buffers do.
+ *
+ * Assumptions:
+ *   This function must be called with the network locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_IOB_TX
+void devif_iob_sendsg(FAR struct net_driver_s *dev, FAR struct iob_s *iob,
+                      unsigned int len, unsigned int offset);
+#else
+#  define devif_iob_sendsg(dev,iob,len,offset) \
+     devif_iob_send(dev,iob,len,offset)
+#endif
+
 /****************************************************************************
  * Name: devif_pkt_send
  *
@@ -84,4 +84,39 @@ void devif_iob_send(FAR struct net_driver_s *dev, FAR struct iob_s *iob,
 #endif
 }
 
+/****************************************************************************
+ * Name: devif_iob_sendsg
+ *
+ * Description:
+ *   Like devif_iob_send(), but the data is only referenced if the device
+ *   supports scatter-gather transmit.  See net/devif/devif.h.
+ *
+ * Assumptions:
+ *   Called with the network locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_IOB_TX
+void devif_iob_sendsg(FAR struct net_driver_s *dev, FAR struct iob_s *iob,
+                      unsigned int len, unsigned int offset)
+{
+  if (!dev->d_txsg)
+    {
+      devif_iob_send(dev, iob, len, offset);
+      return;
+    }
+
+  DEBUGASSERT(dev && len > 0 && len < NETDEV_PKTSIZE(dev));
+
+  /* The packet headers are built in d_buf as usual, but the driver takes
+   * the payload directly from the I/O buffer chain.
+   */
+
+  dev->d_txiob    = iob;
+  dev->d_txoffset = offset;
+  dev->d_txlen    = len;
+  dev->d_sndlen   = len;
+}
+#endif /* CONFIG_NETDEV_IOB_TX */
+
 #endif /* CONFIG_MM_IOB */
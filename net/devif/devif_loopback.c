@@ -96,6 +96,12 @@ int devif_loopback(FAR struct net_driver_s *dev)
 
   do
     {
+#ifdef CONFIG_NETDEV_IOB_TX
+      /* The input functions expect the whole packet in d_buf */
+
+      netdev_iob_txflatten(dev);
+#endif
+
        NETDEV_TXPACKETS(dev);
        NETDEV_RXPACKETS(dev);
 
@@ -49,6 +49,7 @@
 #include <nuttx/net/net.h>
 
 #include "devif/devif.h"
+#include "netdev/netdev.h"
 #include "arp/arp.h"
 #include "can/can.h"
 #include "tcp/tcp.h"
@@ -564,23 +565,38 @@ static inline int devif_poll_tcp_connections(FAR struct net_driver_s *dev,
                                              devif_poll_callback_t callback)
 {
   FAR struct tcp_conn_s *conn  = NULL;
+  bool sent;
+  int batch;
   int bstop = 0;
 
   /* Traverse all of the active TCP connections and perform the poll action */
 
   while (!bstop && (conn = tcp_nextconn(conn)))
     {
-      /* Perform the TCP TX poll */
+      /* Keep polling the same connection as long as it produces packets,
+       * the driver is able to take them and the batch is not exhausted.
+       * With the default batch size of one, each connection is polled
+       * exactly once.
+       */
 
-      tcp_poll(dev, conn);
+      batch = 0;
+      do
+        {
+          /* Perform the TCP TX poll */
 
-      /* Perform any necessary conversions on outgoing packets */
+          tcp_poll(dev, conn);
+          sent = dev->d_len > 0;
 
-      devif_packet_conversion(dev, DEVIF_TCP);
+          /* Perform any necessary conversions on outgoing packets */
 
-      /* Call back into the driver */
+          devif_packet_conversion(dev, DEVIF_TCP);
 
-      bstop = callback(dev);
+          /* Call back into the driver */
+
+          bstop = callback(dev);
+          netdev_iob_txreset(dev);
+        }
+      while (!bstop && sent && ++batch < CONFIG_NET_TCP_POLL_BATCH);
     }
 
   return bstop;
@@ -625,6 +641,7 @@ static inline int devif_poll_tcp_timer(FAR struct net_driver_s *dev,
       /* Call back into the driver */
 
       bstop = callback(dev);
+      netdev_iob_txreset(dev);
     }
 
   return bstop;
@@ -666,6 +683,10 @@ int devif_poll(FAR struct net_driver_s *dev, devif_poll_callback_t callback)
 {
   int bstop = false;
 
+  /* Forget the I/O buffer payload of any previous response packet */
+
+  netdev_iob_txreset(dev);
+
   /* Traverse all of the active packet connections and perform the poll
    * action.
    */
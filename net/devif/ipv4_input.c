@@ -103,6 +103,7 @@
 
 #include "ipforward/ipforward.h"
 #include "devif/devif.h"
+#include "netdev/netdev.h"
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -335,7 +336,11 @@ int ipv4_input(FAR struct net_driver_s *dev)
   uint16_t llhdrlen;
   uint16_t totlen;
 
-  /* This is where the input processing starts. */
+  /* This is where the input processing starts.  Forget the I/O buffer
+   * payload of any previous outgoing packet.
+   */
+
+  netdev_iob_txreset(dev);
 
 #ifdef CONFIG_NET_STATISTICS
   g_netstats.ipv4.recv++;
@@ -283,7 +283,11 @@ int ipv6_input(FAR struct net_driver_s *dev)
   int ret;
 #endif
 
-  /* This is where the input processing starts. */
+  /* This is where the input processing starts.  Forget the I/O buffer
+   * payload of any previous outgoing packet.
+   */
+
+  netdev_iob_txreset(dev);
 
 #ifdef CONFIG_NET_STATISTICS
   g_netstats.ipv6.recv++;
@@ -105,6 +105,10 @@ void icmpv6_solicit(FAR struct net_driver_s *dev,
   uint16_t lladdrsize;
   uint16_t l3size;
 
+  /* The solicitation replaces the outgoing packet */
+
+  netdev_iob_txreset(dev);
+
   /* Set up the IPv6 header (most is probably already in place) */
 
   ipv6          = IPv6BUF;
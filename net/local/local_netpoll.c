@@ -152,7 +152,7 @@ void local_accept_pollnotify(FAR struct local_conn_s *conn,
           if (fds->revents != 0)
             {
               ninfo("Report events: %02x\n", fds->revents);
-              nxsem_post(fds->sem);
+              poll_notify(fds);
             }
         }
     }
@@ -230,13 +230,21 @@ int local_pollsetup(FAR struct socket *psock, FAR struct pollfd *fds)
                 }
             }
 
-          shadowfds[0].fd     = 1; /* Does not matter */
-          shadowfds[0].sem    = fds->sem;
-          shadowfds[0].events = fds->events & ~POLLOUT;
+          /* The shadow pollfds forward their events to fds through
+           * poll_notify(), whether fds belongs to poll() or to epoll.
+           */
 
-          shadowfds[1].fd     = 0; /* Does not matter */
-          shadowfds[1].sem    = fds->sem;
-          shadowfds[1].events = fds->events & ~POLLIN;
+          shadowfds[0].fd      = 1; /* Does not matter */
+          shadowfds[0].sem     = NULL;
+          shadowfds[0].ptr     = fds;
+          shadowfds[0].revents = 0;
+          shadowfds[0].events  = fds->events & ~(POLLOUT | POLLMASK);
+
+          shadowfds[1].fd      = 0; /* Does not matter */
+          shadowfds[1].sem     = NULL;
+          shadowfds[1].ptr     = fds;
+          shadowfds[1].revents = 0;
+          shadowfds[1].events  = fds->events & ~(POLLIN | POLLMASK);
 
           net_unlock();
 
@@ -304,7 +312,7 @@ int local_pollsetup(FAR struct socket *psock, FAR struct pollfd *fds)
 #ifdef CONFIG_NET_LOCAL_STREAM
 pollerr:
   fds->revents |= POLLERR;
-  nxsem_post(fds->sem);
+  poll_notify(fds);
   return OK;
 #endif
 }
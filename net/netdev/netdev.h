@@ -51,10 +51,28 @@
 #  include <nuttx/wqueue.h>
 #endif
 
+#if defined(CONFIG_NETDEV_IOB_RX) || defined(CONFIG_NETDEV_IOB_TX)
+#  include <nuttx/mm/iob.h>
+#endif
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Forget any I/O buffer payload of the previous outgoing packet */
+
+#ifdef CONFIG_NETDEV_IOB_TX
+#  define netdev_iob_txreset(dev) \
+     do \
+       { \
+         (dev)->d_txiob = NULL; \
+         (dev)->d_txlen = 0; \
+       } \
+     while (0)
+#else
+#  define netdev_iob_txreset(dev)
+#endif
+
 /* If CONFIG_NETDEV_IFINDEX is enabled then there is limit to the number of
  * devices that can be registered due to the nature of some static data.
  */
@@ -570,6 +588,42 @@ int netdown_notifier_teardown(int key);
 void netdown_notifier_signal(FAR struct net_driver_s *dev);
 #endif
 
+/****************************************************************************
+ * Name: netdev_iob_claim
+ *
+ * Description:
+ *   Take ownership of the I/O buffer that holds the received packet so that
+ *   received data can be retained without copying it.  The device is given
+ *   a new I/O buffer holding a copy of the packet headers for any response.
+ *
+ * Input Parameters:
+ *   dev        - The device that received the packet
+ *   data       - The data to be retained.  This must lie within d_buf.
+ *   len        - The length of the data
+ *   headroom   - The number of bytes preceding 'data' that the caller will
+ *                use for its own meta-data.  These will overwrite the
+ *                packet headers in the claimed I/O buffer.
+ *   consumerid - The IOB user that takes over the I/O buffer and will
+ *                eventually free it
+ *
+ * Returned Value:
+ *   The I/O buffer trimmed to the headroom and the data or NULL if the
+ *   packet is not held in an I/O buffer or if there is no free I/O buffer
+ *   to replace it without exceeding the throttle limit.  The caller must
+ *   then copy the data.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_IOB_RX
+FAR struct iob_s *netdev_iob_claim(FAR struct net_driver_s *dev,
+                                   FAR uint8_t *data, uint16_t len,
+                                   uint16_t headroom,
+                                   enum iob_user_e consumerid);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -0,0 +1,205 @@
+/****************************************************************************
+ * net/netdev/netdev_iob.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/mm/iob.h>
+#include <nuttx/net/netconfig.h>
+#include <nuttx/net/netdev.h>
+
+#include "netdev/netdev.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* A received packet is only passed in an I/O buffer if the I/O buffer can
+ * hold a full packet of the device, so smaller I/O buffers are useless.
+ */
+
+#if defined(CONFIG_NETDEV_IOB_RX) && \
+    CONFIG_IOB_BUFSIZE < MIN_NETDEV_PKTSIZE + CONFIG_NET_GUARDSIZE
+#  error CONFIG_IOB_BUFSIZE is too small for CONFIG_NETDEV_IOB_RX
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_IOB_RX
+
+/****************************************************************************
+ * Name: netdev_iob_prepare
+ *
+ * Description:
+ *   Make a received packet held in an I/O buffer chain the current packet
+ *   of the device.  See include/nuttx/net/netdev.h.
+ *
+ ****************************************************************************/
+
+void netdev_iob_prepare(FAR struct net_driver_s *dev, FAR struct iob_s *iob)
+{
+  DEBUGASSERT(dev != NULL && iob != NULL && dev->d_iob == NULL);
+
+  /* The stack builds any response in d_buf, so the I/O buffer must be able
+   * to hold a packet of the full device packet size.
+   */
+
+  if (iob->io_flink == NULL &&
+      CONFIG_IOB_BUFSIZE - iob->io_offset >=
+      NETDEV_PKTSIZE(dev) + CONFIG_NET_GUARDSIZE)
+    {
+      dev->d_drvbuf = dev->d_buf;
+      dev->d_iob    = iob;
+      dev->d_buf    = IOB_DATA(iob);
+      dev->d_len    = iob->io_pktlen;
+    }
+  else
+    {
+      /* Fall back to copying the packet into the driver's buffer */
+
+      DEBUGASSERT(iob->io_pktlen <= NETDEV_PKTSIZE(dev));
+
+      dev->d_len = iob_copyout(dev->d_buf, iob, iob->io_pktlen, 0);
+      iob_free_chain(iob, IOBUSER_NET_NETDEV);
+    }
+}
+
+/****************************************************************************
+ * Name: netdev_iob_release
+ *
+ * Description:
+ *   Free the I/O buffer that backs d_buf (if any) and restore the driver's
+ *   own packet buffer.
+ *
+ ****************************************************************************/
+
+void netdev_iob_release(FAR struct net_driver_s *dev)
+{
+  if (dev->d_iob != NULL)
+    {
+      iob_free_chain(dev->d_iob, IOBUSER_NET_NETDEV);
+
+      dev->d_buf    = dev->d_drvbuf;
+      dev->d_iob    = NULL;
+      dev->d_drvbuf = NULL;
+    }
+}
+
+/****************************************************************************
+ * Name: netdev_iob_claim
+ *
+ * Description:
+ *   Take ownership of the I/O buffer that holds the received packet so that
+ *   received data can be retained without copying it.  See
+ *   net/netdev/netdev.h.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *netdev_iob_claim(FAR struct net_driver_s *dev,
+                                   FAR uint8_t *data, uint16_t len,
+                                   uint16_t headroom,
+                                   enum iob_user_e consumerid)
+{
+  FAR struct iob_s *iob = dev->d_iob;
+  FAR struct iob_s *newiob;
+  uint16_t hdrlen;
+
+  if (iob == NULL || data < dev->d_buf + headroom ||
+      data + len > dev->d_buf + iob->io_len)
+    {
+      return NULL;
+    }
+
+  /* The device still needs a packet buffer for any response.  Give it a
+   * new I/O buffer with a copy of the headers of the received packet; the
+   * payload is not needed for the response.  This is subject to the same
+   * throttling as the read-ahead buffers that it replaces.
+   */
+
+  newiob = iob_tryalloc(true, IOBUSER_NET_NETDEV);
+  if (newiob == NULL)
+    {
+      return NULL;
+    }
+
+  hdrlen = data - dev->d_buf;
+  memcpy(newiob->io_data, dev->d_buf, hdrlen);
+
+  dev->d_appdata = newiob->io_data + (dev->d_appdata - dev->d_buf);
+#ifdef CONFIG_NET_TCPURGDATA
+  if (dev->d_urgdata != NULL)
+    {
+      dev->d_urgdata = newiob->io_data + (dev->d_urgdata - dev->d_buf);
+    }
+#endif
+
+  dev->d_buf = newiob->io_data;
+  dev->d_iob = newiob;
+
+  /* Trim the claimed I/O buffer to the headroom and the data */
+
+  iob->io_offset += hdrlen - headroom;
+  iob->io_len     = headroom + len;
+  iob->io_pktlen  = headroom + len;
+
+  /* The caller now owns the I/O buffer and will free it as its own */
+
+  iob_reassign(iob, IOBUSER_NET_NETDEV, consumerid);
+
+  ninfo("Claimed %u bytes in IOB %p\n", len, iob);
+  return iob;
+}
+
+#endif /* CONFIG_NETDEV_IOB_RX */
+
+/****************************************************************************
+ * Name: netdev_iob_txflatten
+ *
+ * Description:
+ *   Copy the payload of an outgoing packet that is held in d_txiob into
+ *   d_buf behind the packet headers.  See include/nuttx/net/netdev.h.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_IOB_TX
+void netdev_iob_txflatten(FAR struct net_driver_s *dev)
+{
+  if (dev->d_txiob != NULL)
+    {
+      DEBUGASSERT(dev->d_len >= dev->d_txlen);
+
+      iob_copyout(&dev->d_buf[dev->d_len - dev->d_txlen], dev->d_txiob,
+                  dev->d_txlen, dev->d_txoffset);
+
+      dev->d_txiob = NULL;
+      dev->d_txlen = 0;
+    }
+}
+#endif /* CONFIG_NETDEV_IOB_TX */
@@ -32,6 +32,7 @@
 #include <debug.h>
 #include <assert.h>
 
+#include <nuttx/fs/fs.h>
 #include <nuttx/net/net.h>
 
 #include "socket/socket.h"
@@ -70,6 +71,15 @@ int psock_close(FAR struct socket *psock)
       return -EBADF;
     }
 
+  /* Remove the epoll registrations of the last reference while the
+   * connection still exists.
+   */
+
+  if (psock->s_crefs <= 1)
+    {
+      epoll_detach(psock);
+    }
+
   /* We perform the close operation only if this is the last count on
    * the socket. (actually, I think the socket crefs only takes the values
    * 0 and 1 right now).
@@ -45,10 +45,12 @@
 
 #include <nuttx/mm/iob.h>
 #include <nuttx/net/netconfig.h>
+#include <nuttx/net/net.h>
 #include <nuttx/net/netdev.h>
 #include <nuttx/net/netstats.h>
 
 #include "devif/devif.h"
+#include "netdev/netdev.h"
 #include "tcp/tcp.h"
 
 #ifdef NET_TCP_HAVE_STACK
@@ -99,7 +101,7 @@ tcp_data_event(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
        * partial packets will not be buffered.
        */
 
-      recvlen = tcp_datahandler(conn, buffer, buflen);
+      recvlen = tcp_datahandler(dev, conn, buffer, buflen);
       if (recvlen < buflen)
         {
           /* There is no handler to receive new data and there are no free
@@ -221,6 +223,7 @@ uint16_t tcp_callback(FAR struct net_driver_s *dev,
  *   receive the data.
  *
  * Input Parameters:
+ *   dev - The device driver that received the data
  *   conn - A pointer to the TCP connection structure
  *   buffer - A pointer to the buffer to be copied to the read-ahead
  *     buffers
@@ -237,12 +240,26 @@ uint16_t tcp_callback(FAR struct net_driver_s *dev,
  *
  ****************************************************************************/
 
-uint16_t tcp_datahandler(FAR struct tcp_conn_s *conn, FAR uint8_t *buffer,
+uint16_t tcp_datahandler(FAR struct net_driver_s *dev,
+                         FAR struct tcp_conn_s *conn, FAR uint8_t *buffer,
                          uint16_t buflen)
 {
   FAR struct iob_s *iob;
   int ret;
 
+#ifdef CONFIG_NETDEV_IOB_RX
+  /* If the packet is held in an I/O buffer, keep that I/O buffer instead of
+   * copying the data.
+   */
+
+  iob = netdev_iob_claim(dev, buffer, buflen, 0,
+                         IOBUSER_NET_TCP_READAHEAD);
+  if (iob != NULL)
+    {
+      goto enqueue;
+    }
+#endif
+
   /* Try to allocate on I/O buffer to start the chain without waiting (and
    * throttling as necessary).  If we would have to wait, then drop the
    * packet.
@@ -270,11 +287,17 @@ uint16_t tcp_datahandler(FAR struct tcp_conn_s *conn, FAR uint8_t *buffer,
       return 0;
     }
 
+#ifdef CONFIG_NETDEV_IOB_RX
+enqueue:
+#endif
+
   /* Add the new I/O buffer chain to the tail of the read-ahead queue (again
    * without waiting).
    */
 
+  net_connlock(&conn->rdlock);
   ret = iob_tryadd_queue(iob, &conn->readahead);
+  net_connunlock(&conn->rdlock);
   if (ret < 0)
     {
       nerr("ERROR: Failed to queue the I/O buffer chain: %d\n", ret);
@@ -74,6 +74,14 @@
 #define IPv4BUF ((struct ipv4_hdr_s *)&dev->d_buf[NET_LL_HDRLEN(dev)])
 #define IPv6BUF ((struct ipv6_hdr_s *)&dev->d_buf[NET_LL_HDRLEN(dev)])
 
+/* The next candidate connection when searching for an active connection */
+
+#ifdef CONFIG_NET_TCP_CONN_HASH
+#  define TCP_ACTIVE_NEXT(c) ((c)->hnext)
+#else
+#  define TCP_ACTIVE_NEXT(c) ((FAR struct tcp_conn_s *)(c)->node.flink)
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -90,10 +98,146 @@ static dq_queue_t g_free_tcp_connections;
 
 static dq_queue_t g_active_tcp_connections;
 
+#ifdef CONFIG_NET_TCP_CONN_HASH
+/* The active TCP connections hashed by remote address and ports */
+
+static FAR struct tcp_conn_s *g_tcp_hashtab[CONFIG_NET_TCP_HASH_BUCKETS];
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+#ifdef CONFIG_NET_TCP_CONN_HASH
+/****************************************************************************
+ * Name: tcp_hashkey
+ *
+ * Description:
+ *   Return the hash bucket for a remote address (folded to 32 bits) and
+ *   a pair of local and remote ports (network byte order).  The local
+ *   address is not part of the key because a connection may be bound to
+ *   the wildcard address.
+ *
+ ****************************************************************************/
+
+static inline unsigned int tcp_hashkey(uint32_t raddr, uint16_t lport,
+                                       uint16_t rport)
+{
+  uint32_t hash = raddr ^ ((uint32_t)lport << 16 | rport);
+
+  hash ^= hash >> 16;
+  hash *= 0x45d9f3b;
+  hash ^= hash >> 16;
+
+  return hash % CONFIG_NET_TCP_HASH_BUCKETS;
+}
+
+/****************************************************************************
+ * Name: tcp_ipv6_hashaddr
+ *
+ * Description:
+ *   Fold an IPv6 address into 32 bits for tcp_hashkey().
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv6
+static inline uint32_t tcp_ipv6_hashaddr(FAR const uint16_t *addr)
+{
+  return ((uint32_t)addr[0] << 16 | addr[1]) ^
+         ((uint32_t)addr[2] << 16 | addr[3]) ^
+         ((uint32_t)addr[4] << 16 | addr[5]) ^
+         ((uint32_t)addr[6] << 16 | addr[7]);
+}
+#endif
+
+/****************************************************************************
+ * Name: tcp_conn_hashkey
+ *
+ * Description:
+ *   Return the hash bucket of an active connection.
+ *
+ ****************************************************************************/
+
+static unsigned int tcp_conn_hashkey(FAR struct tcp_conn_s *conn)
+{
+#ifdef CONFIG_NET_IPv4
+#ifdef CONFIG_NET_IPv6
+  if (conn->domain == PF_INET)
+#endif
+    {
+      return tcp_hashkey(conn->u.ipv4.raddr, conn->lport, conn->rport);
+    }
+#endif /* CONFIG_NET_IPv4 */
+
+#ifdef CONFIG_NET_IPv6
+#ifdef CONFIG_NET_IPv4
+  else
+#endif
+    {
+      return tcp_hashkey(tcp_ipv6_hashaddr(conn->u.ipv6.raddr),
+                         conn->lport, conn->rport);
+    }
+#endif /* CONFIG_NET_IPv6 */
+}
+#endif /* CONFIG_NET_TCP_CONN_HASH */
+
+/****************************************************************************
+ * Name: tcp_addactive
+ *
+ * Description:
+ *   Add a connection to the list (and the hash table) of active
+ *   connections.  The local and remote addresses and ports must be set and
+ *   must not change while the connection is active.
+ *
+ * Assumptions:
+ *   This function is called with the network locked.
+ *
+ ****************************************************************************/
+
+static void tcp_addactive(FAR struct tcp_conn_s *conn)
+{
+#ifdef CONFIG_NET_TCP_CONN_HASH
+  unsigned int ndx = tcp_conn_hashkey(conn);
+
+  conn->hnext        = g_tcp_hashtab[ndx];
+  g_tcp_hashtab[ndx] = conn;
+#endif
+
+  dq_addlast(&conn->node, &g_active_tcp_connections);
+}
+
+/****************************************************************************
+ * Name: tcp_remactive
+ *
+ * Description:
+ *   Remove a connection from the list (and the hash table) of active
+ *   connections.
+ *
+ * Assumptions:
+ *   This function is called with the network locked.
+ *
+ ****************************************************************************/
+
+static void tcp_remactive(FAR struct tcp_conn_s *conn)
+{
+#ifdef CONFIG_NET_TCP_CONN_HASH
+  FAR struct tcp_conn_s **pconn = &g_tcp_hashtab[tcp_conn_hashkey(conn)];
+
+  while (*pconn != NULL)
+    {
+      if (*pconn == conn)
+        {
+          *pconn = conn->hnext;
+          break;
+        }
+
+      pconn = &(*pconn)->hnext;
+    }
+#endif
+
+  dq_rem(&conn->node, &g_active_tcp_connections);
+}
+
 /****************************************************************************
  * Name: tcp_ipv4_listener
  *
@@ -339,10 +483,15 @@ static inline FAR struct tcp_conn_s *
   in_addr_t srcipaddr;
   in_addr_t destipaddr;
 
-  conn       = (FAR struct tcp_conn_s *)g_active_tcp_connections.head;
   srcipaddr  = net_ip4addr_conv32(ip->srcipaddr);
   destipaddr = net_ip4addr_conv32(ip->destipaddr);
 
+#ifdef CONFIG_NET_TCP_CONN_HASH
+  conn = g_tcp_hashtab[tcp_hashkey(srcipaddr, tcp->destport, tcp->srcport)];
+#else
+  conn = (FAR struct tcp_conn_s *)g_active_tcp_connections.head;
+#endif
+
   while (conn)
     {
       /* Find an open connection matching the TCP input. The following
@@ -378,7 +527,7 @@ static inline FAR struct tcp_conn_s *
 
       /* Look at the next active connection */
 
-      conn = (FAR struct tcp_conn_s *)conn->node.flink;
+      conn = TCP_ACTIVE_NEXT(conn);
     }
 
   return conn;
@@ -406,10 +555,16 @@ static inline FAR struct tcp_conn_s *
   net_ipv6addr_t *srcipaddr;
   net_ipv6addr_t *destipaddr;
 
-  conn       = (FAR struct tcp_conn_s *)g_active_tcp_connections.head;
   srcipaddr  = (net_ipv6addr_t *)ip->srcipaddr;
   destipaddr = (net_ipv6addr_t *)ip->destipaddr;
 
+#ifdef CONFIG_NET_TCP_CONN_HASH
+  conn = g_tcp_hashtab[tcp_hashkey(tcp_ipv6_hashaddr(ip->srcipaddr),
+                                   tcp->destport, tcp->srcport)];
+#else
+  conn = (FAR struct tcp_conn_s *)g_active_tcp_connections.head;
+#endif
+
   while (conn)
     {
       /* Find an open connection matching the TCP input. The following
@@ -445,7 +600,7 @@ static inline FAR struct tcp_conn_s *
 
       /* Look at the next active connection */
 
-      conn = (FAR struct tcp_conn_s *)conn->node.flink;
+      conn = TCP_ACTIVE_NEXT(conn);
     }
 
   return conn;
@@ -605,6 +760,9 @@ void tcp_initialize(void)
 
   dq_init(&g_free_tcp_connections);
   dq_init(&g_active_tcp_connections);
+#ifdef CONFIG_NET_TCP_CONN_HASH
+  memset(g_tcp_hashtab, 0, sizeof(g_tcp_hashtab));
+#endif
 
   /* Now initialize each connection structure */
 
@@ -724,6 +882,8 @@ FAR struct tcp_conn_s *tcp_alloc(uint8_t domain)
   if (conn)
     {
       memset(conn, 0, sizeof(struct tcp_conn_s));
+      net_connlock_init(&conn->rdlock);
+      net_connlock_init(&conn->rcvlock);
       conn->tcpstateflags = TCP_ALLOCATED;
 #if defined(CONFIG_NET_IPv4) && defined(CONFIG_NET_IPv6)
       conn->domain        = domain;
@@ -782,12 +942,14 @@ void tcp_free(FAR struct tcp_conn_s *conn)
     {
       /* Remove the connection from the active list */
 
-      dq_rem(&conn->node, &g_active_tcp_connections);
+      tcp_remactive(conn);
     }
 
   /* Release any read-ahead buffers attached to the connection */
 
+  net_connlock(&conn->rdlock);
   iob_free_queue(&conn->readahead, IOBUSER_NET_TCP_READAHEAD);
+  net_connunlock(&conn->rdlock);
 
 #ifdef CONFIG_NET_TCP_WRITE_BUFFERS
   /* Release any write buffers attached to the connection */
@@ -1043,7 +1205,7 @@ FAR struct tcp_conn_s *tcp_alloc_accept(FAR struct net_driver_s *dev,
        * Interrupts should already be disabled in this context.
        */
 
-      dq_addlast(&conn->node, &g_active_tcp_connections);
+      tcp_addactive(conn);
     }
 
   return conn;
@@ -1308,7 +1470,7 @@ int tcp_connect(FAR struct tcp_conn_s *conn, FAR const struct sockaddr *addr)
 
   /* And, finally, put the connection structure into the active list. */
 
-  dq_addlast(&conn->node, &g_active_tcp_connections);
+  tcp_addactive(conn);
   ret = OK;
 
 errout_with_lock:
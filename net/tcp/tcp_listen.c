@@ -48,6 +48,8 @@
 #include <stdbool.h>
 #include <debug.h>
 
+#include <arpa/inet.h>
+
 #include <nuttx/net/netconfig.h>
 #include <nuttx/net/net.h>
 
@@ -58,14 +60,39 @@
  * Private Data
  ****************************************************************************/
 
+#ifdef CONFIG_NET_TCP_CONN_HASH
+/* The listening connections hashed by local port number and the number of
+ * listening connections.
+ */
+
+static FAR struct tcp_conn_s *tcp_listenhash[CONFIG_NET_TCP_HASH_BUCKETS];
+static int tcp_nlisteners;
+#else
 /* The tcp_listenports list all currently listening ports. */
 
 static FAR struct tcp_conn_s *tcp_listenports[CONFIG_NET_MAX_LISTENPORTS];
+#endif
 
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: tcp_listenhash_head
+ *
+ * Description:
+ *   Return the head of the listener hash chain for a port (network byte
+ *   order).
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_CONN_HASH
+static inline FAR struct tcp_conn_s **tcp_listenhash_head(uint16_t portno)
+{
+  return &tcp_listenhash[NTOHS(portno) % CONFIG_NET_TCP_HASH_BUCKETS];
+}
+#endif
+
 /****************************************************************************
  * Name: tcp_findlistener
  *
@@ -83,6 +110,23 @@ FAR struct tcp_conn_s *tcp_findlistener(uint16_t portno, uint8_t domain)
 FAR struct tcp_conn_s *tcp_findlistener(uint16_t portno)
 #endif
 {
+#ifdef CONFIG_NET_TCP_CONN_HASH
+  FAR struct tcp_conn_s *conn;
+
+  /* Examine only the listeners that hash to the same chain */
+
+  for (conn = *tcp_listenhash_head(portno); conn != NULL; conn = conn->lnext)
+    {
+#if defined(CONFIG_NET_IPv4) && defined(CONFIG_NET_IPv6)
+      if (conn->lport == portno && conn->domain == domain)
+#else
+      if (conn->lport == portno)
+#endif
+        {
+          return conn;
+        }
+    }
+#else
   int ndx;
 
   /* Examine each connection structure in each slot of the listener list */
@@ -105,6 +149,7 @@ FAR struct tcp_conn_s *tcp_findlistener(uint16_t portno)
           return conn;
         }
     }
+#endif
 
   /* No listener for this port */
 
@@ -129,11 +174,22 @@ FAR struct tcp_conn_s *tcp_findlistener(uint16_t portno)
 
 void tcp_listen_initialize(void)
 {
+#ifdef CONFIG_NET_TCP_CONN_HASH
+  int ndx;
+
+  for (ndx = 0; ndx < CONFIG_NET_TCP_HASH_BUCKETS; ndx++)
+    {
+      tcp_listenhash[ndx] = NULL;
+    }
+
+  tcp_nlisteners = 0;
+#else
   int ndx;
   for (ndx = 0; ndx < CONFIG_NET_MAX_LISTENPORTS; ndx++)
     {
       tcp_listenports[ndx] = NULL;
     }
+#endif
 }
 
 /****************************************************************************
@@ -149,10 +205,29 @@ void tcp_listen_initialize(void)
 
 int tcp_unlisten(FAR struct tcp_conn_s *conn)
 {
+#ifdef CONFIG_NET_TCP_CONN_HASH
+  FAR struct tcp_conn_s **pconn;
+#else
   int ndx;
+#endif
   int ret = -EINVAL;
 
   net_lock();
+
+#ifdef CONFIG_NET_TCP_CONN_HASH
+  for (pconn = tcp_listenhash_head(conn->lport); *pconn != NULL;
+       pconn = &(*pconn)->lnext)
+    {
+      if (*pconn == conn)
+        {
+          *pconn = conn->lnext;
+          conn->lnext = NULL;
+          tcp_nlisteners--;
+          ret = OK;
+          break;
+        }
+    }
+#else
   for (ndx = 0; ndx < CONFIG_NET_MAX_LISTENPORTS; ndx++)
     {
       if (tcp_listenports[ndx] == conn)
@@ -162,6 +237,7 @@ int tcp_unlisten(FAR struct tcp_conn_s *conn)
           break;
         }
     }
+#endif
 
   net_unlock();
   return ret;
@@ -180,7 +256,11 @@ int tcp_unlisten(FAR struct tcp_conn_s *conn)
 
 int tcp_listen(FAR struct tcp_conn_s *conn)
 {
+#ifdef CONFIG_NET_TCP_CONN_HASH
+  FAR struct tcp_conn_s **head;
+#else
   int ndx;
+#endif
   int ret;
 
   /* This must be done with network locked because the listener table
@@ -209,6 +289,20 @@ int tcp_listen(FAR struct tcp_conn_s *conn)
 
       ret = -ENOBUFS; /* Assume failure */
 
+#ifdef CONFIG_NET_TCP_CONN_HASH
+      /* Add the connection to the head of its hash chain, keeping the
+       * same limit on the number of listeners as the listener list.
+       */
+
+      if (tcp_nlisteners < CONFIG_NET_MAX_LISTENPORTS)
+        {
+          head        = tcp_listenhash_head(conn->lport);
+          conn->lnext = *head;
+          *head       = conn;
+          tcp_nlisteners++;
+          ret = OK;
+        }
+#else
       /* Search all slots until an available slot is found */
 
       for (ndx = 0; ndx < CONFIG_NET_MAX_LISTENPORTS; ndx++)
@@ -224,6 +318,7 @@ int tcp_listen(FAR struct tcp_conn_s *conn)
               break;
             }
         }
+#endif
     }
 
   net_unlock();
@@ -186,9 +186,9 @@ static inline void tcp_newdata(FAR struct net_driver_s *dev,
 #ifdef CONFIG_DEBUG_NET
       uint16_t nsaved;
 
-      nsaved = tcp_datahandler(conn, buffer, buflen);
+      nsaved = tcp_datahandler(dev, conn, buffer, buflen);
 #else
-      tcp_datahandler(conn, buffer, buflen);
+      tcp_datahandler(dev, conn, buffer, buflen);
 #endif
 
       /* There are complicated buffering issues that are not addressed fully
@@ -228,7 +228,8 @@ static inline void tcp_newdata(FAR struct net_driver_s *dev,
  *   None
  *
  * Assumptions:
- *   The network is locked.
+ *   The network is locked or, with CONFIG_NET_CONN_LOCK, the caller holds
+ *   the connection's rcvlock.
  *
  ****************************************************************************/
 
@@ -237,19 +238,29 @@ static inline void tcp_readahead(struct tcp_recvfrom_s *pstate)
   FAR struct tcp_conn_s *conn =
     (FAR struct tcp_conn_s *)pstate->ir_sock->s_conn;
   FAR struct iob_s *iob;
+  FAR struct iob_s *tmp;
   int recvlen;
 
   /* Check there is any TCP data already buffered in a read-ahead
    * buffer.
    */
 
-  while ((iob = iob_peek_queue(&conn->readahead)) != NULL &&
-          pstate->ir_buflen > 0)
+  while (pstate->ir_buflen > 0)
     {
+      net_connlock(&conn->rdlock);
+      iob = iob_peek_queue(&conn->readahead);
+      net_connunlock(&conn->rdlock);
+
+      if (iob == NULL)
+        {
+          break;
+        }
+
       DEBUGASSERT(iob->io_pktlen > 0);
 
       /* Transfer that buffered data from the I/O buffer chain into
-       * the user buffer.
+       * the user buffer.  The network only appends to the queue, so the
+       * head is stable while we are the only reader.
        */
 
       recvlen = iob_copyout(pstate->ir_buffer, iob, pstate->ir_buflen, 0);
@@ -267,13 +278,14 @@ static inline void tcp_readahead(struct tcp_recvfrom_s *pstate)
 
       if (recvlen >= iob->io_pktlen)
         {
-          FAR struct iob_s *tmp;
-
           /* Remove the I/O buffer chain from the head of the read-ahead
            * buffer queue.
            */
 
+          net_connlock(&conn->rdlock);
           tmp = iob_remove_queue(&conn->readahead);
+          net_connunlock(&conn->rdlock);
+
           DEBUGASSERT(tmp == iob);
           UNUSED(tmp);
 
@@ -288,8 +300,10 @@ static inline void tcp_readahead(struct tcp_recvfrom_s *pstate)
            * buffer queue).
            */
 
+          net_connlock(&conn->rdlock);
           iob_trimhead_queue(&conn->readahead, recvlen,
                              IOBUSER_NET_TCP_READAHEAD);
+          net_connunlock(&conn->rdlock);
         }
     }
 }
@@ -636,22 +650,35 @@ ssize_t psock_tcp_recvfrom(FAR struct socket *psock, FAR void *buf,
                            size_t len, int flags, FAR struct sockaddr *from,
                            FAR socklen_t *fromlen)
 {
+  FAR struct tcp_conn_s *conn = (FAR struct tcp_conn_s *)psock->s_conn;
   struct tcp_recvfrom_s state;
   int               ret;
 
-  /* Initialize the state structure.  This is done with the network locked
-   * because we don't want anything to happen until we are ready.
+  /* Initialize the state structure. */
+
+  tcp_recvfrom_initialize(psock, buf, len, from, fromlen, &state);
+
+#ifdef CONFIG_NET_CONN_LOCK
+  /* Copy out the data already buffered in the read-ahead buffers without
+   * the network lock so that the copy does not stall the network.
    */
 
+  net_connlock(&conn->rcvlock);
+  tcp_readahead(&state);
+#endif
+
+  /* Nothing may happen to the connection from here until we are ready */
+
   net_lock();
-  tcp_recvfrom_initialize(psock, buf, len, from, fromlen, &state);
 
   /* Handle any any TCP data already buffered in a read-ahead buffer.  NOTE
    * that there may be read-ahead data to be retrieved even after the
-   * socket has been disconnected.
+   * socket has been disconnected.  With CONFIG_NET_CONN_LOCK, this picks
+   * up data that arrived since the copy above.
    */
 
   tcp_readahead(&state);
+  net_connunlock(&conn->rcvlock);
 
   /* The default return value is the number of bytes that we just copied
    * into the user buffer.  We will return this if the socket has become
@@ -727,8 +754,6 @@ ssize_t psock_tcp_recvfrom(FAR struct socket *psock, FAR void *buf,
 
   if (state.ir_recvlen == 0 && state.ir_buflen > 0)
     {
-      FAR struct tcp_conn_s *conn = (FAR struct tcp_conn_s *)psock->s_conn;
-
       /* Set up the callback in the connection */
 
       state.ir_cb = tcp_callback_alloc(conn);
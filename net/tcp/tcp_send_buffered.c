@@ -759,7 +759,7 @@ static uint16_t psock_send_eventhandler(FAR struct net_driver_s *dev,
        * won't actually happen until the polling cycle completes).
        */
 
-      devif_iob_send(dev, TCP_WBIOB(wrb), sndlen, TCP_WBSENT(wrb));
+      devif_iob_sendsg(dev, TCP_WBIOB(wrb), sndlen, TCP_WBSENT(wrb));
 
       /* Remember how much data we send out now so that we know
        * when everything has been acknowledged.  Just increment
@@ -1000,6 +1000,9 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
 
   if (len > 0)
     {
+      unsigned int count;
+      int blresult;
+
       /* Allocate a write buffer.  Careful, the network will be momentarily
        * unlocked here.
        */
@@ -1067,7 +1070,20 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
            * remaining data.
            */
 
+#ifdef CONFIG_NET_CONN_LOCK
+          /* The write buffer is not yet visible to the network so the copy
+           * does not need the network lock.
+           */
+
+          blresult = net_breaklock(&count);
+          result = TCP_WBTRYCOPYIN(wrb, (FAR uint8_t *)buf, len);
+          if (blresult >= 0)
+            {
+              net_restorelock(count);
+            }
+#else
           result = TCP_WBTRYCOPYIN(wrb, (FAR uint8_t *)buf, len);
+#endif
           if (result == -ENOMEM)
             {
               if (TCP_WBPKTLEN(wrb) > 0)
@@ -1089,9 +1105,6 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
         }
       else
         {
-          unsigned int count;
-          int blresult;
-
           /* iob_copyin might wait for buffers to be freed, but if network is
            * locked this might never happen, since network driver is also locked,
            * therefore we need to break the lock
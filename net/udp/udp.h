@@ -53,6 +53,10 @@
 #  include <nuttx/wqueue.h>
 #endif
 
+#ifdef CONFIG_NET_CONN_LOCK
+#  include <nuttx/mutex.h>
+#endif
+
 #if defined(CONFIG_NET_UDP) && !defined(CONFIG_NET_UDP_NO_STACK)
 
 /****************************************************************************
@@ -123,6 +127,10 @@ struct udp_conn_s
 
   /* UDP-specific content follows */
 
+#ifdef CONFIG_NET_UDP_CONN_HASH
+  FAR struct udp_conn_s *hnext; /* Next connection in the port hash chain */
+#endif
+
   union ip_binding_u u;   /* IP address binding */
   uint16_t lport;         /* Bound local port number (network byte order) */
   uint16_t rport;         /* Remote port number (network byte order) */
@@ -143,6 +151,10 @@ struct udp_conn_s
    */
 
   struct iob_queue_s readahead;   /* Read-ahead buffering */
+#ifdef CONFIG_NET_CONN_LOCK
+  mutex_t rdlock;                 /* Protects the read-ahead queue */
+  mutex_t rcvlock;                /* Serializes readers of the queue */
+#endif
 
 #ifdef CONFIG_NET_UDP_WRITE_BUFFERS
   /* Write buffering
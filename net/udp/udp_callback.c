@@ -45,11 +45,13 @@
 #include <debug.h>
 
 #include <nuttx/net/netconfig.h>
+#include <nuttx/net/net.h>
 #include <nuttx/net/netdev.h>
 #include <nuttx/net/netstats.h>
 #include <nuttx/net/udp.h>
 
 #include "devif/devif.h"
+#include "netdev/netdev.h"
 #include "udp/udp.h"
 
 /****************************************************************************
@@ -98,17 +100,6 @@ static uint16_t udp_datahandler(FAR struct net_driver_s *dev,
   FAR void  *src_addr;
   uint8_t src_addr_size;
 
-  /* Allocate on I/O buffer to start the chain (throttling as necessary).
-   * We will not wait for an I/O buffer to become available in this context.
-   */
-
-  iob = iob_tryalloc(true, IOBUSER_NET_UDP_READAHEAD);
-  if (iob == NULL)
-    {
-      nerr("ERROR: Failed to create new I/O buffer chain\n");
-      return 0;
-    }
-
 #ifdef CONFIG_NET_IPv6
 #ifdef CONFIG_NET_IPv4
   if (IFF_IS_IPv6(dev->d_flags))
@@ -173,6 +164,33 @@ static uint16_t udp_datahandler(FAR struct net_driver_s *dev,
     }
 #endif /* CONFIG_NET_IPv4 */
 
+#ifdef CONFIG_NETDEV_IOB_RX
+  /* If the packet is held in an I/O buffer, keep that I/O buffer and put
+   * the address meta-data in front of the payload, over the headers.
+   */
+
+  iob = netdev_iob_claim(dev, buffer, buflen,
+                         src_addr_size + sizeof(uint8_t),
+                         IOBUSER_NET_UDP_READAHEAD);
+  if (iob != NULL)
+    {
+      IOB_DATA(iob)[0] = src_addr_size;
+      memcpy(IOB_DATA(iob) + sizeof(uint8_t), src_addr, src_addr_size);
+      goto enqueue;
+    }
+#endif
+
+  /* Allocate on I/O buffer to start the chain (throttling as necessary).
+   * We will not wait for an I/O buffer to become available in this context.
+   */
+
+  iob = iob_tryalloc(true, IOBUSER_NET_UDP_READAHEAD);
+  if (iob == NULL)
+    {
+      nerr("ERROR: Failed to create new I/O buffer chain\n");
+      return 0;
+    }
+
   /* Copy the src address info into the I/O buffer chain.  We will not wait
    * for an I/O buffer to become available in this context.  It there is
    * any failure to allocated, the entire I/O buffer chain will be discarded.
@@ -224,9 +242,15 @@ static uint16_t udp_datahandler(FAR struct net_driver_s *dev,
         }
     }
 
+#ifdef CONFIG_NETDEV_IOB_RX
+enqueue:
+#endif
+
   /* Add the new I/O buffer chain to the tail of the read-ahead queue */
 
+  net_connlock(&conn->rdlock);
   ret = iob_tryadd_queue(iob, &conn->readahead);
+  net_connunlock(&conn->rdlock);
   if (ret < 0)
     {
       nerr("ERROR: Failed to queue the I/O buffer chain: %d\n", ret);
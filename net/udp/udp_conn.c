@@ -51,6 +51,7 @@
 #include <debug.h>
 
 #include <netinet/in.h>
+#include <arpa/inet.h>
 
 #include <arch/irq.h>
 
@@ -74,6 +75,20 @@
 #define IPv4BUF ((struct ipv4_hdr_s *)&dev->d_buf[NET_LL_HDRLEN(dev)])
 #define IPv6BUF ((struct ipv6_hdr_s *)&dev->d_buf[NET_LL_HDRLEN(dev)])
 
+/* The bound connections are hashed by local port number (network byte
+ * order).
+ */
+
+#ifdef CONFIG_NET_UDP_CONN_HASH
+#  define UDP_HASH(p)        (NTOHS(p) % CONFIG_NET_UDP_HASH_BUCKETS)
+#  define UDP_ACTIVE_HEAD(p) g_udp_hashtab[UDP_HASH(p)]
+#  define UDP_ACTIVE_NEXT(c) ((c)->hnext)
+#else
+#  define UDP_ACTIVE_HEAD(p) \
+     ((FAR struct udp_conn_s *)g_active_udp_connections.head)
+#  define UDP_ACTIVE_NEXT(c) ((FAR struct udp_conn_s *)(c)->node.flink)
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -91,6 +106,12 @@ static sem_t g_free_sem;
 
 static dq_queue_t g_active_udp_connections;
 
+#ifdef CONFIG_NET_UDP_CONN_HASH
+/* The connections that are bound to a local port, hashed by port number */
+
+static FAR struct udp_conn_s *g_udp_hashtab[CONFIG_NET_UDP_HASH_BUCKETS];
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -110,6 +131,59 @@ static inline void _udp_semtake(FAR sem_t *sem)
 
 #define _udp_semgive(sem) nxsem_post(sem)
 
+/****************************************************************************
+ * Name: udp_setport
+ *
+ * Description:
+ *   Set the local port number of a connection, moving the connection to the
+ *   hash chain of the new port.  A connection with no local port (zero) is
+ *   not in the hash table.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_CONN_HASH
+static void udp_setport(FAR struct udp_conn_s *conn, uint16_t portno)
+{
+  FAR struct udp_conn_s **pconn;
+
+  net_lock();
+
+  if (conn->lport != 0)
+    {
+      for (pconn = &g_udp_hashtab[UDP_HASH(conn->lport)]; *pconn != NULL;
+           pconn = &(*pconn)->hnext)
+        {
+          if (*pconn == conn)
+            {
+              *pconn = conn->hnext;
+              break;
+            }
+        }
+    }
+
+  conn->lport = portno;
+  conn->hnext = NULL;
+
+  if (portno != 0)
+    {
+      /* Add the connection to the tail of the chain so that connections
+       * sharing a port are matched in the order that they were bound.
+       */
+
+      for (pconn = &g_udp_hashtab[UDP_HASH(portno)]; *pconn != NULL;
+           pconn = &(*pconn)->hnext)
+        {
+        }
+
+      *pconn = conn;
+    }
+
+  net_unlock();
+}
+#else
+#  define udp_setport(c,p) do { (c)->lport = (p); } while (0)
+#endif
+
 /****************************************************************************
  * Name: udp_find_conn()
  *
@@ -126,13 +200,21 @@ static FAR struct udp_conn_s *udp_find_conn(uint8_t domain,
                                             uint16_t portno)
 {
   FAR struct udp_conn_s *conn;
+#ifndef CONFIG_NET_UDP_CONN_HASH
   int i;
+#endif
 
   /* Now search each connection structure. */
 
+#ifdef CONFIG_NET_UDP_CONN_HASH
+  for (conn = UDP_ACTIVE_HEAD(portno); conn != NULL; conn = conn->hnext)
+#else
   for (i = 0; i < CONFIG_NET_UDP_CONNS; i++)
+#endif
     {
+#ifndef CONFIG_NET_UDP_CONN_HASH
       conn = &g_udp_connections[i];
+#endif
 
       /* If the port local port number assigned to the connections matches
        * AND the IP address of the connection matches, then return a
@@ -264,7 +346,7 @@ static inline FAR struct udp_conn_s *
   FAR struct ipv4_hdr_s *ip = IPv4BUF;
   FAR struct udp_conn_s *conn;
 
-  conn = (FAR struct udp_conn_s *)g_active_udp_connections.head;
+  conn = UDP_ACTIVE_HEAD(udp->destport);
   while (conn)
     {
       /* If the local UDP port is non-zero, the connection is considered
@@ -377,7 +459,7 @@ static inline FAR struct udp_conn_s *
 
       /* Look at the next active connection */
 
-      conn = (FAR struct udp_conn_s *)conn->node.flink;
+      conn = UDP_ACTIVE_NEXT(conn);
     }
 
   return conn;
@@ -403,7 +485,7 @@ static inline FAR struct udp_conn_s *
   FAR struct ipv6_hdr_s *ip = IPv6BUF;
   FAR struct udp_conn_s *conn;
 
-  conn = (FAR struct udp_conn_s *)g_active_udp_connections.head;
+  conn = UDP_ACTIVE_HEAD(udp->destport);
   while (conn != NULL)
     {
       /* If the local UDP port is non-zero, the connection is considered
@@ -516,7 +598,7 @@ static inline FAR struct udp_conn_s *
 
       /* Look at the next active connection */
 
-      conn = (FAR struct udp_conn_s *)conn->node.flink;
+      conn = UDP_ACTIVE_NEXT(conn);
     }
 
   return conn;
@@ -544,6 +626,9 @@ void udp_initialize(void)
 
   dq_init(&g_free_udp_connections);
   dq_init(&g_active_udp_connections);
+#ifdef CONFIG_NET_UDP_CONN_HASH
+  memset(g_udp_hashtab, 0, sizeof(g_udp_hashtab));
+#endif
   nxsem_init(&g_free_sem, 0, 1);
 
   for (i = 0; i < CONFIG_NET_UDP_CONNS; i++)
@@ -551,6 +636,8 @@ void udp_initialize(void)
       /* Mark the connection closed and move it to the free list */
 
       g_udp_connections[i].lport = 0;
+      net_connlock_init(&g_udp_connections[i].rdlock);
+      net_connlock_init(&g_udp_connections[i].rcvlock);
       dq_addlast(&g_udp_connections[i].node, &g_free_udp_connections);
     }
 }
@@ -619,8 +706,8 @@ void udp_free(FAR struct udp_conn_s *conn)
 
   DEBUGASSERT(conn->crefs == 0);
 
+  udp_setport(conn, 0);
   _udp_semtake(&g_free_sem);
-  conn->lport = 0;
 
   /* Remove the connection from the active list */
 
@@ -628,7 +715,9 @@ void udp_free(FAR struct udp_conn_s *conn)
 
   /* Release any read-ahead buffers attached to the connection */
 
+  net_connlock(&conn->rdlock);
   iob_free_queue(&conn->readahead, IOBUSER_NET_UDP_READAHEAD);
+  net_connunlock(&conn->rdlock);
 
 #ifdef CONFIG_NET_UDP_WRITE_BUFFERS
   /* Release any write buffers attached to the connection */
@@ -769,8 +858,8 @@ int udp_bind(FAR struct udp_conn_s *conn, FAR const struct sockaddr *addr)
     {
       /* Yes.. Select any unused local port number */
 
-      conn->lport = htons(udp_select_port(conn->domain, &conn->u));
-      ret         = OK;
+      udp_setport(conn, htons(udp_select_port(conn->domain, &conn->u)));
+      ret = OK;
     }
   else
     {
@@ -786,7 +875,7 @@ int udp_bind(FAR struct udp_conn_s *conn, FAR const struct sockaddr *addr)
         {
           /* No.. then bind the socket to the port */
 
-          conn->lport = portno;
+          udp_setport(conn, portno);
           ret         = OK;
         }
       else
@@ -839,7 +928,7 @@ int udp_connect(FAR struct udp_conn_s *conn, FAR const struct sockaddr *addr)
        * connection structure.
        */
 
-      conn->lport = htons(udp_select_port(conn->domain, &conn->u));
+      udp_setport(conn, htons(udp_select_port(conn->domain, &conn->u)));
     }
 
   /* Is there a remote port (rport)? */
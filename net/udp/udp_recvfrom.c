@@ -207,7 +207,11 @@ static inline void udp_readahead(struct udp_recvfrom_s *pstate)
 
   pstate->ir_recvlen = -1;
 
-  if ((iob = iob_peek_queue(&conn->readahead)) != NULL)
+  net_connlock(&conn->rdlock);
+  iob = iob_peek_queue(&conn->readahead);
+  net_connunlock(&conn->rdlock);
+
+  if (iob != NULL)
     {
       FAR struct iob_s *tmp;
       uint8_t src_addr_size;
@@ -215,7 +219,8 @@ static inline void udp_readahead(struct udp_recvfrom_s *pstate)
       DEBUGASSERT(iob->io_pktlen > 0);
 
       /* Transfer that buffered data from the I/O buffer chain into
-       * the user buffer.
+       * the user buffer.  The network only appends to the queue, so the
+       * head is stable while we are the only reader.
        */
 
       recvlen = iob_copyout(&src_addr_size, iob, sizeof(uint8_t), 0);
@@ -271,7 +276,10 @@ out:
        * buffer queue.
        */
 
+      net_connlock(&conn->rdlock);
       tmp = iob_remove_queue(&conn->readahead);
+      net_connunlock(&conn->rdlock);
+
       DEBUGASSERT(tmp == iob);
       UNUSED(tmp);
 
@@ -621,16 +629,33 @@ ssize_t psock_udp_recvfrom(FAR struct socket *psock, FAR void *buf,
 
   /* Perform the UDP recvfrom() operation */
 
-  /* Initialize the state structure.  This is done with the network locked
-   * because we don't want anything to happen until we are ready.
-   */
+  /* Initialize the state structure. */
 
-  net_lock();
   udp_recvfrom_initialize(psock, buf, len, from, fromlen, &state);
 
-  /* Copy the read-ahead data from the packet */
+#ifdef CONFIG_NET_CONN_LOCK
+  /* Copy a buffered datagram without the network lock so that the copy
+   * does not stall the network.
+   */
 
+  net_connlock(&conn->rcvlock);
   udp_readahead(&state);
+#endif
+
+  /* Nothing may happen to the connection from here until we are ready */
+
+  net_lock();
+
+#ifdef CONFIG_NET_CONN_LOCK
+  if (state.ir_recvlen < 0)
+#endif
+    {
+      /* Copy the read-ahead data from the packet */
+
+      udp_readahead(&state);
+    }
+
+  net_connunlock(&conn->rcvlock);
 
   /* The default return value is the number of bytes that we just copied
    * into the user buffer.  We will return this if the socket has become
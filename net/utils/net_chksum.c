@@ -41,8 +41,56 @@
 #include <nuttx/config.h>
 #ifdef CONFIG_NET
 
+#include <sys/param.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <arpa/inet.h>
+
+#include <nuttx/mm/iob.h>
+
 #include "utils/utils.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The native (host byte order) value of a 16-bit word holding the bytes
+ * 'a' and 'b', in that order, in memory.
+ */
+
+#ifdef CONFIG_ENDIAN_BIG
+#  define CHKSUM_WORD(a,b)  ((uint16_t)(((a) << 8) | (b)))
+#else
+#  define CHKSUM_WORD(a,b)  ((uint16_t)(((b) << 8) | (a)))
+#endif
+
+#define CHKSUM_SWAP16(x)    ((uint16_t)((((x) & 0xff) << 8) | ((x) >> 8)))
+
+/* Add both 16-bit halves of a 32-bit word to the accumulator */
+
+#define CHKSUM_ADD32(acc,w) ((acc) += ((w) & 0xffff) + ((w) >> 16))
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#if !defined(CONFIG_NET_ARCH_CHKSUM) && !defined(CONFIG_NET_ARCH_RAWCHKSUM)
+/****************************************************************************
+ * Name: chksum_fold
+ *
+ * Description:
+ *   Fold a 32-bit one's complement accumulator into 16 bits.
+ *
+ ****************************************************************************/
+
+static inline uint16_t chksum_fold(uint32_t acc)
+{
+  acc = (acc >> 16) + (acc & 0xffff);
+  acc = (acc >> 16) + (acc & 0xffff);
+  return (uint16_t)acc;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -54,6 +102,16 @@
  *   Calculate the raw change some over the memory region described by
  *   data and len.
  *
+ *   The one's complement sum does not depend on the byte order (RFC1071),
+ *   so the data is summed 32 bits at a time in the native byte order and
+ *   the result is converted to host order of the big-endian 16-bit words
+ *   at the end.  The 16-bit halves of each 32-bit word are accumulated in
+ *   a 32-bit accumulator which cannot overflow for a 16-bit length.
+ *
+ *   If CONFIG_NET_ARCH_RAWCHKSUM is defined, then this function must be
+ *   provided by architecture-specific logic (e.g., using SIMD
+ *   instructions) while the rest of the checksum logic is common.
+ *
  * Input Parameters:
  *   sum  - Partial calculations carried over from a previous call to
  *          chksum().  This should be zero on the first time that check
@@ -66,33 +124,162 @@
  *
  ****************************************************************************/
 
-#ifndef CONFIG_NET_ARCH_CHKSUM
+#if !defined(CONFIG_NET_ARCH_CHKSUM) && !defined(CONFIG_NET_ARCH_RAWCHKSUM)
 uint16_t chksum(uint16_t sum, FAR const uint8_t *data, uint16_t len)
 {
-  FAR const uint8_t *dataptr;
-  FAR const uint8_t *last_byte;
+  FAR const uint32_t *ptr32;
+  uint32_t acc;
+  uint32_t w;
+  bool odd;
+
+  acc = HTONS(sum);
+
+  /* If the data starts at an odd address, sum the data as if it started
+   * one byte earlier with a zero byte and swap the bytes of the result.
+   * The swap of the partial sum here is undone by the final swap.
+   */
+
+  odd = ((uintptr_t)data & 1) != 0 && len > 0;
+  if (odd)
+    {
+      acc  = CHKSUM_SWAP16(acc);
+      acc += CHKSUM_WORD(0, data[0]);
+      data++;
+      len--;
+    }
+
+  /* Align to 32 bits */
+
+  if (((uintptr_t)data & 2) != 0 && len >= 2)
+    {
+      acc  += *(FAR const uint16_t *)data;
+      data += 2;
+      len  -= 2;
+    }
+
+  /* Sum 16 bytes per iteration, then any remaining 32-bit words */
+
+  ptr32 = (FAR const uint32_t *)data;
+  while (len >= 16)
+    {
+      w = ptr32[0];
+      CHKSUM_ADD32(acc, w);
+      w = ptr32[1];
+      CHKSUM_ADD32(acc, w);
+      w = ptr32[2];
+      CHKSUM_ADD32(acc, w);
+      w = ptr32[3];
+      CHKSUM_ADD32(acc, w);
+
+      ptr32 += 4;
+      len   -= 16;
+    }
+
+  while (len >= 4)
+    {
+      w = *ptr32++;
+      CHKSUM_ADD32(acc, w);
+      len -= 4;
+    }
+
+  /* Then the trailing 16-bit word and byte */
+
+  data = (FAR const uint8_t *)ptr32;
+  if (len >= 2)
+    {
+      acc  += *(FAR const uint16_t *)data;
+      data += 2;
+      len  -= 2;
+    }
+
+  if (len > 0)
+    {
+      acc += CHKSUM_WORD(data[0], 0);
+    }
+
+  sum = chksum_fold(acc);
+  if (odd)
+    {
+      sum = CHKSUM_SWAP16(sum);
+    }
+
+  /* Return sum in host byte order. */
+
+  return NTOHS(sum);
+}
+#endif /* !CONFIG_NET_ARCH_CHKSUM && !CONFIG_NET_ARCH_RAWCHKSUM */
+
+/****************************************************************************
+ * Name: chksum_iob
+ *
+ * Description:
+ *   Calculate the raw checksum over data held in an I/O buffer chain.
+ *   The I/O buffers may hold an odd number of bytes of the data; the
+ *   16-bit words are formed across the I/O buffer boundaries.
+ *
+ * Input Parameters:
+ *   sum    - Partial calculations carried over from a previous call to
+ *            chksum().
+ *   iob    - The I/O buffer chain holding the data.
+ *   offset - The offset of the data in the I/O buffer chain.
+ *   len    - Length of the data to include in the checksum.
+ *
+ * Returned Value:
+ *   The updated checksum value.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_IOB_TX
+uint16_t chksum_iob(uint16_t sum, FAR struct iob_s *iob, uint16_t offset,
+                    uint16_t len)
+{
+  FAR const uint8_t *data;
+  uint16_t ncopy;
   uint16_t t;
+  uint8_t pending = 0;
+  bool odd = false;
 
-  dataptr = data;
-  last_byte = data + len - 1;
+  /* Skip to the I/O buffer that holds the first byte */
 
-  while (dataptr < last_byte)
+  while (iob != NULL && offset >= iob->io_len)
     {
-      /* At least two more bytes */
+      offset -= iob->io_len;
+      iob     = iob->io_flink;
+    }
 
-      t = ((uint16_t)dataptr[0] << 8) + dataptr[1];
-      sum += t;
-      if (sum < t)
+  for (; iob != NULL && len > 0; iob = iob->io_flink, offset = 0)
+    {
+      data  = &iob->io_data[iob->io_offset + offset];
+      ncopy = MIN(len, iob->io_len - offset);
+      len  -= ncopy;
+
+      /* Complete a word started at the end of the previous I/O buffer */
+
+      if (odd)
         {
-          sum++; /* carry */
+          t = ((uint16_t)pending << 8) + data[0];
+          sum += t;
+          if (sum < t)
+            {
+              sum++; /* carry */
+            }
+
+          data++;
+          ncopy--;
+          odd = false;
         }
 
-      dataptr += 2;
+      sum = chksum(sum, data, ncopy & ~1);
+      if ((ncopy & 1) != 0)
+        {
+          pending = data[ncopy - 1];
+          odd     = true;
+        }
     }
 
-  if (dataptr == last_byte)
+  if (odd)
     {
-      t = (dataptr[0] << 8) + 0;
+      t = (uint16_t)pending << 8;
       sum += t;
       if (sum < t)
         {
@@ -100,11 +287,40 @@ uint16_t chksum(uint16_t sum, FAR const uint8_t *data, uint16_t len)
         }
     }
 
-  /* Return sum in host byte order. */
-
   return sum;
 }
-#endif /* CONFIG_NET_ARCH_CHKSUM */
+#endif /* CONFIG_NETDEV_IOB_TX */
+
+/****************************************************************************
+ * Name: net_chksum_adjust
+ *
+ * Description:
+ *   Update an Internet checksum after a 16-bit word of the data that it
+ *   covers changed from 'oldval' to 'newval' without summing the data
+ *   again (RFC1624, equation 3).  All values are as stored in the packet,
+ *   i.e., in network byte order.
+ *
+ * Input Parameters:
+ *   chksum - The checksum field of the packet
+ *   oldval - The previous value of the modified 16-bit word
+ *   newval - The new value of the modified 16-bit word
+ *
+ * Returned Value:
+ *   The new value of the checksum field.
+ *
+ ****************************************************************************/
+
+uint16_t net_chksum_adjust(uint16_t chksum, uint16_t oldval,
+                           uint16_t newval)
+{
+  uint32_t sum;
+
+  sum = (uint32_t)(uint16_t)~chksum + (uint16_t)~oldval + newval;
+  sum = (sum >> 16) + (sum & 0xffff);
+  sum = (sum >> 16) + (sum & 0xffff);
+
+  return (uint16_t)~sum;
+}
 
 /****************************************************************************
  * Name: net_chksum
@@ -116,7 +116,24 @@ uint16_t ipv4_upperlayer_chksum(FAR struct net_driver_s *dev, uint8_t proto)
 
   /* Sum IP payload data. */
 
-  sum = chksum(sum, &dev->d_buf[iphdrlen + NET_LL_HDRLEN(dev)], upperlen);
+#ifdef CONFIG_NETDEV_IOB_TX
+  if (dev->d_txiob != NULL)
+    {
+      /* The payload of the outgoing packet is still in the I/O buffer
+       * chain; only the upper layer header is in d_buf.
+       */
+
+      sum = chksum(sum, &dev->d_buf[iphdrlen + NET_LL_HDRLEN(dev)],
+                   upperlen - dev->d_txlen);
+      sum = chksum_iob(sum, dev->d_txiob, dev->d_txoffset, dev->d_txlen);
+    }
+  else
+#endif
+    {
+      sum = chksum(sum, &dev->d_buf[iphdrlen + NET_LL_HDRLEN(dev)],
+                   upperlen);
+    }
+
   return (sum == 0) ? 0xffff : htons(sum);
 }
 #endif /* CONFIG_NET_ARCH_CHKSUM */
@@ -183,7 +200,19 @@ uint16_t ipv6_upperlayer_chksum(FAR struct net_driver_s *dev,
 
   /* Sum IP payload data. */
 
-  sum = chksum(sum, &dev->d_buf[NET_LL_HDRLEN(dev) + iplen], upperlen);
+#ifdef CONFIG_NETDEV_IOB_TX
+  if (dev->d_txiob != NULL)
+    {
+      sum = chksum(sum, &dev->d_buf[NET_LL_HDRLEN(dev) + iplen],
+                   upperlen - dev->d_txlen);
+      sum = chksum_iob(sum, dev->d_txiob, dev->d_txoffset, dev->d_txlen);
+    }
+  else
+#endif
+    {
+      sum = chksum(sum, &dev->d_buf[NET_LL_HDRLEN(dev) + iplen], upperlen);
+    }
+
   return (sum == 0) ? 0xffff : htons(sum);
 }
 #endif /* CONFIG_NET_ARCH_CHKSUM */
@@ -236,6 +236,52 @@ void net_ipv6_pref2mask(uint8_t preflen, net_ipv6addr_t mask);
 
 uint16_t chksum(uint16_t sum, FAR const uint8_t *data, uint16_t len);
 
+/****************************************************************************
+ * Name: chksum_iob
+ *
+ * Description:
+ *   Calculate the raw checksum over data held in an I/O buffer chain.
+ *
+ * Input Parameters:
+ *   sum    - Partial calculations carried over from a previous call to
+ *            chksum().
+ *   iob    - The I/O buffer chain holding the data.
+ *   offset - The offset of the data in the I/O buffer chain.
+ *   len    - Length of the data to include in the checksum.
+ *
+ * Returned Value:
+ *   The updated checksum value.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_IOB_TX
+struct iob_s;
+uint16_t chksum_iob(uint16_t sum, FAR struct iob_s *iob, uint16_t offset,
+                    uint16_t len);
+#endif
+
+/****************************************************************************
+ * Name: net_chksum_adjust
+ *
+ * Description:
+ *   Update an Internet checksum after a 16-bit word of the data that it
+ *   covers changed from 'oldval' to 'newval' without summing the data
+ *   again (RFC1624).  All values are as stored in the packet, i.e., in
+ *   network byte order.
+ *
+ * Input Parameters:
+ *   chksum - The checksum field of the packet
+ *   oldval - The previous value of the modified 16-bit word
+ *   newval - The new value of the modified 16-bit word
+ *
+ * Returned Value:
+ *   The new value of the checksum field.
+ *
+ ****************************************************************************/
+
+uint16_t net_chksum_adjust(uint16_t chksum, uint16_t oldval,
+                           uint16_t newval);
+
 /****************************************************************************
  * Name: net_chksum
  *
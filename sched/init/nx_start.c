@@ -421,6 +421,9 @@ void nx_start(void)
 #endif
     {
       FAR dq_queue_t *tasklist;
+#ifdef CONFIG_SCHED_READYTORUN_BITMAP
+      FAR struct rtrindex_s *index;
+#endif
       int hashndx;
 
       /* Assign the process ID(s) of ZERO to the idle task(s) */
@@ -524,6 +527,18 @@ void nx_start(void)
 #endif
       dq_addfirst((FAR dq_entry_t *)&g_idletcb[cpu], tasklist);
 
+#ifdef CONFIG_SCHED_READYTORUN_BITMAP
+      /* The idle task runs below SCHED_PRIORITY_MIN, so it is not added with
+       * nxsched_add_prioritized().  Just record it in the priority index.
+       */
+
+      index = nxsched_rtrindex(tasklist);
+      if (index != NULL)
+        {
+          nxsched_rtrindex_insert(index, &g_idletcb[cpu].cmn);
+        }
+#endif
+
       /* Mark the idle task as the running task */
 
       g_running_tasks[cpu] = &g_idletcb[cpu].cmn;
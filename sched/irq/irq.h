@@ -138,6 +138,12 @@ extern volatile cpu_set_t g_cpu_irqset SP_SECTION;
 extern volatile uint8_t g_cpu_nestcount[CONFIG_SMP_NCPUS];
 #endif
 
+#ifdef CONFIG_SPINLOCK_LOCKDEP
+/* The ranks of the subsystem spinlocks held by each CPU, one bit each */
+
+extern volatile uint32_t g_irqspin_held[CONFIG_SMP_NCPUS];
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
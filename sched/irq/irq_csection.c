@@ -261,6 +261,12 @@ try_again:
 
               if ((g_cpu_irqset & (1 << cpu)) == 0)
                 {
+#ifdef CONFIG_SPINLOCK_LOCKDEP
+                  /* The global lock ranks below all subsystem spinlocks */
+
+                  DEBUGASSERT(g_irqspin_held[cpu] == 0);
+#endif
+
                   /* Wait until we can get the spinlock (meaning that we are
                    * no longer blocked by the critical section).
                    */
@@ -326,6 +332,9 @@ try_again:
                */
 
               DEBUGASSERT((g_cpu_irqset & (1 << cpu)) == 0);
+#ifdef CONFIG_SPINLOCK_LOCKDEP
+              DEBUGASSERT(g_irqspin_held[cpu] == 0);
+#endif
 
               if (!irq_waitlock(cpu))
                 {
@@ -0,0 +1,121 @@
+/****************************************************************************
+ * sched/irq/irq_irqspinlock.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/spinlock.h>
+#include <arch/irq.h>
+
+#include "sched/sched.h"
+#include "irq/irq.h"
+
+#ifdef CONFIG_SPINLOCK_SUBSYS
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+#ifdef CONFIG_SPINLOCK_LOCKDEP
+/* The ranks of the subsystem spinlocks held by each CPU, one bit each */
+
+volatile uint32_t g_irqspin_held[CONFIG_SMP_NCPUS];
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: irqspin_lock
+ *
+ * Description:
+ *   Disable local interrupts and take the subsystem spinlock 'lock'.  The
+ *   lock is not recursive.  Do not call kernel APIs that may suspend the
+ *   caller while the lock is held.
+ *
+ * Input Parameters:
+ *   lock - The subsystem spinlock
+ *
+ * Returned Value:
+ *   An opaque, architecture-specific value that represents the state of
+ *   the interrupts prior to the call to irqspin_lock();
+ *
+ ****************************************************************************/
+
+irqstate_t irqspin_lock(FAR irqspinlock_t *lock)
+{
+  irqstate_t flags = up_irq_save();
+
+#ifdef CONFIG_SPINLOCK_LOCKDEP
+  int cpu = this_cpu();
+
+  /* The lock must rank above every lock that this CPU already holds.  This
+   * also catches recursive locking.
+   */
+
+  DEBUGASSERT(lock->rank > 0 && lock->rank < 32);
+  DEBUGASSERT((g_irqspin_held[cpu] >> lock->rank) == 0);
+  g_irqspin_held[cpu] |= UINT32_C(1) << lock->rank;
+#endif
+
+  spin_lock(&lock->lock);
+  return flags;
+}
+
+/****************************************************************************
+ * Name: irqspin_unlock
+ *
+ * Description:
+ *   Release the subsystem spinlock 'lock' and restore the interrupt state
+ *   as it was prior to the matching call to irqspin_lock().
+ *
+ * Input Parameters:
+ *   lock  - The subsystem spinlock
+ *   flags - The architecture-specific value that represents the state of
+ *           the interrupts prior to the call to irqspin_lock();
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void irqspin_unlock(FAR irqspinlock_t *lock, irqstate_t flags)
+{
+#ifdef CONFIG_SPINLOCK_LOCKDEP
+  int cpu = this_cpu();
+
+  DEBUGASSERT((g_irqspin_held[cpu] & (UINT32_C(1) << lock->rank)) != 0);
+  g_irqspin_held[cpu] &= ~(UINT32_C(1) << lock->rank);
+#endif
+
+  spin_unlock(&lock->lock);
+  up_irq_restore(flags);
+}
+
+#endif /* CONFIG_SPINLOCK_SUBSYS */
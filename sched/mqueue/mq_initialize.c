@@ -59,6 +59,10 @@ sq_queue_t  g_msgfree;
 
 sq_queue_t  g_msgfreeirq;
 
+/* g_msgfreelock protects the g_msgfree and g_msgfreeirq lists */
+
+irqspinlock_t g_msgfreelock = IRQSPINLOCK_INITIALIZER(IRQSPIN_RANK_MQUEUE);
+
 /* The g_desfree data structure is a list of message descriptors available
  * to the operating system for general use. The number of messages in the
  * pool is a constant.
@@ -63,12 +63,12 @@ void nxmq_free_msg(FAR struct mqueue_msg_s *mqmsg)
   if (mqmsg->type == MQ_ALLOC_FIXED)
     {
       /* Make sure we avoid concurrent access to the free
-       * list from interrupt handlers.
+       * list from interrupt handlers and other CPUs.
        */
 
-      flags = enter_critical_section();
+      flags = irqspin_lock(&g_msgfreelock);
       sq_addlast((FAR sq_entry_t *)mqmsg, &g_msgfree);
-      leave_critical_section(flags);
+      irqspin_unlock(&g_msgfreelock, flags);
     }
 
   /* If this is a message pre-allocated for interrupts,
@@ -78,12 +78,12 @@ void nxmq_free_msg(FAR struct mqueue_msg_s *mqmsg)
   else if (mqmsg->type == MQ_ALLOC_IRQ)
     {
       /* Make sure we avoid concurrent access to the free
-       * list from interrupt handlers.
+       * list from interrupt handlers and other CPUs.
        */
 
-      flags = enter_critical_section();
+      flags = irqspin_lock(&g_msgfreelock);
       sq_addlast((FAR sq_entry_t *)mqmsg, &g_msgfreeirq);
-      leave_critical_section(flags);
+      irqspin_unlock(&g_msgfreelock, flags);
     }
 
   /* Otherwise, deallocate it.  Note:  interrupt handlers
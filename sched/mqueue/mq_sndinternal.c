@@ -133,8 +133,11 @@ FAR struct mqueue_msg_s *nxmq_alloc_msg(void)
 
   if (up_interrupt_context())
     {
-      /* Try the general free list */
+      /* Try the general free list.  The lock is still needed here because
+       * another CPU may be using the lists.
+       */
 
+      flags = irqspin_lock(&g_msgfreelock);
       mqmsg = (FAR struct mqueue_msg_s *)sq_remfirst(&g_msgfree);
       if (mqmsg == NULL)
         {
@@ -142,6 +145,8 @@ FAR struct mqueue_msg_s *nxmq_alloc_msg(void)
 
           mqmsg = (FAR struct mqueue_msg_s *)sq_remfirst(&g_msgfreeirq);
         }
+
+      irqspin_unlock(&g_msgfreelock, flags);
     }
 
   /* We were not called from an interrupt handler. */
@@ -152,9 +157,9 @@ FAR struct mqueue_msg_s *nxmq_alloc_msg(void)
        * Disable interrupts -- we might be called from an interrupt handler.
        */
 
-      flags = enter_critical_section();
+      flags = irqspin_lock(&g_msgfreelock);
       mqmsg = (FAR struct mqueue_msg_s *)sq_remfirst(&g_msgfree);
-      leave_critical_section(flags);
+      irqspin_unlock(&g_msgfreelock, flags);
 
       /* If we cannot a message from the free list, then we will have to
        * allocate one.
@@ -35,6 +35,7 @@
 #include <mqueue.h>
 #include <sched.h>
 
+#include <nuttx/irq.h>
 #include <nuttx/mqueue.h>
 
 #if CONFIG_MQ_MAXMSGSIZE > 0
@@ -109,6 +110,10 @@ EXTERN sq_queue_t  g_msgfree;
 
 EXTERN sq_queue_t  g_msgfreeirq;
 
+/* g_msgfreelock protects the g_msgfree and g_msgfreeirq lists */
+
+EXTERN irqspinlock_t g_msgfreelock;
+
 /* The g_desfree data structure is a list of message descriptors available
  * to the operating system for general use. The number of messages in the
  * pool is a constant.
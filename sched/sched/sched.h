@@ -99,6 +99,10 @@
 #  define TLIST_BLOCKED(s)       __TLIST_HEAD(s)
 #endif
 
+/* Number of 32-bit words in the priority bitmap of a ready-to-run index */
+
+#define RTRINDEX_NWORDS          ((SCHED_PRIORITY_MAX + 32) >> 5)
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
@@ -133,6 +137,21 @@ struct tasklist_s
   uint8_t attr;                   /* List attribute flags */
 };
 
+#ifdef CONFIG_SCHED_READYTORUN_BITMAP
+/* This structure indexes a prioritized ready-to-run list by priority.  The
+ * TCBs of one priority form a contiguous FIFO segment of the list; 'tail'
+ * holds the last TCB of each segment and 'bitmap' has one bit set for each
+ * priority that has a non-empty segment.  This allows a TCB to be inserted
+ * or removed in constant time without walking the list.
+ */
+
+struct rtrindex_s
+{
+  uint32_t bitmap[RTRINDEX_NWORDS];               /* Non-empty priorities */
+  FAR struct tcb_s *tail[SCHED_PRIORITY_MAX + 1]; /* Last TCB per priority */
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -278,6 +297,20 @@ extern const struct tasklist_s g_tasklisttable[NUM_TASK_STATES];
 extern volatile uint32_t g_cpuload_total;
 #endif
 
+#ifdef CONFIG_SCHED_READYTORUN_BITMAP
+/* Declared in sched_rtrindex.c *********************************************/
+
+/* The priority index of the g_readytorun list */
+
+extern struct rtrindex_s g_readytorun_index;
+
+#ifdef CONFIG_SMP
+/* The priority indices of the g_assignedtasks[] lists */
+
+extern struct rtrindex_s g_assignedtasks_index[CONFIG_SMP_NCPUS];
+#endif
+#endif
+
 /* Declared in sched_lock.c *************************************************/
 
 /* Pre-emption is disabled via the interface sched_lock(). sched_lock()
@@ -366,6 +399,24 @@ void nxsched_add_blocked(FAR struct tcb_s *btcb, tstate_t task_state);
 void nxsched_remove_blocked(FAR struct tcb_s *btcb);
 int  nxsched_set_priority(FAR struct tcb_s *tcb, int sched_priority);
 
+/* Ready-to-run list priority index */
+
+#ifdef CONFIG_SCHED_READYTORUN_BITMAP
+FAR struct rtrindex_s *nxsched_rtrindex(DSEG dq_queue_t *list);
+void nxsched_rtrindex_insert(FAR struct rtrindex_s *index,
+                             FAR struct tcb_s *tcb);
+void nxsched_rtrindex_remove(FAR struct rtrindex_s *index,
+                             FAR struct tcb_s *tcb);
+void nxsched_rtrindex_reset(FAR struct rtrindex_s *index);
+bool nxsched_rtrindex_add(FAR struct rtrindex_s *index,
+                          FAR struct tcb_s *tcb, DSEG dq_queue_t *list);
+void nxsched_remove_prioritized(FAR struct tcb_s *tcb,
+                                DSEG dq_queue_t *list);
+#else
+#  define nxsched_remove_prioritized(tcb,list) \
+     dq_rem((FAR dq_entry_t *)(tcb), (list))
+#endif
+
 /* Priority inheritance support */
 
 #ifdef CONFIG_PRIORITY_INHERITANCE
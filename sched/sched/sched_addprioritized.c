@@ -80,6 +80,9 @@ bool nxsched_add_prioritized(FAR struct tcb_s *tcb, DSEG dq_queue_t *list)
 {
   FAR struct tcb_s *next;
   FAR struct tcb_s *prev;
+#ifdef CONFIG_SCHED_READYTORUN_BITMAP
+  FAR struct rtrindex_s *index;
+#endif
   uint8_t sched_priority = tcb->sched_priority;
   bool ret = false;
 
@@ -87,6 +90,18 @@ bool nxsched_add_prioritized(FAR struct tcb_s *tcb, DSEG dq_queue_t *list)
 
   DEBUGASSERT(sched_priority >= SCHED_PRIORITY_MIN);
 
+#ifdef CONFIG_SCHED_READYTORUN_BITMAP
+  /* If the list has a priority index, then the insertion point can be
+   * found without searching the list.
+   */
+
+  index = nxsched_rtrindex(list);
+  if (index != NULL)
+    {
+      return nxsched_rtrindex_add(index, tcb, list);
+    }
+#endif
+
   /* Search the list to find the location to insert the new Tcb.
    * Each is list is maintained in descending sched_priority order.
    */
@@ -74,6 +74,16 @@ uint32_t g_premp_max[1];
 uint32_t g_crit_max[1];
 #endif
 
+/* Total time within critical sections and number of critical sections. */
+
+#ifdef CONFIG_SMP_NCPUS
+uint64_t g_crit_total[CONFIG_SMP_NCPUS];
+uint32_t g_crit_count[CONFIG_SMP_NCPUS];
+#else
+uint64_t g_crit_total[1];
+uint32_t g_crit_count[1];
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -175,6 +185,7 @@ void nxsched_critmon_csection(FAR struct tcb_s *tcb, bool state)
           /* Set the global start time */
 
           g_crit_start[cpu] = tcb->crit_start;
+          g_crit_count[cpu]++;
         }
     }
   else if (tcb->crit_start != 0)
@@ -198,6 +209,7 @@ void nxsched_critmon_csection(FAR struct tcb_s *tcb, bool state)
         {
           elapsed           = now - g_crit_start[cpu];
           g_crit_start[cpu] = 0;
+          g_crit_total[cpu] += elapsed;
 
           if (elapsed > g_crit_max[cpu])
             {
@@ -268,6 +280,7 @@ void nxsched_resume_critmon(FAR struct tcb_s *tcb)
       if (g_crit_start[cpu] == 0)
         {
           g_crit_start[cpu] = tcb->crit_start;
+          g_crit_count[cpu]++;
         }
     }
   else if (g_crit_start[cpu] != 0)
@@ -276,6 +289,7 @@ void nxsched_resume_critmon(FAR struct tcb_s *tcb)
 
       elapsed      = up_critmon_gettime() - g_crit_start[cpu];
       g_crit_start[cpu] = 0;
+      g_crit_total[cpu] += elapsed;
 
       if (elapsed > g_crit_max[cpu])
         {
@@ -74,12 +74,16 @@ bool nxsched_merge_pending(void)
   FAR struct tcb_s *ptcb;
   FAR struct tcb_s *pnext;
   FAR struct tcb_s *rtcb;
+#ifndef CONFIG_SCHED_READYTORUN_BITMAP
   FAR struct tcb_s *rprev;
+#endif
   bool ret = false;
 
+#ifndef CONFIG_SCHED_READYTORUN_BITMAP
   /* Initialize the inner search loop */
 
   rtcb = this_task();
+#endif
 
   /* Process every TCB in the g_pendingtasks list */
 
@@ -89,6 +93,26 @@ bool nxsched_merge_pending(void)
     {
       pnext = ptcb->flink;
 
+#ifdef CONFIG_SCHED_READYTORUN_BITMAP
+      /* The ready-to-run list is indexed by priority so the insertion
+       * point can be found without searching the list.
+       */
+
+      rtcb = this_task();
+      if (nxsched_rtrindex_add(&g_readytorun_index, ptcb,
+                               (FAR dq_queue_t *)&g_readytorun))
+        {
+          /* Inserted ptcb at the head of the list */
+
+          rtcb->task_state  = TSTATE_TASK_READYTORUN;
+          ptcb->task_state  = TSTATE_TASK_RUNNING;
+          ret               = true;
+        }
+      else
+        {
+          ptcb->task_state  = TSTATE_TASK_READYTORUN;
+        }
+#else
       /* REVISIT:  Why don't we just remove the ptcb from pending task list
        * and call nxsched_add_readytorun?
        */
@@ -141,6 +165,7 @@ bool nxsched_merge_pending(void)
       /* Set up for the next time through */
 
       rtcb = ptcb;
+#endif
     }
 
   /* Mark the input list empty */
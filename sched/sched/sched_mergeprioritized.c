@@ -67,6 +67,9 @@ void nxsched_merge_prioritized(FAR dq_queue_t *list1, FAR dq_queue_t *list2,
   FAR struct tcb_s *tcb1;
   FAR struct tcb_s *tcb2;
   FAR struct tcb_s *tmp;
+#ifdef CONFIG_SCHED_READYTORUN_BITMAP
+  FAR struct rtrindex_s *index;
+#endif
 
 #ifdef CONFIG_SMP
   /* Lock the tasklists before accessing */
@@ -83,6 +86,16 @@ void nxsched_merge_prioritized(FAR dq_queue_t *list1, FAR dq_queue_t *list2,
 
   dq_move(list1, &clone);
 
+#ifdef CONFIG_SCHED_READYTORUN_BITMAP
+  /* If list1 was indexed, then its index is now empty too */
+
+  index = nxsched_rtrindex(list1);
+  if (index != NULL)
+    {
+      nxsched_rtrindex_reset(index);
+    }
+#endif
+
   /* Get the TCB at the head of list1 */
 
   tcb1 = (FAR struct tcb_s *)dq_peek(&clone);
@@ -105,6 +118,23 @@ void nxsched_merge_prioritized(FAR dq_queue_t *list1, FAR dq_queue_t *list2,
       tmp->task_state = task_state;
     }
 
+#ifdef CONFIG_SCHED_READYTORUN_BITMAP
+  /* If list2 is indexed, then each TCB can be added in constant time
+   * using the index.  That also keeps the index of list2 up to date.
+   */
+
+  index = nxsched_rtrindex(list2);
+  if (index != NULL)
+    {
+      while ((tmp = (FAR struct tcb_s *)dq_remfirst(&clone)) != NULL)
+        {
+          nxsched_rtrindex_add(index, tmp, list2);
+        }
+
+      goto ret_with_lock;
+    }
+#endif
+
   /* Get the head of list2 */
 
   tcb2 = (FAR struct tcb_s *)dq_peek(list2);
@@ -102,7 +102,7 @@ bool nxsched_remove_readytorun(FAR struct tcb_s *rtcb)
    * is always the g_readytorun list.
    */
 
-  dq_rem((FAR dq_entry_t *)rtcb, (FAR dq_queue_t *)&g_readytorun);
+  nxsched_remove_prioritized(rtcb, (FAR dq_queue_t *)&g_readytorun);
 
   /* Since the TCB is not in any list, it is now invalid */
 
@@ -199,7 +199,7 @@ bool nxsched_remove_readytorun(FAR struct tcb_s *rtcb)
        * or the g_assignedtasks[cpu] list.
        */
 
-      dq_rem((FAR dq_entry_t *)rtcb, tasklist);
+      nxsched_remove_prioritized(rtcb, tasklist);
 
       /* Which task will go at the head of the list?  It will be either the
        * next tcb in the assigned task list (nxttcb) or a TCB in the
@@ -238,10 +238,14 @@ bool nxsched_remove_readytorun(FAR struct tcb_s *rtcb)
            * list and add to the head of the g_assignedtasks[cpu] list.
            */
 
-          tmptcb = (FAR struct tcb_s *)
-            dq_remfirst((FAR dq_queue_t *)&g_readytorun);
+          tmptcb = (FAR struct tcb_s *)dq_peek(&g_readytorun);
+          nxsched_remove_prioritized(tmptcb,
+                                     (FAR dq_queue_t *)&g_readytorun);
 
           dq_addfirst((FAR dq_entry_t *)tmptcb, tasklist);
+#ifdef CONFIG_SCHED_READYTORUN_BITMAP
+          nxsched_rtrindex_insert(&g_assignedtasks_index[cpu], tmptcb);
+#endif
 
           tmptcb->cpu = cpu;
           nxttcb = tmptcb;
@@ -329,7 +333,7 @@ bool nxsched_remove_readytorun(FAR struct tcb_s *rtcb)
        * g_assignedtasks[cpu] list.
        */
 
-      dq_rem((FAR dq_entry_t *)rtcb, tasklist);
+      nxsched_remove_prioritized(rtcb, tasklist);
     }
 
   /* Since the TCB is no longer in any list, it is now invalid */
@@ -0,0 +1,322 @@
+/****************************************************************************
+ * sched/sched/sched_rtrindex.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <strings.h>
+#include <queue.h>
+#include <assert.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_READYTORUN_BITMAP
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* The priority index of the g_readytorun list */
+
+struct rtrindex_s g_readytorun_index;
+
+#ifdef CONFIG_SMP
+/* The priority indices of the g_assignedtasks[] lists */
+
+struct rtrindex_s g_assignedtasks_index[CONFIG_SMP_NCPUS];
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxsched_rtrindex_above
+ *
+ * Description:
+ *   Return the lowest priority that is greater than or equal to 'priority'
+ *   and that has at least one TCB in the indexed list.  The number of
+ *   bitmap words examined is bounded by RTRINDEX_NWORDS.
+ *
+ * Input Parameters:
+ *   index    - The priority index of the list
+ *   priority - The lower bound of the priority search
+ *
+ * Returned Value:
+ *   The priority found or -1 if there is no such priority in the list.
+ *
+ ****************************************************************************/
+
+static int nxsched_rtrindex_above(FAR struct rtrindex_s *index,
+                                  int priority)
+{
+  int ndx = priority >> 5;
+  uint32_t word;
+
+  /* Ignore the priorities below 'priority' in the first word */
+
+  word = index->bitmap[ndx] & ~((UINT32_C(1) << (priority & 31)) - 1);
+
+  while (word == 0)
+    {
+      if (++ndx >= RTRINDEX_NWORDS)
+        {
+          return -1;
+        }
+
+      word = index->bitmap[ndx];
+    }
+
+  return (ndx << 5) + ffs((int)word) - 1;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxsched_rtrindex
+ *
+ * Description:
+ *   Return the priority index associated with a task list.  Only the
+ *   g_readytorun list and, in the SMP case, the g_assignedtasks[] lists
+ *   are indexed.
+ *
+ * Input Parameters:
+ *   list - The task list
+ *
+ * Returned Value:
+ *   The priority index of the list or NULL if the list is not indexed.
+ *
+ ****************************************************************************/
+
+FAR struct rtrindex_s *nxsched_rtrindex(DSEG dq_queue_t *list)
+{
+#ifdef CONFIG_SMP
+  FAR dq_queue_t *assigned = (FAR dq_queue_t *)g_assignedtasks;
+#endif
+
+  if (list == (FAR dq_queue_t *)&g_readytorun)
+    {
+      return &g_readytorun_index;
+    }
+
+#ifdef CONFIG_SMP
+  if (list >= assigned && list < &assigned[CONFIG_SMP_NCPUS])
+    {
+      return &g_assignedtasks_index[list - assigned];
+    }
+#endif
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: nxsched_rtrindex_insert
+ *
+ * Description:
+ *   Update the priority index after a TCB has been linked into the
+ *   indexed list.  The TCB becomes the tail of its priority group unless
+ *   it was inserted ahead of another TCB of the same priority.
+ *
+ * Input Parameters:
+ *   index - The priority index of the list holding the TCB
+ *   tcb   - The TCB that was just added to the list
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The caller holds the critical section (and the task list lock in the
+ *   SMP case).
+ *
+ ****************************************************************************/
+
+void nxsched_rtrindex_insert(FAR struct rtrindex_s *index,
+                             FAR struct tcb_s *tcb)
+{
+  FAR struct tcb_s *next = (FAR struct tcb_s *)tcb->flink;
+  uint8_t priority = tcb->sched_priority;
+
+  if (next == NULL || next->sched_priority != priority)
+    {
+      index->tail[priority] = tcb;
+      index->bitmap[priority >> 5] |= UINT32_C(1) << (priority & 31);
+    }
+}
+
+/****************************************************************************
+ * Name: nxsched_rtrindex_remove
+ *
+ * Description:
+ *   Update the priority index before a TCB is unlinked from the indexed
+ *   list.
+ *
+ * Input Parameters:
+ *   index - The priority index of the list holding the TCB
+ *   tcb   - The TCB that is about to be removed from the list
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The caller holds the critical section (and the task list lock in the
+ *   SMP case).
+ *
+ ****************************************************************************/
+
+void nxsched_rtrindex_remove(FAR struct rtrindex_s *index,
+                             FAR struct tcb_s *tcb)
+{
+  FAR struct tcb_s *prev = (FAR struct tcb_s *)tcb->blink;
+  uint8_t priority = tcb->sched_priority;
+
+  if (index->tail[priority] == tcb)
+    {
+      if (prev != NULL && prev->sched_priority == priority)
+        {
+          /* The previous TCB becomes the tail of the priority group */
+
+          index->tail[priority] = prev;
+        }
+      else
+        {
+          /* This was the only TCB at this priority */
+
+          index->tail[priority] = NULL;
+          index->bitmap[priority >> 5] &= ~(UINT32_C(1) << (priority & 31));
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: nxsched_rtrindex_reset
+ *
+ * Description:
+ *   Mark an index as empty.  This is used when the entire content of an
+ *   indexed list is moved elsewhere.
+ *
+ * Input Parameters:
+ *   index - The priority index to be reset
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxsched_rtrindex_reset(FAR struct rtrindex_s *index)
+{
+  int i;
+
+  for (i = 0; i < RTRINDEX_NWORDS; i++)
+    {
+      index->bitmap[i] = 0;
+    }
+
+  for (i = 0; i <= SCHED_PRIORITY_MAX; i++)
+    {
+      index->tail[i] = NULL;
+    }
+}
+
+/****************************************************************************
+ * Name: nxsched_rtrindex_add
+ *
+ * Description:
+ *   Add a TCB to an indexed, prioritized task list in constant time.  The
+ *   TCB is placed after all TCBs of the same or higher priority, i.e., at
+ *   the same position that the linear search in nxsched_add_prioritized()
+ *   would select.
+ *
+ * Input Parameters:
+ *   index - The priority index of the list
+ *   tcb   - Points to the TCB to add to the prioritized list
+ *   list  - Points to the prioritized list to add tcb to
+ *
+ * Returned Value:
+ *   true if the head of the list has changed.
+ *
+ ****************************************************************************/
+
+bool nxsched_rtrindex_add(FAR struct rtrindex_s *index,
+                          FAR struct tcb_s *tcb, DSEG dq_queue_t *list)
+{
+  FAR struct tcb_s *prev;
+  int priority;
+  bool ret = false;
+
+  /* Find the nearest priority group at or above the priority of the new
+   * TCB.  The new TCB goes just after the tail of that group.
+   */
+
+  priority = nxsched_rtrindex_above(index, tcb->sched_priority);
+  if (priority < 0)
+    {
+      /* There is no TCB of the same or higher priority in the list */
+
+      dq_addfirst((FAR dq_entry_t *)tcb, list);
+      ret = true;
+    }
+  else
+    {
+      prev = index->tail[priority];
+      DEBUGASSERT(prev != NULL);
+
+      dq_addafter((FAR dq_entry_t *)prev, (FAR dq_entry_t *)tcb, list);
+    }
+
+  nxsched_rtrindex_insert(index, tcb);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nxsched_remove_prioritized
+ *
+ * Description:
+ *   Remove a TCB from a prioritized task list, keeping the priority index
+ *   of the list (if any) up to date.
+ *
+ * Input Parameters:
+ *   tcb  - Points to the TCB to be removed
+ *   list - Points to the list that holds the TCB
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxsched_remove_prioritized(FAR struct tcb_s *tcb,
+                                DSEG dq_queue_t *list)
+{
+  FAR struct rtrindex_s *index = nxsched_rtrindex(list);
+
+  if (index != NULL)
+    {
+      nxsched_rtrindex_remove(index, tcb);
+    }
+
+  dq_rem((FAR dq_entry_t *)tcb, list);
+}
+
+#endif /* CONFIG_SCHED_READYTORUN_BITMAP */
@@ -149,9 +149,25 @@ static inline void nxsched_running_setpriority(FAR struct tcb_s *tcb,
 
   else
     {
+#ifdef CONFIG_SCHED_READYTORUN_BITMAP
+      /* The task stays at the head of its list, but it moves to a
+       * different priority group in the list's priority index.
+       */
+
+#ifdef CONFIG_SMP
+      FAR struct rtrindex_s *index = &g_assignedtasks_index[tcb->cpu];
+#else
+      FAR struct rtrindex_s *index = &g_readytorun_index;
+#endif
+
+      nxsched_rtrindex_remove(index, tcb);
+      tcb->sched_priority = (uint8_t)sched_priority;
+      nxsched_rtrindex_insert(index, tcb);
+#else
       /* Change the task priority */
 
       tcb->sched_priority = (uint8_t)sched_priority;
+#endif
     }
 }
 
@@ -283,7 +299,7 @@ static inline void nxsched_blocked_setpriority(FAR struct tcb_s *tcb,
     {
       /* Remove the TCB from the prioritized task list */
 
-      dq_rem((FAR dq_entry_t *)tcb, tasklist);
+      nxsched_remove_prioritized(tcb, tasklist);
 
       /* Change the task priority */
 
@@ -55,7 +55,9 @@ typedef int (*holderhandler_t)(FAR struct semholder_s *pholder,
  * Private Data
  ****************************************************************************/
 
-/* Preallocated holder structures */
+/* Preallocated containers for the second and later holders of a counting
+ * semaphore.  The first holder is kept in the semaphore itself.
+ */
 
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
 static struct semholder_s g_holderalloc[CONFIG_SEM_PREALLOCHOLDERS];
@@ -66,50 +68,49 @@ static FAR struct semholder_s *g_freeholders;
  * Name: nxsem_allocholder
  ****************************************************************************/
 
-static inline FAR struct semholder_s *nxsem_allocholder(sem_t *sem)
+static inline FAR struct semholder_s *nxsem_allocholder(FAR sem_t *sem)
 {
   FAR struct semholder_s *pholder;
 
-  /* Check if the "built-in" holder is being used.  We have this built-in
-   * holder to optimize for the simplest case where semaphores are only
-   * used to implement mutexes.
+  /* Use the holder built into the semaphore if it is free.  It is the only
+   * one ever needed when the semaphore is used as a mutex.
    */
 
+  if (sem->holder.htcb == NULL)
+    {
+      pholder          = &sem->holder;
+    }
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
-  pholder = g_freeholders;
-  if (pholder != NULL)
+  else if (g_freeholders != NULL)
     {
-      /* Remove the holder from the free list an put it into the semaphore's
-       * holder list
+      /* Remove a holder from the free list an put it into the semaphore's
+       * list of further holders.
        */
 
+      pholder          = g_freeholders;
       g_freeholders    = pholder->flink;
       pholder->flink   = sem->hhead;
       sem->hhead       = pholder;
-
-      /* Make sure the initial count is zero */
-
-      pholder->counts  = 0;
-    }
-#else
-  if (sem->holder[0].htcb == NULL)
-    {
-      pholder          = &sem->holder[0];
-      pholder->counts  = 0;
     }
-  else if (sem->holder[1].htcb == NULL)
+  else
     {
-      pholder          = &sem->holder[1];
-      pholder->counts  = 0;
+      serr("ERROR: Insufficient pre-allocated holders\n");
+      DEBUGPANIC();
+      return NULL;
     }
-#endif
+#else
   else
     {
-      serr("ERROR: Insufficient pre-allocated holders\n");
-      pholder          = NULL;
+      /* Only the first holder of a counting semaphore is tracked */
+
+      swarn("WARNING: No container for a further holder\n");
+      return NULL;
     }
+#endif
 
-  DEBUGASSERT(pholder != NULL);
+  /* Make sure the initial count is zero */
+
+  pholder->counts  = 0;
   return pholder;
 }
 
@@ -122,34 +123,25 @@ static inline FAR struct semholder_s *nxsem_allocholder(sem_t *sem)
  *
  ****************************************************************************/
 
-static FAR struct semholder_s *nxsem_findholder(sem_t *sem,
+static FAR struct semholder_s *nxsem_findholder(FAR sem_t *sem,
                                                 FAR struct tcb_s *htcb)
 {
+#if CONFIG_SEM_PREALLOCHOLDERS > 0
   FAR struct semholder_s *pholder;
+#endif
 
-#if CONFIG_SEM_PREALLOCHOLDERS > 0
-  /* Try to find the holder in the list of holders associated with this
-   * semaphore
-   */
+  /* Check the holder built into the semaphore first */
 
-  for (pholder = sem->hhead; pholder != NULL; pholder = pholder->flink)
+  if (sem->holder.htcb == htcb)
     {
-      if (pholder->htcb == htcb)
-        {
-          /* Got it! */
-
-          return pholder;
-        }
+      return &sem->holder;
     }
-#else
-  int i;
-  pholder = NULL;
 
-  /* We have two hard-allocated holder structures in sem_t */
+#if CONFIG_SEM_PREALLOCHOLDERS > 0
+  /* Then the list of further holders associated with this semaphore */
 
-  for (i = 0; i < 2; i++)
+  for (pholder = sem->hhead; pholder != NULL; pholder = pholder->flink)
     {
-      pholder = &sem->holder[i];
       if (pholder->htcb == htcb)
         {
           /* Got it! */
@@ -169,7 +161,7 @@ static FAR struct semholder_s *nxsem_findholder(sem_t *sem,
  ****************************************************************************/
 
 static inline FAR struct semholder_s *
-nxsem_findorallocateholder(sem_t *sem, FAR struct tcb_s *htcb)
+nxsem_findorallocateholder(FAR sem_t *sem, FAR struct tcb_s *htcb)
 {
   FAR struct semholder_s *pholder = nxsem_findholder(sem, htcb);
   if (!pholder)
@@ -184,12 +176,10 @@ nxsem_findorallocateholder(sem_t *sem, FAR struct tcb_s *htcb)
  * Name: nxsem_freeholder
  ****************************************************************************/
 
-static inline void nxsem_freeholder(sem_t *sem,
-                                    FAR struct semholder_s *pholder)
+static void nxsem_freeholder(FAR sem_t *sem, FAR struct semholder_s *pholder)
 {
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
-  FAR struct semholder_s *curr;
-  FAR struct semholder_s *prev;
+  FAR struct semholder_s **link;
 #endif
 
   /* Release the holder and counts */
@@ -198,23 +188,17 @@ static inline void nxsem_freeholder(sem_t *sem,
   pholder->counts = 0;
 
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
-  /* Search the list for the matching holder */
-
-  for (prev = NULL, curr = sem->hhead;
-       curr && curr != pholder;
-       prev = curr, curr = curr->flink);
-
-  if (curr != NULL)
+  if (pholder != &sem->holder)
     {
-      /* Remove the holder from the list */
+      /* Remove the holder from the list of further holders */
 
-      if (prev != NULL)
-        {
-          prev->flink = pholder->flink;
-        }
-      else
+      for (link = &sem->hhead; *link != NULL; link = &(*link)->flink)
         {
-          sem->hhead = pholder->flink;
+          if (*link == pholder)
+            {
+              *link = pholder->flink;
+              break;
+            }
         }
 
       /* And put it in the free list */
@@ -225,25 +209,6 @@ static inline void nxsem_freeholder(sem_t *sem,
 #endif
 }
 
-/****************************************************************************
- * Name: nxsem_findandfreeholder
- ****************************************************************************/
-
-static inline void nxsem_findandfreeholder(sem_t *sem,
-                                           FAR struct tcb_s *htcb)
-{
-  FAR struct semholder_s *pholder = nxsem_findholder(sem, htcb);
-
-  /* When no more counts are held, remove the holder from the list.  The
-   * count was decremented in nxsem_release_holder.
-   */
-
-  if (pholder != NULL && pholder->counts <= 0)
-    {
-      nxsem_freeholder(sem, pholder);
-    }
-}
-
 /****************************************************************************
  * Name: nxsem_foreachholder
  ****************************************************************************/
@@ -251,10 +216,10 @@ static inline void nxsem_findandfreeholder(sem_t *sem,
 static int nxsem_foreachholder(FAR sem_t *sem, holderhandler_t handler,
                                FAR void *arg)
 {
-  FAR struct semholder_s *pholder;
   int ret = 0;
 
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
+  FAR struct semholder_s *pholder;
   FAR struct semholder_s *next;
 
   for (pholder = sem->hhead; pholder && ret == 0; pholder = next)
@@ -274,25 +239,14 @@ static int nxsem_foreachholder(FAR sem_t *sem, holderhandler_t handler,
           ret = handler(pholder, sem, arg);
         }
     }
-#else
-  int i;
+#endif
 
-  /* We have two hard-allocated holder structures in sem_t */
+  /* Then the holder built into the semaphore, if it is in use */
 
-  for (i = 0; i < 2; i++)
+  if (ret == 0 && sem->holder.htcb != NULL)
     {
-      pholder = &sem->holder[i];
-
-      /* The hard-allocated containers may hold a NULL holder */
-
-      if (pholder->htcb != NULL)
-        {
-          /* Call the handler */
-
-          ret = handler(pholder, sem, arg);
-        }
+      ret = handler(&sem->holder, sem, arg);
     }
-#endif
 
   return ret;
 }
@@ -301,14 +255,12 @@ static int nxsem_foreachholder(FAR sem_t *sem, holderhandler_t handler,
  * Name: nxsem_recoverholders
  ****************************************************************************/
 
-#if CONFIG_SEM_PREALLOCHOLDERS > 0
 static int nxsem_recoverholders(FAR struct semholder_s *pholder,
                                 FAR sem_t *sem, FAR void *arg)
 {
   nxsem_freeholder(sem, pholder);
   return 0;
 }
-#endif
 
 /****************************************************************************
  * Name: nxsem_boostholderprio
@@ -459,12 +411,7 @@ static int nxsem_verifyholder(FAR struct semholder_s *pholder,
 static int nxsem_dumpholder(FAR struct semholder_s *pholder, FAR sem_t *sem,
                             FAR void *arg)
 {
-#if CONFIG_SEM_PREALLOCHOLDERS > 0
-  _info("  %08x: %08x %08x %04x\n",
-        pholder, pholder->flink, pholder->htcb, pholder->counts);
-#else
   _info("  %08x: %08x %04x\n", pholder, pholder->htcb, pholder->counts);
-#endif
   return 0;
 }
 #endif
@@ -651,39 +598,6 @@ static int nxsem_restoreholderprio_others(FAR struct semholder_s *pholder,
   return 0;
 }
 
-/****************************************************************************
- * Name: nxsem_restoreholderprio_self
- *
- * Description:
- *   Reprioritize only the currently executing task
- *
- ****************************************************************************/
-
-static int nxsem_restoreholderprio_self(FAR struct semholder_s *pholder,
-                                        FAR sem_t *sem, FAR void *arg)
-{
-  FAR struct tcb_s *rtcb = this_task();
-
-  if (pholder->htcb == rtcb)
-    {
-      /* The running task has given up a count on the semaphore */
-
-#if CONFIG_SEM_PREALLOCHOLDERS == 0
-      /* In the case where there are only 2 holders. This step
-       * is necessary to ensure we have space. Release the holder
-       * if all counts have been given up before reprioritizing
-       * causes a context switch.
-       */
-
-      nxsem_findandfreeholder(sem, rtcb);
-#endif
-      nxsem_restoreholderprio(rtcb, sem, arg);
-      return 1;
-    }
-
-  return 0;
-}
-
 /****************************************************************************
  * Name: nxsem_restore_baseprio_irq
  *
@@ -802,9 +716,16 @@ static inline void nxsem_restore_baseprio_task(FAR struct tcb_s *stcb,
 
       nxsem_foreachholder(sem, nxsem_restoreholderprio_others, stcb);
 
-      /* Now, find an reprioritize only the ready to run task */
+      /* Now reprioritize the running thread if it held a count.  If it
+       * gave up its last count, nxsem_release_holder() has already freed
+       * its holder so that the container was available to stcb.
+       */
 
-      nxsem_foreachholder(sem, nxsem_restoreholderprio_self, stcb);
+      if ((sem->flags & PRIOINHERIT_FLAGS_RELEASED) != 0 ||
+          nxsem_findholder(sem, rtcb) != NULL)
+        {
+          nxsem_restoreholderprio(rtcb, sem, stcb);
+        }
     }
 
   /* If there are no tasks waiting for available counts, then all holders
@@ -817,13 +738,6 @@ static inline void nxsem_restore_baseprio_task(FAR struct tcb_s *stcb,
       nxsem_foreachholder(sem, nxsem_verifyholder, NULL);
     }
 #endif
-
-  /* In any case, the currently executing task should have an entry in the
-   * list.  Its counts were previously decremented; if it now holds no
-   * counts, then we need to remove it from the list of holders.
-   */
-
-  nxsem_findandfreeholder(sem, rtcb);
 }
 
 /****************************************************************************
@@ -898,25 +812,13 @@ void nxsem_destroyholder(FAR sem_t *sem)
    * any stranded holders and hope the task knows what it is doing.
    */
 
-#if CONFIG_SEM_PREALLOCHOLDERS > 0
-  if (sem->hhead != NULL)
-    {
-      /* There may be an issue if there are multiple holders of
-       * the semaphore.
-       */
-
-      DEBUGASSERT(sem->hhead->flink == NULL);
-      nxsem_foreachholder(sem, nxsem_recoverholders, NULL);
-    }
-
-#else
   /* There may be an issue if there are multiple holders of the semaphore. */
 
-  DEBUGASSERT(sem->holder[0].htcb == NULL || sem->holder[1].htcb == NULL);
-
-  sem->holder[0].htcb = NULL;
-  sem->holder[1].htcb = NULL;
+#if CONFIG_SEM_PREALLOCHOLDERS > 0
+  DEBUGASSERT(sem->hhead == NULL);
 #endif
+
+  nxsem_foreachholder(sem, nxsem_recoverholders, NULL);
 }
 
 /****************************************************************************
@@ -1041,11 +943,17 @@ void nxsem_release_holder(FAR sem_t *sem)
   pholder = nxsem_findholder(sem, rtcb);
   if (pholder != NULL && pholder->counts > 0)
     {
-      /* Decrement the counts on this holder -- the holder will be freed
-       * later in nxsem_restore_baseprio.
+      /* Decrement the counts on this holder.  When it gives up its last
+       * count, free the container now so that it is available to the
+       * thread that receives the count, and let nxsem_restore_baseprio()
+       * know that the priority of this thread may have to be restored.
        */
 
-      pholder->counts--;
+      if (--pholder->counts <= 0)
+        {
+          nxsem_freeholder(sem, pholder);
+          sem->flags |= PRIOINHERIT_FLAGS_RELEASED;
+        }
     }
 }
 
@@ -1107,6 +1015,8 @@ void nxsem_restore_baseprio(FAR struct tcb_s *stcb, FAR sem_t *sem)
     {
       nxsem_restore_baseprio_task(stcb, sem);
     }
+
+  sem->flags &= ~PRIOINHERIT_FLAGS_RELEASED;
 }
 
 /****************************************************************************
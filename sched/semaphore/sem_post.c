@@ -200,6 +200,9 @@ int nxsem_post(FAR sem_t *sem)
  *   then one of the tasks blocked waiting for the semaphore shall be
  *   allowed to return successfully from its call to nxsem_wait().
  *
+ *   With CONFIG_SEM_FASTPATH, this is sem_post_slow(), which is called by
+ *   the C library sem_post() when the fast path fails.
+ *
  * Input Parameters:
  *   sem - Semaphore descriptor
  *
@@ -213,7 +216,11 @@ int nxsem_post(FAR sem_t *sem)
  *
  ****************************************************************************/
 
+#ifdef CONFIG_SEM_FASTPATH
+int sem_post_slow(FAR sem_t *sem)
+#else
 int sem_post(FAR sem_t *sem)
+#endif
 {
   int ret;
 
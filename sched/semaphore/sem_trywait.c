@@ -132,6 +132,9 @@ int nxsem_trywait(FAR sem_t *sem)
  *   currently not locked.  In either case, the call returns without
  *   blocking.
  *
+ *   With CONFIG_SEM_FASTPATH, this is sem_trywait_slow(), which is called by
+ *   the C library sem_trywait() when the fast path fails.
+ *
  * Input Parameters:
  *   sem - the semaphore descriptor
  *
@@ -145,7 +148,11 @@ int nxsem_trywait(FAR sem_t *sem)
  *
  ****************************************************************************/
 
+#ifdef CONFIG_SEM_FASTPATH
+int sem_trywait_slow(FAR sem_t *sem)
+#else
 int sem_trywait(FAR sem_t *sem)
+#endif
 {
   int ret;
 
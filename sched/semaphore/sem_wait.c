@@ -234,6 +234,9 @@ int nxsem_wait_uninterruptible(FAR sem_t *sem)
  *   the semaphore value is (<=) zero, then the calling task will not return
  *   until it successfully acquires the lock.
  *
+ *   With CONFIG_SEM_FASTPATH, this is sem_wait_slow(), which is called by
+ *   the C library sem_wait() when the fast path fails.
+ *
  * Input Parameters:
  *   sem - Semaphore descriptor.
  *
@@ -247,7 +250,11 @@ int nxsem_wait_uninterruptible(FAR sem_t *sem)
  *
  ****************************************************************************/
 
+#ifdef CONFIG_SEM_FASTPATH
+int sem_wait_slow(FAR sem_t *sem)
+#else
 int sem_wait(FAR sem_t *sem)
+#endif
 {
   int errcode;
   int ret;
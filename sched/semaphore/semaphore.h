@@ -34,6 +34,17 @@
 #include <sched.h>
 #include <queue.h>
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Internal bit of the struct sem_s flags field, next to the public
+ * PRIOINHERIT_FLAGS_DISABLE:  The posting thread gave up its last count,
+ * so its priority may still have to be restored.
+ */
+
+#define PRIOINHERIT_FLAGS_RELEASED (1 << 1)
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
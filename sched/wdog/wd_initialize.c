@@ -32,12 +32,14 @@
  * Public Data
  ****************************************************************************/
 
+#ifndef CONFIG_WDOG_TIMINGWHEEL
 /* The g_wdactivelist data structure is a singly linked list ordered by
  * watchdog expiration time. When watchdog timers expire,the functions on
  * this linked list are removed and the function is called.
  */
 
 sq_queue_t g_wdactivelist;
+#endif
 
 /* This is wdog tickbase, for wd_gettime() may called many times
  * between 2 times of wd_timer(), we use it to update wd_gettime().
@@ -72,7 +74,13 @@ clock_t g_wdtickbase;
 
 void wd_initialize(void)
 {
+#ifndef CONFIG_WDOG_TIMINGWHEEL
   /* Initialize watchdog lists */
 
   sq_init(&g_wdactivelist);
+#endif
+
+  /* The timing wheel, if selected, resides in .bss and needs no further
+   * initialization.
+   */
 }
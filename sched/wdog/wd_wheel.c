@@ -0,0 +1,790 @@
+/****************************************************************************
+ * sched/wdog/wd_wheel.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <strings.h>
+#include <limits.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/arch.h>
+#include <nuttx/wdog.h>
+
+#include "sched/sched.h"
+#include "wdog/wdog.h"
+
+#ifdef CONFIG_WDOG_TIMINGWHEEL
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Each level of the wheel has 32 slots so that the slot occupancy of a
+ * level fits into one 32-bit bitmap.  A slot at level 'n' spans 32^n ticks
+ * and the complete wheel spans 32^WDOG_WHEEL_LEVELS ticks.  Watchdogs
+ * beyond that range are parked in the last level and re-cascaded until
+ * they come into range.
+ */
+
+#define WDOG_WHEEL_BITS      5
+#define WDOG_WHEEL_SIZE      (1 << WDOG_WHEEL_BITS)
+#define WDOG_WHEEL_MASK      (WDOG_WHEEL_SIZE - 1)
+#define WDOG_WHEEL_LEVELS    CONFIG_WDOG_TIMINGWHEEL_LEVELS
+
+#define WDOG_WHEEL_SHIFT(l)  ((l) * WDOG_WHEEL_BITS)
+#define WDOG_WHEEL_SPAN(l)   ((clock_t)1 << WDOG_WHEEL_SHIFT(l))
+#define WDOG_WHEEL_RANGE     WDOG_WHEEL_SPAN(WDOG_WHEEL_LEVELS)
+
+/* The location of a watchdog in the wheel is saved in wdog->slot */
+
+#define WDOG_SLOT(l,i)       (uint8_t)(((l) << WDOG_WHEEL_BITS) | (i))
+#define WDOG_SLOT_LEVEL(s)   ((s) >> WDOG_WHEEL_BITS)
+#define WDOG_SLOT_INDEX(s)   ((s) & WDOG_WHEEL_MASK)
+
+/* The wheel has its own spinlock with CONFIG_SPINLOCK_SUBSYS.  In tickless
+ * mode, starting and cancelling watchdogs reprograms the interval timer,
+ * which needs the global critical section anyway.
+ */
+
+#ifdef CONFIG_SCHED_TICKLESS
+#  define wd_lock()          enter_critical_section()
+#  define wd_unlock(f)       leave_critical_section(f)
+#else
+#  define wd_lock()          irqspin_lock(&g_wdlock)
+#  define wd_unlock(f)       irqspin_unlock(&g_wdlock, f)
+#endif
+
+/* Watchdog functions run without the wheel lock.  Only in SMP with the
+ * wheel spinlock can another CPU cancel a watchdog while its function is
+ * running, otherwise the global critical section or the disabled interrupts
+ * of the timer interrupt serialize wd_cancel() with the expiration.
+ */
+
+#if defined(CONFIG_SMP) && defined(CONFIG_SPINLOCK_SUBSYS) && \
+    !defined(CONFIG_SCHED_TICKLESS)
+#  define WDOG_TRACK_RUNNING 1
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct wd_wheel_s
+{
+  clock_t now;                              /* Last processed tick */
+  unsigned int count;                       /* Number of active watchdogs */
+  uint32_t bitmap[WDOG_WHEEL_LEVELS];       /* Non-empty slots per level */
+  FAR struct wdog_s *slot[WDOG_WHEEL_LEVELS][WDOG_WHEEL_SIZE];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct wd_wheel_s g_wdwheel;
+
+#ifndef CONFIG_SCHED_TICKLESS
+static irqspinlock_t g_wdlock = IRQSPINLOCK_INITIALIZER(IRQSPIN_RANK_WDOG);
+#endif
+
+#ifdef WDOG_TRACK_RUNNING
+/* The watchdog whose function is running and the CPU that runs it */
+
+static FAR struct wdog_s *volatile g_wdrunning;
+static volatile int g_wdrunningcpu;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_wheel_insert
+ *
+ * Description:
+ *   Link a watchdog into the wheel slot that corresponds to its expiration
+ *   time relative to the current wheel time.
+ *
+ ****************************************************************************/
+
+static void wd_wheel_insert(FAR struct wdog_s *wdog)
+{
+  FAR struct wdog_s **head;
+  clock_t expired = wdog->expired;
+  clock_t delta   = expired - g_wdwheel.now;
+  int level;
+  int index;
+
+  for (level = 0; level < WDOG_WHEEL_LEVELS - 1; level++)
+    {
+      if (delta < WDOG_WHEEL_SPAN(level + 1))
+        {
+          break;
+        }
+    }
+
+  /* Park watchdogs beyond the range of the wheel at the last slot that is
+   * in range.  They will be re-inserted when that slot is cascaded.
+   */
+
+  if (delta >= WDOG_WHEEL_RANGE)
+    {
+      expired = g_wdwheel.now + WDOG_WHEEL_RANGE - 1;
+    }
+
+  index       = (expired >> WDOG_WHEEL_SHIFT(level)) & WDOG_WHEEL_MASK;
+  head        = &g_wdwheel.slot[level][index];
+
+  wdog->slot  = WDOG_SLOT(level, index);
+  wdog->prev  = NULL;
+  wdog->next  = *head;
+
+  if (*head != NULL)
+    {
+      (*head)->prev = wdog;
+    }
+
+  *head = wdog;
+  g_wdwheel.bitmap[level] |= UINT32_C(1) << index;
+}
+
+/****************************************************************************
+ * Name: wd_wheel_remove
+ *
+ * Description:
+ *   Unlink a watchdog from its wheel slot.
+ *
+ ****************************************************************************/
+
+static void wd_wheel_remove(FAR struct wdog_s *wdog)
+{
+  int level = WDOG_SLOT_LEVEL(wdog->slot);
+  int index = WDOG_SLOT_INDEX(wdog->slot);
+
+  if (wdog->prev != NULL)
+    {
+      wdog->prev->next = wdog->next;
+    }
+  else
+    {
+      g_wdwheel.slot[level][index] = wdog->next;
+    }
+
+  if (wdog->next != NULL)
+    {
+      wdog->next->prev = wdog->prev;
+    }
+
+  if (g_wdwheel.slot[level][index] == NULL)
+    {
+      g_wdwheel.bitmap[level] &= ~(UINT32_C(1) << index);
+    }
+
+  wdog->next = NULL;
+  wdog->prev = NULL;
+}
+
+/****************************************************************************
+ * Name: wd_wheel_cascade
+ *
+ * Description:
+ *   Re-insert all watchdogs in a slot of a higher level of the wheel.  Each
+ *   will move to a lower level because less than one slot span of the
+ *   higher level remains until it expires.
+ *
+ ****************************************************************************/
+
+static void wd_wheel_cascade(int level, int index)
+{
+  FAR struct wdog_s *wdog;
+  FAR struct wdog_s *next;
+
+  wdog = g_wdwheel.slot[level][index];
+  g_wdwheel.slot[level][index] = NULL;
+  g_wdwheel.bitmap[level] &= ~(UINT32_C(1) << index);
+
+  for (; wdog != NULL; wdog = next)
+    {
+      next = wdog->next;
+      wd_wheel_insert(wdog);
+    }
+}
+
+/****************************************************************************
+ * Name: wd_wheel_advance
+ *
+ * Description:
+ *   Advance the wheel by one tick and cascade the higher level slots that
+ *   start at the new time.
+ *
+ * Returned Value:
+ *   True if watchdogs expire at the new time.
+ *
+ ****************************************************************************/
+
+static bool wd_wheel_advance(void)
+{
+  clock_t now = ++g_wdwheel.now;
+  int level;
+  int index;
+
+  for (level = 1; level < WDOG_WHEEL_LEVELS; level++)
+    {
+      if ((now & (WDOG_WHEEL_SPAN(level) - 1)) != 0)
+        {
+          break;
+        }
+
+      index = (now >> WDOG_WHEEL_SHIFT(level)) & WDOG_WHEEL_MASK;
+      if ((g_wdwheel.bitmap[level] & (UINT32_C(1) << index)) != 0)
+        {
+          wd_wheel_cascade(level, index);
+        }
+    }
+
+  return g_wdwheel.slot[0][now & WDOG_WHEEL_MASK] != NULL;
+}
+
+/****************************************************************************
+ * Name: wd_wheel_expire
+ *
+ * Description:
+ *   Execute the watchdogs that expire at the current wheel time.
+ *
+ * Input Parameters:
+ *   flags - The interrupt state returned by wd_lock()
+ *
+ * Assumptions:
+ *   Called with the wheel locked.
+ *
+ ****************************************************************************/
+
+static void wd_wheel_expire(FAR irqstate_t *flags)
+{
+  FAR struct wdog_s *wdog;
+  FAR struct wdog_s **head;
+  clock_t now = g_wdwheel.now;
+  wdentry_t func;
+  wdparm_t arg;
+
+  UNUSED(flags);
+
+  /* Execute every watchdog in the current level 0 slot.  The watchdogs are
+   * removed one at a time so that a watchdog function may safely cancel or
+   * restart any watchdog, including others in this slot.  A restarted
+   * watchdog always lands in a different slot.
+   */
+
+  head = &g_wdwheel.slot[0][now & WDOG_WHEEL_MASK];
+
+  while ((wdog = *head) != NULL)
+    {
+      DEBUGASSERT(wdog->expired == now);
+
+      wd_wheel_remove(wdog);
+      g_wdwheel.count--;
+
+      /* Indicate that the watchdog is no longer active. */
+
+      WDOG_CLRACTIVE(wdog);
+
+      /* Execute the watchdog function.  The wheel spinlock is released
+       * while it runs, but in tickless mode the global critical section is
+       * kept like before.
+       */
+
+      func = wdog->func;
+      arg  = wdog->arg;
+      up_setpicbase(wdog->picbase);
+
+#ifdef WDOG_TRACK_RUNNING
+      g_wdrunning    = wdog;
+      g_wdrunningcpu = this_cpu();
+#endif
+#ifndef CONFIG_SCHED_TICKLESS
+      wd_unlock(*flags);
+#endif
+      func(arg);
+#ifndef CONFIG_SCHED_TICKLESS
+      *flags = wd_lock();
+#endif
+#ifdef WDOG_TRACK_RUNNING
+      g_wdrunning = NULL;
+#endif
+    }
+}
+
+/****************************************************************************
+ * Name: wd_wheel_next
+ *
+ * Description:
+ *   Return the number of ticks until the next wheel event: Either the
+ *   expiration of a watchdog in level 0 or the cascade of a non-empty slot
+ *   in a higher level.  The cost is bounded by the number of levels.
+ *
+ * Returned Value:
+ *   The number of ticks until the next event or zero if there are no
+ *   active watchdogs.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+static clock_t wd_wheel_next(void)
+{
+  clock_t next = 0;
+  clock_t block;
+  clock_t delta;
+  uint32_t bitmap;
+  int level;
+  int rot;
+
+  for (level = 0; level < WDOG_WHEEL_LEVELS; level++)
+    {
+      bitmap = g_wdwheel.bitmap[level];
+      if (bitmap == 0)
+        {
+          continue;
+        }
+
+      /* Find the first non-empty slot starting with the next slot of this
+       * level, i.e., rotate the bitmap so that bit 0 is the next slot.
+       */
+
+      block = (g_wdwheel.now >> WDOG_WHEEL_SHIFT(level)) + 1;
+      rot   = block & WDOG_WHEEL_MASK;
+
+      if (rot != 0)
+        {
+          bitmap = (bitmap >> rot) | (bitmap << (WDOG_WHEEL_SIZE - rot));
+        }
+
+      block += ffs((int)bitmap) - 1;
+      delta  = (block << WDOG_WHEEL_SHIFT(level)) - g_wdwheel.now;
+
+      if (next == 0 || delta < next)
+        {
+          next = delta;
+        }
+    }
+
+  return next;
+}
+#endif
+
+/****************************************************************************
+ * Name: wd_wheel_cancel
+ *
+ * Description:
+ *   Remove an active watchdog from the wheel.
+ *
+ * Assumptions:
+ *   Called with the wheel locked.
+ *
+ ****************************************************************************/
+
+static void wd_wheel_cancel(FAR struct wdog_s *wdog)
+{
+#ifdef CONFIG_SCHED_TICKLESS
+  /* Was this watchdog the next event of the interval timer? */
+
+  bool reassess = wdog->expired - g_wdwheel.now <= wd_wheel_next();
+#endif
+
+  /* Remove the watchdog from the wheel and mark it inactive */
+
+  wd_wheel_remove(wdog);
+  g_wdwheel.count--;
+  WDOG_CLRACTIVE(wdog);
+
+#ifdef CONFIG_SCHED_TICKLESS
+  /* Reassess the interval timer that will generate the next interval
+   * event.
+   */
+
+  if (reassess)
+    {
+      nxsched_reassess_timer();
+    }
+#endif
+}
+
+/****************************************************************************
+ * Name: wd_wheel_waitrunning
+ *
+ * Description:
+ *   Wait until the function of 'wdog' is no longer running on another CPU,
+ *   so that nothing of the watchdog is in use when wd_cancel() returns.
+ *   A watchdog function may cancel its own watchdog.
+ *
+ * Input Parameters:
+ *   wdog  - The watchdog to wait for
+ *   flags - The interrupt state returned by wd_lock()
+ *
+ * Assumptions:
+ *   Called with the wheel locked.  The lock is released while waiting.
+ *
+ ****************************************************************************/
+
+#ifdef WDOG_TRACK_RUNNING
+static void wd_wheel_waitrunning(FAR struct wdog_s *wdog,
+                                 FAR irqstate_t *flags)
+{
+  irqstate_t csflags;
+
+  while (g_wdrunning == wdog && g_wdrunningcpu != this_cpu())
+    {
+      /* The expiring CPU holds the global critical section for as long as
+       * watchdog functions run.  Waiting for it there also serves the
+       * pause requests of other CPUs, unlike a plain spin.
+       */
+
+      wd_unlock(*flags);
+      csflags = enter_critical_section();
+      leave_critical_section(csflags);
+      *flags = wd_lock();
+    }
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_start
+ *
+ * Description:
+ *   This function adds a watchdog timer to the timing wheel.  The
+ *   specified watchdog function at 'wdentry' will be called from the
+ *   interrupt level after the specified number of ticks has elapsed.
+ *   Watchdog timers may be started from the interrupt level.
+ *
+ *   Watchdog timers execute in the address environment that was in effect
+ *   when wd_start() is called.
+ *
+ *   Watchdog timers execute only once.
+ *
+ *   To replace either the timeout delay or the function to be executed,
+ *   call wd_start again with the same wdog; only the most recent wdStart()
+ *   on a given watchdog ID has any effect.
+ *
+ * Input Parameters:
+ *   wdog     - Watchdog ID
+ *   delay    - Delay count in clock ticks
+ *   wdentry  - Function to call on timeout
+ *   arg      - Parameter to pass to wdentry
+ *
+ *   NOTE:  The parameter must be of type wdparm_t.
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success; a negated errno value is return to
+ *   indicate the nature of any failure.
+ *
+ * Assumptions:
+ *   The watchdog routine runs in the context of the timer interrupt handler
+ *   and is subject to all ISR restrictions.
+ *
+ ****************************************************************************/
+
+int wd_start(FAR struct wdog_s *wdog, int32_t delay,
+             wdentry_t wdentry, wdparm_t arg)
+{
+  irqstate_t flags;
+
+  /* Verify the wdog and setup parameters */
+
+  if (wdog == NULL || delay < 0)
+    {
+      return -EINVAL;
+    }
+
+  /* Check if the watchdog has been started. If so, stop it. */
+
+  flags = wd_lock();
+  if (WDOG_ISACTIVE(wdog))
+    {
+      wd_wheel_cancel(wdog);
+    }
+
+  /* Save the data in the watchdog structure */
+
+  wdog->func = wdentry;         /* Function to execute when delay expires */
+  up_getpicbase(&wdog->picbase);
+  wdog->arg = arg;
+
+  /* Calculate delay+1, forcing the delay into a range that we can handle */
+
+  if (delay <= 0)
+    {
+      delay = 1;
+    }
+  else if (++delay <= 0)
+    {
+      delay--;
+    }
+
+#ifdef CONFIG_SCHED_TICKLESS
+  /* Cancel the interval timer that drives the timing events.  This will
+   * cause wd_timer to be called which brings the wheel time up to date.
+   */
+
+  nxsched_cancel_timer();
+
+  /* Update clock tickbase if the wheel was empty */
+
+  if (g_wdwheel.count == 0)
+    {
+      g_wdtickbase = clock_systime_ticks();
+    }
+#endif
+
+  /* Add the watchdog to the wheel and mark it as active. */
+
+  wdog->expired = g_wdwheel.now + delay;
+  wd_wheel_insert(wdog);
+  g_wdwheel.count++;
+  WDOG_SETACTIVE(wdog);
+
+#ifdef CONFIG_SCHED_TICKLESS
+  /* Resume the interval timer that will generate the next interval event.
+   * If the next wheel event changed, then this will pick that new delay.
+   */
+
+  nxsched_resume_timer();
+#endif
+
+  wd_unlock(flags);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: wd_cancel
+ *
+ * Description:
+ *   This function cancels a currently running watchdog timer. Watchdog
+ *   timers may be canceled from the interrupt level.
+ *
+ * Input Parameters:
+ *   wdog - ID of the watchdog to cancel.
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success;  A negated errno value is returned to
+ *   indicate the nature of any failure.
+ *
+ ****************************************************************************/
+
+int wd_cancel(FAR struct wdog_s *wdog)
+{
+  irqstate_t flags;
+  int ret = -EINVAL;
+
+  /* Prohibit timer interactions with the timer wheel until the
+   * cancellation is complete
+   */
+
+  flags = wd_lock();
+
+#ifdef WDOG_TRACK_RUNNING
+  /* Do not return while the function of the watchdog is still running */
+
+  if (wdog != NULL)
+    {
+      wd_wheel_waitrunning(wdog, &flags);
+    }
+#endif
+
+  /* Make sure that the watchdog is initialized (non-NULL) and is still
+   * active.
+   */
+
+  if (wdog != NULL && WDOG_ISACTIVE(wdog))
+    {
+      wd_wheel_cancel(wdog);
+      ret = OK;
+    }
+
+  wd_unlock(flags);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: wd_gettime
+ *
+ * Description:
+ *   This function returns the time remaining before the specified watchdog
+ *   timer expires.
+ *
+ * Input Parameters:
+ *   wdog - watchdog ID
+ *
+ * Returned Value:
+ *   The time in system ticks remaining until the watchdog time expires.
+ *   Zero means either that wdog is not valid or that the wdog has already
+ *   expired.
+ *
+ ****************************************************************************/
+
+int wd_gettime(FAR struct wdog_s *wdog)
+{
+  irqstate_t flags;
+  int delay = 0;
+
+  flags = wd_lock();
+  if (wdog != NULL && WDOG_ISACTIVE(wdog))
+    {
+      delay = (int)(wdog->expired - g_wdwheel.now) - (int)wd_elapse();
+    }
+
+  wd_unlock(flags);
+  return delay;
+}
+
+/****************************************************************************
+ * Name: wd_timer
+ *
+ * Description:
+ *   This function is called from the timer interrupt handler to determine
+ *   if it is time to execute a watchdog function.  If so, the watchdog
+ *   function will be executed in the context of the timer interrupt
+ *   handler.
+ *
+ * Input Parameters:
+ *   ticks - If CONFIG_SCHED_TICKLESS is defined then the number of ticks
+ *     in the interval that just expired is provided.  Otherwise,
+ *     this function is called on each timer interrupt and a value of one
+ *     is implicit.
+ *
+ * Returned Value:
+ *   If CONFIG_SCHED_TICKLESS is defined then the number of ticks for the
+ *   next delay is provided (zero if no delay).  Otherwise, this function
+ *   has no returned value.
+ *
+ * Assumptions:
+ *   Called from interrupt handler logic with interrupts disabled.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+unsigned int wd_timer(int ticks)
+{
+  irqstate_t flags;
+  clock_t next;
+
+  /* We are in an interrupt handler as, as a consequence, interrupts are
+   * disabled.  But in the SMP case, interrupts MAY be disabled only on
+   * the local CPU since most architectures do not permit disabling
+   * interrupts on other CPUS.
+   *
+   * Hence, we must follow rules for critical sections even here in the
+   * SMP case.  The wheel lock is released while watchdog functions run.
+   */
+
+  flags = wd_lock();
+
+  /* Skip directly from one wheel event to the next.  Ticks without an
+   * event need no processing at all.
+   */
+
+  while (ticks > 0 && (next = wd_wheel_next()) != 0 &&
+         next <= (clock_t)ticks)
+    {
+      g_wdwheel.now += next - 1;
+      g_wdtickbase  += next;
+      ticks         -= next;
+
+      if (wd_wheel_advance())
+        {
+          wd_wheel_expire(&flags);
+        }
+    }
+
+  /* No further event in the remaining ticks */
+
+  g_wdwheel.now += ticks;
+  g_wdtickbase  += ticks;
+
+  /* Return the delay for the next wheel event */
+
+  next = wd_wheel_next();
+  wd_unlock(flags);
+
+  return next > UINT_MAX ? UINT_MAX : (unsigned int)next;
+}
+
+#else
+void wd_timer(void)
+{
+  irqstate_t flags;
+  bool expire = false;
+
+  /* We are in an interrupt handler as, as a consequence, interrupts are
+   * disabled.  But in the SMP case, interrupts MAY be disabled only on
+   * the local CPU since most architectures do not permit disabling
+   * interrupts on other CPUS.  Hence, the wheel must be locked even here.
+   */
+
+  flags = wd_lock();
+
+  /* Check if there are any active watchdogs to process */
+
+  if (g_wdwheel.count > 0)
+    {
+      expire = wd_wheel_advance();
+    }
+  else
+    {
+      g_wdwheel.now++;
+    }
+
+  wd_unlock(flags);
+
+  /* Only ticks with expiring watchdogs need the global critical section:
+   * In the SMP case, the watchdog functions expect to run in it, as they
+   * did before the wheel had its own lock.  Watchdogs cannot be added to
+   * the current slot while the wheel is unlocked.
+   */
+
+  if (expire)
+    {
+#ifdef CONFIG_SMP
+      irqstate_t csflags = enter_critical_section();
+#endif
+
+      flags = wd_lock();
+      wd_wheel_expire(&flags);
+      wd_unlock(flags);
+
+#ifdef CONFIG_SMP
+      leave_critical_section(csflags);
+#endif
+    }
+}
+#endif /* CONFIG_SCHED_TICKLESS */
+#endif /* CONFIG_WDOG_TIMINGWHEEL */
@@ -0,0 +1,616 @@
+/****************************************************************************
+ * tools/notetrace.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* These must match include/nuttx/sched_note.h and
+ * include/nuttx/note/noteram_driver.h
+ */
+
+#define NOTE_START           0
+#define NOTE_STOP            1
+#define NOTE_SUSPEND         2
+#define NOTE_RESUME          3
+#define NOTE_CPU_START       4
+#define NOTE_CPU_STARTED     5
+#define NOTE_CPU_PAUSE       6
+#define NOTE_CPU_PAUSED      7
+#define NOTE_CPU_RESUME      8
+#define NOTE_CPU_RESUMED     9
+#define NOTE_PREEMPT_LOCK    10
+#define NOTE_PREEMPT_UNLOCK  11
+#define NOTE_CSECTION_ENTER  12
+#define NOTE_CSECTION_LEAVE  13
+#define NOTE_SPINLOCK_LOCK   14
+#define NOTE_SPINLOCK_LOCKED 15
+#define NOTE_SPINLOCK_UNLOCK 16
+#define NOTE_SPINLOCK_ABORT  17
+#define NOTE_SYSCALL_ENTER   18
+#define NOTE_SYSCALL_LEAVE   19
+#define NOTE_IRQ_ENTER       20
+#define NOTE_IRQ_LEAVE       21
+
+#define NOTERAM_COMPACT_VERSION 1
+#define NOTERAM_CPU_HEADER      0xff
+
+#define NOTERAM_STATE_READY     0
+#define NOTERAM_STATE_WAIT_SEM  1
+#define NOTERAM_STATE_WAIT_SIG  2
+#define NOTERAM_STATE_WAIT_MQ   3
+#define NOTERAM_STATE_OTHER     4
+
+#define MAX_CPUS             32
+#define MAX_PIDS             65536
+#define MAX_NAME             32
+
+/* Trace viewer process IDs of the CPU and the task timelines */
+
+#define TRACE_CPUS           0
+#define TRACE_TASKS          1
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct task_s
+{
+  char name[MAX_NAME];       /* Task name from NOTE_START, if any */
+  bool seen;                 /* The task appeared in the trace */
+  bool waiting;              /* A wait slice is open */
+  int syscalls;              /* Number of open syscall slices */
+};
+
+struct cpu_s
+{
+  int running;               /* PID with an open run slice or -1 */
+  int irqs;                  /* Number of open IRQ slices */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct task_s g_tasks[MAX_PIDS];
+static struct cpu_s g_cpus[MAX_CPUS];
+static FILE *g_out;
+static bool g_first = true;
+static int g_ncpus = 1;
+static double g_usec_per_unit;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void show_usage(const char *progname, int exitcode)
+{
+  fprintf(stderr, "USAGE: %s [-o <json-file>] <note-file>\n", progname);
+  fprintf(stderr, "\nWhere:\n");
+  fprintf(stderr, "  <note-file>\n");
+  fprintf(stderr, "    A copy of /dev/note taken with "
+                  "CONFIG_DRIVER_NOTERAM_COMPACT=y\n");
+  fprintf(stderr, "  -o <json-file>\n");
+  fprintf(stderr, "    The Chrome trace event file to write.  Default: "
+                  "stdout.\n");
+  fprintf(stderr, "\nThe output can be loaded into chrome://tracing or "
+                  "ui.perfetto.dev.\n");
+  exit(exitcode);
+}
+
+/* Decode an unsigned LEB128 varint.  Returns the number of bytes used or
+ * zero if the varint does not fit into the remaining record.
+ */
+
+static size_t get_varint(const uint8_t *ptr, size_t len, uint64_t *value)
+{
+  uint64_t result = 0;
+  size_t i;
+
+  for (i = 0; i < len && i < 10; i++)
+    {
+      result |= (uint64_t)(ptr[i] & 0x7f) << (7 * i);
+      if ((ptr[i] & 0x80) == 0)
+        {
+          *value = result;
+          return i + 1;
+        }
+    }
+
+  return 0;
+}
+
+static const char *task_name(int pid, char *buffer, size_t size)
+{
+  if (g_tasks[pid].name[0] != '\0')
+    {
+      snprintf(buffer, size, "%.*s (%d)", MAX_NAME - 1, g_tasks[pid].name,
+               pid);
+    }
+  else
+    {
+      snprintf(buffer, size, "pid %d", pid);
+    }
+
+  return buffer;
+}
+
+static void emit(const char *ph, const char *name, int pid, int tid,
+                 double ts, const char *args)
+{
+  fprintf(g_out, "%s\n  {\"ph\":\"%s\",\"name\":\"%s\",\"pid\":%d,"
+          "\"tid\":%d,\"ts\":%.3f", g_first ? "" : ",", ph, name, pid, tid,
+          ts);
+
+  if (ph[0] == 'i')
+    {
+      fprintf(g_out, ",\"s\":\"t\"");
+    }
+
+  if (args != NULL)
+    {
+      fprintf(g_out, ",\"args\":{%s}", args);
+    }
+
+  fprintf(g_out, "}");
+  g_first = false;
+}
+
+static void emit_name(const char *kind, int pid, int tid, const char *name)
+{
+  fprintf(g_out, "%s\n  {\"ph\":\"M\",\"name\":\"%s\",\"pid\":%d,"
+          "\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+          g_first ? "" : ",", kind, pid, tid, name);
+  g_first = false;
+}
+
+/* Close the run slice of the task running on a CPU */
+
+static void cpu_idle(int cpu, double ts)
+{
+  if (g_cpus[cpu].running >= 0)
+    {
+      emit("E", "", TRACE_CPUS, cpu * 2, ts, NULL);
+      g_cpus[cpu].running = -1;
+    }
+}
+
+static const char *wait_name(int state)
+{
+  switch (state)
+    {
+      case NOTERAM_STATE_WAIT_SEM:
+        return "wait semaphore";
+
+      case NOTERAM_STATE_WAIT_SIG:
+        return "wait signal";
+
+      case NOTERAM_STATE_WAIT_MQ:
+        return "wait message queue";
+
+      case NOTERAM_STATE_OTHER:
+        return "blocked";
+
+      default:
+        return NULL;
+    }
+}
+
+static void handle_note(int cpu, double ts, const uint8_t *ptr, size_t len)
+{
+  char name[MAX_NAME + 16];
+  char args[64];
+  uint64_t value;
+  uint64_t pid64;
+  size_t n;
+  size_t i;
+  int taskcpu = cpu;
+  int type;
+  int prio = 0;
+  int pid;
+
+  type = *ptr++;
+  len--;
+
+  n = get_varint(ptr, len, &pid64);
+  if (n == 0 || pid64 >= MAX_PIDS)
+    {
+      return;
+    }
+
+  ptr += n;
+  len -= n;
+  pid  = (int)pid64;
+  g_tasks[pid].seen = true;
+
+  /* Task state notes carry the priority and, on SMP, the CPU of the task */
+
+  if (type <= NOTE_RESUME)
+    {
+      if (len < (g_ncpus > 1 ? 2 : 1))
+        {
+          return;
+        }
+
+      prio = *ptr++;
+      len--;
+
+      if (g_ncpus > 1)
+        {
+          taskcpu = *ptr++;
+          len--;
+        }
+
+      if (taskcpu >= g_ncpus)
+        {
+          taskcpu = cpu;
+        }
+    }
+
+  switch (type)
+    {
+      case NOTE_START:
+
+        /* Keep the name safe for use in a JSON string */
+
+        n = len < MAX_NAME - 1 ? len : MAX_NAME - 1;
+        for (i = 0; i < n; i++)
+          {
+            g_tasks[pid].name[i] = (ptr[i] < ' ' || ptr[i] > '~' ||
+                                    ptr[i] == '"' || ptr[i] == '\\') ?
+                                   '_' : ptr[i];
+          }
+
+        g_tasks[pid].name[n] = '\0';
+
+        snprintf(args, sizeof(args), "\"priority\":%d", prio);
+        emit("i", "start", TRACE_TASKS, pid, ts, args);
+        break;
+
+      case NOTE_STOP:
+        if (g_cpus[taskcpu].running == pid)
+          {
+            cpu_idle(taskcpu, ts);
+          }
+
+        emit("i", "stop", TRACE_TASKS, pid, ts, NULL);
+        break;
+
+      case NOTE_SUSPEND:
+        if (g_cpus[taskcpu].running == pid)
+          {
+            cpu_idle(taskcpu, ts);
+          }
+
+        if (len > 0 && wait_name(*ptr) != NULL && !g_tasks[pid].waiting)
+          {
+            emit("B", wait_name(*ptr), TRACE_TASKS, pid, ts, NULL);
+            g_tasks[pid].waiting = true;
+          }
+        break;
+
+      case NOTE_RESUME:
+        if (g_tasks[pid].waiting)
+          {
+            emit("E", "", TRACE_TASKS, pid, ts, NULL);
+            g_tasks[pid].waiting = false;
+          }
+
+        cpu_idle(taskcpu, ts);
+
+        snprintf(args, sizeof(args), "\"priority\":%d", prio);
+        emit("B", task_name(pid, name, sizeof(name)), TRACE_CPUS,
+             taskcpu * 2, ts, args);
+        g_cpus[taskcpu].running = pid;
+        break;
+
+      case NOTE_CPU_START:
+      case NOTE_CPU_PAUSE:
+      case NOTE_CPU_RESUME:
+        if (len > 0)
+          {
+            snprintf(args, sizeof(args), "\"target\":%d", *ptr);
+            emit("i", type == NOTE_CPU_START ? "cpu start" :
+                      type == NOTE_CPU_PAUSE ? "cpu pause" : "cpu resume",
+                 TRACE_CPUS, cpu * 2, ts, args);
+          }
+        break;
+
+      case NOTE_CPU_STARTED:
+      case NOTE_CPU_PAUSED:
+      case NOTE_CPU_RESUMED:
+        emit("i", type == NOTE_CPU_STARTED ? "cpu started" :
+                  type == NOTE_CPU_PAUSED ? "cpu paused" : "cpu resumed",
+             TRACE_CPUS, cpu * 2, ts, NULL);
+        break;
+
+      case NOTE_PREEMPT_LOCK:
+      case NOTE_PREEMPT_UNLOCK:
+      case NOTE_CSECTION_ENTER:
+      case NOTE_CSECTION_LEAVE:
+        if (get_varint(ptr, len, &value) > 0)
+          {
+            snprintf(args, sizeof(args), "\"count\":%llu",
+                     (unsigned long long)value);
+          }
+        else
+          {
+            args[0] = '\0';
+          }
+
+        emit("i", type == NOTE_PREEMPT_LOCK ? "sched_lock" :
+                  type == NOTE_PREEMPT_UNLOCK ? "sched_unlock" :
+                  type == NOTE_CSECTION_ENTER ? "csection enter" :
+                                                "csection leave",
+             TRACE_TASKS, pid, ts, args[0] != '\0' ? args : NULL);
+        break;
+
+      case NOTE_SPINLOCK_LOCK:
+      case NOTE_SPINLOCK_LOCKED:
+      case NOTE_SPINLOCK_UNLOCK:
+      case NOTE_SPINLOCK_ABORT:
+        if (get_varint(ptr, len, &value) > 0)
+          {
+            snprintf(args, sizeof(args), "\"spinlock\":\"0x%llx\"",
+                     (unsigned long long)value);
+            emit("i", type == NOTE_SPINLOCK_LOCK ? "spin lock" :
+                      type == NOTE_SPINLOCK_LOCKED ? "spin locked" :
+                      type == NOTE_SPINLOCK_UNLOCK ? "spin unlock" :
+                                                     "spin abort",
+                 TRACE_TASKS, pid, ts, args);
+          }
+        break;
+
+      case NOTE_SYSCALL_ENTER:
+        if (len > 0)
+          {
+            snprintf(name, sizeof(name), "syscall %d", *ptr);
+            emit("B", name, TRACE_TASKS, pid, ts, NULL);
+            g_tasks[pid].syscalls++;
+          }
+        break;
+
+      case NOTE_SYSCALL_LEAVE:
+        if (len > 1 && g_tasks[pid].syscalls > 0 &&
+            get_varint(ptr + 1, len - 1, &value) > 0)
+          {
+            /* The result is zigzag encoded */
+
+            snprintf(args, sizeof(args), "\"result\":%lld",
+                     (long long)((value >> 1) ^ -(int64_t)(value & 1)));
+            emit("E", "", TRACE_TASKS, pid, ts, args);
+            g_tasks[pid].syscalls--;
+          }
+        break;
+
+      case NOTE_IRQ_ENTER:
+        if (len > 0)
+          {
+            snprintf(name, sizeof(name), "irq %d", *ptr);
+            emit("B", name, TRACE_CPUS, cpu * 2 + 1, ts, NULL);
+            g_cpus[cpu].irqs++;
+          }
+        break;
+
+      case NOTE_IRQ_LEAVE:
+        if (g_cpus[cpu].irqs > 0)
+          {
+            emit("E", "", TRACE_CPUS, cpu * 2 + 1, ts, NULL);
+            g_cpus[cpu].irqs--;
+          }
+        break;
+
+      default:
+        break;
+    }
+}
+
+static int handle_header(const uint8_t *record, size_t len)
+{
+  uint64_t low;
+  uint64_t high;
+  size_t n;
+  size_t m;
+
+  if (len < 5 || record[2] != NOTERAM_COMPACT_VERSION)
+    {
+      fprintf(stderr, "ERROR: Unsupported note stream version\n");
+      return -1;
+    }
+
+  g_ncpus = record[3];
+  if (g_ncpus < 1 || g_ncpus > MAX_CPUS)
+    {
+      fprintf(stderr, "ERROR: Bad number of CPUs: %d\n", g_ncpus);
+      return -1;
+    }
+
+  n = get_varint(&record[4], len - 4, &low);
+  m = n > 0 ? get_varint(&record[4 + n], len - 4 - n, &high) : 0;
+  if (m == 0)
+    {
+      fprintf(stderr, "ERROR: Bad note stream header\n");
+      return -1;
+    }
+
+  g_usec_per_unit = (double)(high << 32 | low) / 1024 / 1000;
+  return 0;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv)
+{
+  char name[MAX_NAME + 16];
+  uint8_t record[256];
+  uint64_t stamp = 0;
+  uint64_t delta;
+  bool header = false;
+  FILE *in;
+  size_t len;
+  size_t n;
+  int cpu;
+  int pid;
+  int ch;
+
+  g_out = stdout;
+
+  while ((ch = getopt(argc, argv, ":o:h")) > 0)
+    {
+      switch (ch)
+        {
+          case 'o':
+            g_out = fopen(optarg, "w");
+            if (g_out == NULL)
+              {
+                fprintf(stderr, "ERROR: Failed to open %s\n", optarg);
+                return EXIT_FAILURE;
+              }
+            break;
+
+          case 'h':
+            show_usage(argv[0], EXIT_SUCCESS);
+            break;
+
+          default:
+            show_usage(argv[0], EXIT_FAILURE);
+            break;
+        }
+    }
+
+  if (optind != argc - 1)
+    {
+      show_usage(argv[0], EXIT_FAILURE);
+    }
+
+  in = fopen(argv[optind], "rb");
+  if (in == NULL)
+    {
+      fprintf(stderr, "ERROR: Failed to open %s\n", argv[optind]);
+      return EXIT_FAILURE;
+    }
+
+  for (cpu = 0; cpu < MAX_CPUS; cpu++)
+    {
+      g_cpus[cpu].running = -1;
+    }
+
+  fprintf(g_out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+  /* Read one record at a time.  The first byte is the record length. */
+
+  while ((ch = fgetc(in)) != EOF)
+    {
+      len = ch;
+      if (len < 3)
+        {
+          fprintf(stderr, "ERROR: Bad record length %zu\n", len);
+          break;
+        }
+
+      record[0] = len;
+      if (fread(&record[1], 1, len - 1, in) != len - 1)
+        {
+          fprintf(stderr, "WARNING: Truncated record\n");
+          break;
+        }
+
+      if (record[1] == NOTERAM_CPU_HEADER)
+        {
+          if (handle_header(record, len) < 0)
+            {
+              break;
+            }
+
+          /* Each header starts a new stream with time relative to zero */
+
+          header = true;
+          stamp  = 0;
+          continue;
+        }
+
+      if (!header)
+        {
+          fprintf(stderr, "ERROR: Missing note stream header\n");
+          break;
+        }
+
+      cpu = record[1];
+      n   = get_varint(&record[2], len - 2, &delta);
+      if (cpu >= g_ncpus || n == 0 || 2 + n >= len)
+        {
+          fprintf(stderr, "WARNING: Skipping malformed record\n");
+          continue;
+        }
+
+      /* The delta is a 32-bit difference of time stamps and goes backwards
+       * when the record is older than the previous one of another CPU.
+       */
+
+      stamp += (int32_t)delta;
+      handle_note(cpu, stamp * g_usec_per_unit, &record[2 + n],
+                  len - 2 - n);
+    }
+
+  /* Name the timelines */
+
+  emit_name("process_name", TRACE_CPUS, 0, "CPUs");
+  emit_name("process_name", TRACE_TASKS, 0, "Tasks");
+
+  for (cpu = 0; cpu < g_ncpus; cpu++)
+    {
+      snprintf(name, sizeof(name), "CPU %d", cpu);
+      emit_name("thread_name", TRACE_CPUS, cpu * 2, name);
+      snprintf(name, sizeof(name), "CPU %d IRQ", cpu);
+      emit_name("thread_name", TRACE_CPUS, cpu * 2 + 1, name);
+    }
+
+  for (pid = 0; pid < MAX_PIDS; pid++)
+    {
+      if (g_tasks[pid].seen)
+        {
+          emit_name("thread_name", TRACE_TASKS, pid,
+                    task_name(pid, name, sizeof(name)));
+        }
+    }
+
+  fprintf(g_out, "\n]}\n");
+
+  fclose(in);
+  if (g_out != stdout)
+    {
+      fclose(g_out);
+    }
+
+  return EXIT_SUCCESS;
+}